@@ -54,7 +54,8 @@ def Run():
     dataBuildScript = [
         "compile_sponza_model.py",
         "compile_pbr_materials.py",
-        "compile_utility_textures.py"
+        "compile_utility_textures.py",
+        "pack_assets.py"
         ]
 
     #################
@@ -23,6 +23,7 @@
 #define FRAMEWORK_H_
 
 #include <string>
+#include <vector>
 
 namespace AppFramework
 {
@@ -34,6 +35,7 @@ namespace AppFramework
             , m_bPauseRendering(false)
             , m_bPauseUpdate(false)
             , m_fDeltaTime(0.f)
+            , m_fFixedDeltaTime(0.f)
             , m_eWindowMode(WM_WINDOWED)
             , m_szTitle("PLACEHOLDER")
         { m_pInstance = this; };
@@ -71,6 +73,12 @@ namespace AppFramework
 
         float GetDeltaTime() const { return m_fDeltaTime; } // in seconds
 
+        // Override the measured delta time with a constant value, for deterministic updates (0 to disable)
+        void SetFixedDeltaTime(const float fixedDeltaTime) { m_fFixedDeltaTime = fixedDeltaTime; } // in seconds
+
+        // Command line arguments, excluding the executable path
+        const std::vector<std::string>& GetCommandLineArgs() const { return m_arrCommandLineArgs; }
+
     protected:
         enum WindowMode
         {
@@ -86,6 +94,8 @@ namespace AppFramework
         bool m_bPauseRendering; // Pause rendering when not in focus
         bool m_bPauseUpdate;
         float m_fDeltaTime; // in seconds
+        float m_fFixedDeltaTime; // in seconds
+        std::vector<std::string> m_arrCommandLineArgs;
         std::string m_szTitle;
         static Framework* m_pInstance;
     };
@@ -57,10 +57,13 @@ namespace AppFramework
     }
 }
 
-void FrameworkWin::Init(HINSTANCE& hInstance, int& nCmdShow)
+void FrameworkWin::Init(HINSTANCE& hInstance, int& nCmdShow, int argc, char** argv)
 {
     m_hInstance = hInstance;
     m_nCmdShow = nCmdShow;
+
+    for (int i = 1; i < argc; i++)
+        m_arrCommandLineArgs.push_back(argv[i]);
 }
 
 int FrameworkWin::Run()
@@ -547,7 +550,7 @@ float FrameworkWin::CalculateDeltaTime()
     if (m_nTicksPrev == 0) m_nTicksPrev = ticksNow;
     const unsigned int deltaTicks = ticksNow - m_nTicksPrev;
     m_nTicksPrev = ticksNow;
-    m_fDeltaTime = (float)deltaTicks / 1000000.f;
+    m_fDeltaTime = m_fFixedDeltaTime > 0.f ? m_fFixedDeltaTime : (float)deltaTicks / 1000000.f;
     return m_fDeltaTime;
 }
 
@@ -38,7 +38,7 @@ namespace AppFramework
         {};
         ~FrameworkWin() {};
 
-        void Init(HINSTANCE& hInstance, int& nCmdShow);
+        void Init(HINSTANCE& hInstance, int& nCmdShow, int argc, char** argv);
         int Run();
 
         void ShowCursor(const bool bShow);
@@ -39,6 +39,7 @@ int APIENTRY _tWinMain(
     UNREFERENCED_PARAMETER(lpCmdLine);
 
     FrameworkWin fw;
-    fw.Init(hInstance, nCmdShow);
+    // The CRT has already split the command line
+    fw.Init(hInstance, nCmdShow, __argc, __argv);
     return fw.Run();
 }
@@ -23,12 +23,14 @@
 
 #include <time.h>
 #include <sstream>
+#include <fstream>
 
 #include <imgui.h>
 #include <imgui_internal.h>
 
 #include <Renderer.h>
 #include <ResourceManager.h>
+#include <ShaderCache.h>
 #include <Texture.h>
 #include <VertexBuffer.h>
 #include <IndexBuffer.h>
@@ -84,9 +86,27 @@ bool GITechDemo::Init(void* hWnd)
 {
     Framework* const pFW = Framework::GetInstance();
 
+    // Command line options:
+    //  -api null               Don't render anything (e.g. for tracking CPU performance without a GPU)
+    //  -benchmark <script>     Run a benchmark script, then quit (see Benchmark)
+    API api = API_DX9;
+    const char* benchmarkScript = nullptr;
+    const std::vector<std::string>& args = pFW->GetCommandLineArgs();
+    for (unsigned int i = 0; i < args.size(); i++)
+    {
+        if (args[i] == "-api" && i + 1 < args.size())
+        {
+            if (args[++i] == "null")
+                api = API_NULL;
+        }
+        else if (args[i] == "-benchmark" && i + 1 < args.size())
+        {
+            benchmarkScript = args[++i].c_str();
+        }
+    }
+
     // Renderer MUST be initialized on the SAME thread as the target window
-    Renderer::CreateInstance(API_DX9);
-    //Renderer::CreateInstance(API_NULL);
+    Renderer::CreateInstance(api);
 
     Renderer* RenderContext = Renderer::GetInstance();
     if (!RenderContext)
@@ -98,6 +118,13 @@ bool GITechDemo::Init(void* hWnd)
     if (!ResourceMgr)
         return false;
 
+    // Load models and textures from the asset pack, if the data build produced one (see pack_assets.py);
+    // anything not in it is loaded from its own file
+    ResourceManager::MountAssetPack("GITechDemo.s3dpak");
+
+    // Reuse shader programs compiled on previous runs; editing a shader or any file it includes invalidates its entries
+    RenderContext->GetShaderCache()->SetDirectory("ShaderCache");
+
     // Set initial camera position
     m_tCamera.vPos = Vec3f(-828.031738f, -651.508972f, -100.693771f);
     m_tCamera.mRot.set(
@@ -137,7 +164,7 @@ bool GITechDemo::Init(void* hWnd)
 
     const std::vector<Synesthesia3D::DeviceCaps::SupportedScreenFormat>& arrSupportedScreenFormats = RenderContext->GetDeviceCaps().arrSupportedScreenFormats;
 
-    // Build a list of all available resolutions
+    // Build a list of all available resolutions (the NULL renderer doesn't report any)
     BuildSupportedResolutionList();
 
     // Set the highest resolution available (hopefully it's the native one...)
@@ -152,7 +179,8 @@ bool GITechDemo::Init(void* hWnd)
     }
 
     // Build a list of all available refresh rates for the specified resolution
-    BuildSupportedRefreshRateList(m_arrSupportedResolutionList[RenderConfig::Window::ResolutionIdx].GetResolution());
+    if (!m_arrSupportedResolutionList.empty())
+        BuildSupportedRefreshRateList(m_arrSupportedResolutionList[RenderConfig::Window::ResolutionIdx].GetResolution());
 
     // Set the highest available refresh rate for the selected resolution
     for (int i = 0, bestRefreshRate = 0; i < m_arrSupportedRefreshRateList.size(); i++)
@@ -174,6 +202,26 @@ bool GITechDemo::Init(void* hWnd)
 
     HLSL::FrameParams->ViewProjMat = MAT_IDENTITY44F;
 
+    // Alias transient render targets before the resource loading threads create them
+    RenderScheme::CompileRenderGraph();
+
+    if (benchmarkScript)
+    {
+        if (m_tBenchmark.Load(benchmarkScript))
+        {
+            // Updates are deterministic and frame times aren't capped by the display
+            pFW->SetFixedDeltaTime(m_tBenchmark.GetTimeStep());
+            RenderConfig::Window::VSync = false;
+        }
+        else
+        {
+            pFW->Quit();
+        }
+    }
+
+    // The loader threads are started right after this
+    m_tStartupTimeline.Begin();
+
     return true;
 }
 
@@ -187,11 +235,15 @@ void GITechDemo::Release()
 
     bExtraResInit = false;
 
+    m_tTextureStreamer.Stop();
+
     ImGui::Shutdown();
     RenderScheme::ReleaseResources();
 
     RenderResource::FreeAll();
     Renderer::DestroyInstance();
+
+    ResourceManager::UnmountAssetPacks();
 }
 
 void GITechDemo::LoadResources(unsigned int thId, unsigned int thCount)
@@ -200,6 +252,10 @@ void GITechDemo::LoadResources(unsigned int thId, unsigned int thCount)
     if (!pFW)
         return;
 
+    Renderer* RenderContext = Renderer::GetInstance();
+    if (RenderContext && RenderContext->GetProfiler())
+        RenderContext->GetProfiler()->SetCPUProfileThreadName(("Loader thread " + tostr(thId)).c_str());
+
     bool bAllInitialized = false;
     do
     {
@@ -207,22 +263,41 @@ void GITechDemo::LoadResources(unsigned int thId, unsigned int thCount)
         const vector<RenderResource*>& resList = RenderResource::GetResourceList();
         for (unsigned int i = 0; i < resList.size(); i++)
         {
+            // Slots of released resources are cleared
+            if (!resList[i])
+                continue;
+
+            // Render targets used by the render scheme are created on demand by the render graph
+            if (resList[i]->GetResourceType() == RenderResource::RES_RENDERTARGET && RenderGraph::IsManaged((GITechDemoApp::RenderTarget*)resList[i]))
+                continue;
+
             if (!resList[i]->IsInitialized())
             {
                 bAllInitialized = false;
                 if (resList[i]->TryLockRes())
                 {
-                    std::stringstream msg;
-                    msg << "Thread " << thId << " - ";
-                    msg << RenderResource::ms_ResourceTypeMap[resList[i]->GetResourceType()] << ": \"" << resList[i]->GetDesc() << "\"";
-                    cout << msg.str() + " start\n";
-                    const unsigned startTicks = pFW->GetTicks();
-                    resList[i]->Init();
-                    cout << msg.str() + " finished in " + tostr((float)(pFW->GetTicks() - startTicks) / 1000.f) + "ms\n";
+                    const long long startTime = m_tStartupTimeline.BeginEntry();
+                    bool initialized = false;
+                    {
+                        CPU_PROFILE_SCOPE(resList[i]->GetDesc());
+                        ResourceManager::PushMemoryOwner(RenderResource::ms_ResourceTypeMap[resList[i]->GetResourceType()]);
+                        initialized = resList[i]->Init();
+                        ResourceManager::PopMemoryOwner();
+                    }
+                    if (initialized)
+                    {
+                        std::stringstream msg;
+                        StartupTimeline::WriteEntry(msg,
+                            m_tStartupTimeline.EndEntry(
+                                thId, resList[i]->GetDesc(), RenderResource::ms_ResourceTypeMap[resList[i]->GetResourceType()], startTime,
+                                resList[i]->GetCreationTime(), resList[i]->GetCreationThreadId()));
+                        cout << msg.str();
+                    }
                     resList[i]->UnlockRes();
                 }
             }
         }
+        CPU_PROFILE_SCOPE("Wait for resources");
         pFW->Sleep(1); // sleep 1 ms so as not to hog CPU time
     } while (!bAllInitialized);
 
@@ -231,34 +306,59 @@ void GITechDemo::LoadResources(unsigned int thId, unsigned int thCount)
     {
         if (!bExtraResInit)
         {
-            std::stringstream msg;
-            msg << "Thread " << thId << " - ";
-            msg << "RenderScheme::AllocateResources()";
-            cout << msg.str() + " start\n";
-
-            const unsigned startTicks = pFW->GetTicks();
+            const long long startTime = m_tStartupTimeline.BeginEntry();
 
             // Misc. resources
-            RenderScheme::AllocateResources();
+            {
+                CPU_PROFILE_SCOPE("RenderScheme::AllocateResources()");
+                RenderScheme::AllocateResources();
+            }
 
             bExtraResInit = true;
 
-            cout << msg.str() + " finished in " + tostr((float)(pFW->GetTicks() - startTicks) / 1000.f) + "ms\n";
+            std::stringstream msg;
+            StartupTimeline::WriteEntry(msg,
+                m_tStartupTimeline.EndEntry(
+                    thId, "RenderScheme::AllocateResources()", "RenderScheme", startTime,
+                    0, std::thread::id(), true));
+            cout << msg.str();
         }
         MUTEX_UNLOCK(mResInitMutex);
     }
+
+    // Every thread is done with its own work by now, so the last one to get here reports on all of them
+    if (m_tStartupTimeline.EndThread(thCount))
+    {
+        std::stringstream report;
+        m_tStartupTimeline.WriteReport(report);
+        cout << report.str();
+
+        std::ofstream file("GITechDemo_startup.txt", std::ios::out | std::ios::trunc);
+        if (file.is_open())
+            file << report.str();
+    }
 }
 
 void GITechDemo::Update(const float fDeltaTime)
 {
+    CPU_PROFILE_SCOPE("GITechDemo::Update()");
+
     m_fDeltaTime = fDeltaTime;
     
     Renderer* RenderContext = Renderer::GetInstance();
     if (!RenderContext)
         return;
 
-    int cLeft, cTop, cRight, cBottom;
     Framework* const pFW = Framework::GetInstance();
+
+    // Scripted camera and parameters take precedence over user input
+    if (IsBenchmarkRunning())
+    {
+        m_tBenchmark.Update(m_tCamera.vPos, m_tCamera.mRot);
+        pFW->PauseRendering(false);
+    }
+
+    int cLeft, cTop, cRight, cBottom;
     pFW->GetClientArea(cLeft, cTop, cRight, cBottom);
     const Vec2i viewportSize = Vec2i(cRight - cLeft, cBottom - cTop);
 
@@ -269,7 +369,7 @@ void GITechDemo::Update(const float fDeltaTime)
         m_vLastFrameViewport != Vec2i(-1, -1) ||
         m_nLastFrameRefreshRate != -1)
     {
-        if (RenderConfig::Window::ResolutionIdx != m_nLastFrameRes)
+        if (RenderConfig::Window::ResolutionIdx != m_nLastFrameRes && !m_arrSupportedResolutionList.empty())
         {
             BuildSupportedRefreshRateList(m_arrSupportedResolutionList[RenderConfig::Window::ResolutionIdx].GetResolution());
 
@@ -310,10 +410,10 @@ void GITechDemo::Update(const float fDeltaTime)
             pFW->OnSwitchToWindowedMode();
 
         RenderContext->SetDisplayResolution(
-            RenderConfig::Window::Fullscreen ? m_arrSupportedResolutionList[RenderConfig::Window::ResolutionIdx].GetResolution() : viewportSize,
+            RenderConfig::Window::Fullscreen && !m_arrSupportedResolutionList.empty() ? m_arrSupportedResolutionList[RenderConfig::Window::ResolutionIdx].GetResolution() : viewportSize,
             Vec2i(0, 0),
             RenderConfig::Window::Fullscreen,
-            m_arrSupportedRefreshRateList[RenderConfig::Window::RefreshRateIdx].GetRefreshRate(),
+            m_arrSupportedRefreshRateList.empty() ? 0 : m_arrSupportedRefreshRateList[RenderConfig::Window::RefreshRateIdx].GetRefreshRate(),
             RenderConfig::Window::VSync);
 
         m_nLastFrameRes = RenderConfig::Window::ResolutionIdx;
@@ -323,7 +423,7 @@ void GITechDemo::Update(const float fDeltaTime)
         m_bLastFrameBorderless = RenderConfig::Window::Borderless;
         m_bLastFrameVSync = RenderConfig::Window::VSync;
 
-        UI_PASS.ResetFrametimeGraph();
+        UI_PASS.ResetFrameStatistics();
     }
 
     // Update focus context
@@ -331,7 +431,7 @@ void GITechDemo::Update(const float fDeltaTime)
 
     // Handle user input
     unsigned int cmd = APP_CMD_NONE;
-    if (m_pInputManager && m_pInputMap && !IsUIInFocus())
+    if (m_pInputManager && m_pInputMap && !IsUIInFocus() && !IsBenchmarkRunning())
     {
         // Handle user input for camera movement
         if (m_pInputMap->GetBool(APP_CMD_FORWARD))
@@ -441,7 +541,7 @@ void GITechDemo::Update(const float fDeltaTime)
     }
 
     // Animate camera
-    if (RenderConfig::Camera::Animation)
+    if (RenderConfig::Camera::Animation && !IsBenchmarkRunning())
     {
         static float lastInput = 0.f;
         if (cmd == APP_CMD_NONE)
@@ -566,6 +666,13 @@ void GITechDemo::Update(const float fDeltaTime)
     // to the current frame's view-projection matrix
     if (HLSL::FrameParams->PrevViewProjMat == MAT_IDENTITY44F)
         HLSL::FrameParams->PrevViewProjMat = HLSL::FrameParams->ViewProjMat;
+
+    // Stream in the top mips of model textures once the loader threads are done
+    if (bExtraResInit)
+    {
+        m_tTextureStreamer.Start();
+        m_tTextureStreamer.Update(-m_tCamera.vPos, Math::deg2Rad(RenderConfig::Camera::FoV), viewportSize[1]);
+    }
 }
 
 void GITechDemo::UpdateUIFocus()
@@ -622,6 +729,8 @@ void GITechDemo::UpdateUIFocus()
 
 void GITechDemo::Draw()
 {
+    CPU_PROFILE_SCOPE("GITechDemo::Draw()");
+
     Renderer* RenderContext = Renderer::GetInstance();
     if (!RenderContext)
         return;
@@ -630,13 +739,24 @@ void GITechDemo::Draw()
     // so as the GPU has as much time as possible to process the last frame.
     if (RenderContext->GetDeviceState() == DS_PRESENTING)
     {
+        CPU_PROFILE_SCOPE("SwapBuffers()");
         RenderContext->SwapBuffers();
     }
 
     if (RenderContext->BeginFrame())
     {
+        CPU_PROFILE_SCOPE(RenderScheme::GetRootPass().GetProfileMarkerId());
         RenderScheme::Draw();
         RenderContext->EndFrame();
+
+        if (IsBenchmarkRunning())
+        {
+            m_tBenchmark.EndFrame();
+
+            // The report has been written
+            if (!IsBenchmarkRunning())
+                Framework::GetInstance()->Quit();
+        }
     }
 }
 
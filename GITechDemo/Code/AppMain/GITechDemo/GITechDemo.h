@@ -29,6 +29,10 @@ using namespace AppFramework;
 
 #include <Utility/Mutex.h>
 
+#include "Benchmark.h"
+#include "StartupTimeline.h"
+#include "TextureStreamer.h"
+
 namespace gainput
 {
     class InputMap;
@@ -56,6 +60,7 @@ namespace GITechDemoApp
         Camera& GetCamera() { return m_tCamera; }
         const float GetDeltaTime() const { return m_fDeltaTime; }
         const bool IsUIInFocus() const { return m_bUIHasFocus; }
+        const bool IsBenchmarkRunning() const { return m_tBenchmark.IsRunning(); }
 
         static bool GetSupportedResolutionList(void* data, int idx, const char** out_text);
         static bool GetSupportedRefreshRateList(void* data, int idx, const char** out_text);
@@ -76,6 +81,9 @@ namespace GITechDemoApp
         Vec2i m_vLastFrameViewport;
         bool m_bLastFrameFullscreen, m_bLastFrameBorderless, m_bLastFrameVSync;
         bool m_bUIHasFocus;
+        Benchmark m_tBenchmark;
+        StartupTimeline m_tStartupTimeline;
+        TextureStreamer m_tTextureStreamer;
 
         struct SupportedResolution
         {
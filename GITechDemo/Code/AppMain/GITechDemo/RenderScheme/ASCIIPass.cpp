@@ -36,11 +36,21 @@ ASCIIPass::ASCIIPass(const char* const passName, RenderPass* const parentPass)
     : RenderPass(passName, parentPass)
     , m_pSourceImageMipChain(nullptr)
     , m_nSourceImageMipChainIdx(~0u)
-{}
+{
+    ReadsRenderTarget(&LightAccumulationBuffer);
+    ReadsRenderTarget(&LDRToneMappedImageBuffer);
+    ReadsRenderTarget(&LDRFxaaImageBuffer);
+    WritesRenderTarget(&ASCIIEffectBuffer);
+}
 
 ASCIIPass::~ASCIIPass()
 {}
 
+const bool ASCIIPass::IsEnabled() const
+{
+    return RenderConfig::PostProcessing::ASCIIEffect::Enabled;
+}
+
 void ASCIIPass::Update(const float fDeltaTime)
 {
     Renderer* RenderContext = Renderer::GetInstance();
@@ -119,9 +129,6 @@ void ASCIIPass::Update(const float fDeltaTime)
 
 void ASCIIPass::Draw()
 {
-    if (!RenderConfig::PostProcessing::ASCIIEffect::Enabled)
-        return;
-
     CopySourceImageAndGenerateMips();
     ApplyASCIIEffect();
 }
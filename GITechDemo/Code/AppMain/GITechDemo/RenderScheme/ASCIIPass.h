@@ -34,6 +34,7 @@ namespace GITechDemoApp
     class ASCIIPass : public RenderPass
     {
         IMPLEMENT_RENDER_PASS(ASCIIPass)
+        const bool IsEnabled() const;
 
     private:
         void CopySourceImageAndGenerateMips();
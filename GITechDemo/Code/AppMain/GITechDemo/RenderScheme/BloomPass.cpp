@@ -36,11 +36,22 @@ using namespace GITechDemoApp;
 
 BloomPass::BloomPass(const char* const passName, RenderPass* const parentPass)
     : RenderPass(passName, parentPass)
-{}
+{
+    ReadsRenderTarget(&HDRDownsampleForBloomBuffer);
+    ReadsRenderTarget(&LightAccumulationBuffer);
+    WritesRenderTarget(&BloomBuffer0);
+    WritesRenderTarget(&BloomBuffer1);
+    WritesRenderTarget(&LightAccumulationBuffer);
+}
 
 BloomPass::~BloomPass()
 {}
 
+const bool BloomPass::IsEnabled() const
+{
+    return RenderConfig::PostProcessing::Bloom::Enabled;
+}
+
 void BloomPass::Update(const float fDeltaTime)
 {
     Renderer* RenderContext = Renderer::GetInstance();
@@ -131,7 +142,7 @@ void BloomPass::BloomBlur()
         char label[10];
         sprintf_s(label, "Kernel %d", RenderConfig::PostProcessing::Bloom::BlurKernel[i]);
 #endif
-        PUSH_PROFILE_MARKER(label);
+        PUSH_DYNAMIC_PROFILE_MARKER(label);
 
         BloomBuffer[(i + 1) % 2]->Enable();
 
@@ -215,9 +226,6 @@ void BloomPass::BloomApply()
 
 void BloomPass::Draw()
 {
-    if (!RenderConfig::PostProcessing::Bloom::Enabled)
-        return;
-
     BloomBrightnessFilter();
     BloomBlur();
     BloomApply();
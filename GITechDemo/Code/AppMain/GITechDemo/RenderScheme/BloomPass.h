@@ -29,6 +29,7 @@ namespace GITechDemoApp
     class BloomPass : public RenderPass
     {
         IMPLEMENT_RENDER_PASS(BloomPass)
+        const bool IsEnabled() const;
 
     private:
         void BloomBrightnessFilter();
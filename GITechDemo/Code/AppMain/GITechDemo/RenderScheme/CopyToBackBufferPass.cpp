@@ -35,7 +35,16 @@ using namespace GITechDemoApp;
 CopyToBackBufferPass::CopyToBackBufferPass(const char* const passName, RenderPass* const parentPass)
     : RenderPass(passName, parentPass)
     , m_pFinalImageBuffer(nullptr)
-{}
+{
+    ReadsRenderTarget(&GBuffer);
+    ReadsRenderTarget(&LinearFullDepthBuffer);
+    ReadsRenderTarget(&ShadowMapDir);
+    ReadsRenderTarget(&RSMBuffer);
+    ReadsRenderTarget(&LightAccumulationBuffer);
+    ReadsRenderTarget(&LDRToneMappedImageBuffer);
+    ReadsRenderTarget(&LDRFxaaImageBuffer);
+    ReadsRenderTarget(&ASCIIEffectBuffer);
+}
 
 CopyToBackBufferPass::~CopyToBackBufferPass()
 {}
@@ -90,12 +99,13 @@ void CopyToBackBufferPass::Update(const float fDeltaTime)
         HLSL::ColorCopyParams->CustomColorModulator = Vec4f(1.f, 1.f, 1.f, 1.f) / HLSL::PostProcessingParams->ZFar;
     }
 
-    if (RenderConfig::CascadedShadowMaps::DebugCameraView)
+    // The shadow map and the RSM are not resident if the passes rendering them have been pruned
+    if (RenderConfig::CascadedShadowMaps::DebugCameraView && ShadowMapDir.GetRenderTarget())
     {
         HLSL::ColorCopy_SourceTexture = ShadowMapDir.GetRenderTarget()->GetDepthBuffer();
         HLSL::ColorCopyParams->SingleChannelCopy = true;
     }
-    else if (RenderConfig::ReflectiveShadowMap::DebugCameraView)
+    else if (RenderConfig::ReflectiveShadowMap::DebugCameraView && RSMBuffer.GetRenderTarget())
     {
         HLSL::ColorCopy_SourceTexture = RSMBuffer.GetRenderTarget()->GetColorBuffer();
     }
@@ -33,7 +33,12 @@ using namespace GITechDemoApp;
 
 DepthDownsamplePass::DepthDownsamplePass(const char* const passName, RenderPass* const parentPass)
     : RenderPass(passName, parentPass)
-{}
+{
+    ReadsRenderTarget(&GBuffer);
+    WritesRenderTarget(&HyperbolicQuarterDepthBuffer);
+    WritesRenderTarget(&LinearFullDepthBuffer);
+    WritesRenderTarget(&LinearQuarterDepthBuffer);
+}
 
 DepthDownsamplePass::~DepthDownsamplePass()
 {}
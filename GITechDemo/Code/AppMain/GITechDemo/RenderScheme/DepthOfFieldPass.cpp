@@ -41,11 +41,28 @@ using namespace GITechDemoApp;
 
 DepthOfFieldPass::DepthOfFieldPass(const char* const passName, RenderPass* const parentPass)
     : RenderPass(passName, parentPass)
-{}
+{
+    ReadsRenderTarget(&GBuffer);
+    ReadsRenderTarget(&LinearFullDepthBuffer);
+    ReadsRenderTarget(&LinearQuarterDepthBuffer);
+    ReadsRenderTarget(&LightAccumulationBuffer);
+    ReadsRenderTarget(&AutofocusBuffer0);
+    ReadsRenderTarget(&AutofocusBuffer1);
+    WritesRenderTarget(&DepthOfFieldBuffer0);
+    WritesRenderTarget(&DepthOfFieldBuffer1);
+    WritesRenderTarget(&AutofocusBuffer0);
+    WritesRenderTarget(&AutofocusBuffer1);
+    WritesRenderTarget(&LightAccumulationBuffer);
+}
 
 DepthOfFieldPass::~DepthOfFieldPass()
 {}
 
+const bool DepthOfFieldPass::IsEnabled() const
+{
+    return RenderConfig::PostProcessing::DepthOfField::Enabled;
+}
+
 void DepthOfFieldPass::Update(const float fDeltaTime)
 {
     Renderer* RenderContext = Renderer::GetInstance();
@@ -241,9 +258,6 @@ void DepthOfFieldPass::ApplyDoF()
 
 void DepthOfFieldPass::Draw()
 {
-    if (!RenderConfig::PostProcessing::DepthOfField::Enabled)
-        return;
-
     AutofocusPass();
 
     CalculateBlurFactor();
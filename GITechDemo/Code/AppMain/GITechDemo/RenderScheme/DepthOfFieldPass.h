@@ -29,6 +29,7 @@ namespace GITechDemoApp
     class DepthOfFieldPass : public RenderPass
     {
         IMPLEMENT_RENDER_PASS(DepthOfFieldPass)
+        const bool IsEnabled() const;
 
     private:
         void AutofocusPass();
@@ -39,6 +39,13 @@ using namespace GITechDemoApp;
 DirectionalIndirectLightPass::DirectionalIndirectLightPass(const char* const passName, RenderPass* const parentPass)
     : RenderPass(passName, parentPass)
 {
+    ReadsRenderTarget(&GBuffer);
+    ReadsRenderTarget(&LinearQuarterDepthBuffer);
+    ReadsRenderTarget(&RSMBuffer);
+    ReadsRenderTarget(&LightAccumulationBuffer);
+    WritesRenderTarget(&IndirectLightAccumulationBuffer0);
+    WritesRenderTarget(&IndirectLightAccumulationBuffer1);
+    WritesRenderTarget(&LightAccumulationBuffer);
 }
 
 DirectionalIndirectLightPass::~DirectionalIndirectLightPass()
@@ -77,6 +84,11 @@ void DirectionalIndirectLightPass::ReleaseResources()
 {
 }
 
+const bool DirectionalIndirectLightPass::IsEnabled() const
+{
+    return RenderConfig::ReflectiveShadowMap::Enabled;
+}
+
 void DirectionalIndirectLightPass::Update(const float fDeltaTime)
 {
     Renderer* RenderContext = Renderer::GetInstance();
@@ -96,9 +108,6 @@ void DirectionalIndirectLightPass::Update(const float fDeltaTime)
 
 void DirectionalIndirectLightPass::Draw()
 {
-    if (!RenderConfig::ReflectiveShadowMap::Enabled)
-        return;
-
     Renderer* RenderContext = Renderer::GetInstance();
     if (!RenderContext)
         return;
@@ -126,7 +135,7 @@ void DirectionalIndirectLightPass::Draw()
         char marker[16];
         sprintf_s(marker, "Pass %d", i);
 #endif
-        PUSH_PROFILE_MARKER(marker);
+        PUSH_DYNAMIC_PROFILE_MARKER(marker);
 
         RSMApplyShader.Enable();
         RenderContext->DrawVertexBuffer(FullScreenTri);
@@ -32,6 +32,7 @@ namespace GITechDemoApp
     class DirectionalIndirectLightPass : public RenderPass
     {
         IMPLEMENT_RENDER_PASS(DirectionalIndirectLightPass)
+        const bool IsEnabled() const;
 
     private:
         void Blur();
@@ -37,6 +37,10 @@ using namespace GITechDemoApp;
 DirectionalLightPass::DirectionalLightPass(const char* const passName, RenderPass* const parentPass)
     : RenderPass(passName, parentPass)
 {
+    ReadsRenderTarget(&GBuffer);
+    ReadsRenderTarget(&ShadowMapDir);
+    ReadsRenderTarget(&LightAccumulationBuffer);
+    WritesRenderTarget(&LightAccumulationBuffer);
 }
 
 DirectionalLightPass::~DirectionalLightPass()
@@ -72,6 +76,11 @@ void DirectionalLightPass::ReleaseResources()
 {
 }
 
+const bool DirectionalLightPass::IsEnabled() const
+{
+    return RenderConfig::DirectionalLight::Enabled;
+}
+
 void DirectionalLightPass::Update(const float fDeltaTime)
 {
     HLSL::DirectionalLightParams->DebugCascades = RenderConfig::CascadedShadowMaps::DebugCascades;
@@ -102,9 +111,6 @@ void DirectionalLightPass::Update(const float fDeltaTime)
 
 void DirectionalLightPass::Draw()
 {
-    if (!RenderConfig::DirectionalLight::Enabled)
-        return;
-
     Renderer* RenderContext = Renderer::GetInstance();
     if (!RenderContext)
         return;
@@ -29,6 +29,7 @@ namespace GITechDemoApp
     class DirectionalLightPass : public RenderPass
     {
         IMPLEMENT_RENDER_PASS(DirectionalLightPass)
+        const bool IsEnabled() const;
     };
 }
 
@@ -38,12 +38,28 @@ using namespace GITechDemoApp;
 DirectionalLightVolumePass::DirectionalLightVolumePass(const char* const passName, RenderPass* const parentPass)
     : RenderPass(passName, parentPass)
 {
+    ReadsRenderTarget(&GBuffer);
+    ReadsRenderTarget(&HyperbolicQuarterDepthBuffer);
+    ReadsRenderTarget(&LinearQuarterDepthBuffer);
+    ReadsRenderTarget(&ShadowMapDir);
+    ReadsRenderTarget(&LightAccumulationBuffer);
+    WritesRenderTarget(&VolumetricLightFullBuffer0);
+    WritesRenderTarget(&VolumetricLightFullBuffer1);
+    WritesRenderTarget(&VolumetricLightQuarterBuffer0);
+    WritesRenderTarget(&VolumetricLightQuarterBuffer1);
+    WritesRenderTarget(&LightAccumulationBuffer);
+
     HLSL::DirectionalLightVolumeParams->ElapsedTime = 0.f;
 }
 
 DirectionalLightVolumePass::~DirectionalLightVolumePass()
 {}
 
+const bool DirectionalLightVolumePass::IsEnabled() const
+{
+    return RenderConfig::DirectionalLightVolume::Enabled;
+}
+
 void DirectionalLightVolumePass::Update(const float fDeltaTime)
 {
     if (RenderConfig::DirectionalLightVolume::QuarterResolution)
@@ -262,21 +278,18 @@ void DirectionalLightVolumePass::ApplyLightVolume()
 
 void DirectionalLightVolumePass::Draw()
 {
-    if (RenderConfig::DirectionalLightVolume::Enabled)
-    {
-        //Synesthesia3D::RenderTarget* pCurrRT = Synesthesia3D::RenderTarget::GetActiveRenderTarget();
-        //if (pCurrRT)
-        //  pCurrRT->Disable();
-        
-        CalculateLightVolume();
+    //Synesthesia3D::RenderTarget* pCurrRT = Synesthesia3D::RenderTarget::GetActiveRenderTarget();
+    //if (pCurrRT)
+    //  pCurrRT->Disable();
 
-        if (RenderConfig::DirectionalLightVolume::BlurSamples)
-            GatherSamples();
+    CalculateLightVolume();
 
-        ApplyLightVolume();
+    if (RenderConfig::DirectionalLightVolume::BlurSamples)
+        GatherSamples();
 
-        //pCurrRT->Enable();
-    }
+    ApplyLightVolume();
+
+    //pCurrRT->Enable();
 }
 
 void DirectionalLightVolumePass::AllocateResources()
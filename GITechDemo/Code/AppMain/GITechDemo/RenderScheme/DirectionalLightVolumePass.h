@@ -31,6 +31,7 @@ namespace GITechDemoApp
     class DirectionalLightVolumePass : public RenderPass
     {
         IMPLEMENT_RENDER_PASS(DirectionalLightVolumePass)
+        const bool IsEnabled() const;
 
     protected:
         void    CalculateLightVolume();
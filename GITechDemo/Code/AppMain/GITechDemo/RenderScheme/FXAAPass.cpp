@@ -35,11 +35,21 @@ using namespace GITechDemoApp;
 
 FXAAPass::FXAAPass(const char* const passName, RenderPass* const parentPass)
     : RenderPass(passName, parentPass)
-{}
+{
+    ReadsRenderTarget(&GBuffer);
+    ReadsRenderTarget(&LightAccumulationBuffer);
+    ReadsRenderTarget(&LDRToneMappedImageBuffer);
+    WritesRenderTarget(&LDRFxaaImageBuffer);
+}
 
 FXAAPass::~FXAAPass()
 {}
 
+const bool FXAAPass::IsEnabled() const
+{
+    return RenderConfig::PostProcessing::FastApproximateAntiAliasing::Enabled;
+}
+
 void FXAAPass::Update(const float fDeltaTime)
 {
     Renderer* RenderContext = Renderer::GetInstance();
@@ -77,9 +87,6 @@ void FXAAPass::Update(const float fDeltaTime)
 
 void FXAAPass::Draw()
 {
-    if (!RenderConfig::PostProcessing::FastApproximateAntiAliasing::Enabled)
-        return;
-
     Renderer* RenderContext = Renderer::GetInstance();
     if (!RenderContext)
         return;
@@ -29,6 +29,7 @@ namespace GITechDemoApp
     class FXAAPass : public RenderPass
     {
         IMPLEMENT_RENDER_PASS(FXAAPass)
+        const bool IsEnabled() const;
     };
 }
 
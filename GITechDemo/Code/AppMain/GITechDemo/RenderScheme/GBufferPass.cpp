@@ -38,7 +38,9 @@ using namespace GITechDemoApp;
 
 GBufferPass::GBufferPass(const char* const passName, RenderPass* const parentPass)
     : RenderPass(passName, parentPass)
-{}
+{
+    WritesRenderTarget(&GBuffer);
+}
 
 GBufferPass::~GBufferPass()
 {}
@@ -35,7 +35,10 @@ using namespace GITechDemoApp;
 
 HDRDownsampleForBloomPass::HDRDownsampleForBloomPass(const char* const passName, RenderPass* const parentPass)
     : RenderPass(passName, parentPass)
-{}
+{
+    ReadsRenderTarget(&LightAccumulationBuffer);
+    WritesRenderTarget(&HDRDownsampleForBloomBuffer);
+}
 
 HDRDownsampleForBloomPass::~HDRDownsampleForBloomPass()
 {}
@@ -91,9 +94,6 @@ void HDRDownsampleForBloomPass::DownsampleForBloomPass(GITechDemoApp::RenderTarg
 
 void HDRDownsampleForBloomPass::Draw()
 {
-    if (!RenderConfig::PostProcessing::Bloom::Enabled)
-        return;
-
     Renderer* RenderContext = Renderer::GetInstance();
     if (!RenderContext)
         return;
@@ -35,7 +35,11 @@ using namespace GITechDemoApp;
 
 HDRDownsamplePass::HDRDownsamplePass(const char* const passName, RenderPass* const parentPass)
     : RenderPass(passName, parentPass)
-{}
+{
+    ReadsRenderTarget(&LightAccumulationBuffer);
+    WritesRenderTarget(&HDRDownsampleQuarterBuffer);
+    WritesRenderTarget(&HDRDownsampleSixteenthBuffer);
+}
 
 HDRDownsamplePass::~HDRDownsamplePass()
 {}
@@ -86,9 +90,6 @@ void HDRDownsamplePass::DownsamplePass(GITechDemoApp::RenderTarget* const pSourc
 
 void HDRDownsamplePass::Draw()
 {
-    if (!RenderConfig::PostProcessing::ToneMapping::Enabled)
-        return;
-
     Renderer* RenderContext = Renderer::GetInstance();
     if (!RenderContext)
         return;
@@ -39,11 +39,29 @@ using namespace GITechDemoApp;
 
 HDRToneMappingPass::HDRToneMappingPass(const char* const passName, RenderPass* const parentPass)
     : RenderPass(passName, parentPass)
-{}
+{
+    ReadsRenderTarget(&LightAccumulationBuffer);
+    ReadsRenderTarget(&HDRDownsampleQuarterBuffer);
+    ReadsRenderTarget(&HDRDownsampleSixteenthBuffer);
+    ReadsRenderTarget(&AdaptedLuminance0);
+    ReadsRenderTarget(&AdaptedLuminance1);
+    WritesRenderTarget(&AverageLuminanceBuffer0);
+    WritesRenderTarget(&AverageLuminanceBuffer1);
+    WritesRenderTarget(&AverageLuminanceBuffer2);
+    WritesRenderTarget(&AverageLuminanceBuffer3);
+    WritesRenderTarget(&AdaptedLuminance0);
+    WritesRenderTarget(&AdaptedLuminance1);
+    WritesRenderTarget(&LDRToneMappedImageBuffer);
+}
 
 HDRToneMappingPass::~HDRToneMappingPass()
 {}
 
+const bool HDRToneMappingPass::IsEnabled() const
+{
+    return RenderConfig::PostProcessing::ToneMapping::Enabled;
+}
+
 void HDRToneMappingPass::Update(const float fDeltaTime)
 {
     Renderer* RenderContext = Renderer::GetInstance();
@@ -220,9 +238,6 @@ void HDRToneMappingPass::ToneMappingPass()
 
 void HDRToneMappingPass::Draw()
 {
-    if (!RenderConfig::PostProcessing::ToneMapping::Enabled)
-        return;
-
     LuminanceMeasurementPass();
     LuminanceAdaptationPass();
     ToneMappingPass();
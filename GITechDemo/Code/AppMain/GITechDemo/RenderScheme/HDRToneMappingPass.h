@@ -29,6 +29,7 @@ namespace GITechDemoApp
     class HDRToneMappingPass : public RenderPass
     {
         IMPLEMENT_RENDER_PASS(HDRToneMappingPass)
+        const bool IsEnabled() const;
 
     private:
         void LuminanceMeasurementPass();
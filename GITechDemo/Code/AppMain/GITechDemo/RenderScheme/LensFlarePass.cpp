@@ -36,11 +36,26 @@ using namespace GITechDemoApp;
 
 LensFlarePass::LensFlarePass(const char* const passName, RenderPass* const parentPass)
     : RenderPass(passName, parentPass)
-{}
+{
+    ReadsRenderTarget(&HDRDownsampleQuarterBuffer);
+    ReadsRenderTarget(&HDRDownsampleSixteenthBuffer);
+    ReadsRenderTarget(&LightAccumulationBuffer);
+    WritesRenderTarget(&SphericalLensFlareBuffer0);
+    WritesRenderTarget(&SphericalLensFlareBuffer1);
+    WritesRenderTarget(&AnamorphicLensFlareBuffer0);
+    WritesRenderTarget(&AnamorphicLensFlareBuffer1);
+    WritesRenderTarget(&AnamorphicLensFlareBuffer2);
+    WritesRenderTarget(&LightAccumulationBuffer);
+}
 
 LensFlarePass::~LensFlarePass()
 {}
 
+const bool LensFlarePass::IsEnabled() const
+{
+    return RenderConfig::PostProcessing::LensFlare::Enabled;
+}
+
 void LensFlarePass::Update(const float fDeltaTime)
 {
     Renderer* RenderContext = Renderer::GetInstance();
@@ -122,9 +137,6 @@ void LensFlarePass::Update(const float fDeltaTime)
 
 void LensFlarePass::Draw()
 {
-    if (!RenderConfig::PostProcessing::LensFlare::Enabled)
-        return;
-
     ApplyBrightnessFilter();
     GenerateFeatures();
     if (RenderConfig::PostProcessing::LensFlare::Anamorphic)
@@ -289,7 +301,7 @@ void LensFlarePass::Blur()
         char label[10];
         sprintf_s(label, "Kernel %d", RenderConfig::PostProcessing::LensFlare::BlurKernel[i]);
 #endif
-        PUSH_PROFILE_MARKER(label);
+        PUSH_DYNAMIC_PROFILE_MARKER(label);
 
         CurrentLensFlareBuffer[i % 2]->Enable();
 
@@ -350,7 +362,7 @@ void LensFlarePass::AnamorphicBlur()
         char label[10];
         sprintf_s(label, "Kernel %d", i);
 #endif
-        PUSH_PROFILE_MARKER(label);
+        PUSH_DYNAMIC_PROFILE_MARKER(label);
 
         CurrentLensFlareBuffer[i % 2]->Enable();
 
@@ -31,6 +31,7 @@ namespace GITechDemoApp
     class LensFlarePass : public RenderPass
     {
         IMPLEMENT_RENDER_PASS(LensFlarePass)
+        const bool IsEnabled() const;
 
     private:
         void    ApplyBrightnessFilter();
@@ -36,7 +36,11 @@ using namespace GITechDemoApp;
 
 LightingPass::LightingPass(const char* const passName, RenderPass* const parentPass)
     : RenderPass(passName, parentPass)
-{}
+    , m_pAdditiveBlendState(nullptr)
+    , m_pNoDepthWriteState(nullptr)
+{
+    WritesRenderTarget(&LightAccumulationBuffer);
+}
 
 LightingPass::~LightingPass()
 {}
@@ -69,39 +73,46 @@ void LightingPass::Draw()
 
     RenderContext->Clear(Vec4f(0.f, 0.f, 0.f, 0.f), 1.f, 0);
 
-    const bool zWrite = RenderContext->GetRenderStateManager()->GetZWriteEnabled();
-    const Cmp zFunc = RenderContext->GetRenderStateManager()->GetZFunc();
-    const bool blendEnabled = RenderContext->GetRenderStateManager()->GetColorBlendEnabled();
-    const Blend DstBlend = RenderContext->GetRenderStateManager()->GetColorDstBlend();
-    const Blend SrcBlend = RenderContext->GetRenderStateManager()->GetColorSrcBlend();
+    const BlendState* const blendState = RenderContext->GetRenderStateManager()->GetBlendState();
+    const DepthStencilState* const depthStencilState = RenderContext->GetRenderStateManager()->GetDepthStencilState();
 
-    // Disable Z writes, since we already have the correct depth buffer
-    RenderContext->GetRenderStateManager()->SetZWriteEnabled(false);
-    RenderContext->GetRenderStateManager()->SetZFunc(CMP_ALWAYS);
-
-    // Additive color blending is required for accumulating light
-    RenderContext->GetRenderStateManager()->SetColorBlendEnabled(true);
-    RenderContext->GetRenderStateManager()->SetColorDstBlend(BLEND_ONE);
-    RenderContext->GetRenderStateManager()->SetColorSrcBlend(BLEND_ONE);
+    RenderContext->GetRenderStateManager()->SetDepthStencilState(m_pNoDepthWriteState);
+    RenderContext->GetRenderStateManager()->SetBlendState(m_pAdditiveBlendState);
 
     DrawChildren();
 
     // Reset the render states
-    RenderContext->GetRenderStateManager()->SetZWriteEnabled(zWrite);
-    RenderContext->GetRenderStateManager()->SetZFunc(zFunc);
-    RenderContext->GetRenderStateManager()->SetColorBlendEnabled(blendEnabled);
-    RenderContext->GetRenderStateManager()->SetColorDstBlend(DstBlend);
-    RenderContext->GetRenderStateManager()->SetColorSrcBlend(SrcBlend);
+    RenderContext->GetRenderStateManager()->SetDepthStencilState(depthStencilState);
+    RenderContext->GetRenderStateManager()->SetBlendState(blendState);
 
     LightAccumulationBuffer.Disable();
 }
 
 void LightingPass::AllocateResources()
 {
+    Renderer* RenderContext = Renderer::GetInstance();
+    if (!RenderContext)
+        return;
 
+    // Only override the states required by the pass, on top of the default ones
+
+    // Disable Z writes, since we already have the correct depth buffer
+    DepthStencilStateDesc depthStencilDesc;
+    depthStencilDesc.bZWriteEnabled = false;
+    depthStencilDesc.eZFunc = CMP_ALWAYS;
+    m_pNoDepthWriteState = RenderContext->GetRenderStateManager()->CreateDepthStencilState(depthStencilDesc);
+
+    // Additive color blending is required for accumulating light
+    BlendStateDesc blendDesc;
+    blendDesc.bColorBlendEnabled = true;
+    blendDesc.eColorSrcBlend = BLEND_ONE;
+    blendDesc.eColorDstBlend = BLEND_ONE;
+    m_pAdditiveBlendState = RenderContext->GetRenderStateManager()->CreateBlendState(blendDesc);
 }
 
 void LightingPass::ReleaseResources()
 {
-
+    // State blocks are owned by the render state manager
+    m_pAdditiveBlendState = nullptr;
+    m_pNoDepthWriteState = nullptr;
 }
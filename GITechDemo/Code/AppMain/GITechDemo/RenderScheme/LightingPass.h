@@ -24,11 +24,27 @@
 
 #include "RenderPass.h"
 
+namespace Synesthesia3D
+{
+    struct BlendStateDesc;
+    struct DepthStencilStateDesc;
+    template <typename DESC> class RenderStateBlock;
+    typedef RenderStateBlock<BlendStateDesc>        BlendState;
+    typedef RenderStateBlock<DepthStencilStateDesc> DepthStencilState;
+}
+
 namespace GITechDemoApp
 {
+    using namespace Synesthesia3D;
+
     class LightingPass : public RenderPass
     {
         IMPLEMENT_RENDER_PASS(LightingPass)
+
+    private:
+        // Render states used when accumulating light
+        const BlendState*           m_pAdditiveBlendState;
+        const DepthStencilState*    m_pNoDepthWriteState;
     };
 }
 
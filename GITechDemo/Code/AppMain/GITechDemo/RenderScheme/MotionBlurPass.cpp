@@ -39,11 +39,21 @@ using namespace GITechDemoApp;
 
 MotionBlurPass::MotionBlurPass(const char* const passName, RenderPass* const parentPass)
     : RenderPass(passName, parentPass)
-{}
+{
+    ReadsRenderTarget(&GBuffer);
+    ReadsRenderTarget(&LightAccumulationBuffer);
+    WritesRenderTarget(&MotionBlurBuffer);
+    WritesRenderTarget(&LightAccumulationBuffer);
+}
 
 MotionBlurPass::~MotionBlurPass()
 {}
 
+const bool MotionBlurPass::IsEnabled() const
+{
+    return RenderConfig::PostProcessing::MotionBlur::Enabled;
+}
+
 void MotionBlurPass::Update(const float fDeltaTime)
 {
     Framework* const pFW = Framework::GetInstance();
@@ -59,9 +69,6 @@ void MotionBlurPass::Update(const float fDeltaTime)
 
 void MotionBlurPass::Draw()
 {
-    if(!RenderConfig::PostProcessing::MotionBlur::Enabled)
-        return;
-
     CalculateMotionBlur();
     ApplyMotionBlur();
 }
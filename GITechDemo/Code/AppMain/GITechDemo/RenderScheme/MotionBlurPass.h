@@ -29,6 +29,7 @@ namespace GITechDemoApp
     class MotionBlurPass : public RenderPass
     {
         IMPLEMENT_RENDER_PASS(MotionBlurPass)
+        const bool IsEnabled() const;
 
     private:
         void CalculateMotionBlur();
@@ -31,7 +31,10 @@ using namespace GITechDemoApp;
 
 PBRMaterialTestPass::PBRMaterialTestPass(const char* const passName, RenderPass* const parentPass)
     : RenderPass(passName, parentPass)
-{}
+{
+    ReadsRenderTarget(&GBuffer);
+    WritesRenderTarget(&GBuffer);
+}
 
 PBRMaterialTestPass::~PBRMaterialTestPass()
 {}
@@ -58,7 +61,7 @@ void PBRMaterialTestPass::Draw()
         {
             const PBRMaterial* const pbrMaterial = (PBRMaterial*)arrRenderResourceList[resIdx];
 
-            PUSH_PROFILE_MARKER(pbrMaterial->GetDesc());
+            PUSH_DRAW_PROFILE_MARKER(pbrMaterial->GetDesc());
 
             // Update matrices
             HLSL::FrameParams->WorldMat = CalculateWorldMatrixForSphereIdx(pbrMatIdx++, pbrMaterialCount);
@@ -103,7 +106,7 @@ void PBRMaterialTestPass::Draw()
                 GBufferGenerationShader.Disable();
             }
 
-            POP_PROFILE_MARKER();
+            POP_DRAW_PROFILE_MARKER();
         }
     }
 
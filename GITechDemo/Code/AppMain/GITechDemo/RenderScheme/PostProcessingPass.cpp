@@ -43,6 +43,11 @@ PostProcessingPass::~PostProcessingPass()
 
 }
 
+const bool PostProcessingPass::IsEnabled() const
+{
+    return RenderConfig::PostProcessing::Enabled;
+}
+
 void PostProcessingPass::Update(const float fDeltaTime)
 {
 
@@ -50,8 +55,7 @@ void PostProcessingPass::Update(const float fDeltaTime)
 
 void PostProcessingPass::Draw()
 {
-    if (RenderConfig::PostProcessing::Enabled)
-        DrawChildren();
+    DrawChildren();
 }
 
 void PostProcessingPass::AllocateResources()
@@ -65,7 +69,7 @@ void PostProcessingPass::AllocateResources()
         return;
 
     // Create a full screen quad (it's actually an over-sized triangle) for fullscreen effects and processing
-    unsigned int vfIdx = ResourceMgr->CreateVertexFormat(1, VAS_POSITION, VAT_FLOAT4, 0);
+    unsigned int vfIdx = ResourceMgr->GetOrCreateVertexFormat(1, VAS_POSITION, VAT_FLOAT4, 0);
     VertexFormat* vf = ResourceMgr->GetVertexFormat(vfIdx);
 
     unsigned int ibIdx = ResourceMgr->CreateIndexBuffer(3);
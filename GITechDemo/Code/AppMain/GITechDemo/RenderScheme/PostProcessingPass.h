@@ -29,6 +29,7 @@ namespace GITechDemoApp
     class PostProcessingPass : public RenderPass
     {
         IMPLEMENT_RENDER_PASS(PostProcessingPass)
+        const bool IsEnabled() const;
     };
 }
 
@@ -34,11 +34,18 @@ using namespace GITechDemoApp;
 
 RSMDirectionalLightPass::RSMDirectionalLightPass(const char* const passName, RenderPass* const parentPass)
     : RenderPass(passName, parentPass)
-{}
+{
+    WritesRenderTarget(&RSMBuffer);
+}
 
 RSMDirectionalLightPass::~RSMDirectionalLightPass()
 {}
 
+const bool RSMDirectionalLightPass::IsEnabled() const
+{
+    return RenderConfig::ReflectiveShadowMap::Enabled;
+}
+
 void RSMDirectionalLightPass::Update(const float fDeltaTime)
 {
     Renderer* RenderContext = Renderer::GetInstance();
@@ -76,9 +83,6 @@ void RSMDirectionalLightPass::Update(const float fDeltaTime)
 
 void RSMDirectionalLightPass::Draw()
 {
-    if (!RenderConfig::ReflectiveShadowMap::Enabled)
-        return;
-
     Renderer* RenderContext = Renderer::GetInstance();
     if (!RenderContext)
         return;
@@ -29,6 +29,7 @@ namespace GITechDemoApp
     class RSMDirectionalLightPass : public RenderPass
     {
         IMPLEMENT_RENDER_PASS(RSMDirectionalLightPass)
+        const bool IsEnabled() const;
     };
 }
 
@@ -0,0 +1,315 @@
+/*=============================================================================
+ * This file is part of the "GITechDemo" application
+ * Copyright (C) Iftode Bogdan-Marius <iftode.bogdan@gmail.com>
+ *
+ *      File:   RenderGraph.cpp
+ *      Author: Bogdan Iftode
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+=============================================================================*/
+
+#include "stdafx.h"
+
+#include <iostream>
+#include <algorithm>
+
+#include "AppResources.h"
+
+#include "RenderPass.h"
+#include "RenderGraph.h"
+using namespace GITechDemoApp;
+
+std::vector<GITechDemoApp::RenderTarget*> RenderGraph::ms_arrRenderTarget;
+std::vector<RenderPass*> RenderGraph::ms_arrOwnerPass;
+std::vector<bool> RenderGraph::ms_arrRequired;
+std::vector<GITechDemoApp::RenderTarget*> RenderGraph::ms_arrConsumedRenderTarget;
+
+unsigned int RenderGraph::ms_nRenderTargetCount = 0;
+unsigned int RenderGraph::ms_nAliasedRenderTargetCount = 0;
+unsigned int RenderGraph::ms_nActivePassCount = 0;
+unsigned int RenderGraph::ms_nResidentRenderTargetCount = 0;
+
+void RenderGraph::Compile(RenderPass& rootPass)
+{
+    std::vector<RenderTargetLifetime> lifetimes;
+    unsigned int passIdx = 0;
+    GatherLifetimes(&rootPass, passIdx, lifetimes);
+
+    ms_nRenderTargetCount = (unsigned int)lifetimes.size();
+    ms_nAliasedRenderTargetCount = 0;
+
+    ms_arrRenderTarget.clear();
+    ms_arrOwnerPass.clear();
+    for (unsigned int i = 0; i < lifetimes.size(); i++)
+    {
+        ms_arrRenderTarget.push_back(lifetimes[i].pRenderTarget);
+        ms_arrOwnerPass.push_back(lifetimes[i].pFirstPass);
+    }
+    ms_arrRequired.assign(ms_arrRenderTarget.size(), false);
+
+    // Lifetimes are gathered in execution order, so they are already sorted by their first use.
+    // Greedily place every transient render target in the first compatible alias group that is
+    // no longer in use by the time the render target is first written to.
+    std::vector<AliasGroup> groups;
+    for (unsigned int i = 0; i < lifetimes.size(); i++)
+    {
+        RenderTarget* const rt = lifetimes[i].pRenderTarget;
+
+        // Aliasing has to be decided before the resources are created
+        assert(!rt->IsInitialized());
+        rt->pAliasOwner = nullptr;
+
+        if (!lifetimes[i].bTransient)
+            continue;
+
+        AliasGroup* group = nullptr;
+        for (unsigned int j = 0; j < groups.size() && !group; j++)
+            if (groups[j].nLastUse < lifetimes[i].nFirstUse && groups[j].arrRenderTarget[0]->IsCompatible(*rt))
+                group = &groups[j];
+
+        if (group)
+        {
+            group->arrRenderTarget.push_back(rt);
+            group->nLastUse = lifetimes[i].nLastUse;
+        }
+        else
+        {
+            AliasGroup newGroup;
+            newGroup.arrRenderTarget.push_back(rt);
+            newGroup.nLastUse = lifetimes[i].nLastUse;
+            groups.push_back(newGroup);
+        }
+    }
+
+    for (unsigned int i = 0; i < groups.size(); i++)
+    {
+        if (groups[i].arrRenderTarget.size() < 2)
+            continue;
+
+        // The render target declared first owns the resource, so that initializing
+        // render targets in declaration order never has to wait for an alias owner
+        RenderTarget* owner = groups[i].arrRenderTarget[0];
+        for (unsigned int j = 1; j < groups[i].arrRenderTarget.size(); j++)
+            if (groups[i].arrRenderTarget[j]->nId < owner->nId)
+                owner = groups[i].arrRenderTarget[j];
+
+        for (unsigned int j = 0; j < groups[i].arrRenderTarget.size(); j++)
+        {
+            if (groups[i].arrRenderTarget[j] != owner)
+            {
+                groups[i].arrRenderTarget[j]->pAliasOwner = owner;
+                ms_nAliasedRenderTargetCount++;
+
+                cout << "Render graph: \"" << groups[i].arrRenderTarget[j]->GetDesc() << "\" aliased to \"" << owner->GetDesc() << "\"\n";
+            }
+        }
+    }
+
+    cout << "Render graph: " << ms_nAliasedRenderTargetCount << " out of " << ms_nRenderTargetCount << " render targets aliased\n";
+}
+
+void RenderGraph::GatherLifetimes(RenderPass* const pass, unsigned int& passIdx, std::vector<RenderTargetLifetime>& lifetimes)
+{
+    const unsigned int firstPassIdx = passIdx++;
+    std::vector<unsigned int> accessed;
+
+    const std::vector<RenderTarget*>& written = pass->GetWrittenRenderTargets();
+    const std::vector<RenderTarget*>& read = pass->GetReadRenderTargets();
+
+    for (unsigned int i = 0; i < written.size(); i++)
+    {
+        const bool isTransient = std::find(read.begin(), read.end(), written[i]) == read.end();
+        accessed.push_back(FindOrAddLifetime(written[i], pass, firstPassIdx, isTransient, lifetimes));
+    }
+
+    for (unsigned int i = 0; i < read.size(); i++)
+        accessed.push_back(FindOrAddLifetime(read[i], pass, firstPassIdx, false, lifetimes));
+
+    const std::vector<RenderPass*>& children = pass->GetChildren();
+    for (unsigned int i = 0; i < children.size(); i++)
+        if (children[i] != nullptr)
+            GatherLifetimes(children[i], passIdx, lifetimes);
+
+    // A parent pass may access its render targets before and after any of its children
+    const unsigned int lastPassIdx = passIdx - 1;
+    for (unsigned int i = 0; i < accessed.size(); i++)
+        lifetimes[accessed[i]].nLastUse = Math::Max(lifetimes[accessed[i]].nLastUse, lastPassIdx);
+}
+
+const unsigned int RenderGraph::FindOrAddLifetime(RenderTarget* const renderTarget, RenderPass* const pass, const unsigned int passIdx, const bool isTransient, std::vector<RenderTargetLifetime>& lifetimes)
+{
+    for (unsigned int i = 0; i < lifetimes.size(); i++)
+    {
+        if (lifetimes[i].pRenderTarget == renderTarget)
+        {
+            lifetimes[i].nLastUse = Math::Max(lifetimes[i].nLastUse, passIdx);
+            return i;
+        }
+    }
+
+    RenderTargetLifetime lifetime;
+    lifetime.pRenderTarget = renderTarget;
+    lifetime.pFirstPass = pass;
+    lifetime.nFirstUse = passIdx;
+    lifetime.nLastUse = passIdx;
+    lifetime.bTransient = isTransient;
+    lifetimes.push_back(lifetime);
+
+    return (unsigned int)lifetimes.size() - 1;
+}
+
+void RenderGraph::Update(RenderPass& rootPass)
+{
+    ms_nActivePassCount = 0;
+    ms_arrConsumedRenderTarget.clear();
+    UpdateActivePasses(&rootPass);
+
+    // The root pass is always executed
+    if (!rootPass.m_bActive)
+    {
+        rootPass.m_bActive = true;
+        ms_nActivePassCount++;
+    }
+
+    ms_arrRequired.assign(ms_arrRenderTarget.size(), false);
+    MarkRequiredRenderTargets(&rootPass);
+    UpdateResidency();
+}
+
+const bool RenderGraph::IsManaged(const RenderTarget* const renderTarget)
+{
+    return FindRenderTarget(renderTarget) != ~0u;
+}
+
+void RenderGraph::UpdateActivePasses(RenderPass* const pass)
+{
+    if (!pass->IsEnabled())
+    {
+        DeactivatePass(pass);
+        return;
+    }
+
+    // Visit passes in reverse execution order, so that the consumers
+    // of a pass's outputs have been scheduled by the time it is reached
+    bool isAnyChildActive = false;
+    const std::vector<RenderPass*>& children = pass->GetChildren();
+    for (int i = (int)children.size() - 1; i >= 0; i--)
+    {
+        if (children[i] != nullptr)
+        {
+            UpdateActivePasses(children[i]);
+            isAnyChildActive = isAnyChildActive || children[i]->m_bActive;
+        }
+    }
+
+    const std::vector<RenderTarget*>& written = pass->GetWrittenRenderTargets();
+    bool isActive = isAnyChildActive;
+    if (!isActive)
+    {
+        // Leaf passes that don't write to any render target have other side effects (e.g. drawing to the back buffer)
+        if (written.empty())
+            isActive = children.empty();
+        else
+            for (unsigned int i = 0; i < written.size() && !isActive; i++)
+                isActive = std::find(ms_arrConsumedRenderTarget.begin(), ms_arrConsumedRenderTarget.end(), written[i]) != ms_arrConsumedRenderTarget.end();
+    }
+
+    pass->m_bActive = isActive;
+    if (!isActive)
+        return;
+
+    ms_nActivePassCount++;
+
+    const std::vector<RenderTarget*>& read = pass->GetReadRenderTargets();
+    for (unsigned int i = 0; i < read.size(); i++)
+        if (std::find(ms_arrConsumedRenderTarget.begin(), ms_arrConsumedRenderTarget.end(), read[i]) == ms_arrConsumedRenderTarget.end())
+            ms_arrConsumedRenderTarget.push_back(read[i]);
+}
+
+void RenderGraph::DeactivatePass(RenderPass* const pass)
+{
+    pass->m_bActive = false;
+
+    const std::vector<RenderPass*>& children = pass->GetChildren();
+    for (unsigned int i = 0; i < children.size(); i++)
+        if (children[i] != nullptr)
+            DeactivatePass(children[i]);
+}
+
+void RenderGraph::MarkRequiredRenderTargets(RenderPass* const pass)
+{
+    if (!pass->m_bActive)
+        return;
+
+    const std::vector<RenderTarget*>& written = pass->GetWrittenRenderTargets();
+    for (unsigned int i = 0; i < written.size(); i++)
+        ms_arrRequired[FindRenderTarget(written[i])] = true;
+
+    const std::vector<RenderPass*>& children = pass->GetChildren();
+    for (unsigned int i = 0; i < children.size(); i++)
+        if (children[i] != nullptr)
+            MarkRequiredRenderTargets(children[i]);
+}
+
+void RenderGraph::UpdateResidency()
+{
+    // The resource of an alias group has to be kept for as long as any of its members is required
+    for (unsigned int i = 0; i < ms_arrRenderTarget.size(); i++)
+        if (ms_arrRequired[i] && ms_arrRenderTarget[i]->pAliasOwner)
+            ms_arrRequired[FindRenderTarget(ms_arrRenderTarget[i]->pAliasOwner)] = true;
+
+    // Release unused render targets first, so that their memory can be reused by the ones created below
+    for (unsigned int i = 0; i < ms_arrRenderTarget.size(); i++)
+    {
+        if (!ms_arrRequired[i] && ms_arrRenderTarget[i]->IsInitialized())
+        {
+            ms_arrRenderTarget[i]->Free();
+            cout << "Render graph: released \"" << ms_arrRenderTarget[i]->GetDesc() << "\"\n";
+        }
+    }
+
+    // Owners of alias groups have to be created before their aliases
+    ms_nResidentRenderTargetCount = 0;
+    for (unsigned int step = 0; step < 2; step++)
+    {
+        for (unsigned int i = 0; i < ms_arrRenderTarget.size(); i++)
+        {
+            RenderTarget* const rt = ms_arrRenderTarget[i];
+            if (!ms_arrRequired[i] || (rt->pAliasOwner != nullptr) != (step == 1))
+                continue;
+
+            if (!rt->IsInitialized())
+            {
+                rt->LockRes();
+                ResourceManager::PushMemoryOwner(ms_arrOwnerPass[i]->GetPassName());
+                rt->Init();
+                ResourceManager::PopMemoryOwner();
+                rt->UnlockRes();
+                cout << "Render graph: created \"" << rt->GetDesc() << "\"\n";
+            }
+
+            if (!rt->pAliasOwner)
+                ms_nResidentRenderTargetCount++;
+        }
+    }
+}
+
+const unsigned int RenderGraph::FindRenderTarget(const RenderTarget* const renderTarget)
+{
+    for (unsigned int i = 0; i < ms_arrRenderTarget.size(); i++)
+        if (ms_arrRenderTarget[i] == renderTarget)
+            return i;
+
+    return ~0u;
+}
@@ -0,0 +1,94 @@
+/*=============================================================================
+ * This file is part of the "GITechDemo" application
+ * Copyright (C) Iftode Bogdan-Marius <iftode.bogdan@gmail.com>
+ *
+ *      File:   RenderGraph.h
+ *      Author: Bogdan Iftode
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+=============================================================================*/
+
+#ifndef RENDER_GRAPH_H_
+#define RENDER_GRAPH_H_
+
+#include <vector>
+
+namespace GITechDemoApp
+{
+    class RenderPass;
+    class RenderTarget;
+
+    // Builds the render target lifetimes from the read/write declarations of the passes
+    // in a render scheme and lets transient render targets whose lifetimes do not overlap
+    // share the same underlying resource. Passes are executed in depth-first order, with a
+    // parent pass spanning the execution of all of its children.
+    //
+    // Every frame, passes which are disabled or whose outputs are not consumed by any
+    // pass executing after them are pruned, and only the render targets written by the
+    // remaining passes are kept resident.
+    class RenderGraph
+    {
+    public:
+        // Must be called before render targets are initialized
+        static void Compile(RenderPass& rootPass);
+
+        // Schedules the passes for the current frame and creates or releases render targets accordingly
+        static void Update(RenderPass& rootPass);
+
+        // Render targets declared by the passes are created on demand by Update()
+        static const bool IsManaged(const RenderTarget* const renderTarget);
+
+        static const unsigned int GetRenderTargetCount() { return ms_nRenderTargetCount; }
+        static const unsigned int GetAliasedRenderTargetCount() { return ms_nAliasedRenderTargetCount; }
+        static const unsigned int GetActivePassCount() { return ms_nActivePassCount; }
+        static const unsigned int GetResidentRenderTargetCount() { return ms_nResidentRenderTargetCount; } // Excluding aliases
+
+    private:
+        struct RenderTargetLifetime
+        {
+            RenderTarget*   pRenderTarget;
+            RenderPass*     pFirstPass;     // The pass which first accesses the render target, which its memory is accounted to
+            unsigned int    nFirstUse;
+            unsigned int    nLastUse;
+            bool            bTransient; // First accessed by a pass that only writes it
+        };
+
+        struct AliasGroup
+        {
+            std::vector<RenderTarget*>  arrRenderTarget;
+            unsigned int                nLastUse;
+        };
+
+        static void GatherLifetimes(RenderPass* const pass, unsigned int& passIdx, std::vector<RenderTargetLifetime>& lifetimes);
+        static const unsigned int FindOrAddLifetime(RenderTarget* const renderTarget, RenderPass* const pass, const unsigned int passIdx, const bool isTransient, std::vector<RenderTargetLifetime>& lifetimes);
+
+        static void UpdateActivePasses(RenderPass* const pass);
+        static void DeactivatePass(RenderPass* const pass);
+        static void MarkRequiredRenderTargets(RenderPass* const pass);
+        static void UpdateResidency();
+        static const unsigned int FindRenderTarget(const RenderTarget* const renderTarget);
+
+        static std::vector<RenderTarget*>   ms_arrRenderTarget;         // Render targets declared by the passes
+        static std::vector<RenderPass*>     ms_arrOwnerPass;            // Pass which first accesses each render target
+        static std::vector<bool>            ms_arrRequired;             // Render targets written to by active passes
+        static std::vector<RenderTarget*>   ms_arrConsumedRenderTarget; // Render targets read by active passes later in the frame
+
+        static unsigned int ms_nRenderTargetCount;
+        static unsigned int ms_nAliasedRenderTargetCount;
+        static unsigned int ms_nActivePassCount;
+        static unsigned int ms_nResidentRenderTargetCount;
+    };
+}
+
+#endif //RENDER_GRAPH_H_
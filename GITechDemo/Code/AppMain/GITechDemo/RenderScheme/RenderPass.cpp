@@ -21,7 +21,10 @@
 
 #include "stdafx.h"
 
+#include <algorithm>
+
 #include <Renderer.h>
+#include <ResourceManager.h>
 #include <Profiler.h>
 using namespace Synesthesia3D;
 
@@ -32,6 +35,9 @@ using namespace GITechDemoApp;
 
 RenderPass::RenderPass(const char* const passName, RenderPass* const parentPass)
     : m_szPassName(passName)
+    , m_bActive(true)
+    , m_fCPUTime(0.f)
+    , m_nProfileMarkerId(~0u)
 {
     if(parentPass)
         parentPass->AddChildPass(this);
@@ -40,14 +46,37 @@ RenderPass::RenderPass(const char* const passName, RenderPass* const parentPass)
 RenderPass::~RenderPass()
 {}
 
+const unsigned int RenderPass::GetProfileMarkerId() const
+{
+    Profiler* const profiler = Renderer::GetInstance() ? Renderer::GetInstance()->GetProfiler() : nullptr;
+    if (m_nProfileMarkerId == ~0u && profiler)
+        m_nProfileMarkerId = profiler->InternProfileMarkerLabel(GetPassName());
+
+    return m_nProfileMarkerId;
+}
+
 void RenderPass::AddChildPass(RenderPass* const childPass)
 {
     m_arrChildList.push_back(childPass);
 }
 
+void RenderPass::ReadsRenderTarget(RenderTarget* const renderTarget)
+{
+    assert(renderTarget);
+    if (std::find(m_arrReadRenderTargets.begin(), m_arrReadRenderTargets.end(), renderTarget) == m_arrReadRenderTargets.end())
+        m_arrReadRenderTargets.push_back(renderTarget);
+}
+
+void RenderPass::WritesRenderTarget(RenderTarget* const renderTarget)
+{
+    assert(renderTarget);
+    if (std::find(m_arrWrittenRenderTargets.begin(), m_arrWrittenRenderTargets.end(), renderTarget) == m_arrWrittenRenderTargets.end())
+        m_arrWrittenRenderTargets.push_back(renderTarget);
+}
+
 void RenderPass::Draw()
 {
-    PUSH_PROFILE_MARKER_WITH_GPU_QUERY(GetPassName());
+    PUSH_PROFILE_MARKER_WITH_GPU_QUERY(GetProfileMarkerId());
     DrawChildren();
     POP_PROFILE_MARKER();
 }
@@ -56,11 +85,20 @@ void RenderPass::DrawChildren()
 {
     for (unsigned int child = 0; child < m_arrChildList.size(); child++)
     {
-        if (m_arrChildList[child] != nullptr)
+        // Skip passes pruned by the render graph, as well as their children
+        if (m_arrChildList[child] != nullptr && m_arrChildList[child]->IsActive())
         {
-            PUSH_PROFILE_MARKER_WITH_GPU_QUERY(m_arrChildList[child]->GetPassName());
-            m_arrChildList[child]->Update(((GITechDemo*)AppMain)->GetDeltaTime());
-            m_arrChildList[child]->Draw();
+            PUSH_PROFILE_MARKER_WITH_GPU_QUERY(m_arrChildList[child]->GetProfileMarkerId());
+            const long long cpuStart = Profiler::GetCPUTimestamp();
+            {
+                CPU_PROFILE_SCOPE(m_arrChildList[child]->GetProfileMarkerId());
+                {
+                    CPU_PROFILE_SCOPE("Update");
+                    m_arrChildList[child]->Update(((GITechDemo*)AppMain)->GetDeltaTime());
+                }
+                m_arrChildList[child]->Draw();
+            }
+            m_arrChildList[child]->m_fCPUTime = (float)(Profiler::GetCPUTimestamp() - cpuStart) / 1000000.f;
             POP_PROFILE_MARKER();
         }
     }
@@ -82,7 +120,11 @@ void RenderPass::AllocateChildrenResources()
     {
         if (m_arrChildList[child] != nullptr)
         {
+            // Account the memory of the resources allocated by the pass to it (see the memory usage window)
+            ResourceManager::PushMemoryOwner(m_arrChildList[child]->GetPassName());
             m_arrChildList[child]->AllocateResources();
+            ResourceManager::PopMemoryOwner();
+
             m_arrChildList[child]->AllocateChildrenResources();
         }
     }
@@ -36,6 +36,8 @@
 
 namespace GITechDemoApp
 {
+    class RenderTarget;
+
     class RenderPass
     {
     public:
@@ -45,17 +47,41 @@ namespace GITechDemoApp
         void AddChildPass(RenderPass* const childPass);
         const char* const GetPassName() const { return m_szPassName.c_str(); }
 
+        // Interned profile marker label of the pass, for hashed profiler lookups
+        const unsigned int GetProfileMarkerId() const;
+
+        // Whether the pass has been scheduled for execution this frame (see RenderGraph)
+        const bool IsActive() const { return m_bActive; }
+
+        // CPU time spent updating and drawing the pass (children included) the last time it was active, in miliseconds
+        const float GetCPUTime() const { return m_fCPUTime; }
+
         const std::vector<RenderPass*>&     GetChildren() const { return m_arrChildList; }
 
+        // Render targets accessed by this pass (see RenderGraph)
+        const std::vector<RenderTarget*>&   GetReadRenderTargets() const { return m_arrReadRenderTargets; }
+        const std::vector<RenderTarget*>&   GetWrittenRenderTargets() const { return m_arrWrittenRenderTargets; }
+
     protected:
         virtual void Update(const float fDeltaTime) {}
         virtual void Draw();
 
+        // Passes that are disabled by the render configuration are pruned, along with their children
+        virtual const bool IsEnabled() const { return true; }
+
         virtual void AllocateResources();
         virtual void ReleaseResources();
 
         void DrawChildren();
 
+        // Declare the render targets this pass samples from or renders to, so that the
+        // render graph can compute their lifetimes. A render target should be declared as
+        // read only if the pass consumes contents produced before it started executing
+        // (e.g. earlier in the frame or in a previous frame). Ping-pong buffers which are
+        // fully overwritten by the pass before being sampled are only written.
+        void ReadsRenderTarget(RenderTarget* const renderTarget);
+        void WritesRenderTarget(RenderTarget* const renderTarget);
+
     private:
         // Disallow some member functions
         RenderPass();
@@ -68,7 +94,17 @@ namespace GITechDemoApp
         std::string                 m_szPassName;
         std::vector<RenderPass*>    m_arrChildList;
 
+        std::vector<RenderTarget*>  m_arrReadRenderTargets;
+        std::vector<RenderTarget*>  m_arrWrittenRenderTargets;
+
+        bool                        m_bActive;
+        float                       m_fCPUTime;
+
+        // Interned lazily, since passes are constructed before the renderer
+        mutable unsigned int        m_nProfileMarkerId;
+
         friend class RenderScheme;
+        friend class RenderGraph;
     };
 }
 
@@ -23,6 +23,7 @@
 #define RENDER_SCHEME_H_
 
 #include "RenderPass.h"
+#include "RenderGraph.h"
 
 namespace GITechDemoApp
 {
@@ -30,11 +31,14 @@ namespace GITechDemoApp
     {
     public:
         static RenderPass&  GetRootPass() { return RootPass; }
-        static void         Draw() { RootPass.Draw(); }
+        static void         Draw() { RenderGraph::Update(RootPass); RootPass.Draw(); }
 
-        static void         AllocateResources() { RootPass.AllocateResources(); }
+        // Only the render targets used by the passes which are going to be executed are created
+        static void         AllocateResources() { RenderGraph::Update(RootPass); RootPass.AllocateResources(); }
         static void         ReleaseResources() { RootPass.ReleaseResources(); }
 
+        static void         CompileRenderGraph() { RenderGraph::Compile(RootPass); }
+
     private:
         static RenderPass   RootPass;
     };
@@ -34,7 +34,10 @@ using namespace GITechDemoApp;
 
 ResolveDepthBufferPass::ResolveDepthBufferPass(const char* const passName, RenderPass* const parentPass)
     : RenderPass(passName, parentPass)
-{}
+{
+    ReadsRenderTarget(&GBuffer);
+    WritesRenderTarget(&LightAccumulationBuffer);
+}
 
 ResolveDepthBufferPass::~ResolveDepthBufferPass()
 {}
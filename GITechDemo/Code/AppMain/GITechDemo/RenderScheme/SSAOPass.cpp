@@ -38,11 +38,24 @@ SSAOPass::SSAOPass(const char* const passName, RenderPass* const parentPass)
     : RenderPass(passName, parentPass)
     , SSAOBuffer(SSAOFullBuffer)
     , BlurKernelCount(RenderConfig::PostProcessing::ScreenSpaceAmbientOcclusion::BlurKernelCount)
-{}
+{
+    ReadsRenderTarget(&GBuffer);
+    ReadsRenderTarget(&LightAccumulationBuffer);
+    WritesRenderTarget(&SSAOFullBuffer0);
+    WritesRenderTarget(&SSAOFullBuffer1);
+    WritesRenderTarget(&SSAOQuarterBuffer0);
+    WritesRenderTarget(&SSAOQuarterBuffer1);
+    WritesRenderTarget(&LightAccumulationBuffer);
+}
 
 SSAOPass::~SSAOPass()
 {}
 
+const bool SSAOPass::IsEnabled() const
+{
+    return RenderConfig::PostProcessing::ScreenSpaceAmbientOcclusion::Enabled;
+}
+
 void SSAOPass::Update(const float fDeltaTime)
 {
     Renderer* RenderContext = Renderer::GetInstance();
@@ -120,7 +133,7 @@ void SSAOPass::BlurSSAO()
         char label[10];
         sprintf_s(label, "Kernel %d", RenderConfig::PostProcessing::ScreenSpaceAmbientOcclusion::BlurKernel[i]);
 #endif
-        PUSH_PROFILE_MARKER(label);
+        PUSH_DYNAMIC_PROFILE_MARKER(label);
 
         SSAOBuffer[(i + 1) % 2]->Enable();
 
@@ -204,9 +217,6 @@ void SSAOPass::ApplySSAO()
 
 void SSAOPass::Draw()
 {
-    if (!RenderConfig::PostProcessing::ScreenSpaceAmbientOcclusion::Enabled)
-        return;
-
     //Synesthesia3D::RenderTarget* pCurrRT = Synesthesia3D::RenderTarget::GetActiveRenderTarget();
     //if (pCurrRT)
     //  pCurrRT->Disable();
@@ -31,6 +31,7 @@ namespace GITechDemoApp
     class SSAOPass : public RenderPass
     {
         IMPLEMENT_RENDER_PASS(SSAOPass)
+        const bool IsEnabled() const;
 
     private:
         void CalculateSSAO();
@@ -79,9 +79,9 @@ void SceneGeometryPass::Draw()
 
             if (SponzaScene.GetModel()->arrMaterial[matIdx]->fOpacity >= 1.f)
             {
-                PUSH_PROFILE_MARKER(SponzaScene.GetModel()->arrMaterial[SponzaScene.GetModel()->arrMesh[mesh]->nMaterialIdx]->szName.c_str());
+                PUSH_DRAW_PROFILE_MARKER(SponzaScene.GetModel()->arrMaterial[SponzaScene.GetModel()->arrMesh[mesh]->nMaterialIdx]->szName.c_str());
                 RenderContext->DrawVertexBuffer(SponzaScene.GetModel()->arrMesh[mesh]->pVertexBuffer);
-                POP_PROFILE_MARKER();
+                POP_DRAW_PROFILE_MARKER();
             }
         }
 
@@ -104,9 +104,9 @@ void SceneGeometryPass::Draw()
                     HLSL::DepthPassAlphaTest_Diffuse = diffuseTexIdx;
                     DepthPassAlphaTestShader.CommitShaderInputs();
 
-                    PUSH_PROFILE_MARKER(SponzaScene.GetModel()->arrMaterial[SponzaScene.GetModel()->arrMesh[mesh]->nMaterialIdx]->szName.c_str());
+                    PUSH_DRAW_PROFILE_MARKER(SponzaScene.GetModel()->arrMaterial[SponzaScene.GetModel()->arrMesh[mesh]->nMaterialIdx]->szName.c_str());
                     RenderContext->DrawVertexBuffer(SponzaScene.GetModel()->arrMesh[mesh]->pVertexBuffer);
-                    POP_PROFILE_MARKER();
+                    POP_DRAW_PROFILE_MARKER();
                 }
             }
 
@@ -127,7 +127,7 @@ void SceneGeometryPass::Draw()
     // scene isn't very big and we are mostly pixel bound.
     for (unsigned int mesh = 0; mesh < SponzaScene.GetModel()->arrMesh.size(); mesh++)
     {
-        PUSH_PROFILE_MARKER(SponzaScene.GetModel()->arrMaterial[SponzaScene.GetModel()->arrMesh[mesh]->nMaterialIdx]->szName.c_str());
+        PUSH_DRAW_PROFILE_MARKER(SponzaScene.GetModel()->arrMaterial[SponzaScene.GetModel()->arrMesh[mesh]->nMaterialIdx]->szName.c_str());
 
         const unsigned int diffuseTexIdx = SponzaScene.GetTexture(Synesthesia3D::Model::TextureDesc::TT_DIFFUSE, SponzaScene.GetModel()->arrMesh[mesh]->nMaterialIdx);
         const unsigned int normalTexIdx = SponzaScene.GetTexture(Synesthesia3D::Model::TextureDesc::TT_HEIGHT, SponzaScene.GetModel()->arrMesh[mesh]->nMaterialIdx);
@@ -165,7 +165,7 @@ void SceneGeometryPass::Draw()
             GBufferGenerationShader.Disable();
         }
 
-        POP_PROFILE_MARKER();
+        POP_DRAW_PROFILE_MARKER();
     }
 
     if (RenderConfig::GBuffer::ZPrepass)
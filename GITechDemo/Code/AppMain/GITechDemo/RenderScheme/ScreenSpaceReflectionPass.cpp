@@ -36,11 +36,21 @@ using namespace GITechDemoApp;
 
 ScreenSpaceReflectionPass::ScreenSpaceReflectionPass(const char* const passName, RenderPass* const parentPass)
     : RenderPass(passName, parentPass)
-{}
+{
+    ReadsRenderTarget(&GBuffer);
+    ReadsRenderTarget(&LinearFullDepthBuffer);
+    ReadsRenderTarget(&LightAccumulationBuffer);
+    WritesRenderTarget(&LightAccumulationBuffer);
+}
 
 ScreenSpaceReflectionPass::~ScreenSpaceReflectionPass()
 {}
 
+const bool ScreenSpaceReflectionPass::IsEnabled() const
+{
+    return RenderConfig::PostProcessing::ScreenSpaceReflections::Enabled;
+}
+
 void ScreenSpaceReflectionPass::Update(const float fDeltaTime)
 {
     Renderer* RenderContext = Renderer::GetInstance();
@@ -134,9 +144,6 @@ void ScreenSpaceReflectionPass::Update(const float fDeltaTime)
 
 void ScreenSpaceReflectionPass::Draw()
 {
-    if (!RenderConfig::PostProcessing::ScreenSpaceReflections::Enabled)
-        return;
-
     Renderer* RenderContext = Renderer::GetInstance();
     if (!RenderContext)
         return;
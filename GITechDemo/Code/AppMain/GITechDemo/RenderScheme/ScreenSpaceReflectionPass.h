@@ -34,6 +34,7 @@ namespace GITechDemoApp
     class ScreenSpaceReflectionPass : public RenderPass
     {
         IMPLEMENT_RENDER_PASS(ScreenSpaceReflectionPass)
+        const bool IsEnabled() const;
 
     private:
         void CopyLightAccumulationBuffer();
@@ -59,7 +59,9 @@ namespace GITechDemoApp
 
 ShadowMapDirectionalLightPass::ShadowMapDirectionalLightPass(const char* const passName, RenderPass* const parentPass)
     : RenderPass(passName, parentPass)
-{}
+{
+    WritesRenderTarget(&ShadowMapDir);
+}
 
 ShadowMapDirectionalLightPass::~ShadowMapDirectionalLightPass()
 {}
@@ -108,6 +110,11 @@ void ShadowMapDirectionalLightPass::UpdateSceneAABB()
     RenderConfig::Scene::WorldSpaceAABB.setInitialized();
 }
 
+const bool ShadowMapDirectionalLightPass::IsEnabled() const
+{
+    return RenderConfig::DirectionalLight::Enabled || RenderConfig::DirectionalLightVolume::Enabled;
+}
+
 void ShadowMapDirectionalLightPass::Update(const float fDeltaTime)
 {
     Renderer* RenderContext = Renderer::GetInstance();
@@ -284,9 +291,6 @@ void ShadowMapDirectionalLightPass::Update(const float fDeltaTime)
 
 void ShadowMapDirectionalLightPass::Draw()
 {
-    if (!RenderConfig::DirectionalLight::Enabled && !RenderConfig::DirectionalLightVolume::Enabled)
-        return;
-
     Renderer* RenderContext = Renderer::GetInstance();
     if (!RenderContext)
         return;
@@ -311,7 +315,7 @@ void ShadowMapDirectionalLightPass::Draw()
         char tmpBuf[16];
         sprintf_s(tmpBuf, "Cascade %d", cascade);
 #endif
-        PUSH_PROFILE_MARKER(tmpBuf);
+        PUSH_DYNAMIC_PROFILE_MARKER(tmpBuf);
 
         const Vec2i size(cascadeSize, cascadeSize);
         const Vec2i offset(cascadeSize * (cascade % cascadesPerRow), cascadeSize * (cascade / cascadesPerRow));
@@ -329,9 +333,9 @@ void ShadowMapDirectionalLightPass::Draw()
         // view frustum, but we don't have a big enough scene to care at the moment
         for (unsigned int mesh = 0; mesh < SponzaScene.GetModel()->arrMesh.size(); mesh++)
         {
-            PUSH_PROFILE_MARKER(SponzaScene.GetModel()->arrMaterial[SponzaScene.GetModel()->arrMesh[mesh]->nMaterialIdx]->szName.c_str());
+            PUSH_DRAW_PROFILE_MARKER(SponzaScene.GetModel()->arrMaterial[SponzaScene.GetModel()->arrMesh[mesh]->nMaterialIdx]->szName.c_str());
             RenderContext->DrawVertexBuffer(SponzaScene.GetModel()->arrMesh[mesh]->pVertexBuffer);
-            POP_PROFILE_MARKER();
+            POP_DRAW_PROFILE_MARKER();
         }
 
         DepthPassShader.Disable();
@@ -345,7 +349,7 @@ void ShadowMapDirectionalLightPass::Draw()
             {
                 const PBRMaterial* const pbrMaterial = (PBRMaterial*)arrRenderResourceList[resIdx];
 
-                PUSH_PROFILE_MARKER(pbrMaterial->GetDesc());
+                PUSH_DRAW_PROFILE_MARKER(pbrMaterial->GetDesc());
 
                 HLSL::DepthPassParams->WorldViewProjMat = HLSL::FrameParams->DirectionalLightViewProjMat[cascade] * PBRMaterialTestPass::CalculateWorldMatrixForSphereIdx(pbrMatIdx++, pbrMaterialCount);
 
@@ -357,7 +361,7 @@ void ShadowMapDirectionalLightPass::Draw()
 
                 DepthPassShader.Disable();
 
-                POP_PROFILE_MARKER();
+                POP_DRAW_PROFILE_MARKER();
             }
         }
 
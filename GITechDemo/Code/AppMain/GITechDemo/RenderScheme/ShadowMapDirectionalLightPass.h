@@ -29,6 +29,7 @@ namespace GITechDemoApp
     class ShadowMapDirectionalLightPass : public RenderPass
     {
         IMPLEMENT_RENDER_PASS(ShadowMapDirectionalLightPass)
+        const bool IsEnabled() const;
 
     private:
         void UpdateSceneAABB();
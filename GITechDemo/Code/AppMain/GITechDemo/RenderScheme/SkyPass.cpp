@@ -42,7 +42,13 @@ SkyPass::SkyPass(const char* const passName, RenderPass* const parentPass)
     : RenderPass(passName, parentPass)
     , m_pSkyBoxCube(nullptr)
     , m_nSkyBoxCubeIdx(~0u)
-{}
+    , m_pSkyBlendState(nullptr)
+    , m_pSkyDepthStencilState(nullptr)
+{
+    ReadsRenderTarget(&GBuffer);
+    ReadsRenderTarget(&LightAccumulationBuffer);
+    WritesRenderTarget(&LightAccumulationBuffer);
+}
 
 SkyPass::~SkyPass()
 {}
@@ -65,7 +71,7 @@ void SkyPass::AllocateResources()
     // NB: in the pixel shader responsible for drawing the sky, the visible face(s)
     // are pushed back to the maximum depth (far plane) so as not to be drawn
     // over objects that are not inside the cube (bigger depth).
-    const unsigned int vfIdx = ResourceMgr->CreateVertexFormat(1, VAS_POSITION, VAT_FLOAT4, 0);
+    const unsigned int vfIdx = ResourceMgr->GetOrCreateVertexFormat(1, VAS_POSITION, VAT_FLOAT4, 0);
     VertexFormat* vf = ResourceMgr->GetVertexFormat(vfIdx);
 
     const unsigned int ibIdx = ResourceMgr->CreateIndexBuffer(36);
@@ -97,6 +103,18 @@ void SkyPass::AllocateResources()
     m_pSkyBoxCube->Position<Vec4f>(7) = Vec4f(1.f, -1.f, -1.f, 1.f);
     m_pSkyBoxCube->Update();
     m_pSkyBoxCube->Unlock();
+
+    // Only override the states required by the pass, on top of the default ones
+    BlendStateDesc blendDesc;
+    blendDesc.bColorBlendEnabled = true;
+    blendDesc.eColorSrcBlend = BLEND_ONE;
+    blendDesc.eColorDstBlend = BLEND_ZERO;
+    m_pSkyBlendState = RenderContext->GetRenderStateManager()->CreateBlendState(blendDesc);
+
+    DepthStencilStateDesc depthStencilDesc;
+    depthStencilDesc.bZWriteEnabled = false;
+    depthStencilDesc.eZFunc = CMP_LESSEQUAL;
+    m_pSkyDepthStencilState = RenderContext->GetRenderStateManager()->CreateDepthStencilState(depthStencilDesc);
 }
 
 void SkyPass::ReleaseResources()
@@ -111,6 +129,10 @@ void SkyPass::ReleaseResources()
 
     m_nSkyBoxCubeIdx = ~0u;
     m_pSkyBoxCube = nullptr;
+
+    // State blocks are owned by the render state manager
+    m_pSkyBlendState = nullptr;
+    m_pSkyDepthStencilState = nullptr;
 }
 
 void SkyPass::Update(const float fDeltaTime)
@@ -161,25 +183,16 @@ void SkyPass::Draw()
     if (!RenderContext)
         return;
 
-    const bool blendEnabled = RenderContext->GetRenderStateManager()->GetColorBlendEnabled();
-    const Blend DstBlend = RenderContext->GetRenderStateManager()->GetColorDstBlend();
-    const Blend SrcBlend = RenderContext->GetRenderStateManager()->GetColorSrcBlend();
-    const bool zWriteEnable = RenderContext->GetRenderStateManager()->GetZWriteEnabled();
-    const Cmp zFunc = RenderContext->GetRenderStateManager()->GetZFunc();
+    const BlendState* const blendState = RenderContext->GetRenderStateManager()->GetBlendState();
+    const DepthStencilState* const depthStencilState = RenderContext->GetRenderStateManager()->GetDepthStencilState();
 
-    RenderContext->GetRenderStateManager()->SetColorBlendEnabled(true);
-    RenderContext->GetRenderStateManager()->SetColorDstBlend(BLEND_ZERO);
-    RenderContext->GetRenderStateManager()->SetColorSrcBlend(BLEND_ONE);
-    RenderContext->GetRenderStateManager()->SetZWriteEnabled(false);
-    RenderContext->GetRenderStateManager()->SetZFunc(CMP_LESSEQUAL);
+    RenderContext->GetRenderStateManager()->SetBlendState(m_pSkyBlendState);
+    RenderContext->GetRenderStateManager()->SetDepthStencilState(m_pSkyDepthStencilState);
 
     SkyBoxShader.Enable();
     RenderContext->DrawVertexBuffer(m_pSkyBoxCube);
     SkyBoxShader.Disable();
 
-    RenderContext->GetRenderStateManager()->SetColorBlendEnabled(blendEnabled);
-    RenderContext->GetRenderStateManager()->SetColorDstBlend(DstBlend);
-    RenderContext->GetRenderStateManager()->SetColorSrcBlend(SrcBlend);
-    RenderContext->GetRenderStateManager()->SetZWriteEnabled(zWriteEnable);
-    RenderContext->GetRenderStateManager()->SetZFunc(zFunc);
+    RenderContext->GetRenderStateManager()->SetBlendState(blendState);
+    RenderContext->GetRenderStateManager()->SetDepthStencilState(depthStencilState);
 }
\ No newline at end of file
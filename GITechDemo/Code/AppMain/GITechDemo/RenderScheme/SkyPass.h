@@ -27,6 +27,11 @@
 namespace Synesthesia3D
 {
     class VertexBuffer;
+    struct BlendStateDesc;
+    struct DepthStencilStateDesc;
+    template <typename DESC> class RenderStateBlock;
+    typedef RenderStateBlock<BlendStateDesc>        BlendState;
+    typedef RenderStateBlock<DepthStencilStateDesc> DepthStencilState;
 }
 
 namespace GITechDemoApp
@@ -41,6 +46,10 @@ namespace GITechDemoApp
         // A cube used to draw the sky
         VertexBuffer*   m_pSkyBoxCube;
         unsigned int    m_nSkyBoxCubeIdx;
+
+        // Render states used when drawing the sky
+        const BlendState*           m_pSkyBlendState;
+        const DepthStencilState*    m_pSkyDepthStencilState;
     };
 }
 
@@ -21,6 +21,8 @@
 
 #include "stdafx.h"
 
+#include <algorithm>
+
 #include <imgui.h>
 #include <gainput/gainput.h>
 
@@ -33,9 +35,12 @@
 #include <IndexBuffer.h>
 #include <VertexBuffer.h>
 #include <RenderTarget.h>
+#include <RenderTrace.h>
 using namespace Synesthesia3D;
 
 #include <Utility/Hash.h>
+#include <Utility/FrameAllocator.h>
+#include <Utility/GeometryRingBuffer.h>
 
 #include "Framework.h"
 using namespace AppFramework;
@@ -49,16 +54,14 @@ using namespace AppFramework;
 using namespace GITechDemoApp;
 
 #define FRAMETIME_GRAPH_HEIGHT (100.f)
-#define FRAMETIME_GRAPH_HISTORY (10.f)
 
 #define STEP_FAST (10.f)
 #define BUTTON_WIDTH (100.f)
 #define ALPHA_PER_SECOND (5.f)
 #define ALPHA_MIN (0.25f)
 
-#define MARKER_RESULT_HISTORY (1.f)
-
-static const string HumanReadableByteCount(unsigned long bytes)
+// The strings are formatted in memory from the renderer's frame allocator, valid until the end of the next frame
+static const char* const HumanReadableByteCount(unsigned long bytes)
 {
     int i = 0;
     const char* units[] = { "B", "kB", "MB", "GB", "TB", "PB", "EB", "ZB", "YB" };
@@ -68,19 +71,26 @@ static const string HumanReadableByteCount(unsigned long bytes)
         size /= 1024.f;
         i++;
     }
-    std::ostringstream stringStream;
-    stringStream.imbue(std::locale(""));
-    stringStream << std::fixed << std::setprecision(2);
+
+    FrameAllocator* const frameAllocator = Renderer::GetInstance()->GetFrameAllocator();
     if (i == 0)
     {
-        stringStream << bytes << " " << units[i];
+        return frameAllocator->Format("%lu %s", bytes, units[i]);
     }
     else
     {
-        stringStream << roundf(size * 100.f) / 100.f << " " << units[i] << " (" << bytes << " " << units[0] << ")";
+        return frameAllocator->Format("%.2f %s (%lu %s)", roundf(size * 100.f) / 100.f, units[i], bytes, units[0]);
     }
-    string string = stringStream.str();
-    return string;
+}
+
+static const char* const MemorySizeString(const long long bytes)
+{
+    return Renderer::GetInstance()->GetFrameAllocator()->Format("%.2f MB", (double)bytes / (1024.0 * 1024.0));
+}
+
+static const bool CompareMemoryUsageByGPUBytes(const std::pair<const string, MemoryUsage>* const a, const std::pair<const string, MemoryUsage>* const b)
+{
+    return a->second.nGPUBytes + a->second.nCPUBytes > b->second.nGPUBytes + b->second.nCPUBytes;
 }
 
 UIPass::UIPass(const char* const passName, RenderPass* const parentPass)
@@ -95,10 +105,17 @@ UIPass::UIPass(const char* const passName, RenderPass* const parentPass)
     , m_fSelectedSlice(0.f)
     , m_nSelectedFace(0)
     , m_bChannelMask(true, true, true)
-    , m_nCurrBufferIdx(0u)
+    , m_nImGuiVfIdx(~0u)
+    , m_pImGuiVf(nullptr)
+    , m_pImGuiGeometry(nullptr)
+    , m_nImGuiVtxOffset(0u)
+    , m_nImGuiIdxOffset(0u)
     , m_bShowAllParameters(false)
     , m_bShowProfiler(ENABLE_PROFILE_MARKERS)
     , m_bShowTextureViewer(false)
+    , m_bShowMemoryUsage(false)
+    , m_bHasMemoryBaseline(false)
+    , m_bShowMemoryDiff(false)
     , m_fAlpha(0.f)
     , m_nDummyTex1DIdx(~0u)
     , m_nDummyTex2DIdx(~0u)
@@ -109,15 +126,8 @@ UIPass::UIPass(const char* const passName, RenderPass* const parentPass)
     , m_pDummyTex3D(nullptr)
     , m_pDummyTexCube(nullptr)
 {
-    for (unsigned int i = 0; i < UI_BUFFER_COUNT; i++)
-    {
-        m_nImGuiVfIdx[i] = ~0u;
-        m_pImGuiVf[i] = nullptr;
-        m_nImGuiIbIdx[i] = ~0u;
-        m_pImGuiIb[i] = nullptr;
-        m_nImGuiVbIdx[i] = ~0u;
-        m_pImGuiVb[i] = nullptr;
-    }
+    m_tDrawData.CmdList = nullptr;
+    m_tDrawData.CmdListCount = 0;
 }
 
 UIPass::~UIPass()
@@ -133,7 +143,12 @@ void UIPass::Update(const float fDeltaTime)
     Framework* const pFW = Framework::GetInstance();
     ImGuiIO& io = ImGui::GetIO();
 
-    m_tGPUProfileMarkerResultHistory.Update(pFW->GetDeltaTime());
+    // Retrieve this frame's GPU timings under a single lock, instead of looking them up per pass
+    Profiler* const profiler = RenderContext->GetProfiler();
+    if (profiler)
+        profiler->RetrieveGPUProfileMarkerSnapshot(m_tGPUProfileMarkerSnapshot);
+
+    m_tFrameStatistics.AddFrame(m_tGPUProfileMarkerSnapshot, RenderScheme::GetRootPass());
 
     io.IniFilename = nullptr;
     io.RenderDrawListsFn = nullptr;
@@ -290,12 +305,12 @@ void UIPass::AddParameterInWindow(ArtistParameter* const param) const
     }
 }
 
-void UIPass::CleanGPUProfileMarkerResultCache(const char* const passName)
+void UIPass::CleanGPUProfileMarkerResultCache(const unsigned int markerId)
 {
     // Clean up old cached profile marker results
     for (int i = (int)m_arrGPUProfileMarkerResultCache.size() - 1; i >= 0; i--)
     {
-        if (passName == m_arrGPUProfileMarkerResultCache[i].name)
+        if (markerId == m_arrGPUProfileMarkerResultCache[i].markerId)
         {
             m_arrGPUProfileMarkerResultCache.erase(m_arrGPUProfileMarkerResultCache.begin() + i);
         }
@@ -310,42 +325,15 @@ void UIPass::DrawGPUFrametimeGraph()
 
     const ImGuiStyle& style = ImGui::GetStyle();
 
-    float minTiming = FLT_MAX;
-    float maxTiming = -FLT_MAX;
+    const TimingStatistics& gpuFrameTime = m_tFrameStatistics.GetGPUFrameTime();
+    const unsigned int sampleCount = gpuFrameTime.GetSampleCount();
 
-    // Update GPU frame time history buffer
-    const GPUProfileMarkerResult* const rootMarker = RenderContext->GetProfiler()->RetrieveGPUProfileMarker(RenderScheme::GetRootPass().GetPassName());
-    if (rootMarker)
+    if (sampleCount > 0)
     {
-        const float rootTiming = rootMarker->GetTiming();
-        const float rootStart = rootMarker->GetStart();
-        m_arrGPUFrametimeHistory.push_back(GPUFrametimeHistoryEntry(rootTiming, rootStart));
-
-        // Clean up entries older than FRAMETIME_GRAPH_HISTORY seconds
-        for (int i = (int)m_arrGPUFrametimeHistory.size() - 1; i >= 0; i--)
-        {
-            if (m_arrGPUFrametimeHistory[i].start < rootStart - FRAMETIME_GRAPH_HISTORY * 1000000.f || m_arrGPUFrametimeHistory[i].start > rootStart)
-            {
-                m_arrGPUFrametimeHistory.erase(m_arrGPUFrametimeHistory.begin() + i);
-            }
-            else
-            {
-                if (m_arrGPUFrametimeHistory[i].timing < minTiming)
-                {
-                    minTiming = m_arrGPUFrametimeHistory[i].timing;
-                }
+        const float minTiming = gpuFrameTime.GetMin();
+        const float maxTiming = gpuFrameTime.GetMax();
 
-                if (m_arrGPUFrametimeHistory[i].timing > maxTiming)
-                {
-                    maxTiming = m_arrGPUFrametimeHistory[i].timing;
-                }
-            }
-        }
-    }
-
-    if (m_arrGPUFrametimeHistory.size() > 0)
-    {
-        const float widthFactor = Math::clamp((m_arrGPUFrametimeHistory.back().start - m_arrGPUFrametimeHistory.front().start) / (FRAMETIME_GRAPH_HISTORY * 1000000.f), 0.f, 1.f);
+        const float widthFactor = (float)sampleCount / (float)TimingStatistics::HISTORY_SIZE;
         const float width = ImGui::GetWindowWidth() - style.WindowPadding.x * 2.f;
         const float height = FRAMETIME_GRAPH_HEIGHT - ImGui::GetFontSize() * 2.f - style.WindowPadding.y * 2.f - style.FramePadding.y * 2.f;
         
@@ -357,10 +345,15 @@ void UIPass::DrawGPUFrametimeGraph()
         ImGui::PushStyleColor(ImGuiCol_FrameBg, ImVec4(0.0f, 0.0f, 0.0f, 0.0f));
         ImGui::PushStyleColor(ImGuiCol_PlotLines, ImVec4(lineR, lineG, 0.0f, 1.f));
 
-        ImGui::Text("%7.3f ms (%6.3f fps)", maxTiming, 1000.f / maxTiming);
+        ImGui::Text("%7.3f ms (%6.3f fps)    p50: %6.3f ms    p95: %6.3f ms    p99: %6.3f ms    stutters: %u",
+            maxTiming, 1000.f / maxTiming,
+            gpuFrameTime.GetPercentile(50.f), gpuFrameTime.GetPercentile(95.f), gpuFrameTime.GetPercentile(99.f),
+            gpuFrameTime.GetStutterCount());
         ImGui::SetCursorPosX((1.f - widthFactor) * width + style.WindowPadding.x);
-        ImGui::PlotLines("", &(m_arrGPUFrametimeHistory[0].timing), (int)m_arrGPUFrametimeHistory.size(), 0, nullptr, minTiming, maxTiming, graphSize, sizeof(GPUFrametimeHistoryEntry));
-        ImGui::Text("%7.3f ms (%6.3f fps)", minTiming, 1000.f / minTiming);
+        ImGui::PlotLines("", gpuFrameTime.GetHistory(), (int)sampleCount, (int)gpuFrameTime.GetHistoryOffset(), nullptr, minTiming, maxTiming, graphSize);
+        ImGui::Text("%7.3f ms (%6.3f fps)    CPU p50: %6.3f ms    CPU p99: %6.3f ms",
+            minTiming, 1000.f / minTiming,
+            m_tFrameStatistics.GetCPUFrameTime().GetPercentile(50.f), m_tFrameStatistics.GetCPUFrameTime().GetPercentile(99.f));
 
         ImGui::PopStyleColor();
         ImGui::PopStyleColor();
@@ -380,30 +373,32 @@ void UIPass::DrawGPUProfileBars(const RenderPass* pass, const unsigned int level
 
     if (pass)
     {
-        const GPUProfileMarkerResult* const marker = RenderContext->GetProfiler()->RetrieveGPUProfileMarker(pass->GetPassName());
-        float timing = marker ? marker->GetTiming() : 0.f;
-        float start = marker ? marker->GetStart() : 0.f;
-        float end = marker ? marker->GetEnd() : 0.f;
-
-        const GPUProfileMarkerResult* const rootMarker = RenderContext->GetProfiler()->RetrieveGPUProfileMarker(RenderScheme::GetRootPass().GetPassName());
-        float rootTiming = rootMarker ? rootMarker->GetTiming() : 0.f;
-        float rootStart = rootMarker ? rootMarker->GetStart() : 0.f;
-        float rootEnd = rootMarker ? rootMarker->GetEnd() : 0.f;
+        // Passes pruned by the render graph don't issue queries, so their last results are stale
+        const unsigned int markerId = pass->GetProfileMarkerId();
+        const GPUProfileMarkerSample* const marker = pass->IsActive() ? m_tGPUProfileMarkerSnapshot.Find(markerId) : nullptr;
+        float timing = marker ? marker->fTiming : 0.f;
+        float start = marker ? marker->fStart : 0.f;
+        float end = marker ? marker->fEnd : 0.f;
+
+        const GPUProfileMarkerSample* const rootMarker = m_tGPUProfileMarkerSnapshot.Find(RenderScheme::GetRootPass().GetProfileMarkerId());
+        float rootTiming = rootMarker ? rootMarker->fTiming : 0.f;
+        float rootStart = rootMarker ? rootMarker->fStart : 0.f;
+        float rootEnd = rootMarker ? rootMarker->fEnd : 0.f;
 
         if (level > 0 && timing > 0.f)
         {
             // Add this profile marker result to the cache
             if (start >= rootStart && end <= rootEnd)
             {
-                CleanGPUProfileMarkerResultCache(pass->GetPassName());
+                CleanGPUProfileMarkerResultCache(markerId);
 
                 // Profile marker result is from current frame
-                m_arrGPUProfileMarkerResultCache.push_back(GPUProfileMarkerResultCacheEntry(pass->GetPassName(), timing, start, end, rootTiming, rootStart, rootEnd));
+                m_arrGPUProfileMarkerResultCache.push_back(GPUProfileMarkerResultCacheEntry(markerId, timing, start, end, rootTiming, rootStart, rootEnd));
             }
             else
             {
                 // Profile marker result is from a future frame
-                m_arrGPUProfileMarkerResultCache.push_back(GPUProfileMarkerResultCacheEntry(pass->GetPassName(), timing, start, end, 0.f, 0.f, 0.f));
+                m_arrGPUProfileMarkerResultCache.push_back(GPUProfileMarkerResultCacheEntry(markerId, timing, start, end, 0.f, 0.f, 0.f));
             }
 
             // Add root timings to incomplete cached profile marker results (if applicable)
@@ -418,7 +413,7 @@ void UIPass::DrawGPUProfileBars(const RenderPass* pass, const unsigned int level
                         entry.rootStart = rootStart;
                         entry.rootEnd = rootEnd;
 
-                        CleanGPUProfileMarkerResultCache(entry.name.c_str());
+                        CleanGPUProfileMarkerResultCache(entry.markerId);
 
                         m_arrGPUProfileMarkerResultCache.push_back(entry);
                     }
@@ -430,7 +425,7 @@ void UIPass::DrawGPUProfileBars(const RenderPass* pass, const unsigned int level
             {
                 for (int i = (int)m_arrGPUProfileMarkerResultCache.size() - 1; i >= 0; i--)
                 {
-                    if (pass->GetPassName() == m_arrGPUProfileMarkerResultCache[i].name && m_arrGPUProfileMarkerResultCache[i].rootTiming != 0.f)
+                    if (markerId == m_arrGPUProfileMarkerResultCache[i].markerId && m_arrGPUProfileMarkerResultCache[i].rootTiming != 0.f)
                     {
                         timing = m_arrGPUProfileMarkerResultCache[i].timing;
                         start = m_arrGPUProfileMarkerResultCache[i].start;
@@ -477,8 +472,6 @@ void UIPass::DrawGPUProfileBars(const RenderPass* pass, const unsigned int level
             ImGui::PopStyleColor();
         }
 
-        m_tGPUProfileMarkerResultHistory.PushMarker(GPUProfileMarkerResultCacheEntry(pass->GetPassName(), timing, start, end, rootTiming, rootStart, rootEnd));
-
         for (unsigned int i = 0; i < (unsigned int)pass->GetChildren().size(); i++)
         {
             DrawGPUProfileBars(pass->GetChildren()[i], level + 1);
@@ -495,14 +488,42 @@ void UIPass::DrawGPUProfileDetails(const RenderPass* pass, const unsigned int le
     const ImGuiStyle& style = ImGui::GetStyle();
 
     if (pass == nullptr)
+    {
         pass = &RenderScheme::GetRootPass();
 
+        // Renderer counters of the last frame, for the whole frame
+        const RenderCounters& frameCounters = RenderContext->GetFrameCounters();
+        for (unsigned int i = 0; i < RC_MAX; i++)
+        {
+            const TimingStatistics& counter = m_tFrameStatistics.GetFrameCounter((RenderCounter)i);
+            ImGui::Text("%s: %u (avg %.0f, max %.0f)", Renderer::GetEnumString((RenderCounter)i), frameCounters.nCount[i], counter.GetMean(), counter.GetMax());
+        }
+        ImGui::Separator();
+    }
+
     if (pass)
     {
-        const GPUProfileMarkerResult* const marker = RenderContext->GetProfiler()->RetrieveGPUProfileMarker(pass->GetPassName());
-        const float timing = marker ? marker->GetTiming() : 0.f;
-
-        ImGui::Text("%s: %6.3f ms (avg %6.3f ms)", pass->GetPassName(), timing, m_tGPUProfileMarkerResultHistory.GetAverage(pass->GetPassName()));
+        // Passes pruned by the render graph don't issue queries, so their last results are stale
+        const GPUProfileMarkerSample* const marker = pass->IsActive() ? m_tGPUProfileMarkerSnapshot.Find(pass->GetProfileMarkerId()) : nullptr;
+        const float timing = marker ? marker->fTiming : 0.f;
+
+        const TimingStatistics* const passTime = m_tFrameStatistics.GetPassGPUTime(pass->GetProfileMarkerId());
+        if (passTime)
+            ImGui::Text("%s: %6.3f ms (avg %6.3f ms, p95 %6.3f ms)", pass->GetPassName(), timing, passTime->GetMean(), passTime->GetPercentile(95.f));
+        else
+            ImGui::Text("%s: %6.3f ms", pass->GetPassName(), timing);
+
+        // Renderer counters of the pass' profile marker scope, including its children
+        Profiler* const profiler = RenderContext->GetProfiler();
+        const RenderCounters* const passCounters = pass->IsActive() && profiler ? profiler->RetrieveProfileMarkerCounters(pass->GetProfileMarkerId()) : nullptr;
+        if (passCounters)
+        {
+            ImGui::SameLine();
+            ImGui::TextDisabled("%u draws, %u prims, %u state changes, %u binds, %s constants",
+                (*passCounters)[RC_DRAW_CALLS], (*passCounters)[RC_PRIMITIVES],
+                (*passCounters)[RC_RENDER_STATE_CHANGES] + (*passCounters)[RC_SAMPLER_STATE_CHANGES],
+                (*passCounters)[RC_TEXTURE_BINDS], HumanReadableByteCount((*passCounters)[RC_CONSTANT_BYTES]));
+        }
 
         for (unsigned int i = 0; i < (unsigned int)pass->GetChildren().size(); i++)
         {
@@ -513,6 +534,129 @@ void UIPass::DrawGPUProfileDetails(const RenderPass* pass, const unsigned int le
     }
 }
 
+void UIPass::DrawMemoryUsage()
+{
+    const Synesthesia3D::ResourceManager* const resMan = Renderer::GetInstance()->GetResourceManager();
+    if (!resMan)
+        return;
+
+    resMan->RetrieveMemorySnapshot(m_tMemorySnapshot);
+
+    // Budgets are always checked against the current usage
+    const long long budgetUsage[] = {
+        m_tMemorySnapshot.tType[MRT_VERTEX_BUFFER].nGPUBytes + m_tMemorySnapshot.tType[MRT_INDEX_BUFFER].nGPUBytes,
+        m_tMemorySnapshot.tType[MRT_TEXTURE].nGPUBytes,
+        m_tMemorySnapshot.tType[MRT_RENDER_TARGET].nGPUBytes
+    };
+    const int budget[] = {
+        RenderConfig::Memory::GeometryBudget,
+        RenderConfig::Memory::TextureBudget,
+        RenderConfig::Memory::RenderTargetBudget
+    };
+    const char* const budgetName[] = { "Geometry", "Textures", "Render targets" };
+
+    ImGui::TextDisabled("GPU memory budgets");
+    for (unsigned int i = 0; i < ARRAYSIZE(budget); i++)
+    {
+        const long long budgetBytes = (long long)budget[i] * 1024 * 1024;
+        const float fraction = budgetBytes > 0 ? (float)((double)budgetUsage[i] / (double)budgetBytes) : 1.f;
+        const char* const overlay = Renderer::GetInstance()->GetFrameAllocator()->Format("%s / %s", MemorySizeString(budgetUsage[i]), MemorySizeString(budgetBytes));
+
+        ImGui::PushStyleColor(ImGuiCol_PlotHistogram, fraction > 1.f ? ImVec4(0.9f, 0.2f, 0.2f, 1.f) : ImVec4(0.2f, 0.7f, 0.2f, 1.f));
+        ImGui::ProgressBar(Math::Min(fraction, 1.f), ImVec2(300.f, 0.f), overlay);
+        ImGui::PopStyleColor();
+        ImGui::SameLine();
+        ImGui::Text(budgetName[i]);
+    }
+    ImGui::Separator();
+
+    // Snapshot / diff, for tracking down leaks and the cost of toggling features
+    if (ImGui::Button("Set baseline"))
+    {
+        m_tMemoryBaseline = m_tMemorySnapshot;
+        m_bHasMemoryBaseline = true;
+    }
+    if (m_bHasMemoryBaseline)
+    {
+        ImGui::SameLine();
+        ImGui::Checkbox("Show changes since baseline", &m_bShowMemoryDiff);
+    }
+
+    MemorySnapshot diff;
+    const bool showDiff = m_bHasMemoryBaseline && m_bShowMemoryDiff;
+    if (showDiff)
+        m_tMemorySnapshot.Diff(m_tMemoryBaseline, diff);
+    const MemorySnapshot& snapshot = showDiff ? diff : m_tMemorySnapshot;
+
+    ImGui::Columns(5, "MemoryUsageByType");
+    ImGui::Text("Type"); ImGui::NextColumn();
+    ImGui::Text("Count"); ImGui::NextColumn();
+    ImGui::Text("CPU"); ImGui::NextColumn();
+    ImGui::Text("GPU (est.)"); ImGui::NextColumn();
+    ImGui::Text("Created / released"); ImGui::NextColumn();
+    ImGui::Separator();
+    for (unsigned int type = 0; type < MRT_MAX; type++)
+    {
+        ImGui::Text(Renderer::GetEnumString((MemoryResourceType)type)); ImGui::NextColumn();
+        ImGui::Text("%d", snapshot.tType[type].nCount); ImGui::NextColumn();
+        ImGui::Text(MemorySizeString(snapshot.tType[type].nCPUBytes)); ImGui::NextColumn();
+        ImGui::Text(MemorySizeString(snapshot.tType[type].nGPUBytes)); ImGui::NextColumn();
+        ImGui::Text("%d / %d", snapshot.nCreationCount[type], snapshot.nReleaseCount[type]); ImGui::NextColumn();
+    }
+    ImGui::Separator();
+    ImGui::Text("Total"); ImGui::NextColumn();
+    ImGui::Text("%d", snapshot.tTotal.nCount); ImGui::NextColumn();
+    ImGui::Text(MemorySizeString(snapshot.tTotal.nCPUBytes)); ImGui::NextColumn();
+    ImGui::Text(MemorySizeString(snapshot.tTotal.nGPUBytes)); ImGui::NextColumn();
+    ImGui::NextColumn();
+    ImGui::Columns(1);
+
+    const std::map<string, MemoryUsage>* const breakdown[] = { &snapshot.mapOwner, &snapshot.mapSourceFile };
+    const char* const breakdownName[] = { "By owner", "By source file" };
+    const char* const unattributedName[] = { "(no owner)", "(created at runtime)" };
+    for (unsigned int i = 0; i < ARRAYSIZE(breakdown); i++)
+    {
+        if (!ImGui::CollapsingHeader(breakdownName[i]))
+            continue;
+
+        FrameVector<const std::pair<const string, MemoryUsage>*> sorted(*Renderer::GetInstance()->GetFrameAllocator());
+        sorted.reserve(breakdown[i]->size());
+        for (std::map<string, MemoryUsage>::const_iterator iter = breakdown[i]->begin(); iter != breakdown[i]->end(); iter++)
+            sorted.push_back(&*iter);
+        std::sort(sorted.begin(), sorted.end(), CompareMemoryUsageByGPUBytes);
+
+        ImGui::Columns(4, breakdownName[i]);
+        for (unsigned int j = 0; j < sorted.size(); j++)
+        {
+            ImGui::Text(sorted[j]->first.empty() ? unattributedName[i] : sorted[j]->first.c_str()); ImGui::NextColumn();
+            ImGui::Text("%d", sorted[j]->second.nCount); ImGui::NextColumn();
+            ImGui::Text(MemorySizeString(sorted[j]->second.nCPUBytes)); ImGui::NextColumn();
+            ImGui::Text(MemorySizeString(sorted[j]->second.nGPUBytes)); ImGui::NextColumn();
+        }
+        ImGui::Columns(1);
+    }
+
+    // Heap memory allocated by the engine, as reported by its allocator
+    if (ImGui::CollapsingHeader("By engine subsystem"))
+    {
+        ImGui::Columns(4, "MemoryUsageBySubsystem");
+        ImGui::Text("Subsystem"); ImGui::NextColumn();
+        ImGui::Text("Allocated"); ImGui::NextColumn();
+        ImGui::Text("Peak"); ImGui::NextColumn();
+        ImGui::Text("Allocations / frees"); ImGui::NextColumn();
+        ImGui::Separator();
+        for (unsigned int tag = 0; tag < AT_MAX; tag++)
+        {
+            const AllocationStats stats = Allocator::GetStats((AllocationTag)tag);
+            ImGui::Text(Allocator::GetTagName((AllocationTag)tag)); ImGui::NextColumn();
+            ImGui::Text(MemorySizeString(stats.nAllocatedBytes)); ImGui::NextColumn();
+            ImGui::Text(MemorySizeString(stats.nPeakAllocatedBytes)); ImGui::NextColumn();
+            ImGui::Text("%llu / %llu", stats.nAllocationCount, stats.nFreeCount); ImGui::NextColumn();
+        }
+        ImGui::Columns(1);
+    }
+}
+
 void UIPass::SetupUI()
 {
     Framework* const pFW = Framework::GetInstance();
@@ -561,8 +705,36 @@ void UIPass::SetupUI()
         }
     #endif
 
+        if (ImGui::MenuItem("Export profiler trace", "Debug/Profile only", false, ENABLE_PROFILE_MARKERS))
+        {
+            // Viewable in chrome://tracing or ui.perfetto.dev
+            Profiler* const profiler = Renderer::GetInstance()->GetProfiler();
+            if (profiler)
+                profiler->ExportTrace("GITechDemo_trace.json");
+        }
+
+        if (ImGui::MenuItem("Capture render trace", nullptr, false, !Renderer::GetInstance()->GetRenderTrace()->IsCapturing()))
+        {
+            // Captures the next frame, for replaying with the TraceReplayer tool
+            Renderer::GetInstance()->GetRenderTrace()->RequestCapture("GITechDemo.s3dtrace");
+        }
+
+        if (ImGui::MenuItem("Dump frame statistics"))
+        {
+            m_tFrameStatistics.Dump("GITechDemo_stats.json");
+        }
+
+        if (ImGui::MenuItem("Copy camera keyframe"))
+        {
+            // For recording camera paths in benchmark scripts (see Benchmark)
+            const GITechDemo::Camera& camera = ((GITechDemo*)AppMain)->GetCamera();
+            ImGui::SetClipboardText(Benchmark::FormatCameraKeyframe(0.f, camera.vPos, camera.mRot).c_str());
+        }
+
         ImGui::MenuItem(m_bShowTextureViewer ? "Close texture viewer" : "Open texture viewer", nullptr, &m_bShowTextureViewer);
 
+        ImGui::MenuItem(m_bShowMemoryUsage ? "Hide memory usage" : "Show memory usage", nullptr, &m_bShowMemoryUsage);
+
         if (ImGui::MenuItem("Quit", "Alt+F4"))
         {
             ImGui::OpenPopup("Quit?");
@@ -649,6 +821,17 @@ void UIPass::SetupUI()
     }
     ImGui::PopStyleVar();
 
+    if (m_bShowMemoryUsage)
+    {
+        ImGui::PushStyleVar(ImGuiStyleVar_Alpha, Math::Max(m_fAlpha, ALPHA_MIN));
+        if (ImGui::Begin("Memory usage", &m_bShowMemoryUsage, ImGuiWindowFlags_AlwaysAutoResize))
+        {
+            DrawMemoryUsage();
+        }
+        ImGui::End();
+        ImGui::PopStyleVar();
+    }
+
     if (m_bShowProfiler)
     {
         const float mainMenuBarHeight = ImGui::GetFontSize() + style.FramePadding.y;
@@ -695,10 +878,14 @@ void UIPass::SetupUI()
 
             const Synesthesia3D::ResourceManager* const resMan = Renderer::GetInstance()->GetResourceManager();
 
-            string texDesc;
-            vector<s3dSampler> texList;
+            FrameAllocator* const frameAllocator = Renderer::GetInstance()->GetFrameAllocator();
+            FrameString texDesc(*frameAllocator);
+            FrameVector<s3dSampler> texList(*frameAllocator);
             for (unsigned int i = 0; i < RenderResource::GetResourceList().size(); i++)
             {
+                if (!RenderResource::GetResourceList()[i])
+                    continue;
+
                 if (RenderResource::GetResourceList()[i]->GetResourceType() == RenderResource::RES_RENDERTARGET)
                 {
                     const unsigned int targetCount = ((RenderTarget*)(RenderResource::GetResourceList()[i]))->GetRenderTarget()->GetTargetCount();
@@ -810,7 +997,7 @@ void UIPass::SetupUI()
                     ImGui::Text("Height: %u", tex->GetHeight());
                     ImGui::Text("Depth: %u", tex->GetDepth());
                     ImGui::Text("MIP count: %u", tex->GetMipCount());
-                    ImGui::Text("Total size: %s", HumanReadableByteCount(tex->GetSize()).c_str());
+                    ImGui::Text("Total size: %s", HumanReadableByteCount(tex->GetSize()));
 
                     if (tex->GetTextureType() == TT_CUBE)
                     {
@@ -824,7 +1011,7 @@ void UIPass::SetupUI()
                         ImGui::PopItemWidth();
                         ImGui::NewLine();
 
-                        ImGui::Text("Face size (incl. MIPs): %s", HumanReadableByteCount(tex->GetCubeFaceOffset()).c_str());
+                        ImGui::Text("Face size (incl. MIPs): %s", HumanReadableByteCount(tex->GetCubeFaceOffset()));
                     }
 
                     if (tex->GetTextureType() == TT_3D)
@@ -855,7 +1042,7 @@ void UIPass::SetupUI()
                         ImGui::Text("MIP width: %u", tex->GetWidth(m_nSelectedMip));
                         ImGui::Text("MIP height: %u", tex->GetHeight(m_nSelectedMip));
                         ImGui::Text("MIP depth: %u", tex->GetDepth(m_nSelectedMip));
-                        ImGui::Text("MIP size: %s", HumanReadableByteCount(tex->GetMipSizeBytes(m_nSelectedMip)).c_str());
+                        ImGui::Text("MIP size: %s", HumanReadableByteCount(tex->GetMipSizeBytes(m_nSelectedMip)));
                     }
 
                     ImGui::NewLine();
@@ -901,62 +1088,35 @@ void UIPass::SetupUI()
 
 void UIPass::GenerateDrawData()
 {
+    // The previous frame's draw data is about to be invalidated (see Renderer::GetFrameAllocator())
+    m_tDrawData.CmdListCount = 0;
+
     Renderer* RenderContext = Renderer::GetInstance();
     if (!RenderContext)
         return;
 
-    ResourceManager* ResMgr = RenderContext->GetResourceManager();
-    if (!ResMgr)
-        return;
-
     ImDrawData* drawData = ImGui::GetDrawData();
     if (!drawData)
         return;
 
-    m_nCurrBufferIdx = (m_nCurrBufferIdx + 1) % UI_BUFFER_COUNT;
-
     const bool isUIInFocus = ((GITechDemo*)AppMain)->IsUIInFocus();
 
-    const bool needsIbReallocation = !m_pImGuiIb[m_nCurrBufferIdx] || m_pImGuiIb[m_nCurrBufferIdx]->GetElementCount() < (unsigned int)drawData->TotalIdxCount;
-    if (needsIbReallocation)
-    {
-        if (m_nImGuiIbIdx[m_nCurrBufferIdx] != ~0u)
-        {
-            ResMgr->ReleaseIndexBuffer(m_nImGuiIbIdx[m_nCurrBufferIdx]);
-        }
-
-        m_nImGuiIbIdx[m_nCurrBufferIdx] = ResMgr->CreateIndexBuffer(Math::Max(drawData->TotalIdxCount, 1), sizeof(ImDrawIdx) == 2 ? IBF_INDEX16 : IBF_INDEX32);
-        m_pImGuiIb[m_nCurrBufferIdx] = ResMgr->GetIndexBuffer(m_nImGuiIbIdx[m_nCurrBufferIdx]);
-        assert(sizeof(ImDrawIdx) == m_pImGuiIb[m_nCurrBufferIdx]->GetElementSize());
-        assert(m_pImGuiIb[m_nCurrBufferIdx]->GetElementCount() <= Math::pow(2.f, sizeof(ImDrawIdx) * 8.f));
-
-        //cout << "UI index buffer reallocation: " << m_pImGuiIb[m_nCurrBufferIdx]->GetElementCount() << " indices." << endl;
-    }
-
-    const bool needsVbReallocation = !m_pImGuiVb[m_nCurrBufferIdx] || m_pImGuiVb[m_nCurrBufferIdx]->GetElementCount() < (unsigned int)drawData->TotalVtxCount;
-    if (needsIbReallocation || needsVbReallocation)
-    {
-        const unsigned int prevMaxVtxCount = m_pImGuiVb[m_nCurrBufferIdx] ? m_pImGuiVb[m_nCurrBufferIdx]->GetElementCount() : 1;
-        if (m_nImGuiVbIdx[m_nCurrBufferIdx] != ~0u)
-        {
-            ResMgr->ReleaseVertexBuffer(m_nImGuiVbIdx[m_nCurrBufferIdx]);
-        }
-
-        m_nImGuiVbIdx[m_nCurrBufferIdx] = ResMgr->CreateVertexBuffer(m_pImGuiVf[m_nCurrBufferIdx], Math::Max(prevMaxVtxCount, (unsigned int)drawData->TotalVtxCount), m_pImGuiIb[m_nCurrBufferIdx]);
-        m_pImGuiVb[m_nCurrBufferIdx] = ResMgr->GetVertexBuffer(m_nImGuiVbIdx[m_nCurrBufferIdx]);
+    // Stream this frame's geometry into the next ranges of the ring buffers
+    if (!m_pImGuiGeometry || drawData->TotalVtxCount == 0)
+        return;
 
-        //cout << "UI vertex buffer reallocation: " << m_pImGuiVb[m_nCurrBufferIdx]->GetElementCount() << " vertices." << endl;
-    }
+    m_pImGuiGeometry->Lock(drawData->TotalVtxCount, drawData->TotalIdxCount, m_nImGuiVtxOffset, m_nImGuiIdxOffset);
 
-    m_pImGuiIb[m_nCurrBufferIdx]->Lock(BL_WRITE_ONLY);
-    m_pImGuiVb[m_nCurrBufferIdx]->Lock(BL_WRITE_ONLY);
+    VertexBuffer* const vb = m_pImGuiGeometry->GetVertexBuffer();
+    IndexBuffer* const ib = m_pImGuiGeometry->GetIndexBuffer();
+    assert(sizeof(ImDrawIdx) == ib->GetElementSize());
 
-    for (int n = 0, vtxOffset = 0, idxOffset = 0; n < drawData->CmdListsCount; n++)
+    for (int n = 0, vtxOffset = m_nImGuiVtxOffset, idxOffset = m_nImGuiIdxOffset; n < drawData->CmdListsCount; n++)
     {
         const ImDrawList* const cmdList = drawData->CmdLists[n];
         const ImDrawVert* vtxSrc = cmdList->VtxBuffer.Data;
 
-        m_pImGuiIb[m_nCurrBufferIdx]->SetIndices(cmdList->IdxBuffer.Data, cmdList->IdxBuffer.Size, idxOffset);
+        ib->SetIndices(cmdList->IdxBuffer.Data, cmdList->IdxBuffer.Size, idxOffset);
         idxOffset += cmdList->IdxBuffer.Size;
 
         for (int i = 0; i < cmdList->VtxBuffer.Size; i++)
@@ -966,28 +1126,27 @@ void UIPass::GenerateDrawData()
             const s3dByte B = ((vtxSrc->col & 0x00FF0000) >> 16);
             const s3dByte A = ((vtxSrc->col & 0xFF000000) >> 24);// / (isUIInFocus ? 1 : 2);
 
-            m_pImGuiVb[m_nCurrBufferIdx]->Position<Vec2f>(vtxOffset + i) = Vec2f(vtxSrc->pos.x, vtxSrc->pos.y);
-            m_pImGuiVb[m_nCurrBufferIdx]->Color<s3dDword>(vtxOffset + i, 0) = (A << 24) | (R << 16) | (G << 8) | (B << 0); // RGBA --> ARGB for DirectX9
-            m_pImGuiVb[m_nCurrBufferIdx]->TexCoord<Vec2f>(vtxOffset + i, 0) = Vec2f(vtxSrc->uv.x, vtxSrc->uv.y);
+            vb->Position<Vec2f>(vtxOffset + i) = Vec2f(vtxSrc->pos.x, vtxSrc->pos.y);
+            vb->Color<s3dDword>(vtxOffset + i, 0) = (A << 24) | (R << 16) | (G << 8) | (B << 0); // RGBA --> ARGB for DirectX9
+            vb->TexCoord<Vec2f>(vtxOffset + i, 0) = Vec2f(vtxSrc->uv.x, vtxSrc->uv.y);
 
             vtxSrc++;
         }
         vtxOffset += cmdList->VtxBuffer.Size;
     }
 
-    m_pImGuiIb[m_nCurrBufferIdx]->Update();
-    m_pImGuiVb[m_nCurrBufferIdx]->Update();
+    m_pImGuiGeometry->Unlock();
 
-    m_pImGuiIb[m_nCurrBufferIdx]->Unlock();
-    m_pImGuiVb[m_nCurrBufferIdx]->Unlock();
-
-    // Update draw data cache
-    m_tDrawData[m_nCurrBufferIdx].CmdList.resize(drawData->CmdListsCount);
-    for (unsigned int n = 0; n < m_tDrawData[m_nCurrBufferIdx].CmdList.size(); n++)
+    // Update draw data
+    FrameAllocator* const frameAllocator = RenderContext->GetFrameAllocator();
+    m_tDrawData.CmdList = frameAllocator->NewArray<UIDrawData::UIDrawCommandList>(drawData->CmdListsCount);
+    m_tDrawData.CmdListCount = drawData->CmdListsCount;
+    for (unsigned int n = 0; n < m_tDrawData.CmdListCount; n++)
     {
-        UIDrawData::UIDrawCommandList& cmdList = m_tDrawData[m_nCurrBufferIdx].CmdList[n];
-        cmdList.DrawCmd.resize(drawData->CmdLists[n]->CmdBuffer.Size);
-        for (unsigned int i = 0; i < cmdList.DrawCmd.size(); i++)
+        UIDrawData::UIDrawCommandList& cmdList = m_tDrawData.CmdList[n];
+        cmdList.DrawCmd = frameAllocator->NewArray<UIDrawData::UIDrawCommandList::UIDrawCommand>(drawData->CmdLists[n]->CmdBuffer.Size);
+        cmdList.DrawCmdCount = drawData->CmdLists[n]->CmdBuffer.Size;
+        for (unsigned int i = 0; i < cmdList.DrawCmdCount; i++)
         {
             UIDrawData::UIDrawCommandList::UIDrawCommand& cmd = cmdList.DrawCmd[i];
             const ImVec4 clipRect = drawData->CmdLists[n]->CmdBuffer[i].ClipRect;
@@ -1009,7 +1168,7 @@ void UIPass::RenderUI()
     if (!RSMgr)
         return;
 
-    if (!m_pImGuiVb[m_nCurrBufferIdx])
+    if (!m_pImGuiGeometry || m_tDrawData.CmdListCount == 0)
         return;
 
     // Setup render states
@@ -1035,10 +1194,10 @@ void UIPass::RenderUI()
 
     // Render geometry
     UIShader.Enable();
-    for (unsigned int n = 0, vtxOffset = 0, idxOffset = 0; n < m_tDrawData[m_nCurrBufferIdx].CmdList.size(); n++)
+    for (unsigned int n = 0, vtxOffset = m_nImGuiVtxOffset, idxOffset = m_nImGuiIdxOffset; n < m_tDrawData.CmdListCount; n++)
     {
-        const UIDrawData::UIDrawCommandList& cmdList = m_tDrawData[m_nCurrBufferIdx].CmdList[n];
-        for (unsigned int i = 0; i < cmdList.DrawCmd.size(); i++)
+        const UIDrawData::UIDrawCommandList& cmdList = m_tDrawData.CmdList[n];
+        for (unsigned int i = 0; i < cmdList.DrawCmdCount; i++)
         {
             const UIDrawData::UIDrawCommandList::UIDrawCommand& cmd = cmdList.DrawCmd[i];
             RSMgr->SetScissor(Vec2i(int(cmd.ClipRect[2] - cmd.ClipRect[0]), int(cmd.ClipRect[3] - cmd.ClipRect[1])), Vec2i(int(cmd.ClipRect[0]), int(cmd.ClipRect[1])));
@@ -1078,7 +1237,7 @@ void UIPass::RenderUI()
             if (invalidateShaderConstants)
                 UIShader.CommitShaderInputs();
 
-            RenderContext->DrawVertexBuffer(m_pImGuiVb[m_nCurrBufferIdx], vtxOffset, cmd.ElemCount / 3, cmdList.VtxBufferSize, idxOffset);
+            RenderContext->DrawVertexBuffer(m_pImGuiGeometry->GetVertexBuffer(), vtxOffset, cmd.ElemCount / 3, cmdList.VtxBufferSize, idxOffset);
 
             idxOffset += cmd.ElemCount;
         }
@@ -1175,16 +1334,15 @@ void UIPass::AllocateResources()
         io.Fonts->TexID = m_pFontTexture;
     }
 
-    for (unsigned int i = 0; i < UI_BUFFER_COUNT; i++)
-    {
-        m_nImGuiVfIdx[i] = ResMgr->CreateVertexFormat(
-            3,
-            VAS_POSITION, VAT_FLOAT2, 0,
-            VAS_COLOR, VAT_UBYTE4, 0,
-            VAS_TEXCOORD, VAT_FLOAT2, 0
-        );
-        m_pImGuiVf[i] = ResMgr->GetVertexFormat(m_nImGuiVfIdx[i]);
-    }
+    m_nImGuiVfIdx = ResMgr->GetOrCreateVertexFormat(
+        3,
+        VAS_POSITION, VAT_FLOAT2, 0,
+        VAS_COLOR, VAT_UBYTE4, 0,
+        VAS_TEXCOORD, VAT_FLOAT2, 0
+    );
+    m_pImGuiVf = ResMgr->GetVertexFormat(m_nImGuiVfIdx);
+
+    m_pImGuiGeometry = new GeometryRingBuffer(m_pImGuiVf, UI_INITIAL_VERTEX_COUNT, UI_INITIAL_INDEX_COUNT, sizeof(ImDrawIdx) == 2 ? IBF_INDEX16 : IBF_INDEX32);
 
     for (unsigned int paramIdx = 0; paramIdx < ArtistParameter::GetParameterCount(); paramIdx++)
     {
@@ -1252,29 +1410,18 @@ void UIPass::ReleaseResources()
         io.Fonts->TexID = nullptr;
     }
 
-    for (unsigned int i = 0; i < UI_BUFFER_COUNT; i++)
+    if (m_pImGuiGeometry)
     {
-        if (m_nImGuiVfIdx[i] != ~0u)
-        {
-            ResMgr->ReleaseVertexFormat(m_nImGuiVfIdx[i]);
-            m_nImGuiVfIdx[i] = ~0u;
-            m_pImGuiVf[i] = nullptr;
-        }
-
-        if (m_nImGuiIbIdx[i] != ~0u)
-        {
-            ResMgr->ReleaseIndexBuffer(m_nImGuiIbIdx[i]);
-            m_nImGuiIbIdx[i] = ~0u;
-            m_pImGuiIb[i] = nullptr;
-
-        }
+        delete m_pImGuiGeometry;
+        m_pImGuiGeometry = nullptr;
+        m_tDrawData.CmdListCount = 0;
+    }
 
-        if (m_nImGuiVbIdx[i] != ~0u)
-        {
-            ResMgr->ReleaseVertexBuffer(m_nImGuiVbIdx[i]);
-            m_nImGuiVbIdx[i] = ~0u;
-            m_pImGuiVb[i] = nullptr;
-        }
+    if (m_nImGuiVfIdx != ~0u)
+    {
+        ResMgr->ReleaseVertexFormat(m_nImGuiVfIdx);
+        m_nImGuiVfIdx = ~0u;
+        m_pImGuiVf = nullptr;
     }
 
     if (m_nDummyTex1DIdx != ~0u)
@@ -1301,45 +1448,3 @@ void UIPass::ReleaseResources()
         m_pDummyTexCube = nullptr;
     }
 }
-
-void GPUProfileMarkerResultHistory::Update(const float fDeltaTime)
-{
-    m_fTimeAccum += fDeltaTime;
-
-    if (m_fTimeAccum >= MARKER_RESULT_HISTORY)
-    {
-        m_fTimeAccum = 0.f;
-        m_nCurrBufferIdx = (m_nCurrBufferIdx + 1) % 2;
-        m_arrGPUProfileMarkerResultHistory[m_nCurrBufferIdx].clear();
-    }
-}
-
-const float GPUProfileMarkerResultHistory::GetAverage(const char* const name) const
-{
-    const int historyBufferIdx = (m_nCurrBufferIdx + 1) % 2;
-    float totalTime = 0.f;
-    int markerCount = 0;
-
-    for (unsigned int i = 0; i < m_arrGPUProfileMarkerResultHistory[historyBufferIdx].size(); i++)
-    {
-        if (m_arrGPUProfileMarkerResultHistory[historyBufferIdx][i].name == name)
-        {
-            totalTime += m_arrGPUProfileMarkerResultHistory[historyBufferIdx][i].timing;
-            markerCount++;
-        }
-    }
-
-    if (markerCount)
-    {
-        return totalTime / (float)markerCount;
-    }
-    else
-    {
-        return 0.f;
-    }
-}
-
-void GPUProfileMarkerResultHistory::PushMarker(const GPUProfileMarkerResultCacheEntry& marker)
-{
-    m_arrGPUProfileMarkerResultHistory[m_nCurrBufferIdx].push_back(marker);
-}
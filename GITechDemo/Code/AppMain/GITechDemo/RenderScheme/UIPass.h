@@ -25,7 +25,10 @@
 #include <vector>
 #include <string>
 
+#include <Profiler.h>
+
 #include "RenderPass.h"
+#include "FrameStatistics.h"
 
 namespace gainput
 {
@@ -38,16 +41,17 @@ namespace Synesthesia3D
 {
     class Texture;
     class VertexFormat;
-    class IndexBuffer;
-    class VertexBuffer;
+    class GeometryRingBuffer;
 }
 
 namespace GITechDemoApp
 {
-    #define UI_BUFFER_COUNT (3)
+    #define UI_INITIAL_VERTEX_COUNT (16 * 1024)
+    #define UI_INITIAL_INDEX_COUNT (48 * 1024)
 
     class ArtistParameter;
 
+    // Generated every frame, in memory from the renderer's frame allocator
     struct UIDrawData
     {
         struct UIDrawCommandList
@@ -60,66 +64,42 @@ namespace GITechDemoApp
             };
 
             int VtxBufferSize;
-            std::vector<UIDrawCommand> DrawCmd;
+            UIDrawCommand* DrawCmd;
+            unsigned int DrawCmdCount;
         };
 
-        std::vector<UIDrawCommandList> CmdList;
+        UIDrawCommandList* CmdList;
+        unsigned int CmdListCount;
     };
 
     struct GPUProfileMarkerResultCacheEntry
     {
         GPUProfileMarkerResultCacheEntry(
-            std::string _name, float _timing, float _start, float _end,
+            unsigned int _markerId, float _timing, float _start, float _end,
             float _rootTiming, float _rootStart, float _rootEnd)
-            : name(_name), timing(_timing), start(_start), end(_end)
+            : markerId(_markerId), timing(_timing), start(_start), end(_end)
             , rootTiming(_rootTiming), rootStart(_rootStart), rootEnd(_rootEnd)
         {}
 
-        std::string name;
+        unsigned int markerId;
         float timing, start, end;
         float rootTiming, rootStart, rootEnd;
     };
 
-    struct GPUFrametimeHistoryEntry
-    {
-        GPUFrametimeHistoryEntry(float _timing, float _start)
-            : timing(_timing)
-            , start(_start)
-        {}
-        float timing, start;
-    };
-
     struct ParamCategoryWindowState
     {
         std::string categoryName;
         bool windowOpen;
     };
 
-    class GPUProfileMarkerResultHistory
-    {
-    public:
-        GPUProfileMarkerResultHistory()
-            : m_nCurrBufferIdx(0u)
-            , m_fTimeAccum(0.f)
-        {}
-
-        void Update(const float fDeltaTime);
-        const float GetAverage(const char* const name) const;
-        void PushMarker(const GPUProfileMarkerResultCacheEntry& marker);
-
-    private:
-        std::vector<GPUProfileMarkerResultCacheEntry> m_arrGPUProfileMarkerResultHistory[2];
-        unsigned int m_nCurrBufferIdx;
-        float m_fTimeAccum;
-    };
-
     class UIPass : public RenderPass
     {
         IMPLEMENT_RENDER_PASS(UIPass)
 
     public:
         void SetupInput(gainput::InputManager* pInputManager);
-        void ResetFrametimeGraph() { m_arrGPUFrametimeHistory.clear(); }
+        void ResetFrameStatistics() { m_tFrameStatistics.Reset(); }
+        const FrameStatistics& GetFrameStatistics() const { return m_tFrameStatistics; }
 
     private:
         void SetupUI();
@@ -130,28 +110,35 @@ namespace GITechDemoApp
         void DrawGPUFrametimeGraph();
         void DrawGPUProfileBars(const RenderPass* pass = nullptr, const unsigned int level = 0);
         void DrawGPUProfileDetails(const RenderPass* pass = nullptr, const unsigned int level = 0) const;
-        void CleanGPUProfileMarkerResultCache(const char* const passName);
+        void CleanGPUProfileMarkerResultCache(const unsigned int markerId);
+        void DrawMemoryUsage();
 
         // UI states/parameters
         bool m_bShowAllParameters;
         bool m_bShowProfiler;
         bool m_bShowTextureViewer;
+        bool m_bShowMemoryUsage;
         float m_fAlpha;
         std::vector<ParamCategoryWindowState> m_arrParamCategoryWindowStates;
         std::vector<GPUProfileMarkerResultCacheEntry> m_arrGPUProfileMarkerResultCache;
-        std::vector<GPUFrametimeHistoryEntry> m_arrGPUFrametimeHistory;
+        Synesthesia3D::GPUProfileMarkerSnapshot m_tGPUProfileMarkerSnapshot;
+        FrameStatistics m_tFrameStatistics;
+
+        // Memory usage window data
+        Synesthesia3D::MemorySnapshot m_tMemorySnapshot;
+        Synesthesia3D::MemorySnapshot m_tMemoryBaseline;
+        bool m_bHasMemoryBaseline;
+        bool m_bShowMemoryDiff;
 
         // Geometry resource data
-        unsigned int m_nCurrBufferIdx;
-        unsigned int m_nImGuiVfIdx[UI_BUFFER_COUNT];
-        Synesthesia3D::VertexFormat* m_pImGuiVf[UI_BUFFER_COUNT];
-        unsigned int m_nImGuiIbIdx[UI_BUFFER_COUNT];
-        Synesthesia3D::IndexBuffer* m_pImGuiIb[UI_BUFFER_COUNT];
-        unsigned int m_nImGuiVbIdx[UI_BUFFER_COUNT];
-        Synesthesia3D::VertexBuffer* m_pImGuiVb[UI_BUFFER_COUNT];
+        unsigned int m_nImGuiVfIdx;
+        Synesthesia3D::VertexFormat* m_pImGuiVf;
+        Synesthesia3D::GeometryRingBuffer* m_pImGuiGeometry;
+        unsigned int m_nImGuiVtxOffset; // Ranges of the ring buffers holding this frame's geometry
+        unsigned int m_nImGuiIdxOffset;
 
         // Draw data
-        UIDrawData m_tDrawData[UI_BUFFER_COUNT];
+        UIDrawData m_tDrawData;
 
         // Font texture data
         Synesthesia3D::Texture* m_pFontTexture;
@@ -177,8 +164,6 @@ namespace GITechDemoApp
         // Input devices
         gainput::InputDeviceKeyboard* m_pKeyboardDevice;
         gainput::InputDeviceMouse* m_pMouseDevice;
-
-        GPUProfileMarkerResultHistory m_tGPUProfileMarkerResultHistory;
     };
 }
 
@@ -45,6 +45,8 @@ using namespace Synesthesia3D;
 #define DROPDOWN_TYPE_HASH S3DHASH("DROPDOWN")
 
 vector<RenderResource*> RenderResource::arrResources; // Moved from RenderResource.cpp
+unordered_multimap<unsigned int, ShaderConstant*> ShaderConstant::mapShaderConstant; // Must be constructed before any shader constant, same as arrResources
+GITechDemoApp::Texture::Registry GITechDemoApp::Texture::tRegistry; // Must outlive the models and PBR materials, which release their textures on destruction
 vector<ArtistParameter*> ArtistParameter::ms_arrParams; // Moved from ArtistParameter.cpp
 const unsigned long long ArtistParameter::ms_TypeHash[ArtistParameter::ArtistParameterDataType::APDT_MAX] =
 {
@@ -290,6 +292,15 @@ namespace GITechDemoApp
     int RenderConfig::PostProcessing::ASCIIEffect::ResolutionDescaler;
     float RenderConfig::PostProcessing::ASCIIEffect::Gamma;
     bool RenderConfig::PostProcessing::ASCIIEffect::UseColor;
+
+    int RenderConfig::Memory::GeometryBudget;
+    int RenderConfig::Memory::TextureBudget;
+    int RenderConfig::Memory::RenderTargetBudget;
+
+    bool RenderConfig::TextureStreaming::Enabled;
+    int RenderConfig::TextureStreaming::Budget;
+    int RenderConfig::TextureStreaming::TailSize;
+    float RenderConfig::TextureStreaming::DemandScale;
     //------------------------------------------------------
 
 
@@ -1789,4 +1800,65 @@ namespace GITechDemoApp
         RenderConfig::PostProcessing::ASCIIEffect::UseColor,
         true);
     //------------------------------------------------------
+
+
+    // Memory budgets --------------------------------------
+    CREATE_ARTIST_PARAMETER_OBJECT(
+        "Geometry memory budget",
+        "GPU memory budget for vertex and index buffers, in MB",
+        "Memory budgets",
+        RenderConfig::Memory::GeometryBudget,
+        8,
+        64);
+
+    CREATE_ARTIST_PARAMETER_OBJECT(
+        "Texture memory budget",
+        "GPU memory budget for textures, excluding render targets, in MB",
+        "Memory budgets",
+        RenderConfig::Memory::TextureBudget,
+        16,
+        512);
+
+    CREATE_ARTIST_PARAMETER_OBJECT(
+        "Render target memory budget",
+        "GPU memory budget for render targets, in MB",
+        "Memory budgets",
+        RenderConfig::Memory::RenderTargetBudget,
+        16,
+        256);
+    //------------------------------------------------------
+
+
+    // Texture streaming -----------------------------------
+    CREATE_ARTIST_BOOLPARAM_OBJECT(
+        "Texture streaming",
+        "Stream the top mips of model textures on demand (when disabled, all mips are loaded)",
+        "Texture streaming",
+        RenderConfig::TextureStreaming::Enabled,
+        true);
+
+    CREATE_ARTIST_PARAMETER_OBJECT(
+        "Streaming budget",
+        "GPU memory budget for streamed textures, in MB",
+        "Texture streaming",
+        RenderConfig::TextureStreaming::Budget,
+        16,
+        256);
+
+    CREATE_ARTIST_PARAMETER_OBJECT(
+        "Mip tail size",
+        "Size of the largest mip loaded up front for streamed textures (applied when loading)",
+        "Texture streaming",
+        RenderConfig::TextureStreaming::TailSize,
+        16,
+        64);
+
+    CREATE_ARTIST_PARAMETER_OBJECT(
+        "Demand scale",
+        "Texels required for each pixel covered by a mesh, accounting for texture tiling",
+        "Texture streaming",
+        RenderConfig::TextureStreaming::DemandScale,
+        0.25f,
+        4.f);
+    //------------------------------------------------------
 }
@@ -427,6 +427,23 @@ namespace GITechDemoApp
                 static bool UseColor;
             };
         };
+
+        // Budgets of estimated GPU memory, in MB (see the memory usage window)
+        struct Memory
+        {
+            static int GeometryBudget;
+            static int TextureBudget;
+            static int RenderTargetBudget;
+        };
+
+        // Model textures start with only their mip tail resident (see TextureStreamer)
+        struct TextureStreaming
+        {
+            static bool Enabled;
+            static int Budget;
+            static int TailSize;
+            static float DemandScale;
+        };
     };
     //------------------------------------------------------
 }
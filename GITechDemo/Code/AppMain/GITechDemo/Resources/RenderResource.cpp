@@ -21,6 +21,8 @@
 
 #include "stdafx.h"
 
+#include <algorithm>
+
 #include <Renderer.h>
 #include <ShaderProgram.h>
 #include <ShaderInput.h>
@@ -28,6 +30,7 @@
 #include <ResourceManager.h>
 #include <Texture.h>
 #include <Profiler.h>
+#include <AssetPack.h>
 using namespace Synesthesia3D;
 
 #include <Utility/Hash.h>
@@ -60,8 +63,11 @@ namespace GITechDemoApp
     RenderResource::RenderResource(const char* filePath, ResourceType resType)
         : nId((unsigned int)arrResources.size())
         , szDesc(filePath)
+        , nDescHash(S3DHASH(filePath))
         , eResType(resType)
         , bInitialized(false)
+        , nCreationTime(Profiler::GetCPUTimestamp())
+        , tCreationThreadId(std::this_thread::get_id())
     {
         MUTEX_INIT(mResMutex);
         MUTEX_INIT(mInitMutex);
@@ -124,42 +130,44 @@ namespace GITechDemoApp
     void RenderResource::InitAllModels()
     {
         for (unsigned int i = 0; i < arrResources.size(); i++)
-            if (arrResources[i]->eResType == RES_MODEL)
+            if (arrResources[i] && arrResources[i]->eResType == RES_MODEL)
                 arrResources[i]->Init();
     }
 
     void RenderResource::InitAllTextures()
     {
         for (unsigned int i = 0; i < arrResources.size(); i++)
-            if (arrResources[i]->eResType == RES_TEXTURE)
+            if (arrResources[i] && arrResources[i]->eResType == RES_TEXTURE)
                 arrResources[i]->Init();
     }
 
     void RenderResource::InitAllShaders()
     {
         for (unsigned int i = 0; i < arrResources.size(); i++)
-            if (arrResources[i]->eResType == RES_SHADER)
+            if (arrResources[i] && arrResources[i]->eResType == RES_SHADER)
                 arrResources[i]->Init();
     }
 
     void RenderResource::InitAllRenderTargets()
     {
         for (unsigned int i = 0; i < arrResources.size(); i++)
-            if (arrResources[i]->eResType == RES_RENDERTARGET)
+            if (arrResources[i] && arrResources[i]->eResType == RES_RENDERTARGET)
                 arrResources[i]->Init();
     }
 
     void RenderResource::InitAllPBRMaterials()
     {
         for (unsigned int i = 0; i < arrResources.size(); i++)
-            if (arrResources[i]->eResType == RES_PBR_MATERIAL)
+            if (arrResources[i] && arrResources[i]->eResType == RES_PBR_MATERIAL)
                 arrResources[i]->Init();
     }
 
     void RenderResource::FreeAll()
     {
+        // Freeing the last user of a shared texture clears
+        // the texture's slot in the list (see Texture::Release())
         for (unsigned int i = 0; i < arrResources.size(); i++)
-            if (arrResources[i]->eResType != RES_SHADER_CONSTANT)
+            if (arrResources[i] && arrResources[i]->eResType != RES_SHADER_CONSTANT)
                 arrResources[i]->Free();
     }
 
@@ -169,7 +177,7 @@ namespace GITechDemoApp
 
         for (unsigned int i = 0; i < arrResources.size(); i++)
         {
-            if (arrResources[i]->eResType == type)
+            if (arrResources[i] && arrResources[i]->eResType == type)
             {
                 count++;
             }
@@ -188,6 +196,7 @@ namespace GITechDemoApp
         , nPixelShaderProgIdx(~0u)
         , nVertexShaderInputIdx(~0u)
         , nPixelShaderInputIdx(~0u)
+        , szCommitProfileMarker(szDesc + " - CommitShaderInputs()")
     {}
 
     const bool Shader::Init()
@@ -229,26 +238,27 @@ namespace GITechDemoApp
                 for (unsigned int i = 0; i < shdInput->GetInputCount(); i++)
                 {
                     const ShaderInputDesc& desc = shdInput->GetInputDesc(i);
+                    const auto range = ShaderConstant::GetShaderConstantMap().equal_range(desc.nNameHash);
 
-                    for (unsigned int j = 0; j < arrResources.size(); j++)
+                    for (auto it = range.first; it != range.second; it++)
                     {
-                        if (arrResources[j]->GetResourceType() == RES_SHADER_CONSTANT)
-                        {
-                            const char* const constName = arrResources[j]->GetDesc();
-                            if (desc.nNameHash == S3DHASH(constName))
-                            {
-                                ShaderConstantInstance constInst;
-                                constInst.pShaderConstantTemplate = arrResources[j];
-                                constInst.nShaderConstantHandle = i;
-                                constInst.eShaderType = (ShaderProgramType)spt;
-                                constInst.eConstantType = desc.eInputType;
-                                constInst.nNumRows = desc.nRows;
-                                constInst.nNumColumns = desc.nColumns;
-                                constInst.nNumArrayElem = desc.nArrayElements;
-
-                                arrConstantList.push_back(constInst);
-                            }
-                        }
+                        ShaderConstant* const shdConst = it->second;
+
+                        // Guard against name hash collisions
+                        if (desc.szName.compare(shdConst->GetDesc()) != 0)
+                            continue;
+
+                        ShaderConstantInstance constInst;
+                        constInst.pShaderConstantTemplate = shdConst;
+                        constInst.nShaderConstantVersion = 0;
+                        constInst.nShaderConstantHandle = i;
+                        constInst.eShaderType = (ShaderProgramType)spt;
+                        constInst.eConstantType = desc.eInputType;
+                        constInst.nNumRows = desc.nRows;
+                        constInst.nNumColumns = desc.nColumns;
+                        constInst.nNumArrayElem = desc.nArrayElements;
+
+                        arrConstantList.push_back(constInst);
                     }
                 }
             }
@@ -362,7 +372,7 @@ namespace GITechDemoApp
 
     void Shader::Enable()
     {
-        PUSH_PROFILE_MARKER(szDesc.c_str());
+        PUSH_DRAW_PROFILE_MARKER(szDesc.c_str());
 
         CommitShaderInputsInternal();
 
@@ -379,10 +389,16 @@ namespace GITechDemoApp
 
     void Shader::CommitShaderInputsInternal()
     {
-        PUSH_PROFILE_MARKER((szDesc + " - CommitShaderInputs()").c_str());
+        PUSH_DETAIL_PROFILE_MARKER(szCommitProfileMarker.c_str());
 
         for (unsigned int i = 0; i < arrConstantList.size(); i++)
         {
+            // Skip constants which haven't been modified since they were last copied to the shader input
+            const unsigned int version = arrConstantList[i].pShaderConstantTemplate->GetVersion();
+            if (arrConstantList[i].nShaderConstantVersion == version)
+                continue;
+            arrConstantList[i].nShaderConstantVersion = version;
+
             ShaderInput* shdInput = nullptr;
 
             switch (arrConstantList[i].eShaderType)
@@ -401,7 +417,7 @@ namespace GITechDemoApp
             {
             case IT_STRUCT:
             {
-                const void* const structAddr = &((ShaderConstantTemplate<void*>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue();
+                const void* const structAddr = &((const ShaderConstantTemplate<void*>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue();
                 shdInput->SetStructArray(arrConstantList[i].nShaderConstantHandle, structAddr);
                 break;
             }
@@ -412,28 +428,28 @@ namespace GITechDemoApp
                     case 1:
                         shdInput->SetBoolArray(
                             arrConstantList[i].nShaderConstantHandle,
-                            ((ShaderConstantTemplate<bool*>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
+                            ((const ShaderConstantTemplate<bool*>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
                         break;
                     case 2:
                         SetMatrixHelper<bool, 2>(
                             shdInput,
                             arrConstantList[i].nShaderConstantHandle,
                             arrConstantList[i].nNumColumns,
-                            ((ShaderConstantTemplate<bool*>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
+                            ((const ShaderConstantTemplate<bool*>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
                         break;
                     case 3:
                         SetMatrixHelper<bool, 3>(
                             shdInput,
                             arrConstantList[i].nShaderConstantHandle,
                             arrConstantList[i].nNumColumns,
-                            ((ShaderConstantTemplate<bool*>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
+                            ((const ShaderConstantTemplate<bool*>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
                         break;
                     case 4:
                         SetMatrixHelper<bool, 4>(
                             shdInput,
                             arrConstantList[i].nShaderConstantHandle,
                             arrConstantList[i].nNumColumns,
-                            ((ShaderConstantTemplate<bool*>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
+                            ((const ShaderConstantTemplate<bool*>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
                         break;
                     default:
                         assert(false);
@@ -444,28 +460,28 @@ namespace GITechDemoApp
                     case 1:
                         shdInput->SetBoolArray(
                             arrConstantList[i].nShaderConstantHandle,
-                            &((ShaderConstantTemplate<bool>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
+                            &((const ShaderConstantTemplate<bool>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
                         break;
                     case 2:
                         SetMatrixHelper<bool, 2>(
                             shdInput,
                             arrConstantList[i].nShaderConstantHandle,
                             arrConstantList[i].nNumColumns,
-                            &((ShaderConstantTemplate<bool>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
+                            &((const ShaderConstantTemplate<bool>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
                         break;
                     case 3:
                         SetMatrixHelper<bool, 3>(
                             shdInput,
                             arrConstantList[i].nShaderConstantHandle,
                             arrConstantList[i].nNumColumns,
-                            &((ShaderConstantTemplate<bool>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
+                            &((const ShaderConstantTemplate<bool>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
                         break;
                     case 4:
                         SetMatrixHelper<bool, 4>(
                             shdInput,
                             arrConstantList[i].nShaderConstantHandle,
                             arrConstantList[i].nNumColumns,
-                            &((ShaderConstantTemplate<bool>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
+                            &((const ShaderConstantTemplate<bool>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
                         break;
                     default:
                         assert(false);
@@ -478,28 +494,28 @@ namespace GITechDemoApp
                     case 1:
                         shdInput->SetFloatArray(
                             arrConstantList[i].nShaderConstantHandle,
-                            ((ShaderConstantTemplate<float*>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
+                            ((const ShaderConstantTemplate<float*>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
                         break;
                     case 2:
                         SetMatrixHelper<float, 2>(
                             shdInput,
                             arrConstantList[i].nShaderConstantHandle,
                             arrConstantList[i].nNumColumns,
-                            ((ShaderConstantTemplate<float*>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
+                            ((const ShaderConstantTemplate<float*>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
                         break;
                     case 3:
                         SetMatrixHelper<float, 3>(
                             shdInput,
                             arrConstantList[i].nShaderConstantHandle,
                             arrConstantList[i].nNumColumns,
-                            ((ShaderConstantTemplate<float*>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
+                            ((const ShaderConstantTemplate<float*>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
                         break;
                     case 4:
                         SetMatrixHelper<float, 4>(
                             shdInput,
                             arrConstantList[i].nShaderConstantHandle,
                             arrConstantList[i].nNumColumns,
-                            ((ShaderConstantTemplate<float*>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
+                            ((const ShaderConstantTemplate<float*>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
                         break;
                     default:
                         assert(false);
@@ -510,28 +526,28 @@ namespace GITechDemoApp
                     case 1:
                         shdInput->SetFloatArray(
                             arrConstantList[i].nShaderConstantHandle,
-                            &((ShaderConstantTemplate<float>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
+                            &((const ShaderConstantTemplate<float>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
                         break;
                     case 2:
                         SetMatrixHelper<float, 2>(
                             shdInput,
                             arrConstantList[i].nShaderConstantHandle,
                             arrConstantList[i].nNumColumns,
-                            &((ShaderConstantTemplate<float>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
+                            &((const ShaderConstantTemplate<float>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
                         break;
                     case 3:
                         SetMatrixHelper<float, 3>(
                             shdInput,
                             arrConstantList[i].nShaderConstantHandle,
                             arrConstantList[i].nNumColumns,
-                            &((ShaderConstantTemplate<float>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
+                            &((const ShaderConstantTemplate<float>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
                         break;
                     case 4:
                         SetMatrixHelper<float, 4>(
                             shdInput,
                             arrConstantList[i].nShaderConstantHandle,
                             arrConstantList[i].nNumColumns,
-                            &((ShaderConstantTemplate<float>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
+                            &((const ShaderConstantTemplate<float>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
                         break;
                     default:
                         assert(false);
@@ -544,28 +560,28 @@ namespace GITechDemoApp
                     case 1:
                         shdInput->SetIntArray(
                             arrConstantList[i].nShaderConstantHandle,
-                            ((ShaderConstantTemplate<int*>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
+                            ((const ShaderConstantTemplate<int*>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
                         break;
                     case 2:
                         SetMatrixHelper<int, 2>(
                             shdInput,
                             arrConstantList[i].nShaderConstantHandle,
                             arrConstantList[i].nNumColumns,
-                            ((ShaderConstantTemplate<int*>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
+                            ((const ShaderConstantTemplate<int*>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
                         break;
                     case 3:
                         SetMatrixHelper<int, 3>(
                             shdInput,
                             arrConstantList[i].nShaderConstantHandle,
                             arrConstantList[i].nNumColumns,
-                            ((ShaderConstantTemplate<int*>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
+                            ((const ShaderConstantTemplate<int*>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
                         break;
                     case 4:
                         SetMatrixHelper<int, 4>(
                             shdInput,
                             arrConstantList[i].nShaderConstantHandle,
                             arrConstantList[i].nNumColumns,
-                            ((ShaderConstantTemplate<int*>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
+                            ((const ShaderConstantTemplate<int*>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
                         break;
                     default:
                         assert(false);
@@ -576,28 +592,28 @@ namespace GITechDemoApp
                     case 1:
                         shdInput->SetIntArray(
                             arrConstantList[i].nShaderConstantHandle,
-                            &((ShaderConstantTemplate<int>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
+                            &((const ShaderConstantTemplate<int>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
                         break;
                     case 2:
                         SetMatrixHelper<int, 2>(
                             shdInput,
                             arrConstantList[i].nShaderConstantHandle,
                             arrConstantList[i].nNumColumns,
-                            &((ShaderConstantTemplate<int>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
+                            &((const ShaderConstantTemplate<int>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
                         break;
                     case 3:
                         SetMatrixHelper<int, 3>(
                             shdInput,
                             arrConstantList[i].nShaderConstantHandle,
                             arrConstantList[i].nNumColumns,
-                            &((ShaderConstantTemplate<int>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
+                            &((const ShaderConstantTemplate<int>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
                         break;
                     case 4:
                         SetMatrixHelper<int, 4>(
                             shdInput,
                             arrConstantList[i].nShaderConstantHandle,
                             arrConstantList[i].nNumColumns,
-                            &((ShaderConstantTemplate<int>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
+                            &((const ShaderConstantTemplate<int>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
                         break;
                     default:
                         assert(false);
@@ -610,14 +626,14 @@ namespace GITechDemoApp
             case IT_SAMPLERCUBE:
                 shdInput->SetTexture(
                     arrConstantList[i].nShaderConstantHandle,
-                    ((ShaderConstantTemplate<unsigned int>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
+                    ((const ShaderConstantTemplate<unsigned int>*)arrConstantList[i].pShaderConstantTemplate)->GetCurrentValue());
                 break;
             default:
                 assert(false);
             }
         }
 
-        POP_PROFILE_MARKER();
+        POP_DETAIL_PROFILE_MARKER();
     }
 
     void Shader::Disable()
@@ -625,7 +641,7 @@ namespace GITechDemoApp
         pVertexShaderProg->Disable();
         pPixelShaderProg->Disable();
 
-        POP_PROFILE_MARKER();
+        POP_DRAW_PROFILE_MARKER();
     }
 
     Model::Model(const char* filePath)
@@ -637,10 +653,7 @@ namespace GITechDemoApp
     Model::~Model()
     {
         for (unsigned int i = 0; i < TextureList.size(); i++)
-        {
-            arrResources[TextureList[i]->nId] = nullptr;
-            delete TextureList[i];
-        }
+            Texture::Release(TextureList[i]);
 
         TextureList.clear();
     }
@@ -661,7 +674,9 @@ namespace GITechDemoApp
             for (unsigned int tt = Synesthesia3D::Model::TextureDesc::TT_NONE; tt < Synesthesia3D::Model::TextureDesc::TT_UNKNOWN; tt++)
                 TextureLUT[tt].resize(pModel->arrMaterial.size(), -1);
 
-            // Populate the TextureList
+            // Populate the TextureList, with textures which may be shared with other models or PBR materials.
+            // The model holds one reference to each of them, however many of its materials use them.
+            vector<Texture*> arrMaterialTexture;
             for (unsigned int i = 0; i < pModel->arrMaterial.size(); i++)
             {
                 for (unsigned int j = 0; j < pModel->arrMaterial[i]->arrTexture.size(); j++)
@@ -673,23 +688,13 @@ namespace GITechDemoApp
                     if (offset != string::npos)
                         filePath.replace(offset, UINT_MAX, ".s3dtex");
 
-                    unsigned int texIdx = -1;
-                    texIdx = ResMgr->FindTexture(filePath.c_str());
-                    if (texIdx == -1)
-                    {
-                        bool bDuplicateFound = false;
-                        for (unsigned int k = 0; k < TextureList.size(); k++)
-                        {
-                            if (TextureList[k]->GetFilePath() == filePath)
-                            {
-                                bDuplicateFound = true;
-                                break;
-                            }
-                        }
+                    Texture* const tex = Texture::Acquire(filePath.c_str(), true);
+                    if (std::find(TextureList.begin(), TextureList.end(), tex) == TextureList.end())
+                        TextureList.push_back(tex);
+                    else
+                        Texture::Release(tex);
 
-                        if (!bDuplicateFound)
-                            TextureList.push_back(new Texture(filePath.c_str()));
-                    }
+                    arrMaterialTexture.push_back(tex);
                 }
             }
 
@@ -704,52 +709,41 @@ namespace GITechDemoApp
                 }
             }
 
-            for (unsigned int i = 0; i < pModel->arrMaterial.size(); i++)
+            for (unsigned int i = 0, texCounter = 0; i < pModel->arrMaterial.size(); i++)
             {
                 for (unsigned int j = 0; j < pModel->arrMaterial[i]->arrTexture.size(); j++)
                 {
-                    size_t found = szDesc.find_last_of("/\\");
-                    string filePath = (found ? szDesc.substr(0, found + 1) : "") + pModel->arrMaterial[i]->arrTexture[j]->szFilePath;
-
-                    const unsigned int offset = (unsigned int)filePath.rfind('.');
-                    if (offset != string::npos)
-                        filePath.replace(offset, UINT_MAX, ".s3dtex");
+                    Texture* const materialTex = arrMaterialTexture[texCounter++];
 
                     unsigned int texIdx = -1;
-                    //texIdx = ResMgr->FindTexture(filePath.c_str());
-                    for (unsigned int k = 0; k < TextureList.size(); k++)
+                    bool bGotLockOnTex = false;
+                    do
                     {
-                        if (TextureList[k]->GetFilePath() == filePath)
+                        if (materialTex->TryLockRes())
                         {
-                            bool bGotLockOnTex = false;
-                            do
-                            {
-                                if (TextureList[k]->TryLockRes())
-                                {
-                                    texIdx = TextureList[k]->GetTextureIndex();
-                                    bGotLockOnTex = true;
-                                    break;
-                                }
-                                else
-                                {
-                                    texIdx = TextureList[k]->GetTextureIndex();
-                                    Framework::GetInstance()->Sleep(1);
-                                }
-                            } while (texIdx == ~0u);
-
-                            // This should never happen, but for extra safety, in case this texture
-                            // was locked by another thread when we tried to Init() it above,
-                            // and somehow it still isn't initialized after being unlocked:
-                            if (texIdx == ~0u && bGotLockOnTex)
-                            {
-                                TextureList[k]->Init();
-                                TextureList[k]->UnlockRes();
-                                bGotLockOnTex = false;
-                            }
-
+                            texIdx = materialTex->GetTextureIndex();
+                            bGotLockOnTex = true;
                             break;
                         }
+                        else
+                        {
+                            texIdx = materialTex->GetTextureIndex();
+                            Framework::GetInstance()->Sleep(1);
+                        }
+                    } while (texIdx == ~0u);
+
+                    // This should never happen, but for extra safety, in case this texture
+                    // was locked by another thread when we tried to Init() it above,
+                    // and somehow it still isn't initialized after being unlocked:
+                    if (texIdx == ~0u && bGotLockOnTex)
+                    {
+                        materialTex->Init();
+                        texIdx = materialTex->GetTextureIndex();
                     }
+
+                    if (bGotLockOnTex)
+                        materialTex->UnlockRes();
+
                     assert(texIdx != -1);
 
                     if (texIdx != -1)
@@ -826,24 +820,92 @@ namespace GITechDemoApp
         pModel = nullptr;
 
         for (unsigned int i = 0; i < TextureList.size(); i++)
-            for (unsigned int j = 0; j < arrResources.size(); j++)
-                if (TextureList[i] == arrResources[j])
-                {
-                    arrResources.erase(arrResources.begin() + j);
-                    j--;
-                }
+            Texture::Release(TextureList[i]);
 
         TextureList.clear();
         for (unsigned int tt = Synesthesia3D::Model::TextureDesc::TT_NONE; tt < Synesthesia3D::Model::TextureDesc::TT_UNKNOWN; tt++)
             TextureLUT[tt].clear();
     }
 
-    Texture::Texture(const char* filePath)
+    Texture::Texture(const char* filePath, const bool streamed)
         : RenderResource(filePath, RES_TEXTURE)
         , pTexture(nullptr)
         , nTexIdx(~0u)
+        , bStreamed(streamed)
+        , nPathHash(0)
+        , nContentHash(0)
+        , nRefCount(0)
     {}
 
+    Texture* const Texture::Acquire(const char* filePath, const bool streamed)
+    {
+        const unsigned long long pathHash = AssetPack::HashPath(AssetPack::NormalizePath(filePath).c_str());
+
+        // Only known for files in asset packs, where it's computed offline
+        unsigned long long contentHash = 0;
+        ResourceManager::FindAssetContentHash(filePath, contentHash);
+
+        MUTEX_LOCK(tRegistry.mMutex);
+
+        Texture* tex = nullptr;
+        unordered_map<unsigned long long, Texture*>::const_iterator it = tRegistry.mapPathHash.find(pathHash);
+        if (it != tRegistry.mapPathHash.end())
+            tex = it->second;
+        else if (contentHash)
+        {
+            it = tRegistry.mapContentHash.find(contentHash);
+            if (it != tRegistry.mapContentHash.end())
+                tex = it->second;
+        }
+
+        if (!tex)
+        {
+            tex = new Texture(filePath, streamed);
+            tex->nPathHash = pathHash;
+            tex->nContentHash = contentHash;
+
+            tRegistry.mapPathHash.emplace(pathHash, tex);
+            if (contentHash)
+                tRegistry.mapContentHash.emplace(contentHash, tex);
+        }
+
+        tex->nRefCount++;
+
+        MUTEX_UNLOCK(tRegistry.mMutex);
+
+        return tex;
+    }
+
+    void Texture::Release(Texture* const tex)
+    {
+        if (!tex)
+            return;
+
+        MUTEX_LOCK(tRegistry.mMutex);
+
+        assert(tex->nRefCount > 0);
+        const bool lastUser = (--tex->nRefCount == 0);
+        if (lastUser)
+        {
+            tRegistry.mapPathHash.erase(tex->nPathHash);
+            if (tex->nContentHash)
+                tRegistry.mapContentHash.erase(tex->nContentHash);
+
+            // Textures are added to the resource list under the same lock (see Acquire()).
+            // The slot is cleared instead of erased, so that resource IDs remain valid indices.
+            assert(tex->nId < arrResources.size() && arrResources[tex->nId] == tex);
+            arrResources[tex->nId] = nullptr;
+        }
+
+        MUTEX_UNLOCK(tRegistry.mMutex);
+
+        if (lastUser)
+        {
+            tex->Free();
+            delete tex;
+        }
+    }
+
     const bool Texture::Init()
     {
         Renderer* RenderContext = Renderer::GetInstance();
@@ -854,7 +916,8 @@ namespace GITechDemoApp
 
         if (RenderResource::Init())
         {
-            nTexIdx = ResMgr->CreateTexture(szDesc.c_str());
+            const unsigned int maxMipSize = (bStreamed && RenderConfig::TextureStreaming::Enabled) ? Math::Max(RenderConfig::TextureStreaming::TailSize, 1) : 0;
+            nTexIdx = ResMgr->CreateTexture(szDesc.c_str(), maxMipSize);
             if (nTexIdx != ~0u)
                 pTexture = ResMgr->GetTexture(nTexIdx);
 
@@ -902,6 +965,8 @@ namespace GITechDemoApp
         , heightRatio(heightRatio)
         , eDepthStencilFormat(depthStencilFormat)
         , bIsDynamic(true)
+        , pAliasOwner(nullptr)
+        , szProfileMarker("Render Target: " + szDesc)
     {}
 
     RenderTarget::RenderTarget(const char* name, const unsigned int targetCount,
@@ -923,6 +988,8 @@ namespace GITechDemoApp
         , heightRatio(0)
         , eDepthStencilFormat(depthStencilFormat)
         , bIsDynamic(false)
+        , pAliasOwner(nullptr)
+        , szProfileMarker("Render Target: " + szDesc)
     {}
 
     const bool RenderTarget::Init()
@@ -933,6 +1000,23 @@ namespace GITechDemoApp
         if (!RenderContext || !ResMgr || bInitialized)
             return false;
 
+        if (pAliasOwner)
+        {
+            // Wait for the owner of the alias group to create the actual resource
+            if (!pAliasOwner->pRenderTarget)
+                return false;
+
+            if (RenderResource::Init())
+            {
+                pRenderTarget = pAliasOwner->pRenderTarget;
+                nRenderTargetIdx = pAliasOwner->nRenderTargetIdx;
+
+                return true;
+            }
+            else
+                return false;
+        }
+
         if (RenderResource::Init())
         {
             if (bIsDynamic)
@@ -966,16 +1050,34 @@ namespace GITechDemoApp
 
         RenderResource::Free();
 
-        if (ResMgr)
+        // Aliased render targets don't own their resource
+        if (ResMgr && !pAliasOwner)
             ResMgr->ReleaseRenderTarget(nRenderTargetIdx);
 
         pRenderTarget = nullptr;
         nRenderTargetIdx = ~0u;
     }
 
+    const bool RenderTarget::IsCompatible(const RenderTarget& other) const
+    {
+        if (nTargetCount != other.nTargetCount ||
+            ePixelFormatRT0 != other.ePixelFormatRT0 ||
+            ePixelFormatRT1 != other.ePixelFormatRT1 ||
+            ePixelFormatRT2 != other.ePixelFormatRT2 ||
+            ePixelFormatRT3 != other.ePixelFormatRT3 ||
+            eDepthStencilFormat != other.eDepthStencilFormat ||
+            bIsDynamic != other.bIsDynamic)
+            return false;
+
+        if (bIsDynamic)
+            return widthRatio == other.widthRatio && heightRatio == other.heightRatio;
+        else
+            return nWidth == other.nWidth && nHeight == other.nHeight;
+    }
+
     void RenderTarget::Enable()
     {
-        PUSH_PROFILE_MARKER(("Render Target: " + szDesc).c_str());
+        PUSH_DYNAMIC_PROFILE_MARKER(szProfileMarker.c_str());
         pRenderTarget->Enable();
         ms_vActiveRenderTargetSizeInv.push_back(pRenderTarget->GetSize());
         HLSL::UtilsParams->RenderTargetInvSize = Vec2f(1.f / ms_vActiveRenderTargetSizeInv.back()[0], 1.f / ms_vActiveRenderTargetSizeInv.back()[1]);
@@ -1014,10 +1116,10 @@ namespace GITechDemoApp
 
         if (RenderResource::Init())
         {
-            arrTexture[PBRTT_ALBEDO]     = new Texture(("models/pbr-test/textures/" + szDesc + "/albedo.s3dtex").c_str());
-            arrTexture[PBRTT_NORMAL]     = new Texture(("models/pbr-test/textures/" + szDesc + "/normal.s3dtex").c_str());
-            arrTexture[PBRTT_ROUGHNESS]  = new Texture(("models/pbr-test/textures/" + szDesc + "/roughness.s3dtex").c_str());
-            arrTexture[PBRTT_MATERIAL]   = new Texture(("models/pbr-test/textures/" + szDesc + "/metallic.s3dtex").c_str());
+            arrTexture[PBRTT_ALBEDO]     = Texture::Acquire(("models/pbr-test/textures/" + szDesc + "/albedo.s3dtex").c_str());
+            arrTexture[PBRTT_NORMAL]     = Texture::Acquire(("models/pbr-test/textures/" + szDesc + "/normal.s3dtex").c_str());
+            arrTexture[PBRTT_ROUGHNESS]  = Texture::Acquire(("models/pbr-test/textures/" + szDesc + "/roughness.s3dtex").c_str());
+            arrTexture[PBRTT_MATERIAL]   = Texture::Acquire(("models/pbr-test/textures/" + szDesc + "/metallic.s3dtex").c_str());
 
             // Other free threads might pick up the above textures for
             // initialization before we get a chance to do it from here.
@@ -1045,7 +1147,7 @@ namespace GITechDemoApp
 
         for (unsigned int i = 0; i < PBRTT_MAX; i++)
         {
-            arrTexture[i]->Free();
+            Texture::Release(arrTexture[i]);
             arrTexture[i] = nullptr;
         }
     }
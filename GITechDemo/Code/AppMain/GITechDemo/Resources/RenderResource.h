@@ -23,6 +23,8 @@
 #define RENDER_RESOURCE_H_
 
 #include <string>
+#include <thread>
+#include <unordered_map>
 using namespace std;
 
 #include <gmtl\gmtl.h>
@@ -48,6 +50,7 @@ namespace GITechDemoApp
 
     class Texture;
     class PBRMaterial;
+    class RenderGraph;
 
     class RenderResource
     {
@@ -77,9 +80,12 @@ namespace GITechDemoApp
         static void FreeAll();
 
         const char* GetDesc() const { return szDesc.c_str(); }
+        const unsigned int GetDescHash() const { return nDescHash; }
         const ResourceType GetResourceType() { return eResType; }
 
         const bool IsInitialized() { return bInitialized; }
+        const long long GetCreationTime() const { return nCreationTime; }
+        const std::thread::id GetCreationThreadId() const { return tCreationThreadId; }
         virtual const bool Init();
         virtual void Free();
 
@@ -97,8 +103,11 @@ namespace GITechDemoApp
 
         unsigned int    nId;
         string          szDesc;
+        unsigned int    nDescHash;          // S3DHASH() of szDesc, computed once at construction
         ResourceType    eResType;
         bool            bInitialized;
+        long long       nCreationTime;      // For the startup timeline, to tell when a resource became available to the loader threads
+        std::thread::id tCreationThreadId;
 
         MUTEX           mResMutex;
         MUTEX           mInitMutex;
@@ -133,11 +142,23 @@ namespace GITechDemoApp
     class Texture : public RenderResource
     {
     public:
-        Texture(const char* filePath);
+        Texture(const char* filePath, const bool streamed = false);
+
+        // Textures of models and PBR materials are shared through a registry, keyed by the hash of their normalized
+        // path and, for files in asset packs, of their contents, so that a texture referenced by several of them is
+        // only loaded once. They are reference counted and freed, then deleted, along with their last user.
+        // NB: the first user decides whether the texture is streamed.
+        static Texture* const Acquire(const char* filePath, const bool streamed = false);
+        static void Release(Texture* const tex);
+
+        const unsigned int GetRefCount() const { return nRefCount; }
 
         Synesthesia3D::Texture* const       GetTexture() { return pTexture; }
         const unsigned int  GetTextureIndex() const { return nTexIdx; }
 
+        // Streamed textures are loaded with only their mip tail resident (see TextureStreamer)
+        const bool IsStreamed() const { return bStreamed; }
+
         const char* GetFilePath() { return szDesc.c_str(); }
 
     protected:
@@ -148,48 +169,93 @@ namespace GITechDemoApp
 
         Synesthesia3D::Texture* pTexture;
         unsigned int nTexIdx;
+        bool bStreamed;
+
+        unsigned long long nPathHash;       // AssetPack::HashPath() of the normalized path, for shared textures
+        unsigned long long nContentHash;    // AssetPack::HashContents() of the file, if it's in an asset pack
+        unsigned int nRefCount;             // Number of users, for shared textures
+
+        struct Registry
+        {
+            Registry() { MUTEX_INIT(mMutex); }
+            ~Registry() { MUTEX_DESTROY(mMutex); }
+
+            unordered_map<unsigned long long, Texture*> mapPathHash;
+            unordered_map<unsigned long long, Texture*> mapContentHash;
+            MUTEX mMutex;
+        };
+
+        static Registry tRegistry;
 
         friend class Model;
         friend class PBRMaterial;
     };
 
+    // The version of a shader constant is incremented whenever its value may have been
+    // modified, so that shaders only copy the constants which have changed since their last use.
+    // Accessors returning a non-const reference conservatively count as a modification.
+    class ShaderConstant : public RenderResource
+    {
+    public:
+        const unsigned int GetVersion() const { return nVersion; }
+
+        // All shader constants, indexed by the hash of their names, so that shaders can
+        // bind their inputs without going through the whole resource list for each of them
+        static const unordered_multimap<unsigned int, ShaderConstant*>& GetShaderConstantMap() { return mapShaderConstant; }
+
+    protected:
+        ShaderConstant(const char* name)
+            : RenderResource(name, RES_SHADER_CONSTANT)
+            , nVersion(1)
+        {
+            mapShaderConstant.emplace(nDescHash, this);
+        }
+
+        void Invalidate() { nVersion++; }
+
+        unsigned int nVersion;
+
+        static unordered_multimap<unsigned int, ShaderConstant*> mapShaderConstant;
+    };
+
     template<class T>
-    class ShaderConstantTemplate : public RenderResource
+    class ShaderConstantTemplate : public ShaderConstant
     {
     public:
         ShaderConstantTemplate(const char* name, T defaultVal)
-            : RenderResource(name, RES_SHADER_CONSTANT)
+            : ShaderConstant(name)
         {
             currentValue = defaultVal;
             bInitialized = true;
         }
 
         ShaderConstantTemplate(const char* name)
-            : RenderResource(name, RES_SHADER_CONSTANT)
+            : ShaderConstant(name)
         {
             bInitialized = true;
         }
 
         const char* GetName() { return szDesc.c_str(); }
 
-        T& GetCurrentValue() { return currentValue; }
+        T& GetCurrentValue() { Invalidate(); return currentValue; }
+        const T& GetCurrentValue() const { return currentValue; }
 
-        void operator=(const T& value) { currentValue = value; }
-        void operator= (const ShaderConstantTemplate& lhs) { currentValue = lhs.currentValue; }
+        void operator=(const T& value) { currentValue = value; Invalidate(); }
+        void operator= (const ShaderConstantTemplate& lhs) { currentValue = lhs.currentValue; Invalidate(); }
         void operator=(const Synesthesia3D::Texture* tex) { assert(0); }
         void operator=(const Synesthesia3D::Texture& tex) { assert(0); }
         void operator=(const Texture* tex) { assert(0); }
         void operator=(const Texture& tex) { assert(0); }
 
-        operator T&() { return currentValue; }
+        operator T&() { Invalidate(); return currentValue; }
 
         template<class T>
-        T& operator [] (const int idx) { return currentValue[idx]; }
+        T& operator [] (const int idx) { Invalidate(); return currentValue[idx]; }
 
         template<class DATA_TYPE, unsigned SIZE>
         Vec<DATA_TYPE, SIZE> operator * (const Vec<DATA_TYPE, SIZE>& rhs) { return currentValue * rhs; }
 
-        T* const operator->() { return &currentValue; }
+        T* const operator->() { Invalidate(); return &currentValue; }
 
     protected:
         T       currentValue;
@@ -221,6 +287,7 @@ namespace GITechDemoApp
                 break;
             }
         }
+        Invalidate();
     }
 
     template<>
@@ -233,6 +300,7 @@ namespace GITechDemoApp
     void ShaderConstantTemplate<s3dSampler>::operator=(const Texture* tex)
     {
         currentValue = tex ? tex->GetTextureIndex() : ~0u;
+        Invalidate();
     }
 
     template<>
@@ -265,7 +333,8 @@ namespace GITechDemoApp
     protected:
         struct ShaderConstantInstance
         {
-            RenderResource*     pShaderConstantTemplate;
+            ShaderConstant*     pShaderConstantTemplate;
+            unsigned int        nShaderConstantVersion; // Version last copied to the shader input
             unsigned int        nShaderConstantHandle;
             ShaderProgramType   eShaderType;
             InputType           eConstantType;
@@ -292,6 +361,9 @@ namespace GITechDemoApp
         unsigned int    nPixelShaderInputIdx;
 
         vector<ShaderConstantInstance>  arrConstantList;
+
+        // Built once so that profile markers don't allocate every draw
+        string          szCommitProfileMarker;
     };
 
     class RenderTarget : public RenderResource
@@ -313,12 +385,18 @@ namespace GITechDemoApp
 
         Synesthesia3D::RenderTarget* const GetRenderTarget() { return pRenderTarget; }
 
+        // Returns the render target whose storage this one shares, if it has been aliased by the render graph
+        RenderTarget* const GetAliasOwner() const { return pAliasOwner; }
+
     protected:
         const bool Init();
         void Free();
         
         void operator= (const RenderTarget& lhs) { assert(0); }
 
+        // Checks whether the two render targets can share the same underlying resource
+        const bool IsCompatible(const RenderTarget& other) const;
+
         Synesthesia3D::RenderTarget*    pRenderTarget;
         unsigned int nRenderTargetIdx;
         unsigned int nTargetCount;
@@ -333,7 +411,16 @@ namespace GITechDemoApp
         PixelFormat eDepthStencilFormat;
         bool bIsDynamic;
 
+        // Transient render targets with non-overlapping lifetimes share the
+        // resources of the owner of their alias group (see RenderGraph)
+        RenderTarget* pAliasOwner;
+
+        // Built once so that profile markers don't allocate every pass
+        string szProfileMarker;
+
         static std::vector<Vec2i> RenderTarget::ms_vActiveRenderTargetSizeInv;
+
+        friend class RenderGraph;
     };
 
     class PBRMaterial : public RenderResource
@@ -0,0 +1,359 @@
+/*=============================================================================
+ * This file is part of the "GITechDemo" application
+ * Copyright (C) Iftode Bogdan-Marius <iftode.bogdan@gmail.com>
+ *
+ *      File:   Benchmark.cpp
+ *      Author: Bogdan Iftode
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+=============================================================================*/
+
+#include "stdafx.h"
+
+#include <fstream>
+#include <iostream>
+
+#include <Renderer.h>
+#include <Profiler.h>
+using namespace Synesthesia3D;
+
+#include "Benchmark.h"
+#include "ArtistParameter.h"
+#include "RenderScheme.h"
+using namespace GITechDemoApp;
+
+// Reads the next whitespace separated token, which may be quoted if it contains spaces
+static const bool ReadToken(std::istringstream& line, std::string& token)
+{
+    token.clear();
+    line >> std::ws;
+
+    if (line.peek() == '"')
+    {
+        line.get();
+        std::getline(line, token, '"');
+    }
+    else
+    {
+        line >> token;
+    }
+
+    return !token.empty();
+}
+
+Benchmark::Benchmark()
+    : m_nWarmupFrameCount(60)
+    , m_nMeasuredFrameCount(300)
+    , m_fTimeStep(1.f / 60.f)
+    , m_szOutputPath("GITechDemo_benchmark")
+    , m_nCurrSegment(0)
+    , m_nCurrFrame(0)
+    , m_bOriginalValuesSaved(false)
+{}
+
+const bool Benchmark::Load(const char* const scriptPath)
+{
+    std::ifstream file(scriptPath);
+    if (!file.is_open())
+    {
+        std::cout << "Benchmark: can't open \"" << scriptPath << "\"" << std::endl;
+        return false;
+    }
+
+    m_arrSegment.clear();
+
+    std::string lineStr;
+    for (unsigned int lineIdx = 1; std::getline(file, lineStr); lineIdx++)
+    {
+        std::istringstream line(lineStr);
+        std::string cmd;
+        if (!ReadToken(line, cmd) || cmd[0] == '#')
+            continue;
+
+        bool valid = true;
+        if (cmd == "warmup")
+        {
+            valid = !!(line >> m_nWarmupFrameCount);
+        }
+        else if (cmd == "frames")
+        {
+            valid = !!(line >> m_nMeasuredFrameCount) && m_nMeasuredFrameCount > 0;
+
+            // Percentiles are computed over the last HISTORY_SIZE samples only
+            if (m_nMeasuredFrameCount > TimingStatistics::HISTORY_SIZE)
+            {
+                std::cout << "Benchmark: line " << lineIdx << ": clamping measured frame count to " << TimingStatistics::HISTORY_SIZE << std::endl;
+                m_nMeasuredFrameCount = TimingStatistics::HISTORY_SIZE;
+            }
+        }
+        else if (cmd == "timestep")
+        {
+            float timeStepMs = 0.f;
+            valid = !!(line >> timeStepMs) && timeStepMs > 0.f;
+            m_fTimeStep = timeStepMs / 1000.f;
+        }
+        else if (cmd == "output")
+        {
+            valid = ReadToken(line, m_szOutputPath);
+        }
+        else if (cmd == "segment")
+        {
+            m_arrSegment.push_back(Segment());
+            valid = ReadToken(line, m_arrSegment.back().szName);
+        }
+        else if (cmd == "set" && !m_arrSegment.empty())
+        {
+            std::string paramName;
+            ParameterOverride paramOverride = { nullptr, 0.f };
+            valid = ReadToken(line, paramName) && !!(line >> paramOverride.fValue);
+
+            for (unsigned int i = 0; i < ArtistParameter::GetParameterCount() && valid; i++)
+            {
+                if (ArtistParameter::GetParameterByIdx(i)->GetName() == paramName)
+                {
+                    paramOverride.pParam = ArtistParameter::GetParameterByIdx(i);
+                    break;
+                }
+            }
+
+            if (valid && !paramOverride.pParam)
+            {
+                std::cout << "Benchmark: line " << lineIdx << ": unknown parameter \"" << paramName << "\"" << std::endl;
+                return false;
+            }
+
+            m_arrSegment.back().arrOverride.push_back(paramOverride);
+        }
+        else if (cmd == "key" && !m_arrSegment.empty())
+        {
+            CameraKeyframe key;
+            valid = !!(line >> key.fTime >> key.vPos[0] >> key.vPos[1] >> key.vPos[2] >> key.qRot[0] >> key.qRot[1] >> key.qRot[2] >> key.qRot[3]);
+
+            // Keyframes must be in chronological order
+            const std::vector<CameraKeyframe>& keys = m_arrSegment.back().arrKeyframe;
+            valid = valid && (keys.empty() || keys.back().fTime < key.fTime);
+
+            if (valid)
+            {
+                gmtl::normalize(key.qRot);
+                m_arrSegment.back().arrKeyframe.push_back(key);
+            }
+        }
+        else
+        {
+            valid = false;
+        }
+
+        if (!valid)
+        {
+            std::cout << "Benchmark: line " << lineIdx << ": invalid command \"" << lineStr << "\"" << std::endl;
+            return false;
+        }
+    }
+
+    if (m_arrSegment.empty())
+    {
+        std::cout << "Benchmark: \"" << scriptPath << "\" has no segments" << std::endl;
+        return false;
+    }
+
+    m_nCurrSegment = 0;
+    m_nCurrFrame = 0;
+
+    FrameStatistics::WriteCSVHeader(m_ssReportCSV, "segment,");
+    m_ssReportJSON << "{\n\"warmup_frames\":" << m_nWarmupFrameCount
+        << ",\n\"measured_frames\":" << m_nMeasuredFrameCount
+        << ",\n\"timestep_ms\":" << m_fTimeStep * 1000.f
+        << ",\n\"api\":\"" << (Renderer::GetAPI() == API_NULL ? "NULL" : "DX9") << "\""
+        << ",\n\"segments\":[";
+
+    return true;
+}
+
+void Benchmark::Update(Vec3f& cameraPos, Matrix44f& cameraRot)
+{
+    if (!IsRunning())
+        return;
+
+    if (m_nCurrFrame == 0)
+        BeginSegment();
+
+    // Hold the first keyframe during the warm-up, then play back the path in fixed steps
+    const std::vector<CameraKeyframe>& keys = m_arrSegment[m_nCurrSegment].arrKeyframe;
+    if (keys.empty())
+        return;
+
+    const float time = m_nCurrFrame > m_nWarmupFrameCount ? (float)(m_nCurrFrame - m_nWarmupFrameCount) * m_fTimeStep : 0.f;
+
+    unsigned int nextKey = 0;
+    while (nextKey < keys.size() && keys[nextKey].fTime <= time)
+        nextKey++;
+
+    if (nextKey == 0 || nextKey == keys.size())
+    {
+        const CameraKeyframe& key = keys[nextKey == 0 ? 0 : keys.size() - 1];
+        cameraPos = key.vPos;
+        gmtl::set(cameraRot, key.qRot);
+    }
+    else
+    {
+        const CameraKeyframe& prevKey = keys[nextKey - 1];
+        const CameraKeyframe& key = keys[nextKey];
+        const float t = (time - prevKey.fTime) / (key.fTime - prevKey.fTime);
+
+        Quatf rot;
+        gmtl::lerp(cameraPos, t, prevKey.vPos, key.vPos);
+        gmtl::slerp(rot, t, prevKey.qRot, key.qRot);
+        gmtl::set(cameraRot, rot);
+    }
+}
+
+void Benchmark::EndFrame()
+{
+    if (!IsRunning())
+        return;
+
+    Profiler* const profiler = Renderer::GetInstance() ? Renderer::GetInstance()->GetProfiler() : nullptr;
+    if (profiler)
+        profiler->RetrieveGPUProfileMarkerSnapshot(m_tGPUProfileMarkerSnapshot);
+
+    // Keep timing the warm-up, so that the first measured frame has a valid CPU frame time
+    if (m_nCurrFrame == m_nWarmupFrameCount)
+        m_tFrameStatistics.Reset();
+    m_tFrameStatistics.AddFrame(m_tGPUProfileMarkerSnapshot, RenderScheme::GetRootPass());
+
+    if (++m_nCurrFrame == m_nWarmupFrameCount + m_nMeasuredFrameCount)
+        EndSegment();
+}
+
+void Benchmark::BeginSegment()
+{
+    const Segment& segment = m_arrSegment[m_nCurrSegment];
+
+    if (!m_bOriginalValuesSaved)
+    {
+        for (unsigned int i = 0; i < m_arrSegment.size(); i++)
+        {
+            for (unsigned int j = 0; j < m_arrSegment[i].arrOverride.size(); j++)
+            {
+                ParameterOverride originalValue = { m_arrSegment[i].arrOverride[j].pParam, GetParameterValue(m_arrSegment[i].arrOverride[j].pParam) };
+                m_arrOriginalValue.push_back(originalValue);
+            }
+        }
+        m_bOriginalValuesSaved = true;
+    }
+
+    RestoreParameters();
+    for (unsigned int i = 0; i < segment.arrOverride.size(); i++)
+        SetParameterValue(segment.arrOverride[i].pParam, segment.arrOverride[i].fValue);
+
+    std::cout << "Benchmark: segment \"" << segment.szName << "\" (" << m_nCurrSegment + 1 << "/" << m_arrSegment.size() << ")" << std::endl;
+}
+
+void Benchmark::EndSegment()
+{
+    const Segment& segment = m_arrSegment[m_nCurrSegment];
+
+    m_tFrameStatistics.WriteCSV(m_ssReportCSV, "\"" + segment.szName + "\",");
+
+    m_ssReportJSON << (m_nCurrSegment ? ",\n" : "\n") << "{\"name\":\"" << segment.szName << "\",\"statistics\":";
+    m_tFrameStatistics.WriteJSON(m_ssReportJSON);
+    m_ssReportJSON << "}";
+
+    m_nCurrFrame = 0;
+    if (++m_nCurrSegment == m_arrSegment.size())
+    {
+        RestoreParameters();
+
+        m_ssReportJSON << "\n]\n}\n";
+        if (WriteReport())
+            std::cout << "Benchmark: report written to \"" << m_szOutputPath << ".csv\" and \"" << m_szOutputPath << ".json\"" << std::endl;
+        else
+            std::cout << "Benchmark: can't write report to \"" << m_szOutputPath << "\"" << std::endl;
+    }
+}
+
+void Benchmark::RestoreParameters()
+{
+    for (unsigned int i = 0; i < m_arrOriginalValue.size(); i++)
+        SetParameterValue(m_arrOriginalValue[i].pParam, m_arrOriginalValue[i].fValue);
+}
+
+const bool Benchmark::WriteReport() const
+{
+    std::ofstream csv((m_szOutputPath + ".csv").c_str(), std::ios::out | std::ios::trunc);
+    std::ofstream json((m_szOutputPath + ".json").c_str(), std::ios::out | std::ios::trunc);
+    if (!csv.is_open() || !json.is_open())
+        return false;
+
+    csv << m_ssReportCSV.str();
+    json << m_ssReportJSON.str();
+
+    return csv.good() && json.good();
+}
+
+const std::string Benchmark::FormatCameraKeyframe(const float time, const Vec3f& cameraPos, const Matrix44f& cameraRot)
+{
+    Quatf rot;
+    gmtl::set(rot, cameraRot);
+
+    std::ostringstream key;
+    key.precision(9);
+    key << "key " << time << " "
+        << cameraPos[0] << " " << cameraPos[1] << " " << cameraPos[2] << " "
+        << rot[0] << " " << rot[1] << " " << rot[2] << " " << rot[3];
+
+    return key.str();
+}
+
+const float Benchmark::GetParameterValue(ArtistParameter* const param)
+{
+    switch (param->GetDataType())
+    {
+    case ArtistParameter::APDT_FLOAT:
+    case ArtistParameter::APDT_GPU_FLOAT:
+        return param->GetParameterAsFloat();
+    case ArtistParameter::APDT_INT:
+        return (float)param->GetParameterAsInt();
+    case ArtistParameter::APDT_BOOL:
+        return param->GetParameterAsBool() ? 1.f : 0.f;
+    case ArtistParameter::APDT_DROPDOWN:
+        return (float)param->GetDropdownIndex();
+    default:
+        assert(false);
+        return 0.f;
+    }
+}
+
+void Benchmark::SetParameterValue(ArtistParameter* const param, const float value)
+{
+    switch (param->GetDataType())
+    {
+    case ArtistParameter::APDT_FLOAT:
+    case ArtistParameter::APDT_GPU_FLOAT:
+        param->GetParameterAsFloat() = value;
+        break;
+    case ArtistParameter::APDT_INT:
+        param->GetParameterAsInt() = (int)value;
+        break;
+    case ArtistParameter::APDT_BOOL:
+        param->GetParameterAsBool() = value != 0.f;
+        break;
+    case ArtistParameter::APDT_DROPDOWN:
+        param->GetDropdownIndex() = (int)value;
+        break;
+    default:
+        assert(false);
+    }
+}
@@ -0,0 +1,125 @@
+/*=============================================================================
+ * This file is part of the "GITechDemo" application
+ * Copyright (C) Iftode Bogdan-Marius <iftode.bogdan@gmail.com>
+ *
+ *      File:   Benchmark.h
+ *      Author: Bogdan Iftode
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+=============================================================================*/
+
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+#include <string>
+#include <vector>
+#include <sstream>
+
+#include <gmtl\gmtl.h>
+using namespace gmtl;
+
+#include <Profiler.h>
+
+#include "FrameStatistics.h"
+
+namespace GITechDemoApp
+{
+    class ArtistParameter;
+
+    // Plays back a scripted camera path with per-segment parameter overrides at a fixed
+    // time step, then writes the frame statistics of every segment to "<output>.csv"
+    // and "<output>.json". Script commands, one per line ('#' starts a comment line):
+    //
+    //   warmup <frames>            Frames drawn before measuring each segment (default: 60)
+    //   frames <frames>            Frames measured per segment (default: 300, at most TimingStatistics::HISTORY_SIZE)
+    //   timestep <ms>              Fixed frame time used for updates (default: 16.667)
+    //   output <path>              Report path, without extension (default: GITechDemo_benchmark)
+    //   segment <name>             Starts a new segment, to which the following commands apply
+    //   set <parameter> <value>    Overrides an artist parameter for the segment (booleans are 0 or 1)
+    //   key <time> <px> <py> <pz> <qx> <qy> <qz> <qw>
+    //                              Camera keyframe, in seconds from the start of the measurement
+    //                              (see FormatCameraKeyframe()); the warm-up uses the first one
+    //
+    // Names containing spaces must be quoted. Parameters are restored between segments.
+    class Benchmark
+    {
+    public:
+        Benchmark();
+
+        // Returns false if the script can't be read or is malformed
+        const bool Load(const char* const scriptPath);
+
+        const bool IsRunning() const { return m_nCurrSegment < m_arrSegment.size(); }
+        const float GetTimeStep() const { return m_fTimeStep; } // in seconds
+
+        // Applies the current segment's overrides and camera; call before updating the frame
+        void Update(Vec3f& cameraPos, Matrix44f& cameraRot);
+
+        // Records the frame's statistics; call after drawing it. Writes the
+        // report and stops running after the last frame of the last segment.
+        void EndFrame();
+
+        // A "key" command for the given camera, so that paths can be recorded from within the application
+        static const std::string FormatCameraKeyframe(const float time, const Vec3f& cameraPos, const Matrix44f& cameraRot);
+
+    protected:
+        struct CameraKeyframe
+        {
+            float fTime;
+            Vec3f vPos;
+            Quatf qRot;
+        };
+
+        struct ParameterOverride
+        {
+            ArtistParameter* pParam;
+            float fValue;
+        };
+
+        struct Segment
+        {
+            std::string szName;
+            std::vector<ParameterOverride> arrOverride;
+            std::vector<CameraKeyframe> arrKeyframe;
+        };
+
+        void BeginSegment();
+        void EndSegment();
+        void RestoreParameters();
+        const bool WriteReport() const;
+
+        static const float GetParameterValue(ArtistParameter* const param);
+        static void SetParameterValue(ArtistParameter* const param, const float value);
+
+        std::vector<Segment> m_arrSegment;
+        unsigned int m_nWarmupFrameCount;
+        unsigned int m_nMeasuredFrameCount;
+        float m_fTimeStep; // in seconds
+        std::string m_szOutputPath;
+
+        unsigned int m_nCurrSegment;
+        unsigned int m_nCurrFrame; // From the start of the current segment's warm-up
+
+        // Values of the overridden parameters before the benchmark started
+        std::vector<ParameterOverride> m_arrOriginalValue;
+        bool m_bOriginalValuesSaved;
+
+        Synesthesia3D::GPUProfileMarkerSnapshot m_tGPUProfileMarkerSnapshot;
+        FrameStatistics m_tFrameStatistics;
+        std::ostringstream m_ssReportCSV;
+        std::ostringstream m_ssReportJSON;
+    };
+}
+
+#endif // BENCHMARK_H_
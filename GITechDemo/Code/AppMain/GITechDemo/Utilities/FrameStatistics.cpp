@@ -0,0 +1,351 @@
+/*=============================================================================
+ * This file is part of the "GITechDemo" application
+ * Copyright (C) Iftode Bogdan-Marius <iftode.bogdan@gmail.com>
+ *
+ *      File:   FrameStatistics.cpp
+ *      Author: Bogdan Iftode
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+=============================================================================*/
+
+#include "stdafx.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+#include <Renderer.h>
+#include <Profiler.h>
+using namespace Synesthesia3D;
+
+#include "FrameStatistics.h"
+#include "RenderPass.h"
+using namespace GITechDemoApp;
+
+// Smallest histogram bucket bound, in miliseconds
+#define HISTOGRAM_BASE_BOUND (0.125f)
+
+const unsigned int TimingStatistics::HISTORY_SIZE;
+const unsigned int TimingStatistics::HISTOGRAM_BUCKET_COUNT;
+const unsigned int TimingStatistics::STUTTER_MIN_SAMPLE_COUNT;
+const float TimingStatistics::STUTTER_THRESHOLD = 2.f;
+
+TimingStatistics::TimingStatistics()
+{
+    Reset();
+}
+
+void TimingStatistics::Reset()
+{
+    for (unsigned int i = 0; i < HISTORY_SIZE; i++)
+    {
+        m_fHistory[i] = 0.f;
+        m_bStutter[i] = false;
+    }
+
+    for (unsigned int i = 0; i < HISTOGRAM_BUCKET_COUNT; i++)
+        m_nHistogram[i] = 0;
+
+    m_nSampleCount = 0;
+    m_fSum = 0.0;
+    m_nStutterCount = 0;
+    m_nTotalStutterCount = 0;
+
+    m_arrSortedHistory.clear();
+    m_bSortedHistoryDirty = false;
+}
+
+void TimingStatistics::AddSample(const float timeMs)
+{
+    const unsigned int idx = m_nSampleCount % HISTORY_SIZE;
+    const bool isStutter = GetSampleCount() >= STUTTER_MIN_SAMPLE_COUNT && timeMs > GetMean() * STUTTER_THRESHOLD;
+
+    // Retire the sample being overwritten
+    if (m_nSampleCount >= HISTORY_SIZE)
+    {
+        m_fSum -= m_fHistory[idx];
+        m_nHistogram[GetHistogramBucketIdx(m_fHistory[idx])]--;
+        if (m_bStutter[idx])
+            m_nStutterCount--;
+    }
+
+    m_fHistory[idx] = timeMs;
+    m_bStutter[idx] = isStutter;
+    m_fSum += timeMs;
+    m_nHistogram[GetHistogramBucketIdx(timeMs)]++;
+    if (isStutter)
+    {
+        m_nStutterCount++;
+        m_nTotalStutterCount++;
+    }
+
+    m_nSampleCount++;
+    m_bSortedHistoryDirty = true;
+}
+
+const float TimingStatistics::GetLatest() const
+{
+    return m_nSampleCount ? m_fHistory[(m_nSampleCount - 1) % HISTORY_SIZE] : 0.f;
+}
+
+const float TimingStatistics::GetMean() const
+{
+    return m_nSampleCount ? (float)(m_fSum / GetSampleCount()) : 0.f;
+}
+
+const float TimingStatistics::GetMin() const
+{
+    return GetPercentile(0.f);
+}
+
+const float TimingStatistics::GetMax() const
+{
+    return GetPercentile(100.f);
+}
+
+const float TimingStatistics::GetPercentile(const float percentile) const
+{
+    if (m_nSampleCount == 0)
+        return 0.f;
+
+    SortSamples();
+
+    // Nearest-rank method
+    const unsigned int count = (unsigned int)m_arrSortedHistory.size();
+    unsigned int rank = (unsigned int)ceilf(percentile / 100.f * (float)count);
+    if (rank < 1)
+        rank = 1;
+    if (rank > count)
+        rank = count;
+
+    return m_arrSortedHistory[rank - 1];
+}
+
+const float TimingStatistics::GetHistogramBucketLowerBound(const unsigned int bucket)
+{
+    return bucket ? HISTOGRAM_BASE_BOUND * (float)(1u << bucket) : 0.f;
+}
+
+const unsigned int TimingStatistics::GetHistogramBucketIdx(const float timeMs)
+{
+    if (timeMs < HISTOGRAM_BASE_BOUND * 2.f)
+        return 0;
+
+    const unsigned int bucket = (unsigned int)floorf(log2f(timeMs / HISTOGRAM_BASE_BOUND));
+    return bucket < HISTOGRAM_BUCKET_COUNT ? bucket : HISTOGRAM_BUCKET_COUNT - 1;
+}
+
+void TimingStatistics::SortSamples() const
+{
+    if (!m_bSortedHistoryDirty)
+        return;
+
+    m_arrSortedHistory.assign(m_fHistory, m_fHistory + GetSampleCount());
+    std::sort(m_arrSortedHistory.begin(), m_arrSortedHistory.end());
+    m_bSortedHistoryDirty = false;
+}
+
+FrameStatistics::FrameStatistics()
+    : m_nLastFrameTimestamp(0)
+    , m_fLastGPUFrameStart(0.f)
+{}
+
+void FrameStatistics::AddFrame(const GPUProfileMarkerSnapshot& snapshot, const RenderPass& rootPass)
+{
+    // Measured between calls instead of using the frame's delta time, which can be fixed
+    const long long now = Profiler::GetCPUTimestamp();
+    if (m_nLastFrameTimestamp)
+        AddCPUFrameTime((float)(now - m_nLastFrameTimestamp) / 1000000.f);
+    m_nLastFrameTimestamp = now;
+
+    for (unsigned int i = 0; i < (unsigned int)rootPass.GetChildren().size(); i++)
+        AddPassCPUTimes(*rootPass.GetChildren()[i]);
+
+    if (Renderer::GetInstance())
+        AddFrameCounters(Renderer::GetInstance()->GetFrameCounters());
+
+    // GPU results lag behind by a few frames and aren't always updated every frame,
+    // so only record them once per resolved frame, so that none are counted twice
+    const GPUProfileMarkerSample* const rootMarker = snapshot.Find(rootPass.GetProfileMarkerId());
+    if (!rootMarker || rootMarker->fStart == m_fLastGPUFrameStart)
+        return;
+
+    m_fLastGPUFrameStart = rootMarker->fStart;
+    AddGPUFrameTime(rootMarker->fTiming);
+
+    // Only attribute results belonging to the same frame as the root pass
+    const std::vector<GPUProfileMarkerSample>& samples = snapshot.GetSamples();
+    for (unsigned int i = 0; i < (unsigned int)samples.size(); i++)
+    {
+        if (samples[i].nMarkerId != rootMarker->nMarkerId && samples[i].fStart >= rootMarker->fStart && samples[i].fEnd <= rootMarker->fEnd)
+            AddPassGPUTime(samples[i].nMarkerId, samples[i].szLabel, samples[i].fTiming);
+    }
+}
+
+void FrameStatistics::AddPassCPUTimes(const RenderPass& pass)
+{
+    // Passes pruned by the render graph keep the time of the last frame they were active in
+    if (!pass.IsActive() || pass.GetProfileMarkerId() == ~0u)
+        return;
+
+    AddPassCPUTime(pass.GetProfileMarkerId(), pass.GetPassName(), pass.GetCPUTime());
+
+    for (unsigned int i = 0; i < (unsigned int)pass.GetChildren().size(); i++)
+        AddPassCPUTimes(*pass.GetChildren()[i]);
+}
+
+FrameStatistics::PassStatistics& FrameStatistics::GetPassStatistics(const unsigned int passId, const char* const passName)
+{
+    PassStatistics& pass = m_mapPassTime[passId];
+    if (pass.szName.empty())
+        pass.szName = passName;
+
+    return pass;
+}
+
+void FrameStatistics::AddPassCPUTime(const unsigned int passId, const char* const passName, const float timeMs)
+{
+    GetPassStatistics(passId, passName).tCPUTime.AddSample(timeMs);
+}
+
+void FrameStatistics::AddPassGPUTime(const unsigned int passId, const char* const passName, const float timeMs)
+{
+    GetPassStatistics(passId, passName).tGPUTime.AddSample(timeMs);
+}
+
+void FrameStatistics::AddFrameCounters(const RenderCounters& counters)
+{
+    for (unsigned int i = 0; i < RC_MAX; i++)
+        m_tFrameCounter[i].AddSample((float)counters.nCount[i]);
+}
+
+void FrameStatistics::Reset()
+{
+    m_tCPUFrameTime.Reset();
+    m_tGPUFrameTime.Reset();
+    m_mapPassTime.clear();
+
+    for (unsigned int i = 0; i < RC_MAX; i++)
+        m_tFrameCounter[i].Reset();
+}
+
+const TimingStatistics* const FrameStatistics::GetPassCPUTime(const unsigned int passId) const
+{
+    std::map<unsigned int, PassStatistics>::const_iterator iter = m_mapPassTime.find(passId);
+    return iter != m_mapPassTime.end() && iter->second.tCPUTime.GetSampleCount() ? &iter->second.tCPUTime : nullptr;
+}
+
+const TimingStatistics* const FrameStatistics::GetPassGPUTime(const unsigned int passId) const
+{
+    std::map<unsigned int, PassStatistics>::const_iterator iter = m_mapPassTime.find(passId);
+    return iter != m_mapPassTime.end() && iter->second.tGPUTime.GetSampleCount() ? &iter->second.tGPUTime : nullptr;
+}
+
+static void WriteTimingStatisticsJSON(std::ostream& stream, const TimingStatistics& stats)
+{
+    stream << "{\"samples\":" << stats.GetSampleCount()
+        << ",\"mean\":" << stats.GetMean()
+        << ",\"min\":" << stats.GetMin()
+        << ",\"max\":" << stats.GetMax()
+        << ",\"p50\":" << stats.GetPercentile(50.f)
+        << ",\"p95\":" << stats.GetPercentile(95.f)
+        << ",\"p99\":" << stats.GetPercentile(99.f)
+        << ",\"stutters\":" << stats.GetStutterCount()
+        << ",\"total_stutters\":" << stats.GetTotalStutterCount()
+        << ",\"histogram\":[";
+
+    for (unsigned int i = 0; i < TimingStatistics::HISTOGRAM_BUCKET_COUNT; i++)
+    {
+        stream << (i ? "," : "") << "{\"min\":" << TimingStatistics::GetHistogramBucketLowerBound(i)
+            << ",\"count\":" << stats.GetHistogramBucket(i) << "}";
+    }
+
+    stream << "]}";
+}
+
+void FrameStatistics::WriteJSON(std::ostream& stream) const
+{
+    // All timings are in miliseconds
+    stream << "{\n\"cpu_frame\":";
+    WriteTimingStatisticsJSON(stream, m_tCPUFrameTime);
+    stream << ",\n\"gpu_frame\":";
+    WriteTimingStatisticsJSON(stream, m_tGPUFrameTime);
+    stream << ",\n\"passes\":{";
+
+    for (std::map<unsigned int, PassStatistics>::const_iterator iter = m_mapPassTime.begin(); iter != m_mapPassTime.end(); iter++)
+    {
+        // Pass names don't contain characters that need escaping
+        stream << (iter == m_mapPassTime.begin() ? "\n" : ",\n") << "\"" << iter->second.szName << "\":{\"cpu\":";
+        WriteTimingStatisticsJSON(stream, iter->second.tCPUTime);
+        stream << ",\"gpu\":";
+        WriteTimingStatisticsJSON(stream, iter->second.tGPUTime);
+        stream << "}";
+    }
+
+    // Counters are per frame, in units
+    stream << "\n},\n\"counters\":{";
+
+    for (unsigned int i = 0; i < RC_MAX; i++)
+    {
+        stream << (i ? ",\n" : "\n") << "\"" << Renderer::GetEnumString((RenderCounter)i) << "\":";
+        WriteTimingStatisticsJSON(stream, m_tFrameCounter[i]);
+    }
+
+    stream << "\n}\n}";
+}
+
+static void WriteTimingStatisticsCSV(std::ostream& stream, const std::string& rowPrefix, const char* const timing, const char* const passName, const TimingStatistics& stats)
+{
+    if (stats.GetSampleCount() == 0)
+        return;
+
+    stream << rowPrefix << timing << "," << passName << ","
+        << stats.GetSampleCount() << ","
+        << stats.GetMean() << ","
+        << stats.GetMin() << ","
+        << stats.GetMax() << ","
+        << stats.GetPercentile(50.f) << ","
+        << stats.GetPercentile(95.f) << ","
+        << stats.GetPercentile(99.f) << ","
+        << stats.GetStutterCount() << "\n";
+}
+
+void FrameStatistics::WriteCSVHeader(std::ostream& stream, const std::string& headerPrefix)
+{
+    stream << headerPrefix << "timing,pass,samples,mean_ms,min_ms,max_ms,p50_ms,p95_ms,p99_ms,stutters\n";
+}
+
+void FrameStatistics::WriteCSV(std::ostream& stream, const std::string& rowPrefix) const
+{
+    WriteTimingStatisticsCSV(stream, rowPrefix, "cpu_frame", "", m_tCPUFrameTime);
+    WriteTimingStatisticsCSV(stream, rowPrefix, "gpu_frame", "", m_tGPUFrameTime);
+
+    for (std::map<unsigned int, PassStatistics>::const_iterator iter = m_mapPassTime.begin(); iter != m_mapPassTime.end(); iter++)
+    {
+        WriteTimingStatisticsCSV(stream, rowPrefix, "cpu_pass", iter->second.szName.c_str(), iter->second.tCPUTime);
+        WriteTimingStatisticsCSV(stream, rowPrefix, "gpu_pass", iter->second.szName.c_str(), iter->second.tGPUTime);
+    }
+}
+
+const bool FrameStatistics::Dump(const char* const filePath) const
+{
+    std::ofstream file(filePath, std::ios::out | std::ios::trunc);
+    if (!file.is_open())
+        return false;
+
+    WriteJSON(file);
+    file << "\n";
+
+    return file.good();
+}
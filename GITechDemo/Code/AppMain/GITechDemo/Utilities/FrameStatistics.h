@@ -0,0 +1,154 @@
+/*=============================================================================
+ * This file is part of the "GITechDemo" application
+ * Copyright (C) Iftode Bogdan-Marius <iftode.bogdan@gmail.com>
+ *
+ *      File:   FrameStatistics.h
+ *      Author: Bogdan Iftode
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+=============================================================================*/
+
+#ifndef FRAME_STATISTICS_H_
+#define FRAME_STATISTICS_H_
+
+#include <map>
+#include <string>
+#include <vector>
+#include <ostream>
+
+#include <ResourceData.h>
+
+namespace Synesthesia3D
+{
+    class GPUProfileMarkerSnapshot;
+}
+
+namespace GITechDemoApp
+{
+    class RenderPass;
+
+    // Rolling statistics over the last HISTORY_SIZE samples of a timing, in miliseconds.
+    // Adding a sample is O(1) and never allocates; percentiles are computed on demand
+    // and cached until the next sample is added.
+    class TimingStatistics
+    {
+    public:
+        static const unsigned int HISTORY_SIZE = 1024;
+        static const unsigned int HISTOGRAM_BUCKET_COUNT = 16;
+        static const unsigned int STUTTER_MIN_SAMPLE_COUNT = 30; // Don't detect stutters until the rolling mean has settled
+
+        TimingStatistics();
+
+        void AddSample(const float timeMs);
+        void Reset();
+
+        const unsigned int GetSampleCount() const { return m_nSampleCount < HISTORY_SIZE ? m_nSampleCount : HISTORY_SIZE; }
+        const float GetLatest() const;
+        const float GetMean() const;
+        const float GetMin() const;
+        const float GetMax() const;
+        const float GetPercentile(const float percentile) const; // percentile in [0, 100]
+
+        // A stutter is a sample more than STUTTER_THRESHOLD times the rolling mean at the time it was added
+        const unsigned int GetStutterCount() const { return m_nStutterCount; } // Within the history
+        const unsigned int GetTotalStutterCount() const { return m_nTotalStutterCount; } // Since the last reset
+
+        // Bucket i counts the samples in [GetHistogramBucketLowerBound(i), GetHistogramBucketLowerBound(i + 1)).
+        // Bounds double with every bucket; the first and last buckets are open-ended.
+        const unsigned int GetHistogramBucket(const unsigned int bucket) const { return m_nHistogram[bucket]; }
+        static const float GetHistogramBucketLowerBound(const unsigned int bucket);
+
+        // Ring buffer of the samples, oldest at GetHistoryOffset() (e.g. for ImGui::PlotLines())
+        const float* const GetHistory() const { return m_fHistory; }
+        const unsigned int GetHistoryOffset() const { return m_nSampleCount < HISTORY_SIZE ? 0 : m_nSampleCount % HISTORY_SIZE; }
+
+        static const float STUTTER_THRESHOLD;
+
+    protected:
+        static const unsigned int GetHistogramBucketIdx(const float timeMs);
+
+        void SortSamples() const;
+
+        float           m_fHistory[HISTORY_SIZE];
+        bool            m_bStutter[HISTORY_SIZE];
+        unsigned int    m_nHistogram[HISTOGRAM_BUCKET_COUNT];
+        unsigned int    m_nSampleCount; // Since the last reset
+        double          m_fSum;         // Of the samples in the history
+        unsigned int    m_nStutterCount;
+        unsigned int    m_nTotalStutterCount;
+
+        mutable std::vector<float>  m_arrSortedHistory;
+        mutable bool                m_bSortedHistoryDirty;
+    };
+
+    // Tracks CPU and GPU frame times, the CPU and GPU times of every render pass
+    // and the renderer's counters (stored as TimingStatistics samples, in units instead of miliseconds)
+    class FrameStatistics
+    {
+    public:
+        FrameStatistics();
+
+        // Records the CPU time since the last call, the CPU time of every active pass,
+        // the renderer's counters of the last frame and, once per resolved GPU frame,
+        // the GPU times from the profiler
+        void AddFrame(const Synesthesia3D::GPUProfileMarkerSnapshot& snapshot, const RenderPass& rootPass);
+
+        void AddCPUFrameTime(const float timeMs) { m_tCPUFrameTime.AddSample(timeMs); }
+        void AddGPUFrameTime(const float timeMs) { m_tGPUFrameTime.AddSample(timeMs); }
+        void AddPassCPUTime(const unsigned int passId, const char* const passName, const float timeMs);
+        void AddPassGPUTime(const unsigned int passId, const char* const passName, const float timeMs);
+        void AddFrameCounters(const Synesthesia3D::RenderCounters& counters);
+
+        // Clears all samples; the next frame's CPU time is still measured from the last AddFrame() call
+        void Reset();
+
+        const TimingStatistics& GetCPUFrameTime() const { return m_tCPUFrameTime; }
+        const TimingStatistics& GetGPUFrameTime() const { return m_tGPUFrameTime; }
+        const TimingStatistics* const GetPassCPUTime(const unsigned int passId) const; // nullptr if there are no samples
+        const TimingStatistics* const GetPassGPUTime(const unsigned int passId) const; // nullptr if there are no samples
+        const TimingStatistics& GetFrameCounter(const Synesthesia3D::RenderCounter counter) const { return m_tFrameCounter[counter]; }
+
+        // Writes all statistics as a JSON object, for automated processing
+        void WriteJSON(std::ostream& stream) const;
+
+        // Writes one CSV row per timing, each starting with the given columns (e.g. "name,")
+        void WriteCSV(std::ostream& stream, const std::string& rowPrefix) const;
+        static void WriteCSVHeader(std::ostream& stream, const std::string& headerPrefix);
+
+        // Writes all statistics to a JSON file
+        const bool Dump(const char* const filePath) const;
+
+    protected:
+        void AddPassCPUTimes(const RenderPass& pass);
+
+        struct PassStatistics
+        {
+            std::string         szName;
+            TimingStatistics    tCPUTime;
+            TimingStatistics    tGPUTime;
+        };
+
+        PassStatistics& GetPassStatistics(const unsigned int passId, const char* const passName);
+
+        TimingStatistics                        m_tCPUFrameTime;
+        TimingStatistics                        m_tGPUFrameTime;
+        std::map<unsigned int, PassStatistics>  m_mapPassTime;  // Keyed by the pass' profile marker ID
+        TimingStatistics                        m_tFrameCounter[Synesthesia3D::RC_MAX];
+
+        long long   m_nLastFrameTimestamp;  // CPU timestamp of the last AddFrame() call
+        float       m_fLastGPUFrameStart;   // Start of the last recorded GPU frame, to skip stale results
+    };
+}
+
+#endif // FRAME_STATISTICS_H_
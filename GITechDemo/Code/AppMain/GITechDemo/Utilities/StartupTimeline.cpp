@@ -0,0 +1,300 @@
+/*=============================================================================
+ * This file is part of the "GITechDemo" application
+ * Copyright (C) Iftode Bogdan-Marius <iftode.bogdan@gmail.com>
+ *
+ *      File:   StartupTimeline.cpp
+ *      Author: Bogdan Iftode
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+=============================================================================*/
+
+#include "stdafx.h"
+
+#include <iomanip>
+#include <map>
+
+#include <Renderer.h>
+#include <ResourceManager.h>
+#include <Profiler.h>
+using namespace Synesthesia3D;
+
+#include "StartupTimeline.h"
+using namespace GITechDemoApp;
+
+#define NS_TO_MS(ns) ((double)(ns) / 1000000.0)
+
+StartupTimeline::StartupTimeline()
+    : m_nStartTime(0)
+    , m_nEndTime(0)
+    , m_nFinishedThreadCount(0)
+{
+    MUTEX_INIT(m_tMutex);
+}
+
+StartupTimeline::~StartupTimeline()
+{
+    MUTEX_DESTROY(m_tMutex);
+}
+
+void StartupTimeline::Begin()
+{
+    MUTEX_LOCK(m_tMutex);
+    m_arrEntry.clear();
+    m_nStartTime = Profiler::GetCPUTimestamp();
+    m_nEndTime = 0;
+    m_nFinishedThreadCount = 0;
+    MUTEX_UNLOCK(m_tMutex);
+}
+
+const long long StartupTimeline::BeginEntry()
+{
+    ResourceManager::GetThreadLoadTimings().Reset();
+    return Profiler::GetCPUTimestamp();
+}
+
+const StartupTimeline::Entry StartupTimeline::EndEntry(
+    const unsigned int threadIdx, const char* const name, const char* const type, const long long startTime,
+    const long long creationTime, const std::thread::id creationThreadId, const bool waitsForAll)
+{
+    Entry entry;
+    entry.szName = name;
+    entry.szType = type;
+    entry.nThreadIdx = threadIdx;
+    entry.tThreadId = std::this_thread::get_id();
+    entry.nStartTime = startTime;
+    entry.nEndTime = Profiler::GetCPUTimestamp();
+    entry.bWaitsForAll = waitsForAll;
+    entry.tPhases = ResourceManager::GetThreadLoadTimings();
+
+    // Resources created before the load started were ready as soon as it started
+    entry.nCreationTime = creationTime > m_nStartTime ? creationTime : 0;
+    entry.tCreationThreadId = creationThreadId;
+    entry.nReadyTime = entry.nCreationTime ? entry.nCreationTime : m_nStartTime;
+    if (entry.nReadyTime > entry.nStartTime)
+        entry.nReadyTime = entry.nStartTime;
+
+    MUTEX_LOCK(m_tMutex);
+    m_arrEntry.push_back(entry);
+    MUTEX_UNLOCK(m_tMutex);
+
+    return entry;
+}
+
+const bool StartupTimeline::EndThread(const unsigned int threadCount)
+{
+    if (++m_nFinishedThreadCount < threadCount)
+        return false;
+
+    MUTEX_LOCK(m_tMutex);
+    m_nEndTime = Profiler::GetCPUTimestamp();
+    MUTEX_UNLOCK(m_tMutex);
+
+    return true;
+}
+
+const unsigned int StartupTimeline::FindPredecessor(const unsigned int entryIdx) const
+{
+    // The entry that, by ending, allowed this one to start: the previous entry on the same thread,
+    // the entry during which this resource was created, or the last entry of all, for barriers.
+    // When several of them apply, the one that ended last gated the start.
+    const Entry& entry = m_arrEntry[entryIdx];
+    unsigned int predecessorIdx = ~0u;
+    long long predecessorEnd = 0;
+
+    for (unsigned int i = 0; i < m_arrEntry.size(); i++)
+    {
+        const Entry& other = m_arrEntry[i];
+        if (i == entryIdx || other.nEndTime > entry.nStartTime)
+            continue;
+
+        const bool previousOnThread = other.nThreadIdx == entry.nThreadIdx;
+        const bool creator =
+            entry.nCreationTime != 0 && other.tThreadId == entry.tCreationThreadId &&
+            other.nStartTime <= entry.nCreationTime && other.nEndTime >= entry.nCreationTime;
+
+        if ((previousOnThread || creator || entry.bWaitsForAll) && other.nEndTime > predecessorEnd)
+        {
+            predecessorIdx = i;
+            predecessorEnd = other.nEndTime;
+        }
+    }
+
+    return predecessorIdx;
+}
+
+void StartupTimeline::FindCriticalPath(std::vector<unsigned int>& criticalPath) const
+{
+    criticalPath.clear();
+
+    unsigned int entryIdx = ~0u;
+    for (unsigned int i = 0; i < m_arrEntry.size(); i++)
+        if (entryIdx == ~0u || m_arrEntry[i].nEndTime > m_arrEntry[entryIdx].nEndTime)
+            entryIdx = i;
+
+    while (entryIdx != ~0u)
+    {
+        criticalPath.insert(criticalPath.begin(), entryIdx);
+        entryIdx = FindPredecessor(entryIdx);
+    }
+}
+
+void StartupTimeline::WritePhases(std::ostream& stream, const ResourceLoadTimings& phases, const long long duration)
+{
+    long long other = duration;
+    for (unsigned int phase = 0; phase < RLP_MAX; phase++)
+    {
+        if (phases.nTime[phase] == 0)
+            continue;
+
+        stream << Renderer::GetEnumString((ResourceLoadPhase)phase) << " " << NS_TO_MS(phases.nTime[phase]) << "ms, ";
+        other -= phases.nTime[phase];
+    }
+
+    stream << "other " << NS_TO_MS(other > 0 ? other : 0) << "ms";
+}
+
+void StartupTimeline::WriteEntry(std::ostream& stream, const Entry& entry)
+{
+    const std::ios::fmtflags flags = stream.flags();
+    const std::streamsize precision = stream.precision();
+    stream << std::fixed << std::setprecision(3);
+
+    stream << "Thread " << entry.nThreadIdx << " - " << entry.szType << ": \"" << entry.szName << "\"";
+    stream << " loaded in " << NS_TO_MS(entry.GetDuration()) << "ms";
+    stream << " (queued " << NS_TO_MS(entry.GetQueueWait()) << "ms; ";
+    WritePhases(stream, entry.tPhases, entry.GetDuration());
+    stream << ")\n";
+
+    stream.flags(flags);
+    stream.precision(precision);
+}
+
+void StartupTimeline::WriteReport(std::ostream& stream) const
+{
+    MUTEX_LOCK(m_tMutex);
+
+    const std::ios::fmtflags flags = stream.flags();
+    const std::streamsize precision = stream.precision();
+    stream << std::fixed << std::setprecision(3);
+
+    long long loadEnd = m_nEndTime;
+    for (unsigned int i = 0; i < m_arrEntry.size(); i++)
+        if (m_arrEntry[i].nEndTime > loadEnd)
+            loadEnd = m_arrEntry[i].nEndTime;
+    const long long loadTime = loadEnd - m_nStartTime;
+
+    stream << "\n[STARTUP TIMELINE]\n";
+    stream << "Loaded " << m_arrEntry.size() << " resources in " << NS_TO_MS(loadTime) << "ms\n";
+
+    // Totals per phase, over all threads
+    ResourceLoadTimings totalPhases;
+    long long totalDuration = 0, totalQueueWait = 0, maxQueueWait = 0;
+    unsigned long long totalBytesRead = 0;
+    std::map<std::string, std::pair<unsigned int, ResourceLoadTimings>> typePhases;
+    std::map<std::string, long long> typeDuration;
+    for (unsigned int i = 0; i < m_arrEntry.size(); i++)
+    {
+        const Entry& entry = m_arrEntry[i];
+        std::pair<unsigned int, ResourceLoadTimings>& type = typePhases[entry.szType];
+        type.first++;
+        for (unsigned int phase = 0; phase < RLP_MAX; phase++)
+        {
+            totalPhases.nTime[phase] += entry.tPhases.nTime[phase];
+            type.second.nTime[phase] += entry.tPhases.nTime[phase];
+        }
+        typeDuration[entry.szType] += entry.GetDuration();
+        totalDuration += entry.GetDuration();
+        totalQueueWait += entry.GetQueueWait();
+        if (entry.GetQueueWait() > maxQueueWait)
+            maxQueueWait = entry.GetQueueWait();
+        totalBytesRead += entry.tPhases.nBytesRead;
+    }
+
+    stream << "Summed over all threads: " << NS_TO_MS(totalDuration) << "ms (";
+    WritePhases(stream, totalPhases, totalDuration);
+    stream << ")\n";
+    stream << "Read " << totalBytesRead / 1024 << "KB";
+    if (totalPhases.nTime[RLP_IO] > 0)
+        stream << " at " << (double)totalBytesRead / 1048576.0 / ((double)totalPhases.nTime[RLP_IO] / 1000000000.0) << "MB/s";
+    stream << "\n";
+    if (!m_arrEntry.empty())
+        stream << "Queue wait: average " << NS_TO_MS(totalQueueWait / (long long)m_arrEntry.size()) << "ms, max " << NS_TO_MS(maxQueueWait) << "ms\n";
+
+    stream << "\nPer resource type:\n";
+    for (std::map<std::string, std::pair<unsigned int, ResourceLoadTimings>>::const_iterator iter = typePhases.begin(); iter != typePhases.end(); iter++)
+    {
+        stream << "  " << iter->first << " x" << iter->second.first << ": " << NS_TO_MS(typeDuration[iter->first]) << "ms (";
+        WritePhases(stream, iter->second.second, typeDuration[iter->first]);
+        stream << ")\n";
+    }
+
+    // The critical path is what the load time is made of; speeding up anything else won't shorten it
+    std::vector<unsigned int> criticalPath;
+    FindCriticalPath(criticalPath);
+
+    ResourceLoadTimings criticalPhases;
+    long long criticalDuration = 0;
+    stream << "\nCritical path (" << criticalPath.size() << " entries):\n";
+    for (unsigned int i = 0; i < criticalPath.size(); i++)
+    {
+        const Entry& entry = m_arrEntry[criticalPath[i]];
+        stream << "  +" << NS_TO_MS(entry.nStartTime - m_nStartTime) << "ms ";
+        WriteEntry(stream, entry);
+
+        for (unsigned int phase = 0; phase < RLP_MAX; phase++)
+            criticalPhases.nTime[phase] += entry.tPhases.nTime[phase];
+        criticalDuration += entry.GetDuration();
+    }
+
+    stream << "Critical path: " << NS_TO_MS(criticalDuration) << "ms busy (";
+    WritePhases(stream, criticalPhases, criticalDuration);
+    stream << "), " << NS_TO_MS(loadTime - criticalDuration > 0 ? loadTime - criticalDuration : 0) << "ms waiting\n";
+
+    unsigned int bottleneck = RLP_MAX;
+    for (unsigned int phase = 0; phase < RLP_MAX; phase++)
+        if (criticalPhases.nTime[phase] > 0 && (bottleneck == RLP_MAX || criticalPhases.nTime[phase] > criticalPhases.nTime[bottleneck]))
+            bottleneck = phase;
+    if (bottleneck != RLP_MAX)
+        stream << "Bottleneck: " << Renderer::GetEnumString((ResourceLoadPhase)bottleneck)
+            << " (" << (criticalDuration > 0 ? 100.0 * criticalPhases.nTime[bottleneck] / criticalDuration : 0.0) << "% of the critical path)\n";
+
+    // Time spent loading vs. time spent polling for work, per thread
+    unsigned int threadCount = 0;
+    for (unsigned int i = 0; i < m_arrEntry.size(); i++)
+        if (m_arrEntry[i].nThreadIdx + 1 > threadCount)
+            threadCount = m_arrEntry[i].nThreadIdx + 1;
+
+    stream << "\nThread utilization:\n";
+    for (unsigned int thread = 0; thread < threadCount; thread++)
+    {
+        unsigned int entryCount = 0;
+        long long busy = 0;
+        for (unsigned int i = 0; i < m_arrEntry.size(); i++)
+        {
+            if (m_arrEntry[i].nThreadIdx == thread)
+            {
+                entryCount++;
+                busy += m_arrEntry[i].GetDuration();
+            }
+        }
+
+        stream << "  Thread " << thread << ": " << entryCount << " resources, " << NS_TO_MS(busy) << "ms busy, "
+            << (loadTime > 0 ? 100.0 * busy / loadTime : 0.0) << "% utilization\n";
+    }
+
+    stream.flags(flags);
+    stream.precision(precision);
+
+    MUTEX_UNLOCK(m_tMutex);
+}
@@ -0,0 +1,101 @@
+/*=============================================================================
+ * This file is part of the "GITechDemo" application
+ * Copyright (C) Iftode Bogdan-Marius <iftode.bogdan@gmail.com>
+ *
+ *      File:   StartupTimeline.h
+ *      Author: Bogdan Iftode
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+=============================================================================*/
+
+#ifndef STARTUP_TIMELINE_H_
+#define STARTUP_TIMELINE_H_
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <ostream>
+
+#include <ResourceData.h>
+
+#include <Utility/Mutex.h>
+
+namespace GITechDemoApp
+{
+    // Records every resource initialized by the loader threads: which thread loaded it, how long
+    // it waited to be picked up and how its load time splits into I/O, decompression, deserialization,
+    // shader compilation and GPU upload (see Synesthesia3D::ResourceLoadPhase). Once all loader threads
+    // are done, it reports the critical path of the load and the utilization of every loader thread.
+    class StartupTimeline
+    {
+    public:
+        struct Entry
+        {
+            std::string     szName;
+            std::string     szType;
+            unsigned int    nThreadIdx;
+            std::thread::id tThreadId;
+            long long       nReadyTime;         // When the entry could have started: the start of the load or, for resources created while loading, their creation
+            long long       nStartTime;
+            long long       nEndTime;
+            long long       nCreationTime;      // 0 if the resource was created before the load started
+            std::thread::id tCreationThreadId;
+            bool            bWaitsForAll;       // Can only start after all other entries are done (e.g. RenderScheme::AllocateResources())
+
+            Synesthesia3D::ResourceLoadTimings tPhases;
+
+            const long long GetDuration() const { return nEndTime - nStartTime; }
+            const long long GetQueueWait() const { return nStartTime - nReadyTime; }
+        };
+
+        StartupTimeline();
+        ~StartupTimeline();
+
+        // Marks the start of the load, before the loader threads are started
+        void Begin();
+
+        // Called by the loader threads around each entry; BeginEntry() returns the entry's start time
+        const long long BeginEntry();
+        const Entry EndEntry(
+            const unsigned int threadIdx, const char* const name, const char* const type, const long long startTime,
+            const long long creationTime = 0, const std::thread::id creationThreadId = std::thread::id(), const bool waitsForAll = false);
+
+        // Called by every loader thread when it's done; returns true for the last one, after which the report is complete
+        const bool EndThread(const unsigned int threadCount);
+
+        const std::vector<Entry>& GetEntries() const { return m_arrEntry; }
+
+        // Human readable report: totals per phase and per resource type, the critical path and per-thread utilization
+        void WriteReport(std::ostream& stream) const;
+
+        // Single line summary of an entry, for logging progress
+        static void WriteEntry(std::ostream& stream, const Entry& entry);
+
+    protected:
+        // Indices of the entries on the critical path, from the first one to the one that ended last
+        void FindCriticalPath(std::vector<unsigned int>& criticalPath) const;
+        const unsigned int FindPredecessor(const unsigned int entryIdx) const;
+
+        static void WritePhases(std::ostream& stream, const Synesthesia3D::ResourceLoadTimings& phases, const long long duration);
+
+        std::vector<Entry>          m_arrEntry;
+        long long                   m_nStartTime;
+        long long                   m_nEndTime;
+        std::atomic<unsigned int>   m_nFinishedThreadCount;
+        mutable MUTEX               m_tMutex;
+    };
+}
+
+#endif // STARTUP_TIMELINE_H_
@@ -0,0 +1,417 @@
+/*=============================================================================
+ * This file is part of the "GITechDemo" application
+ * Copyright (C) Iftode Bogdan-Marius <iftode.bogdan@gmail.com>
+ *
+ *      File:   TextureStreamer.cpp
+ *      Author: Bogdan Iftode
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+=============================================================================*/
+
+#include "stdafx.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <map>
+
+#include <Renderer.h>
+#include <ResourceManager.h>
+#include <Texture.h>
+#include <VertexFormat.h>
+#include <VertexBuffer.h>
+#include <Profiler.h>
+using namespace Synesthesia3D;
+
+#include <Utility/FrameAllocator.h>
+
+#include "Framework.h"
+using namespace AppFramework;
+
+#include "TextureStreamer.h"
+#include "AppResources.h"
+using namespace GITechDemoApp;
+
+// Limit the number of files being read ahead and the number of textures recreated in a single frame
+#define MAX_PENDING_REQUESTS    (4u)
+#define MAX_UPLOADS_PER_FRAME   (2u)
+
+#define MB_TO_BYTES(mb) ((long long)(mb) * 1024ll * 1024ll)
+
+namespace GITechDemoApp
+{
+    // Higher priority for the textures which are the furthest from their demanded size
+    static bool CompareStreamingPriority(const std::pair<float, unsigned int>& lhs, const std::pair<float, unsigned int>& rhs)
+    {
+        return lhs.first > rhs.first;
+    }
+}
+
+TextureStreamer::TextureStreamer()
+    : m_nPendingCount(0)
+    , m_nResidentBytes(0)
+    , m_nPendingBytes(0)
+    , m_nFrameIdx(0)
+    , m_bStarted(false)
+    , m_bQuit(false)
+{}
+
+TextureStreamer::~TextureStreamer()
+{
+    Stop();
+}
+
+void TextureStreamer::Start()
+{
+    if (m_bStarted)
+        return;
+
+    GatherTextures();
+
+    m_bQuit = false;
+    m_tThread = std::thread(&TextureStreamer::StreamingThread, this);
+    m_bStarted = true;
+}
+
+void TextureStreamer::Stop()
+{
+    if (!m_bStarted)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_tMutex);
+        m_bQuit = true;
+    }
+    m_tRequestQueued.notify_all();
+
+    if (m_tThread.joinable())
+        m_tThread.join();
+
+    for (unsigned int i = 0; i < m_arrQueued.size(); i++)
+        delete m_arrQueued[i];
+    m_arrQueued.clear();
+
+    for (unsigned int i = 0; i < m_arrCompleted.size(); i++)
+        delete m_arrCompleted[i];
+    m_arrCompleted.clear();
+
+    m_arrTexture.clear();
+    m_arrMeshBounds.clear();
+    m_nPendingCount = 0;
+    m_nPendingBytes = 0;
+    m_nResidentBytes = 0;
+    m_bStarted = false;
+}
+
+void TextureStreamer::GatherTextures()
+{
+    Renderer* RenderContext = Renderer::GetInstance();
+    ResourceManager* ResMgr = RenderContext ? RenderContext->GetResourceManager() : nullptr;
+    if (!ResMgr)
+        return;
+
+    std::map<unsigned int, unsigned int> mapStreamedTexIdx;
+
+    const vector<RenderResource*>& resList = RenderResource::GetResourceList();
+    for (unsigned int res = 0; res < resList.size(); res++)
+    {
+        if (!resList[res] || resList[res]->GetResourceType() != RenderResource::RES_MODEL || !resList[res]->IsInitialized())
+            continue;
+
+        GITechDemoApp::Model* const model = (GITechDemoApp::Model*)resList[res];
+        const Synesthesia3D::Model* const s3dModel = model->GetModel();
+        if (!s3dModel)
+            continue;
+
+        for (unsigned int mesh = 0; mesh < s3dModel->arrMesh.size(); mesh++)
+        {
+            MeshBounds bounds;
+
+            // Bounding sphere of the mesh's AABB
+            const VertexBuffer* const vb = s3dModel->arrMesh[mesh]->pVertexBuffer;
+            Vec3f vMin(FLT_MAX, FLT_MAX, FLT_MAX), vMax(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+            for (unsigned int vert = 0; vert < vb->GetElementCount(); vert++)
+            {
+                const Vec3f vertPos = vb->Position<Vec3f>(vert);
+                for (unsigned int axis = 0; axis < 3; axis++)
+                {
+                    vMin[axis] = Math::Min(vMin[axis], vertPos[axis]);
+                    vMax[axis] = Math::Max(vMax[axis], vertPos[axis]);
+                }
+            }
+
+            if (vb->GetElementCount() == 0)
+                continue;
+
+            bounds.vCenter = (vMin + vMax) * 0.5f;
+            bounds.fRadius = length(Vec3f(vMax - vMin)) * 0.5f;
+
+            for (unsigned int tt = Synesthesia3D::Model::TextureDesc::TT_NONE; tt < Synesthesia3D::Model::TextureDesc::TT_UNKNOWN; tt++)
+            {
+                const unsigned int texIdx = model->GetTexture((Synesthesia3D::Model::TextureDesc::TextureType)tt, s3dModel->arrMesh[mesh]->nMaterialIdx);
+                Synesthesia3D::Texture* const tex = texIdx != ~0u ? ResMgr->GetTexture(texIdx) : nullptr;
+                if (!tex)
+                    continue;
+
+                std::map<unsigned int, unsigned int>::const_iterator iter = mapStreamedTexIdx.find(texIdx);
+                if (iter == mapStreamedTexIdx.end())
+                {
+                    StreamedTexture streamedTex;
+                    streamedTex.nTexIdx = texIdx;
+                    streamedTex.szFilePath = tex->GetSourceFileName();
+                    streamedTex.nFullSize = GetResidentSize(texIdx) << tex->GetSkippedMipCount();
+                    streamedTex.nDemandSize = GetResidentSize(texIdx);
+                    streamedTex.nLastUsedFrame = 0;
+                    streamedTex.bPending = false;
+                    streamedTex.bFailed = streamedTex.szFilePath.empty();
+
+                    iter = mapStreamedTexIdx.insert(std::make_pair(texIdx, (unsigned int)m_arrTexture.size())).first;
+                    m_arrTexture.push_back(streamedTex);
+                }
+
+                if (std::find(bounds.arrTexture.begin(), bounds.arrTexture.end(), iter->second) == bounds.arrTexture.end())
+                    bounds.arrTexture.push_back(iter->second);
+            }
+
+            if (!bounds.arrTexture.empty())
+                m_arrMeshBounds.push_back(bounds);
+        }
+    }
+}
+
+void TextureStreamer::Update(const Vec3f cameraPos, const float fovY, const unsigned int viewportHeight)
+{
+    CPU_PROFILE_SCOPE("TextureStreamer::Update()");
+
+    if (!m_bStarted)
+        return;
+
+    m_nFrameIdx++;
+
+    ApplyCompletedRequests();
+    EstimateDemand(cameraPos, fovY, viewportHeight);
+
+    m_nResidentBytes = 0;
+    Renderer* RenderContext = Renderer::GetInstance();
+    ResourceManager* ResMgr = RenderContext ? RenderContext->GetResourceManager() : nullptr;
+    for (unsigned int i = 0; ResMgr && i < m_arrTexture.size(); i++)
+        m_nResidentBytes += ResMgr->GetTexture(m_arrTexture[i].nTexIdx)->GetSize();
+
+    // Without streaming, everything is loaded regardless of the budget
+    const long long budget = RenderConfig::TextureStreaming::Enabled ? MB_TO_BYTES(RenderConfig::TextureStreaming::Budget) : LLONG_MAX;
+
+    EvictUnusedMips(budget);
+    QueueRequests(budget);
+}
+
+void TextureStreamer::EstimateDemand(const Vec3f cameraPos, const float fovY, const unsigned int viewportHeight)
+{
+    for (unsigned int i = 0; i < m_arrTexture.size(); i++)
+    {
+        StreamedTexture& streamedTex = m_arrTexture[i];
+        streamedTex.nDemandSize = RenderConfig::TextureStreaming::Enabled ?
+            Math::Min((unsigned int)Math::Max(RenderConfig::TextureStreaming::TailSize, 1), streamedTex.nFullSize) :
+            streamedTex.nFullSize;
+    }
+
+    if (RenderConfig::TextureStreaming::Enabled)
+    {
+        // Assuming a texture is mapped once over the whole mesh, it needs as many texels as the pixels the mesh
+        // covers on screen (i.e. the projected diameter of its bounding sphere), scaled for tiling/detail
+        const float pixelsPerUnit = (float)viewportHeight / (2.f * tanf(fovY * 0.5f)) * RenderConfig::TextureStreaming::DemandScale;
+
+        for (unsigned int mesh = 0; mesh < m_arrMeshBounds.size(); mesh++)
+        {
+            const MeshBounds& bounds = m_arrMeshBounds[mesh];
+            const float distance = Math::Max(length(Vec3f(bounds.vCenter - cameraPos)) - bounds.fRadius, (float)RenderConfig::Camera::ZNear);
+            const float projectedSize = 2.f * bounds.fRadius * pixelsPerUnit / distance;
+
+            for (unsigned int tex = 0; tex < bounds.arrTexture.size(); tex++)
+            {
+                StreamedTexture& streamedTex = m_arrTexture[bounds.arrTexture[tex]];
+
+                // Round up to the next mip
+                unsigned int demandSize = streamedTex.nDemandSize;
+                while (demandSize < streamedTex.nFullSize && (float)demandSize < projectedSize)
+                    demandSize <<= 1;
+
+                streamedTex.nDemandSize = Math::Min(demandSize, streamedTex.nFullSize);
+            }
+        }
+    }
+
+    for (unsigned int i = 0; i < m_arrTexture.size(); i++)
+    {
+        StreamedTexture& streamedTex = m_arrTexture[i];
+        if (streamedTex.nDemandSize >= GetResidentSize(streamedTex.nTexIdx))
+            streamedTex.nLastUsedFrame = m_nFrameIdx;
+    }
+}
+
+void TextureStreamer::ApplyCompletedRequests()
+{
+    Renderer* RenderContext = Renderer::GetInstance();
+    ResourceManager* ResMgr = RenderContext ? RenderContext->GetResourceManager() : nullptr;
+    if (!ResMgr)
+        return;
+
+    FrameVector<Request*> arrCompleted(*RenderContext->GetFrameAllocator());
+    {
+        std::lock_guard<std::mutex> lock(m_tMutex);
+        const unsigned int count = Math::Min((unsigned int)m_arrCompleted.size(), MAX_UPLOADS_PER_FRAME);
+        arrCompleted.assign(m_arrCompleted.begin(), m_arrCompleted.begin() + count);
+        m_arrCompleted.erase(m_arrCompleted.begin(), m_arrCompleted.begin() + count);
+    }
+
+    for (unsigned int i = 0; i < arrCompleted.size(); i++)
+    {
+        Request* const request = arrCompleted[i];
+        StreamedTexture& streamedTex = m_arrTexture[request->nStreamedTexIdx];
+
+        if (request->bSuccess)
+        {
+            CPU_PROFILE_SCOPE(request->szFilePath.c_str());
+            request->bSuccess = ResMgr->StreamTextureMips(streamedTex.nTexIdx, request->arrData, request->nMaxMipSize);
+        }
+
+        // Don't retry textures which can't be read
+        streamedTex.bFailed = !request->bSuccess;
+        streamedTex.bPending = false;
+        streamedTex.nLastUsedFrame = m_nFrameIdx;
+
+        m_nPendingBytes -= request->nExtraBytes;
+        m_nPendingCount--;
+
+        delete request;
+    }
+}
+
+void TextureStreamer::EvictUnusedMips(const long long budget)
+{
+    Renderer* RenderContext = Renderer::GetInstance();
+    ResourceManager* ResMgr = RenderContext ? RenderContext->GetResourceManager() : nullptr;
+    if (!ResMgr || m_nResidentBytes + m_nPendingBytes <= budget)
+        return;
+
+    // Least recently used first
+    FrameVector<std::pair<float, unsigned int>> arrCandidate(*RenderContext->GetFrameAllocator());
+    arrCandidate.reserve(m_arrTexture.size());
+    for (unsigned int i = 0; i < m_arrTexture.size(); i++)
+    {
+        const StreamedTexture& streamedTex = m_arrTexture[i];
+        if (!streamedTex.bPending && streamedTex.nDemandSize < GetResidentSize(streamedTex.nTexIdx))
+            arrCandidate.push_back(std::make_pair((float)(m_nFrameIdx - streamedTex.nLastUsedFrame), i));
+    }
+    std::sort(arrCandidate.begin(), arrCandidate.end(), CompareStreamingPriority);
+
+    for (unsigned int i = 0; i < arrCandidate.size() && m_nResidentBytes + m_nPendingBytes > budget; i++)
+    {
+        const StreamedTexture& streamedTex = m_arrTexture[arrCandidate[i].second];
+        Synesthesia3D::Texture* const tex = ResMgr->GetTexture(streamedTex.nTexIdx);
+
+        const unsigned int sizeBefore = tex->GetSize();
+        if (ResMgr->EvictTextureMips(streamedTex.nTexIdx, streamedTex.nDemandSize))
+            m_nResidentBytes -= sizeBefore - tex->GetSize();
+    }
+}
+
+void TextureStreamer::QueueRequests(const long long budget)
+{
+    Renderer* RenderContext = Renderer::GetInstance();
+    ResourceManager* ResMgr = RenderContext ? RenderContext->GetResourceManager() : nullptr;
+    if (!ResMgr || m_nPendingCount >= MAX_PENDING_REQUESTS)
+        return;
+
+    FrameVector<std::pair<float, unsigned int>> arrCandidate(*RenderContext->GetFrameAllocator());
+    arrCandidate.reserve(m_arrTexture.size());
+    for (unsigned int i = 0; i < m_arrTexture.size(); i++)
+    {
+        const StreamedTexture& streamedTex = m_arrTexture[i];
+        const unsigned int residentSize = GetResidentSize(streamedTex.nTexIdx);
+        if (!streamedTex.bPending && !streamedTex.bFailed && streamedTex.nDemandSize > residentSize)
+            arrCandidate.push_back(std::make_pair((float)streamedTex.nDemandSize / (float)residentSize, i));
+    }
+    std::sort(arrCandidate.begin(), arrCandidate.end(), CompareStreamingPriority);
+
+    for (unsigned int i = 0; i < arrCandidate.size() && m_nPendingCount < MAX_PENDING_REQUESTS; i++)
+    {
+        StreamedTexture& streamedTex = m_arrTexture[arrCandidate[i].second];
+        const Synesthesia3D::Texture* const tex = ResMgr->GetTexture(streamedTex.nTexIdx);
+
+        // Every additional mip level quadruples the size of a 2D texture (or octuples it, for volume textures)
+        long long newSize = tex->GetSize();
+        for (unsigned int size = GetResidentSize(streamedTex.nTexIdx); size < streamedTex.nDemandSize; size <<= 1)
+            newSize *= (tex->GetDimensionCount() == 3 ? 8 : 4);
+
+        const long long extraBytes = newSize - tex->GetSize();
+        if (extraBytes > budget - m_nResidentBytes - m_nPendingBytes)
+            continue;
+
+        Request* const request = new Request;
+        request->nStreamedTexIdx = arrCandidate[i].second;
+        request->szFilePath = streamedTex.szFilePath;
+        request->nMaxMipSize = (streamedTex.nDemandSize < streamedTex.nFullSize ? streamedTex.nDemandSize : 0);
+        request->nExtraBytes = extraBytes;
+        request->bSuccess = false;
+
+        streamedTex.bPending = true;
+        m_nPendingBytes += extraBytes;
+        m_nPendingCount++;
+
+        {
+            std::lock_guard<std::mutex> lock(m_tMutex);
+            m_arrQueued.push_back(request);
+        }
+        m_tRequestQueued.notify_one();
+    }
+}
+
+void TextureStreamer::StreamingThread()
+{
+    Renderer* RenderContext = Renderer::GetInstance();
+    if (RenderContext && RenderContext->GetProfiler())
+        RenderContext->GetProfiler()->SetCPUProfileThreadName("Texture streaming thread");
+
+    while (true)
+    {
+        Request* request = nullptr;
+
+        // Sleep until there is something to read, without recording anything while idle
+        {
+            std::unique_lock<std::mutex> lock(m_tMutex);
+            m_tRequestQueued.wait(lock, [this] { return m_bQuit || !m_arrQueued.empty(); });
+            if (m_bQuit)
+                break;
+
+            request = m_arrQueued.front();
+            m_arrQueued.erase(m_arrQueued.begin());
+        }
+
+        {
+            CPU_PROFILE_SCOPE(request->szFilePath.c_str());
+            request->bSuccess = ResourceManager::ReadTextureFile(request->szFilePath.c_str(), request->arrData);
+        }
+
+        std::lock_guard<std::mutex> lock(m_tMutex);
+        m_arrCompleted.push_back(request);
+    }
+}
+
+const unsigned int TextureStreamer::GetResidentSize(const unsigned int texIdx)
+{
+    Renderer* RenderContext = Renderer::GetInstance();
+    ResourceManager* ResMgr = RenderContext ? RenderContext->GetResourceManager() : nullptr;
+    const Synesthesia3D::Texture* const tex = ResMgr ? ResMgr->GetTexture(texIdx) : nullptr;
+
+    return tex ? Math::Max(tex->GetWidth(), tex->GetHeight(), tex->GetDepth()) : 0u;
+}
@@ -0,0 +1,116 @@
+/*=============================================================================
+ * This file is part of the "GITechDemo" application
+ * Copyright (C) Iftode Bogdan-Marius <iftode.bogdan@gmail.com>
+ *
+ *      File:   TextureStreamer.h
+ *      Author: Bogdan Iftode
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+=============================================================================*/
+
+#ifndef TEXTURE_STREAMER_H_
+#define TEXTURE_STREAMER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gmtl\gmtl.h>
+using namespace gmtl;
+
+namespace GITechDemoApp
+{
+    // Model textures are loaded with only their mip tail resident (see RenderConfig::TextureStreaming::TailSize),
+    // so that the scene is interactive as soon as possible. Afterwards, the top mips are streamed in, based on the
+    // screen space size of the meshes using them, estimated from their distance to the camera. Files are read and
+    // decompressed on a separate thread, while the textures are recreated on the rendering thread, between frames.
+    // When over budget, the top mips which are no longer needed are evicted, least recently used textures first.
+    class TextureStreamer
+    {
+    public:
+        TextureStreamer();
+        ~TextureStreamer();
+
+        // Gathers the textures of all models and starts the streaming thread; call once all resources are loaded
+        void Start();
+        void Stop();
+
+        const bool IsStarted() const { return m_bStarted; }
+
+        // Called every frame, on the rendering thread, before drawing
+        void Update(const Vec3f cameraPos, const float fovY, const unsigned int viewportHeight);
+
+        const unsigned int GetTextureCount() const { return (unsigned int)m_arrTexture.size(); }
+        const unsigned int GetPendingCount() const { return m_nPendingCount; }
+        const long long GetResidentBytes() const { return m_nResidentBytes; }
+
+    protected:
+        struct StreamedTexture
+        {
+            unsigned int    nTexIdx;
+            std::string     szFilePath;
+            unsigned int    nFullSize;          // Size of the top mip in the texture's file
+            unsigned int    nDemandSize;        // Size of the top mip required this frame
+            unsigned int    nLastUsedFrame;     // Last frame in which all of the resident mips were required
+            bool            bPending;
+            bool            bFailed;
+        };
+
+        struct MeshBounds
+        {
+            Vec3f                       vCenter;
+            float                       fRadius;
+            std::vector<unsigned int>   arrTexture;     // Indices in m_arrTexture
+        };
+
+        struct Request
+        {
+            unsigned int        nStreamedTexIdx;        // Index in m_arrTexture
+            std::string         szFilePath;
+            unsigned int        nMaxMipSize;
+            long long           nExtraBytes;            // Estimated, until the texture is reloaded
+            std::vector<char>   arrData;
+            bool                bSuccess;
+        };
+
+        void GatherTextures();
+        void EstimateDemand(const Vec3f cameraPos, const float fovY, const unsigned int viewportHeight);
+        void ApplyCompletedRequests();
+        void EvictUnusedMips(const long long budget);
+        void QueueRequests(const long long budget);
+
+        void StreamingThread();
+
+        static const unsigned int GetResidentSize(const unsigned int texIdx);
+
+        std::vector<StreamedTexture>    m_arrTexture;
+        std::vector<MeshBounds>         m_arrMeshBounds;
+        std::vector<Request*>           m_arrQueued;
+        std::vector<Request*>           m_arrCompleted;
+        unsigned int                    m_nPendingCount;
+        long long                       m_nResidentBytes;
+        long long                       m_nPendingBytes;
+        unsigned int                    m_nFrameIdx;
+        bool                            m_bStarted;
+        std::atomic<bool>               m_bQuit;
+        std::thread                     m_tThread;
+        std::mutex                      m_tMutex;           // Guards m_arrQueued, m_arrCompleted and the streaming thread's wake-ups
+        std::condition_variable         m_tRequestQueued;   // Wakes the streaming thread when requests are queued or when stopping
+    };
+}
+
+#endif // TEXTURE_STREAMER_H_
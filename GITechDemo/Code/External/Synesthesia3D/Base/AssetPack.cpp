@@ -0,0 +1,361 @@
+/**
+ * @file        AssetPack.cpp
+ *
+ * @note        This file is part of the "Synesthesia3D" graphics engine
+ *
+ * @copyright   Copyright (C) Iftode Bogdan-Marius <iftode.bogdan@gmail.com>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * @copyright
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ * @copyright
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "stdafx.h"
+
+#include "AssetPack.h"
+using namespace Synesthesia3D;
+
+#include <fstream>
+#include <algorithm>
+
+#include <lz4/lz4.h>
+
+AssetPack::AssetPack()
+    : m_hFile(nullptr)
+{}
+
+AssetPack::~AssetPack()
+{
+    Close();
+}
+
+const bool AssetPack::Open(const char* const filePath)
+{
+    Close();
+
+    std::ifstream packFile;
+    packFile.open(filePath, std::ios::binary);
+
+    if (!packFile.is_open())
+        return false;
+
+    packFile.seekg(0, std::ios::end);
+    const unsigned long long fileSize = (unsigned long long)packFile.tellg();
+    packFile.seekg(0, std::ios::beg);
+
+    char fileSignature[S3D_ASSET_PACK_FILE_HEADER_SIZE];
+    packFile.read(fileSignature, S3D_ASSET_PACK_FILE_HEADER_SIZE);
+
+    if (memcmp(S3D_ASSET_PACK_FILE_HEADER, fileSignature, S3D_ASSET_PACK_FILE_HEADER_SIZE) != 0)
+    {
+        S3D_DBGPRINT("Error: File %s is not a Synesthesia3D asset pack", filePath);
+        assert(0);
+        return false;
+    }
+
+    unsigned int fileVersion = 0;
+    packFile.read((char*)&fileVersion, sizeof(unsigned int));
+
+    if (fileVersion != S3D_ASSET_PACK_FILE_VERSION)
+    {
+        S3D_DBGPRINT("Error: Asset pack %s is version %u but version %u was expected", filePath, fileVersion, S3D_ASSET_PACK_FILE_VERSION);
+        assert(0);
+        return false;
+    }
+
+    unsigned int entryCount = 0;
+    packFile.read((char*)&entryCount, sizeof(unsigned int));
+
+    // Each entry takes at least 40 bytes in the table of contents:
+    // 36 for its fixed size fields (path hash, offset, size, uncompressed size,
+    // codec, content hash) and 4 for the length of its path
+    const unsigned int minEntrySize = 3 * sizeof(unsigned long long) + 4 * sizeof(unsigned int);
+    if (!packFile || entryCount > fileSize / minEntrySize)
+    {
+        S3D_DBGPRINT("Error: Asset pack %s has an invalid table of contents", filePath);
+        assert(0);
+        return false;
+    }
+
+    m_arrEntry.resize(entryCount);
+    for (unsigned int i = 0; i < entryCount; i++)
+    {
+        AssetPackEntry& entry = m_arrEntry[i];
+        unsigned int codec = APC_MAX;
+        packFile.read((char*)&entry.nPathHash, sizeof(unsigned long long));
+        packFile.read((char*)&entry.nOffset, sizeof(unsigned long long));
+        packFile.read((char*)&entry.nSize, sizeof(unsigned int));
+        packFile.read((char*)&entry.nUncompressedSize, sizeof(unsigned int));
+        packFile.read((char*)&codec, sizeof(unsigned int));
+        packFile.read((char*)&entry.nContentHash, sizeof(unsigned long long));
+        entry.eCodec = (AssetPackCodec)codec;
+    }
+
+    m_arrEntryPath.resize(entryCount);
+    for (unsigned int i = 0; i < entryCount && packFile; i++)
+    {
+        unsigned int pathLength = 0;
+        packFile.read((char*)&pathLength, sizeof(unsigned int));
+        if (pathLength > fileSize)
+            break;
+        m_arrEntryPath[i].resize(pathLength);
+        packFile.read(&m_arrEntryPath[i][0], pathLength);
+    }
+
+    bool valid = !packFile.fail();
+    for (unsigned int i = 0; i < entryCount && valid; i++)
+    {
+        const AssetPackEntry& entry = m_arrEntry[i];
+        valid =
+            entry.eCodec < APC_MAX &&
+            entry.nOffset <= fileSize && entry.nSize <= fileSize - entry.nOffset &&
+            (entry.eCodec != APC_NONE || entry.nSize == entry.nUncompressedSize) &&
+            entry.nPathHash == HashPath(m_arrEntryPath[i].c_str()) &&
+            (i == 0 || m_arrEntry[i - 1].nPathHash <= entry.nPathHash);
+    }
+
+    packFile.close();
+
+    if (!valid)
+    {
+        S3D_DBGPRINT("Error: Asset pack %s has an invalid table of contents", filePath);
+        assert(0);
+        m_arrEntry.clear();
+        m_arrEntryPath.clear();
+        return false;
+    }
+
+#ifdef WIN32
+    // Overlapped reads carry their own file offset, so concurrent reads don't contend on a shared file pointer
+    HANDLE hFile = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED, NULL);
+    if (hFile == INVALID_HANDLE_VALUE)
+    {
+        m_arrEntry.clear();
+        m_arrEntryPath.clear();
+        return false;
+    }
+    m_hFile = hFile;
+#endif
+
+    m_szFilePath = filePath;
+
+    return true;
+}
+
+void AssetPack::Close()
+{
+#ifdef WIN32
+    if (m_hFile)
+        CloseHandle((HANDLE)m_hFile);
+#endif
+    m_hFile = nullptr;
+
+    m_szFilePath.clear();
+    m_arrEntry.clear();
+    m_arrEntryPath.clear();
+}
+
+const bool AssetPack::IsOpen() const
+{
+    return !m_szFilePath.empty();
+}
+
+const char* AssetPack::GetFilePath() const
+{
+    return m_szFilePath.c_str();
+}
+
+const AssetPackEntry* AssetPack::FindEntry(const char* const path) const
+{
+    const std::string normalizedPath = NormalizePath(path);
+    const unsigned long long pathHash = HashPath(normalizedPath.c_str());
+
+    struct HashCompare
+    {
+        bool operator()(const AssetPackEntry& entry, const unsigned long long hash) const { return entry.nPathHash < hash; }
+    };
+
+    // Hashes may collide, so also compare the paths of the matching entries
+    for (std::vector<AssetPackEntry>::const_iterator iter = std::lower_bound(m_arrEntry.begin(), m_arrEntry.end(), pathHash, HashCompare());
+        iter != m_arrEntry.end() && iter->nPathHash == pathHash; iter++)
+    {
+        if (m_arrEntryPath[iter - m_arrEntry.begin()] == normalizedPath)
+            return &*iter;
+    }
+
+    return nullptr;
+}
+
+const unsigned int AssetPack::GetEntryCount() const
+{
+    return (unsigned int)m_arrEntry.size();
+}
+
+const AssetPackEntry& AssetPack::GetEntry(const unsigned int idx) const
+{
+    assert(idx < m_arrEntry.size());
+    return m_arrEntry[idx];
+}
+
+const char* AssetPack::GetEntryPath(const unsigned int idx) const
+{
+    assert(idx < m_arrEntryPath.size());
+    return m_arrEntryPath[idx].c_str();
+}
+
+const bool AssetPack::ReadEntry(const AssetPackEntry& entry, std::vector<char>& data) const
+{
+    if (entry.eCodec == APC_NONE)
+        return ReadRawEntry(entry, data);
+
+    std::vector<char> rawData;
+    return ReadRawEntry(entry, rawData) && DecompressEntry(entry, rawData, data);
+}
+
+const bool AssetPack::ReadRawEntry(const AssetPackEntry& entry, std::vector<char>& data) const
+{
+    if (!IsOpen())
+        return false;
+
+    data.resize(entry.nSize);
+    if (entry.nSize > 0 && !ReadData(entry.nOffset, entry.nSize, data.data()))
+    {
+        data.clear();
+        return false;
+    }
+
+    return true;
+}
+
+const bool AssetPack::DecompressEntry(const AssetPackEntry& entry, const std::vector<char>& rawData, std::vector<char>& data)
+{
+    switch (entry.eCodec)
+    {
+    case APC_NONE:
+        data = rawData;
+        return true;
+
+    case APC_LZ4:
+    {
+        data.resize(entry.nUncompressedSize);
+        const int decompressedBytes = LZ4_decompress_safe(rawData.data(), data.data(), (int)rawData.size(), (int)entry.nUncompressedSize);
+        if (decompressedBytes != (int)entry.nUncompressedSize)
+        {
+            S3D_DBGPRINT("Error: Asset pack entry %016llx could not be decompressed", entry.nPathHash);
+            assert(0);
+            data.clear();
+            return false;
+        }
+        return true;
+    }
+
+    default:
+        assert(0);
+        return false;
+    }
+}
+
+const bool AssetPack::ReadData(const unsigned long long offset, const unsigned int size, char* const dest) const
+{
+#ifdef WIN32
+    OVERLAPPED overlapped = {};
+    overlapped.Offset = (DWORD)(offset & 0xffffffffull);
+    overlapped.OffsetHigh = (DWORD)(offset >> 32);
+    overlapped.hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+    if (!overlapped.hEvent)
+        return false;
+
+    DWORD bytesRead = 0;
+    BOOL success = ReadFile((HANDLE)m_hFile, dest, size, NULL, &overlapped);
+    if (success || GetLastError() == ERROR_IO_PENDING)
+        success = GetOverlappedResult((HANDLE)m_hFile, &overlapped, &bytesRead, TRUE);
+
+    CloseHandle(overlapped.hEvent);
+
+    return success && bytesRead == size;
+#else
+    // Every read opens the pack separately, so that concurrent reads don't share a file position
+    std::ifstream packFile;
+    packFile.open(m_szFilePath.c_str(), std::ios::binary);
+    if (!packFile.is_open())
+        return false;
+
+    packFile.seekg((std::streamoff)offset, std::ios::beg);
+    packFile.read(dest, size);
+
+    return packFile.gcount() == (std::streamsize)size;
+#endif
+}
+
+const std::string AssetPack::NormalizePath(const char* const path)
+{
+    std::vector<std::string> segments;
+    std::string segment;
+
+    for (const char* c = path; ; c++)
+    {
+        if (*c == '/' || *c == '\\' || *c == '\0')
+        {
+            if (segment == "..")
+            {
+                if (!segments.empty() && segments.back() != "..")
+                    segments.pop_back();
+                else
+                    segments.push_back(segment);
+            }
+            else if (!segment.empty() && segment != ".")
+                segments.push_back(segment);
+
+            segment.clear();
+
+            if (*c == '\0')
+                break;
+        }
+        else
+            segment += (char)tolower((unsigned char)*c);
+    }
+
+    std::string normalizedPath;
+    for (unsigned int i = 0; i < segments.size(); i++)
+    {
+        if (i > 0)
+            normalizedPath += '/';
+        normalizedPath += segments[i];
+    }
+
+    return normalizedPath;
+}
+
+const unsigned long long AssetPack::HashPath(const char* const path)
+{
+    unsigned long long hash = 14695981039346656037ull;
+    for (const char* c = path; *c != '\0'; c++)
+    {
+        hash ^= (unsigned char)*c;
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+const unsigned long long AssetPack::HashContents(const void* const data, const size_t size)
+{
+    unsigned long long hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= ((const unsigned char*)data)[i];
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
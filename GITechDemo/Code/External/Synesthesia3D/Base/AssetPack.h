@@ -0,0 +1,186 @@
+/**
+ * @file        AssetPack.h
+ *
+ * @note        This file is part of the "Synesthesia3D" graphics engine
+ *
+ * @copyright   Copyright (C) Iftode Bogdan-Marius <iftode.bogdan@gmail.com>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * @copyright
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ * @copyright
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ASSETPACK_H
+#define ASSETPACK_H
+
+#include <vector>
+#include <string>
+
+#include "ResourceData.h"
+
+#define S3D_ASSET_PACK_FILE_VERSION (2)
+#define S3D_ASSET_PACK_FILE_HEADER "\x89S3DPAK\x0d\x0a\x1a\x0a"
+#define S3D_ASSET_PACK_FILE_HEADER_SIZE (sizeof(S3D_ASSET_PACK_FILE_HEADER) - 1)
+#define S3D_ASSET_PACK_DATA_ALIGNMENT (4096)
+
+namespace Synesthesia3D
+{
+    /**
+     * @brief   Read-only archive of compiled assets (*.s3dpak).
+     *
+     * @details A pack starts with a table of contents, sorted by the hashes of the entries' paths,
+     *          followed by the entries' paths and their data, each entry aligned to
+     *          @ref S3D_ASSET_PACK_DATA_ALIGNMENT bytes:
+     *          - @ref S3D_ASSET_PACK_FILE_HEADER
+     *          - @ref S3D_ASSET_PACK_FILE_VERSION (unsigned int)
+     *          - entry count (unsigned int)
+     *          - for each entry: path hash, offset (unsigned long long), size, uncompressed size, codec (unsigned int), content hash (unsigned long long)
+     *          - for each entry: path length (unsigned int), path characters
+     *          - entry data
+     *
+     * @note    The table of contents is kept in memory once opened, so that finding an entry doesn't
+     *          touch the disk. On Windows, entries are read with positioned, overlapped reads on a single
+     *          file handle, so loader threads can read from the same pack concurrently.
+     *
+     * @see     ResourceManager::MountAssetPack()
+     */
+    class AssetPack
+    {
+
+    public:
+
+        /**
+         * @brief   Constructor.
+         */
+                SYNESTHESIA3D_DLL                       AssetPack();
+
+        /**
+         * @brief   Destructor.
+         */
+                SYNESTHESIA3D_DLL                       ~AssetPack();
+
+        /**
+         * @brief   Opens a pack file and reads its table of contents.
+         *
+         * @param[in]   filePath    Path of the pack file (*.s3dpak).
+         *
+         * @return  Success of operation.
+         */
+                SYNESTHESIA3D_DLL   const bool              Open(const char* const filePath);
+
+        /**
+         * @brief   Closes the pack file.
+         */
+                SYNESTHESIA3D_DLL   void                    Close();
+
+        /**
+         * @brief   Checks whether a pack file has been opened.
+         */
+                SYNESTHESIA3D_DLL   const bool              IsOpen() const;
+
+        /**
+         * @brief   Retrieves the path of the opened pack file.
+         */
+                SYNESTHESIA3D_DLL   const char*             GetFilePath() const;
+
+        /**
+         * @brief   Looks up an entry by its path.
+         *
+         * @param[in]   path    Path of the asset, relative to the directory the pack was built from.
+         *
+         * @return  The entry, or nullptr if the pack doesn't contain the asset.
+         */
+                SYNESTHESIA3D_DLL   const AssetPackEntry*   FindEntry(const char* const path) const;
+
+        /**
+         * @brief   Retrieves the number of entries in the pack.
+         */
+                SYNESTHESIA3D_DLL   const unsigned int      GetEntryCount() const;
+
+        /**
+         * @brief   Retrieves an entry from the table of contents.
+         */
+                SYNESTHESIA3D_DLL   const AssetPackEntry&   GetEntry(const unsigned int idx) const;
+
+        /**
+         * @brief   Retrieves the normalized path of an entry from the table of contents.
+         */
+                SYNESTHESIA3D_DLL   const char*             GetEntryPath(const unsigned int idx) const;
+
+        /**
+         * @brief   Reads and decompresses an entry.
+         *
+         * @note    Can be called concurrently from multiple threads.
+         *
+         * @param[in]   entry       The entry, as retrieved by @ref FindEntry() or @ref GetEntry().
+         * @param[out]  data        The decompressed contents of the entry.
+         *
+         * @return  Success of operation.
+         */
+                SYNESTHESIA3D_DLL   const bool              ReadEntry(const AssetPackEntry& entry, std::vector<char>& data) const;
+
+        /**
+         * @brief   Reads an entry as stored in the pack, without decompressing it.
+         *
+         * @note    Can be called concurrently from multiple threads.
+         *
+         * @param[in]   entry       The entry, as retrieved by @ref FindEntry() or @ref GetEntry().
+         * @param[out]  data        The contents of the entry, as stored in the pack.
+         *
+         * @return  Success of operation.
+         *
+         * @see     DecompressEntry()
+         */
+                SYNESTHESIA3D_DLL   const bool              ReadRawEntry(const AssetPackEntry& entry, std::vector<char>& data) const;
+
+        /**
+         * @brief   Decompresses the contents of an entry, as read by @ref ReadRawEntry().
+         *
+         * @param[in]   entry       The entry.
+         * @param[in]   rawData     The contents of the entry, as stored in the pack.
+         * @param[out]  data        The decompressed contents of the entry.
+         *
+         * @return  Success of operation.
+         */
+        static  SYNESTHESIA3D_DLL   const bool              DecompressEntry(const AssetPackEntry& entry, const std::vector<char>& rawData, std::vector<char>& data);
+
+        /**
+         * @brief   Normalizes an asset path: lowercase, '/' separated, with "." and ".." segments collapsed.
+         */
+        static  SYNESTHESIA3D_DLL   const std::string       NormalizePath(const char* const path);
+
+        /**
+         * @brief   Computes the 64 bit FNV-1a hash of a normalized asset path, as stored in the table of contents.
+         */
+        static  SYNESTHESIA3D_DLL   const unsigned long long HashPath(const char* const path);
+
+        /**
+         * @brief   Computes the 64 bit FNV-1a hash of an asset's uncompressed data, as stored in the table of contents.
+         */
+        static  SYNESTHESIA3D_DLL   const unsigned long long HashContents(const void* const data, const size_t size);
+
+    protected:
+
+        /**
+         * @brief   Reads a range of the pack file.
+         */
+        const bool ReadData(const unsigned long long offset, const unsigned int size, char* const dest) const;
+
+        std::string                     m_szFilePath;       /**< @brief Path of the opened pack file. */
+        std::vector<AssetPackEntry>     m_arrEntry;         /**< @brief Table of contents, sorted by path hash. */
+        std::vector<std::string>        m_arrEntryPath;     /**< @brief Normalized paths of the entries, in the same order as @ref m_arrEntry. */
+        void*                           m_hFile;            /**< @brief Handle of the pack file, opened for overlapped reads (Windows only). */
+    };
+}
+
+#endif // ASSETPACK_H
@@ -26,12 +26,14 @@
 #include "Buffer.h"
 using namespace Synesthesia3D;
 
-Buffer::Buffer(const unsigned int elementCount, const unsigned int elementSize, const BufferUsage usage)
+Buffer::Buffer(const unsigned int elementCount, const unsigned int elementSize, const BufferUsage usage, const AllocationTag dataTag)
     : m_nElementCount(elementCount)
     , m_nElementSize(elementSize)
     , m_eBufferUsage(usage)
     , m_nSize(elementCount * elementSize)
     , m_pData(nullptr)
+    , m_pDataAllocator(nullptr)
+    , m_eDataTag(dataTag)
 {
     assert(elementCount >= 0);
     assert(elementSize >= 0);
@@ -43,15 +45,30 @@ Buffer::Buffer(const unsigned int elementCount, const unsigned int elementSize,
     // Texture::GetMipData() for the first time.
     if (elementCount > 0 && elementSize > 0 && usage != BU_RENDERTAGET)
     {
-        m_pData = new s3dByte[m_nSize];
-        assert(m_pData != nullptr);
+        AllocateData();
         memset(m_pData, 0, m_nSize);
     }
 }
 
 Buffer::~Buffer()
 {
-    delete[] m_pData;
+    FreeData();
+}
+
+void Buffer::AllocateData()
+{
+    FreeData();
+
+    m_pData = (s3dByte*)Allocator::AllocateMemory(m_nSize, m_eDataTag);
+    assert(m_pData != nullptr);
+}
+
+void Buffer::FreeData()
+{
+    if (!m_pDataAllocator)
+        Allocator::FreeMemory(m_pData);
+
+    m_pData = nullptr;
 }
 
 const unsigned int Buffer::GetElementCount() const
@@ -27,11 +27,14 @@
 
 namespace Synesthesia3D
 {
+    class LinearAllocator;
+
     /**
      * @brief   Base class which manages memory buffers.
      */
     class Buffer
     {
+        S3D_ALLOCATION_TAG(AT_RESOURCES)
 
     public:
 
@@ -74,8 +77,9 @@ namespace Synesthesia3D
          * @param[in]   elementCount    The number of elements.
          * @param[in]   elementSize     The size, in bytes, of a single element.
          * @param[in]   usage           How the resource will be used.
+         * @param[in]   dataTag         Subsystem on whose behalf the data is allocated.
          */
-        Buffer(const unsigned int elementCount, const unsigned int elementSize, const BufferUsage usage);
+        Buffer(const unsigned int elementCount, const unsigned int elementSize, const BufferUsage usage, const AllocationTag dataTag = AT_RESOURCES);
 
         /**
          * @brief   Destructor.
@@ -88,11 +92,26 @@ namespace Synesthesia3D
          */
         virtual ~Buffer();
 
+        /**
+         * @brief   Allocates @ref m_nSize bytes for the data, freeing the previous data.
+         */
+        void AllocateData();
+
+        /**
+         * @brief   Frees the data, unless it is owned by @ref m_pDataAllocator.
+         */
+        void FreeData();
+
         unsigned int    m_nElementCount;    /**< @brief Holds the number of elements. */
         unsigned int    m_nElementSize;     /**< @brief Holds the size in bytes of an element. */
         BufferUsage     m_eBufferUsage;     /**< @brief Holds the type of usage of the buffer. */
         unsigned int    m_nSize;            /**< @brief Holds the total size in bytes of the buffer. */
         s3dByte*            m_pData;            /**< @brief Pointer to the beginning of the buffer. */
+        LinearAllocator*    m_pDataAllocator;   /**< @brief If set, the data is deserialized into memory from this allocator, which owns it (e.g. the meshes of a model). */
+        AllocationTag       m_eDataTag;         /**< @brief Subsystem on whose behalf the data is allocated (see @ref Allocator::AllocateMemory()). */
+
+        std::string     m_szMemoryOwner;        /**< @brief Owner the buffer was created under, for memory accounting. See @ref ResourceManager::PushMemoryOwner(). */
+        std::string     m_szMemorySourceFile;   /**< @brief File the buffer was created while loading, for memory accounting. */
 
 
 
@@ -107,6 +126,11 @@ namespace Synesthesia3D
          * @brief   Deserializes buffer data.
          */
         friend std::istream& operator>>(std::istream& s_in, Buffer &buf_out);
+
+        /**
+         * @brief   Grant access for mesh object deserialization operator.
+         */
+        friend std::istream& operator>>(std::istream& s_in, Model::Mesh& mesh_out);
     };
 }
 
@@ -23,6 +23,8 @@
 #include "stdafx.h"
 
 #include "IndexBuffer.h"
+#include "Renderer.h"
+#include "RenderTrace.h"
 using namespace Synesthesia3D;
 
 const unsigned int IndexBuffer::IndexBufferFormatSize[IBF_MAX] =
@@ -34,11 +36,28 @@ const unsigned int IndexBuffer::IndexBufferFormatSize[IBF_MAX] =
 IndexBuffer::IndexBuffer(const unsigned int indexCount, const IndexBufferFormat indexFormat, const BufferUsage usage)
     : Buffer(indexCount, IndexBufferFormatSize[indexFormat], usage)
     , m_eIndexFormat(indexFormat)
+    , m_nLockOffset(0u)
+    , m_nLockCount(0u)
 {}
 
 IndexBuffer::~IndexBuffer()
 {}
 
+void IndexBuffer::Lock(const BufferLocking lockMode, const unsigned int offset, const unsigned int count)
+{
+    assert(lockMode < BL_WRITE_DISCARD || m_eBufferUsage == BU_DYNAMIC);
+    assert(offset + count <= GetElementCount());
+
+    m_nLockOffset = offset;
+    m_nLockCount = count > 0 ? count : GetElementCount() - offset;
+
+    Renderer::IncrementCounter(RC_BUFFER_LOCKS);
+
+    RenderTrace* const trace = Renderer::GetInstance()->GetRenderTrace();
+    if (trace->IsRecording())
+        trace->RecordBufferUpdate(this, lockMode, m_nLockOffset, m_nLockCount);
+}
+
 void IndexBuffer::SetIndex(const unsigned int indexIdx, const unsigned int indexVal)
 {
     assert(indexIdx < GetElementCount());
@@ -49,10 +49,13 @@ namespace Synesthesia3D
          * @brief   Locks the index buffer for reading/writing.
          * 
          * @param   lockMode    Specifies the type of operation for which the resource is locked.
+         * @param   offset      The first index of the locked range.
+         * @param   count       The number of indices in the locked range (0 for all indices following @p offset).
          *
          * @note    The resource update flow is: @ref Lock() > @ref SetIndex()/@ref SetIndices() > @ref Update() > @ref Unlock()
+         * @note    Only the locked range is flushed by @ref Update().
          */
-        virtual SYNESTHESIA3D_DLL           void            Lock(const BufferLocking lockMode) PURE_VIRTUAL;
+        virtual SYNESTHESIA3D_DLL           void            Lock(const BufferLocking lockMode, const unsigned int offset = 0u, const unsigned int count = 0u);
 
         /**
          * @brief   Unlocks the index buffer.
@@ -165,6 +168,9 @@ namespace Synesthesia3D
          */
             IndexBufferFormat       m_eIndexFormat;
 
+            unsigned int            m_nLockOffset;  /**< @brief First index of the range locked by @ref Lock(). */
+            unsigned int            m_nLockCount;   /**< @brief Number of indices in the range locked by @ref Lock(). */
+
         /**
          * @brief   An array containing the sizes, in bytes, of an index of the specified format
          * @note    For internal usage only.
@@ -22,26 +22,56 @@
 
 #include "stdafx.h"
 
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+
 #include "Profiler.h"
 #include "Renderer.h"
 using namespace Synesthesia3D;
 
 #include "Utility/Mutex.h"
 
-int Profiler::ms_nProfileMarkerCounter = 0;
+thread_local int Profiler::ms_nProfileMarkerCounter = 0;
+thread_local Profiler::CPUProfileThreadBuffer* Profiler::ms_pCPUProfileThreadBuffer = nullptr;
+thread_local unsigned int Profiler::ms_nCPUProfileThreadBufferOwnerId = 0;
+std::atomic<unsigned int> Profiler::ms_nInstanceCount(0);
 
-// A mutex to guarantee thread-safety for profile marker operations
+// A mutex to guarantee thread-safety for registering new marker labels
+// and for accessing the GPU profile marker results
 MUTEX gProfileMarkerMutex;
 
 Profiler::Profiler()
+    : m_nGPUProfileEventCount(0)
+    , m_nGPUTimelineOrigin(-1)
+    , m_tRenderThreadId(std::this_thread::get_id())
+    , m_nInstanceId(++ms_nInstanceCount)
+    , m_nCounterScopeDepth(0)
+    , m_nCounterFrame(1)
 {
     MUTEX_INIT(gProfileMarkerMutex);
+
+    for (unsigned int i = 0; i < MAX_PROFILE_MARKER_LABELS; i++)
+    {
+        m_arrProfileMarkerLabel[i].nHash = 0;
+        m_arrLatestGPUProfileMarkerResult[i] = nullptr;
+        m_arrProfileMarkerCounters[i].nCurrentFrame = ~0u;
+        m_arrProfileMarkerCounters[i].nLastFrame = ~0u;
+    }
+
+#if ENABLE_PROFILE_MARKERS
+    m_arrGPUProfileEvent.resize(GPU_PROFILE_EVENT_BUFFER_SIZE);
+#endif
 }
 
 Profiler::~Profiler()
 {
     MUTEX_DESTROY(gProfileMarkerMutex);
 
+    for (unsigned int i = 0; i < (unsigned int)m_arrCPUProfileThreadBuffer.size(); i++)
+        delete m_arrCPUProfileThreadBuffer[i];
+    m_arrCPUProfileThreadBuffer.clear();
+
 #if ENABLE_PROFILE_MARKERS
     assert(ms_nProfileMarkerCounter == 0);
 #endif
@@ -50,56 +80,355 @@ Profiler::~Profiler()
 void Profiler::PushProfileMarker(const char* const label, const bool issueGPUQuery)
 {
 #if ENABLE_PROFILE_MARKERS
-    MUTEX_LOCK(gProfileMarkerMutex);
+    PushProfileMarker(InternProfileMarkerLabel(label), issueGPUQuery);
+#endif
+}
+
+void Profiler::PushProfileMarker(const unsigned int markerId, const bool issueGPUQuery)
+{
+#if ENABLE_PROFILE_MARKERS
+    // Push / pop pairs are tracked per thread, so no locking is required
     ms_nProfileMarkerCounter++;
-    MUTEX_UNLOCK(gProfileMarkerMutex);
+
+    // Render counters are only tracked for the rendering thread's scopes
+    if (IsRenderThread())
+    {
+        if (m_nCounterScopeDepth < MAX_COUNTER_SCOPE_DEPTH && Renderer::GetInstance())
+        {
+            CounterScope& scope = m_arrCounterScope[m_nCounterScopeDepth];
+            scope.nMarkerId = markerId;
+            Renderer::GetInstance()->GetCounterTotals(scope.tStart);
+        }
+        m_nCounterScopeDepth++;
+    }
 #endif
 }
 
 void Profiler::PopProfileMarker()
 {
 #if ENABLE_PROFILE_MARKERS
-    MUTEX_LOCK(gProfileMarkerMutex);
+    if (IsRenderThread() && m_nCounterScopeDepth > 0)
+    {
+        m_nCounterScopeDepth--;
+        if (m_nCounterScopeDepth < MAX_COUNTER_SCOPE_DEPTH && Renderer::GetInstance())
+        {
+            const CounterScope& scope = m_arrCounterScope[m_nCounterScopeDepth];
+            if (scope.nMarkerId < MAX_PROFILE_MARKER_LABELS)
+            {
+                ProfileMarkerCounters& counters = m_arrProfileMarkerCounters[scope.nMarkerId];
+                if (counters.nCurrentFrame != m_nCounterFrame)
+                {
+                    counters.tLastFrame = counters.tCurrent;
+                    counters.nLastFrame = counters.nCurrentFrame;
+                    counters.tCurrent.Reset();
+                    counters.nCurrentFrame = m_nCounterFrame;
+                }
+
+                RenderCounters totals;
+                Renderer::GetInstance()->GetCounterTotals(totals);
+                for (unsigned int i = 0; i < RC_MAX; i++)
+                    counters.tCurrent.nCount[i] += totals.nCount[i] - scope.tStart.nCount[i];
+            }
+        }
+    }
+
     ms_nProfileMarkerCounter--;
     assert(ms_nProfileMarkerCounter >= 0);
-    MUTEX_UNLOCK(gProfileMarkerMutex);
 #endif
 }
 
-const float Profiler::RetrieveGPUProfileMarkerStart(const char* const label) const
+// FNV-1a, with 0 reserved for free slots of the label table
+static unsigned int HashProfileMarkerLabel(const char* const label)
 {
-    float time = -1.f;
-#if ENABLE_PROFILE_MARKERS
+    unsigned int hash = 2166136261u;
+    for (const char* c = label; *c; c++)
+        hash = (hash ^ (unsigned char)*c) * 16777619u;
+
+    return hash ? hash : 1u;
+}
+
+const unsigned int Profiler::FindProfileMarkerLabel(const char* const label) const
+{
+    const unsigned int hash = HashProfileMarkerLabel(label);
+
+    // Slots are never freed and are published only after their labels have
+    // been written, so lookups of already registered labels can skip the lock.
+    unsigned int slot = hash & (MAX_PROFILE_MARKER_LABELS - 1);
+    for (unsigned int probe = 0; probe < MAX_PROFILE_MARKER_LABELS; probe++, slot = (slot + 1) & (MAX_PROFILE_MARKER_LABELS - 1))
+    {
+        const unsigned int slotHash = m_arrProfileMarkerLabel[slot].nHash.load(std::memory_order_acquire);
+        if (slotHash == 0)
+            break;
+        if (slotHash == hash && m_arrProfileMarkerLabel[slot].szLabel == label)
+            return slot;
+    }
+
+    return ~0u;
+}
+
+const unsigned int Profiler::InternProfileMarkerLabel(const char* const label)
+{
+    unsigned int markerId = FindProfileMarkerLabel(label);
+    if (markerId != ~0u)
+        return markerId;
+
+    // First time we see this label: register it
+    const unsigned int hash = HashProfileMarkerLabel(label);
     MUTEX_LOCK(gProfileMarkerMutex);
-    for (unsigned int i = 0; i < m_arrGPUProfileMarkerResult.size(); i++)
+    unsigned int slot = hash & (MAX_PROFILE_MARKER_LABELS - 1);
+    for (unsigned int probe = 0; probe < MAX_PROFILE_MARKER_LABELS; probe++, slot = (slot + 1) & (MAX_PROFILE_MARKER_LABELS - 1))
     {
-        GPUProfileMarkerResult* marker = m_arrGPUProfileMarkerResult[i];
-        if (marker && marker->m_eStatus == GPUProfileMarkerResult::GPMRS_VALID && strcmp(label, marker->m_szLabel) == 0)
+        ProfileMarkerLabel& entry = m_arrProfileMarkerLabel[slot];
+        const unsigned int slotHash = entry.nHash.load(std::memory_order_relaxed);
+        if (slotHash == hash && entry.szLabel == label)
+        {
+            // Registered by another thread in the meantime
+            markerId = slot;
+            break;
+        }
+        if (slotHash == 0)
         {
-            time = marker->m_fStart;
+            entry.szLabel = label;
+            entry.szWideLabel.assign(entry.szLabel.begin(), entry.szLabel.end());
+            entry.nHash.store(hash, std::memory_order_release);
+            markerId = slot;
             break;
         }
     }
     MUTEX_UNLOCK(gProfileMarkerMutex);
+
+    assert(markerId != ~0u); // Increase MAX_PROFILE_MARKER_LABELS
+    return markerId;
+}
+
+const char* const Profiler::GetProfileMarkerLabel(const unsigned int markerId) const
+{
+    if (markerId >= MAX_PROFILE_MARKER_LABELS || m_arrProfileMarkerLabel[markerId].nHash.load(std::memory_order_acquire) == 0)
+        return "";
+
+    return m_arrProfileMarkerLabel[markerId].szLabel.c_str();
+}
+
+const wchar_t* const Profiler::GetProfileMarkerWideLabel(const unsigned int markerId) const
+{
+    if (markerId >= MAX_PROFILE_MARKER_LABELS || m_arrProfileMarkerLabel[markerId].nHash.load(std::memory_order_acquire) == 0)
+        return L"";
+
+    return m_arrProfileMarkerLabel[markerId].szWideLabel.c_str();
+}
+
+const RenderCounters* const Profiler::RetrieveProfileMarkerCounters(const unsigned int markerId) const
+{
+    if (markerId >= MAX_PROFILE_MARKER_LABELS)
+        return nullptr;
+
+    // Counters roll over to the last frame lazily, when a scope is closed in a new frame
+    const ProfileMarkerCounters& counters = m_arrProfileMarkerCounters[markerId];
+    if (counters.nCurrentFrame + 1 == m_nCounterFrame)
+        return &counters.tCurrent;
+    if (counters.nCurrentFrame == m_nCounterFrame && counters.nLastFrame + 1 == m_nCounterFrame)
+        return &counters.tLastFrame;
+
+    return nullptr;
+}
+
+void Profiler::ResetCounters()
+{
+    m_nCounterFrame++;
+}
+
+const bool Profiler::IsRenderThread() const
+{
+    return std::this_thread::get_id() == m_tRenderThreadId;
+}
+
+const long long Profiler::GetCPUTimestamp()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Profiler::MarkGPUTimelineOrigin()
+{
+    if (m_nGPUTimelineOrigin < 0)
+        m_nGPUTimelineOrigin = GetCPUTimestamp();
+}
+
+Profiler::CPUProfileThreadBuffer* const Profiler::GetCPUProfileThreadBuffer()
+{
+    if (ms_pCPUProfileThreadBuffer && ms_nCPUProfileThreadBufferOwnerId == m_nInstanceId)
+        return ms_pCPUProfileThreadBuffer;
+
+    // First scope recorded on this thread: register a ring buffer for it
+    CPUProfileThreadBuffer* const buffer = new CPUProfileThreadBuffer;
+    buffer->nWriteCount = 0;
+
+    MUTEX_LOCK(gProfileMarkerMutex);
+    buffer->nThreadIdx = (unsigned int)m_arrCPUProfileThreadBuffer.size();
+    buffer->szThreadName = IsRenderThread() ? "Render thread" : "Thread " + std::to_string(buffer->nThreadIdx);
+    m_arrCPUProfileThreadBuffer.push_back(buffer);
+    MUTEX_UNLOCK(gProfileMarkerMutex);
+
+    ms_pCPUProfileThreadBuffer = buffer;
+    ms_nCPUProfileThreadBufferOwnerId = m_nInstanceId;
+
+    return buffer;
+}
+
+void Profiler::RecordCPUProfileScope(const unsigned int markerId, const long long start, const long long end)
+{
+#if ENABLE_PROFILE_MARKERS
+    if (markerId == ~0u)
+        return;
+
+    // Only the owning thread writes to its buffer, so no locking is required
+    CPUProfileThreadBuffer* const buffer = GetCPUProfileThreadBuffer();
+    const unsigned int writeCount = buffer->nWriteCount.load(std::memory_order_relaxed);
+    CPUProfileEvent& evt = buffer->arrEvent[writeCount % CPU_PROFILE_EVENT_BUFFER_SIZE];
+    evt.nMarkerId = markerId;
+    evt.nStart = start;
+    evt.nEnd = end;
+    buffer->nWriteCount.store(writeCount + 1, std::memory_order_release);
 #endif
-    return time;
 }
 
-const float Profiler::RetrieveGPUProfileMarkerEnd(const char* const label) const
+void Profiler::SetCPUProfileThreadName(const char* const name)
 {
-    float time = -1.f;
 #if ENABLE_PROFILE_MARKERS
+    CPUProfileThreadBuffer* const buffer = GetCPUProfileThreadBuffer();
+
     MUTEX_LOCK(gProfileMarkerMutex);
-    for (unsigned int i = 0; i < m_arrGPUProfileMarkerResult.size(); i++)
+    buffer->szThreadName = name;
+    MUTEX_UNLOCK(gProfileMarkerMutex);
+#endif
+}
+
+// Writes a string as a JSON string literal
+static void WriteJSONString(std::ofstream& file, const char* str)
+{
+    file << '"';
+    for (; *str; str++)
     {
-        GPUProfileMarkerResult* marker = m_arrGPUProfileMarkerResult[i];
-        if (marker && marker->m_eStatus == GPUProfileMarkerResult::GPMRS_VALID && strcmp(label, marker->m_szLabel) == 0)
+        switch (*str)
         {
-            time = marker->m_fEnd;
+        case '"':
+            file << "\\\"";
             break;
+        case '\\':
+            file << "\\\\";
+            break;
+        default:
+            if ((unsigned char)*str >= 0x20)
+                file << *str;
         }
     }
+    file << '"';
+}
+
+const bool Profiler::ExportTrace(const char* const filePath) const
+{
+#if ENABLE_PROFILE_MARKERS
+    std::ofstream file(filePath, std::ios::out | std::ios::trunc);
+    if (!file.is_open())
+        return false;
+
+    // Timestamps are written relative to the oldest recorded event
+    // and in microseconds, which is what the trace viewers expect.
+    enum { CPU_PID = 1, GPU_PID = 2 };
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << CPU_PID << ",\"args\":{\"name\":\"CPU\"}},\n";
+    file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << GPU_PID << ",\"args\":{\"name\":\"GPU\"}}";
+
+    MUTEX_LOCK(gProfileMarkerMutex);
+
+    long long origin = m_nGPUTimelineOrigin >= 0 ? m_nGPUTimelineOrigin : GetCPUTimestamp();
+    for (unsigned int thIdx = 0; thIdx < (unsigned int)m_arrCPUProfileThreadBuffer.size(); thIdx++)
+    {
+        const CPUProfileThreadBuffer* const buffer = m_arrCPUProfileThreadBuffer[thIdx];
+        const unsigned int writeCount = buffer->nWriteCount.load(std::memory_order_acquire);
+        const unsigned int first = writeCount > CPU_PROFILE_EVENT_BUFFER_SIZE ? writeCount - CPU_PROFILE_EVENT_BUFFER_SIZE : 0;
+        if (writeCount > first && buffer->arrEvent[first % CPU_PROFILE_EVENT_BUFFER_SIZE].nStart < origin)
+            origin = buffer->arrEvent[first % CPU_PROFILE_EVENT_BUFFER_SIZE].nStart;
+    }
+
+    // CPU scopes, one track per thread
+    for (unsigned int thIdx = 0; thIdx < (unsigned int)m_arrCPUProfileThreadBuffer.size(); thIdx++)
+    {
+        const CPUProfileThreadBuffer* const buffer = m_arrCPUProfileThreadBuffer[thIdx];
+
+        file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << CPU_PID << ",\"tid\":" << buffer->nThreadIdx << ",\"args\":{\"name\":";
+        WriteJSONString(file, buffer->szThreadName.c_str());
+        file << "}}";
+
+        const unsigned int writeCount = buffer->nWriteCount.load(std::memory_order_acquire);
+        const unsigned int first = writeCount > CPU_PROFILE_EVENT_BUFFER_SIZE ? writeCount - CPU_PROFILE_EVENT_BUFFER_SIZE : 0;
+        for (unsigned int evtIdx = first; evtIdx < writeCount; evtIdx++)
+        {
+            const CPUProfileEvent& evt = buffer->arrEvent[evtIdx % CPU_PROFILE_EVENT_BUFFER_SIZE];
+            file << ",\n{\"name\":";
+            WriteJSONString(file, GetProfileMarkerLabel(evt.nMarkerId));
+            file << ",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":" << CPU_PID << ",\"tid\":" << buffer->nThreadIdx
+                << ",\"ts\":" << (double)(evt.nStart - origin) / 1000.0
+                << ",\"dur\":" << (double)(evt.nEnd - evt.nStart) / 1000.0 << "}";
+        }
+    }
+
+    // GPU profile markers, on a single track
+    if (m_nGPUTimelineOrigin >= 0)
+    {
+        file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << GPU_PID << ",\"tid\":0,\"args\":{\"name\":\"GPU queue\"}}";
+
+        const double gpuOffset = (double)(m_nGPUTimelineOrigin - origin) / 1000.0;
+        const unsigned int first = m_nGPUProfileEventCount > GPU_PROFILE_EVENT_BUFFER_SIZE ? m_nGPUProfileEventCount - GPU_PROFILE_EVENT_BUFFER_SIZE : 0;
+        for (unsigned int evtIdx = first; evtIdx < m_nGPUProfileEventCount; evtIdx++)
+        {
+            const GPUProfileEvent& evt = m_arrGPUProfileEvent[evtIdx % GPU_PROFILE_EVENT_BUFFER_SIZE];
+            file << ",\n{\"name\":";
+            WriteJSONString(file, GetProfileMarkerLabel(evt.nMarkerId));
+            file << ",\"cat\":\"gpu\",\"ph\":\"X\",\"pid\":" << GPU_PID << ",\"tid\":0"
+                << ",\"ts\":" << gpuOffset + evt.fStart
+                << ",\"dur\":" << evt.fEnd - evt.fStart << "}";
+        }
+    }
+
     MUTEX_UNLOCK(gProfileMarkerMutex);
+
+    file << "\n]}\n";
+
+    return file.good();
+#else
+    return false;
+#endif
+}
+
+const float Profiler::RetrieveGPUProfileMarkerStart(const char* const label) const
+{
+    float time = -1.f;
+#if ENABLE_PROFILE_MARKERS
+    const unsigned int markerId = FindProfileMarkerLabel(label);
+    if (markerId != ~0u)
+    {
+        MUTEX_LOCK(gProfileMarkerMutex);
+        if (m_arrLatestGPUProfileMarkerResult[markerId])
+            time = m_arrLatestGPUProfileMarkerResult[markerId]->m_fStart;
+        MUTEX_UNLOCK(gProfileMarkerMutex);
+    }
+#endif
+    return time;
+}
+
+const float Profiler::RetrieveGPUProfileMarkerEnd(const char* const label) const
+{
+    float time = -1.f;
+#if ENABLE_PROFILE_MARKERS
+    const unsigned int markerId = FindProfileMarkerLabel(label);
+    if (markerId != ~0u)
+    {
+        MUTEX_LOCK(gProfileMarkerMutex);
+        if (m_arrLatestGPUProfileMarkerResult[markerId])
+            time = m_arrLatestGPUProfileMarkerResult[markerId]->m_fEnd;
+        MUTEX_UNLOCK(gProfileMarkerMutex);
+    }
 #endif
     return time;
 }
@@ -108,17 +437,14 @@ const float Profiler::RetrieveGPUProfileMarkerResult(const char* const label) co
 {
     float time = -1.f;
 #if ENABLE_PROFILE_MARKERS
-    MUTEX_LOCK(gProfileMarkerMutex);
-    for (unsigned int i = 0; i < m_arrGPUProfileMarkerResult.size(); i++)
+    const unsigned int markerId = FindProfileMarkerLabel(label);
+    if (markerId != ~0u)
     {
-        GPUProfileMarkerResult* marker = m_arrGPUProfileMarkerResult[i];
-        if (marker && marker->m_eStatus == GPUProfileMarkerResult::GPMRS_VALID && strcmp(label, marker->m_szLabel) == 0)
-        {
-            time = marker->m_fTime;
-            break;
-        }
+        MUTEX_LOCK(gProfileMarkerMutex);
+        if (m_arrLatestGPUProfileMarkerResult[markerId])
+            time = m_arrLatestGPUProfileMarkerResult[markerId]->m_fTime;
+        MUTEX_UNLOCK(gProfileMarkerMutex);
     }
-    MUTEX_UNLOCK(gProfileMarkerMutex);
 #endif
     return time;
 }
@@ -140,22 +466,52 @@ const GPUProfileMarkerResult* const Profiler::RetrieveGPUProfileMarker(const uns
 }
 
 const GPUProfileMarkerResult* const Profiler::RetrieveGPUProfileMarker(const char* const label) const
+{
+#if ENABLE_PROFILE_MARKERS
+    return RetrieveGPUProfileMarkerById(FindProfileMarkerLabel(label));
+#else
+    return nullptr;
+#endif
+}
+
+const GPUProfileMarkerResult* const Profiler::RetrieveGPUProfileMarkerById(const unsigned int markerId) const
 {
     const GPUProfileMarkerResult* ret = nullptr;
+#if ENABLE_PROFILE_MARKERS
+    if (markerId < MAX_PROFILE_MARKER_LABELS)
+    {
+        MUTEX_LOCK(gProfileMarkerMutex);
+        ret = m_arrLatestGPUProfileMarkerResult[markerId];
+        MUTEX_UNLOCK(gProfileMarkerMutex);
+    }
+#endif
+    return ret;
+}
+
+void Profiler::RetrieveGPUProfileMarkerSnapshot(GPUProfileMarkerSnapshot& snapshot) const
+{
+    snapshot.m_arrSample.clear();
+    snapshot.m_arrSampleIdx.assign(MAX_PROFILE_MARKER_LABELS, ~0u);
 #if ENABLE_PROFILE_MARKERS
     MUTEX_LOCK(gProfileMarkerMutex);
-    for (unsigned int i = 0; i < m_arrGPUProfileMarkerResult.size(); i++)
+    for (unsigned int i = 0; i < (unsigned int)m_arrGPUProfileMarkerResult.size(); i++)
     {
         const GPUProfileMarkerResult* const marker = m_arrGPUProfileMarkerResult[i];
-        if (marker && marker->m_eStatus == GPUProfileMarkerResult::GPMRS_VALID && strcmp(label, marker->m_szLabel) == 0)
+        if (marker && marker == m_arrLatestGPUProfileMarkerResult[marker->m_nMarkerId])
         {
-            ret = marker;
-            break;
+            GPUProfileMarkerSample sample;
+            sample.nMarkerId = marker->m_nMarkerId;
+            sample.szLabel = marker->m_szLabel;
+            sample.fTiming = marker->m_fTime;
+            sample.fStart = marker->m_fStart;
+            sample.fEnd = marker->m_fEnd;
+
+            snapshot.m_arrSampleIdx[sample.nMarkerId] = (unsigned int)snapshot.m_arrSample.size();
+            snapshot.m_arrSample.push_back(sample);
         }
     }
     MUTEX_UNLOCK(gProfileMarkerMutex);
 #endif
-    return ret;
 }
 
 const unsigned int Profiler::GetGPUProfileMarkerCount() const
@@ -172,56 +528,85 @@ void Profiler::ReleaseGPUProfileMarkerResults()
     }
 
     m_arrGPUProfileMarkerResult.clear();
+
+    for (unsigned int i = 0; i < MAX_PROFILE_MARKER_LABELS; i++)
+        m_arrLatestGPUProfileMarkerResult[i] = nullptr;
 #endif
 }
 
 void Profiler::UpdateGPUProfileMarkerResults()
 {
 #if ENABLE_PROFILE_MARKERS
-    // Cleanup old timestamps
+    // Copy newly resolved timestamps to the trace buffer
+    MUTEX_LOCK(gProfileMarkerMutex);
+    for (unsigned int i = 0; i < (unsigned int)m_arrGPUProfileMarkerResult.size(); i++)
+    {
+        GPUProfileMarkerResult* result = m_arrGPUProfileMarkerResult[i];
+        if (result && result->m_eStatus == GPUProfileMarkerResult::GPMRS_VALID && !result->m_bTraced)
+        {
+            GPUProfileEvent& evt = m_arrGPUProfileEvent[m_nGPUProfileEventCount++ % GPU_PROFILE_EVENT_BUFFER_SIZE];
+            evt.nMarkerId = result->m_nMarkerId;
+            evt.fStart = result->m_fStart;
+            evt.fEnd = result->m_fEnd;
+            result->m_bTraced = true;
+        }
+    }
+
+    // Cleanup old timestamps: walking from newest to oldest, only keep results
+    // issued after the latest valid result of their label, which is also indexed
+    for (unsigned int i = 0; i < MAX_PROFILE_MARKER_LABELS; i++)
+        m_arrLatestGPUProfileMarkerResult[i] = nullptr;
+
     for (int i = (int)m_arrGPUProfileMarkerResult.size() - 1; i >= 0; i--)
     {
         GPUProfileMarkerResult* result = m_arrGPUProfileMarkerResult[i];
-        if (result && result->m_eStatus == GPUProfileMarkerResult::GPMRS_VALID)
+        if (!result)
+            continue;
+
+        if (m_arrLatestGPUProfileMarkerResult[result->m_nMarkerId])
         {
-            for (int j = i - 1; j >= 0; j--)
-            {
-                GPUProfileMarkerResult* otherResult = m_arrGPUProfileMarkerResult[j];
-                if (otherResult && strcmp(otherResult->m_szLabel, result->m_szLabel) == 0)
-                {
-                    delete otherResult;
-                    m_arrGPUProfileMarkerResult.erase(m_arrGPUProfileMarkerResult.begin() + j);
-                    i--;
-                    continue;
-                }
-            }
+            RecycleGPUProfileMarkerResult(result);
+            m_arrGPUProfileMarkerResult.erase(m_arrGPUProfileMarkerResult.begin() + i);
+        }
+        else if (result->m_eStatus == GPUProfileMarkerResult::GPMRS_VALID)
+        {
+            m_arrLatestGPUProfileMarkerResult[result->m_nMarkerId] = result;
         }
     }
+    MUTEX_UNLOCK(gProfileMarkerMutex);
 #endif
 }
 
+void Profiler::RecycleGPUProfileMarkerResult(GPUProfileMarkerResult* const result)
+{
+    delete result;
+}
+
 //////////////////////////////////
 // GPUProfileMarkerResult class //
 //////////////////////////////////
-GPUProfileMarkerResult::GPUProfileMarkerResult(const char* const label)
+GPUProfileMarkerResult::GPUProfileMarkerResult(const unsigned int markerId, const char* const label)
     : m_fTime(-1.f)
     , m_fStart(-1.f)
     , m_fEnd(-1.f)
     , m_eStatus(GPMRS_ISSUED)
-    , m_szLabel(nullptr)
-{
-#if ENABLE_PROFILE_MARKERS
-    const unsigned int size = (unsigned int)strlen(label) + 1;
-    m_szLabel = new char[size];
-    strcpy_s(m_szLabel, size, label);
-#endif
-}
+    , m_szLabel(label)
+    , m_nMarkerId(markerId)
+    , m_bTraced(false)
+{}
 
 GPUProfileMarkerResult::~GPUProfileMarkerResult()
+{}
+
+void GPUProfileMarkerResult::Reset(const unsigned int markerId, const char* const label)
 {
-#if ENABLE_PROFILE_MARKERS
-    delete m_szLabel;
-#endif
+    m_fTime = -1.f;
+    m_fStart = -1.f;
+    m_fEnd = -1.f;
+    m_eStatus = GPMRS_ISSUED;
+    m_szLabel = label;
+    m_nMarkerId = markerId;
+    m_bTraced = false;
 }
 
 const char* const GPUProfileMarkerResult::GetLabel() const
@@ -229,6 +614,11 @@ const char* const GPUProfileMarkerResult::GetLabel() const
     return m_szLabel;
 }
 
+const unsigned int GPUProfileMarkerResult::GetMarkerId() const
+{
+    return m_nMarkerId;
+}
+
 const float GPUProfileMarkerResult::GetTiming() const
 {
     return m_fTime;
@@ -243,3 +633,55 @@ const float GPUProfileMarkerResult::GetEnd() const
 {
     return m_fEnd;
 }
+
+///////////////////////////
+// CPUProfileScope class //
+///////////////////////////
+CPUProfileScope::CPUProfileScope(const char* const label)
+    : m_nMarkerId(~0u)
+    , m_nStart(0)
+{
+#if ENABLE_PROFILE_MARKERS
+    Profiler* const profiler = Renderer::GetInstance() ? Renderer::GetInstance()->GetProfiler() : nullptr;
+    if (profiler)
+    {
+        m_nMarkerId = profiler->InternProfileMarkerLabel(label);
+        m_nStart = Profiler::GetCPUTimestamp();
+    }
+#endif
+}
+
+CPUProfileScope::CPUProfileScope(const unsigned int markerId)
+    : m_nMarkerId(markerId)
+    , m_nStart(0)
+{
+#if ENABLE_PROFILE_MARKERS
+    m_nStart = Profiler::GetCPUTimestamp();
+#endif
+}
+
+CPUProfileScope::~CPUProfileScope()
+{
+#if ENABLE_PROFILE_MARKERS
+    Profiler* const profiler = Renderer::GetInstance() ? Renderer::GetInstance()->GetProfiler() : nullptr;
+    if (profiler)
+        profiler->RecordCPUProfileScope(m_nMarkerId, m_nStart, Profiler::GetCPUTimestamp());
+#endif
+}
+
+///////////////////////////////////
+// ProfileMarkerLabelCache class //
+///////////////////////////////////
+const unsigned int ProfileMarkerLabelCache::GetMarkerId(Profiler* const profiler, const char* const label)
+{
+    // Identifiers are only valid for the profiler that interned them
+    const unsigned long long cachedMarkerId = m_nCachedMarkerId.load(std::memory_order_relaxed);
+    if ((unsigned int)(cachedMarkerId >> 32) == profiler->m_nInstanceId)
+        return (unsigned int)cachedMarkerId;
+
+    const unsigned int markerId = profiler->InternProfileMarkerLabel(label);
+    if (markerId != ~0u)
+        m_nCachedMarkerId.store(((unsigned long long)profiler->m_nInstanceId << 32) | markerId, std::memory_order_relaxed);
+
+    return markerId;
+}
@@ -32,6 +32,11 @@
 #endif // SYNESTHESIA3D_DLL
 
 #include <vector>
+#include <string>
+#include <atomic>
+#include <thread>
+
+#include "ResourceData.h"
 
 #ifndef ENABLE_PROFILE_MARKERS
     #if defined(_DEBUG) || defined(_PROFILE)
@@ -41,13 +46,39 @@
     #endif
 #endif
 
+#define PROFILE_MARKER_LEVEL_FRAME  (0) /**< @brief Markers around whole frames. */
+#define PROFILE_MARKER_LEVEL_PASS   (1) /**< @brief Markers around render passes and their stages (@ref PUSH_PROFILE_MARKER()). */
+#define PROFILE_MARKER_LEVEL_DRAW   (2) /**< @brief Markers around individual draws (@ref PUSH_DRAW_PROFILE_MARKER()). */
+#define PROFILE_MARKER_LEVEL_DETAIL (3) /**< @brief Markers around shader input commits (@ref PUSH_DETAIL_PROFILE_MARKER()). */
+
+#ifndef PROFILE_MARKER_LEVEL
+    #if defined(_DEBUG)
+        #define PROFILE_MARKER_LEVEL PROFILE_MARKER_LEVEL_DETAIL    /**< @brief Finest level of profile markers that gets compiled in. */
+    #else
+        #define PROFILE_MARKER_LEVEL PROFILE_MARKER_LEVEL_PASS      /**< @brief Finest level of profile markers that gets compiled in. */
+    #endif
+#endif
+
 #if ENABLE_PROFILE_MARKERS
-    extern int g_nProfileMarkerCounter; /**< Counter for keeping track of profile markers pushes/pops. */
     #ifndef PUSH_PROFILE_MARKER
         /**
-         * @brief   Macro for simple introduction of a profile marker.
+         * @brief   Macro for simple introduction of a profile marker, labeled by a string literal.
+         *
+         * @note    The label is interned once per call site. Use @ref PUSH_DYNAMIC_PROFILE_MARKER() for labels built at runtime.
          */
         #define PUSH_PROFILE_MARKER(label) \
+            if(Synesthesia3D::Renderer::GetInstance() && Synesthesia3D::Renderer::GetInstance()->GetProfiler()) \
+            { \
+                static Synesthesia3D::ProfileMarkerLabelCache profileMarkerLabelCache; \
+                Synesthesia3D::Profiler* const profileMarkerProfiler = Synesthesia3D::Renderer::GetInstance()->GetProfiler(); \
+                profileMarkerProfiler->PushProfileMarker(profileMarkerLabelCache.GetMarkerId(profileMarkerProfiler, "" label)); \
+            } else ((void)0)
+    #endif
+    #ifndef PUSH_DYNAMIC_PROFILE_MARKER
+        /**
+         * @brief   Macro for introducing a profile marker whose label is built at runtime (interned on every push).
+         */
+        #define PUSH_DYNAMIC_PROFILE_MARKER(label) \
             if(Synesthesia3D::Renderer::GetInstance() && Synesthesia3D::Renderer::GetInstance()->GetProfiler()) \
                 Synesthesia3D::Renderer::GetInstance()->GetProfiler()->PushProfileMarker(label)
     #endif
@@ -71,6 +102,9 @@
     #ifndef PUSH_PROFILE_MARKER
         #define PUSH_PROFILE_MARKER(label) ((void)0)
     #endif
+    #ifndef PUSH_DYNAMIC_PROFILE_MARKER
+        #define PUSH_DYNAMIC_PROFILE_MARKER(label) ((void)0)
+    #endif
     #ifndef PUSH_PROFILE_MARKER_WITH_GPU_QUERY
         #define PUSH_PROFILE_MARKER_WITH_GPU_QUERY(label) ((void)0)
     #endif
@@ -79,10 +113,57 @@
     #endif
 #endif
 
+#if ENABLE_PROFILE_MARKERS && PROFILE_MARKER_LEVEL >= PROFILE_MARKER_LEVEL_DRAW
+    /**
+     * @brief   Macro for introducing a profile marker around an individual draw.
+     */
+    #define PUSH_DRAW_PROFILE_MARKER(label) PUSH_DYNAMIC_PROFILE_MARKER(label)
+    /**
+     * @brief   Macro for removing a profile marker introduced by @ref PUSH_DRAW_PROFILE_MARKER().
+     */
+    #define POP_DRAW_PROFILE_MARKER() POP_PROFILE_MARKER()
+#else
+    #define PUSH_DRAW_PROFILE_MARKER(label) ((void)0)
+    #define POP_DRAW_PROFILE_MARKER() ((void)0)
+#endif
+
+#if ENABLE_PROFILE_MARKERS && PROFILE_MARKER_LEVEL >= PROFILE_MARKER_LEVEL_DETAIL
+    /**
+     * @brief   Macro for introducing a fine-grained profile marker (e.g. per shader input).
+     */
+    #define PUSH_DETAIL_PROFILE_MARKER(label) PUSH_DYNAMIC_PROFILE_MARKER(label)
+    /**
+     * @brief   Macro for removing a profile marker introduced by @ref PUSH_DETAIL_PROFILE_MARKER().
+     */
+    #define POP_DETAIL_PROFILE_MARKER() POP_PROFILE_MARKER()
+#else
+    #define PUSH_DETAIL_PROFILE_MARKER(label) ((void)0)
+    #define POP_DETAIL_PROFILE_MARKER() ((void)0)
+#endif
+
+#if ENABLE_PROFILE_MARKERS
+    #ifndef CPU_PROFILE_SCOPE
+        /**
+         * @brief   Macro for timing the enclosing scope on the CPU (see @ref Synesthesia3D::Profiler::ExportTrace()).
+         */
+        #define CPU_PROFILE_SCOPE(label) Synesthesia3D::CPUProfileScope CPU_PROFILE_SCOPE_NAME(__LINE__)(label)
+        #define CPU_PROFILE_SCOPE_NAME(line) CPU_PROFILE_SCOPE_NAME_IMPL(line)
+        #define CPU_PROFILE_SCOPE_NAME_IMPL(line) cpuProfileScope##line
+    #endif
+#else
+    #ifndef CPU_PROFILE_SCOPE
+        #define CPU_PROFILE_SCOPE(label) ((void)0)
+    #endif
+#endif
+
 namespace Synesthesia3D
 {
+    class Profiler;
+
     class GPUProfileMarkerResult
     {
+        S3D_ALLOCATION_TAG(AT_PROFILER)
+
     public:
         enum GPUProfileMarkerResultStatus
         {
@@ -91,25 +172,107 @@ namespace Synesthesia3D
         };
 
         SYNESTHESIA3D_DLL   const char* const   GetLabel() const;
+        SYNESTHESIA3D_DLL   const unsigned int  GetMarkerId() const;
         SYNESTHESIA3D_DLL   const float         GetTiming() const;
         SYNESTHESIA3D_DLL   const float         GetStart() const;
         SYNESTHESIA3D_DLL   const float         GetEnd() const;
 
     protected:
-        GPUProfileMarkerResult(const char* const label);
+        GPUProfileMarkerResult(const unsigned int markerId, const char* const label);
         virtual ~GPUProfileMarkerResult();
 
-        char* m_szLabel;
+        // Reinitializes a pooled result for a new marker
+        void Reset(const unsigned int markerId, const char* const label);
+
+        const char* m_szLabel;      // Points into the profiler's interned label table
+        unsigned int m_nMarkerId;
         float m_fTime;
         float m_fStart;
         float m_fEnd;
         GPUProfileMarkerResultStatus m_eStatus;
+        bool m_bTraced;             // Whether it has been copied to the profiler's trace buffer
+
+        friend class Profiler;
+    };
+
+    /**
+    * @brief    Times the scope it lives in on the CPU (see @ref CPU_PROFILE_SCOPE()).
+    */
+    class CPUProfileScope
+    {
+    public:
+        SYNESTHESIA3D_DLL   CPUProfileScope(const char* const label);
+        SYNESTHESIA3D_DLL   CPUProfileScope(const unsigned int markerId);
+        SYNESTHESIA3D_DLL   ~CPUProfileScope();
+
+    private:
+        unsigned int    m_nMarkerId;    /**< @brief Interned label of the scope. */
+        long long       m_nStart;       /**< @brief CPU timestamp at the start of the scope, in nanoseconds. */
+    };
+
+    /**
+    * @brief    Caches the interned identifier of a constant profile marker label at its call site (see @ref PUSH_PROFILE_MARKER()).
+    */
+    class ProfileMarkerLabelCache
+    {
+    public:
+        ProfileMarkerLabelCache()
+            : m_nCachedMarkerId(0)
+        {}
+
+        /**
+        * @brief    Retrieves the identifier of the label, interning it only if it hasn't been cached for this profiler yet.
+        *
+        * @note Never locks or allocates once the identifier has been cached.
+        */
+        SYNESTHESIA3D_DLL   const unsigned int  GetMarkerId(Profiler* const profiler, const char* const label);
+
+    private:
+        std::atomic<unsigned long long> m_nCachedMarkerId;  /**< @brief Instance ID of the profiler that interned the label (high 32 bits) and the label's identifier (low 32 bits), or 0. */
+    };
+
+    /**
+    * @brief    A copy of a GPU profile marker result, as retrieved by @ref Profiler::RetrieveGPUProfileMarkerSnapshot().
+    */
+    struct GPUProfileMarkerSample
+    {
+        unsigned int    nMarkerId;  /**< @brief Interned label of the marker. */
+        const char*     szLabel;    /**< @brief Label of the marker. */
+        float           fTiming;    /**< @brief GPU timing, in miliseconds. */
+        float           fStart;     /**< @brief GPU absolute start time. */
+        float           fEnd;       /**< @brief GPU absolute end time. */
+    };
+
+    /**
+    * @brief    The latest GPU profile marker results for every label, retrieved under a single lock.
+    */
+    class GPUProfileMarkerSnapshot
+    {
+    public:
+        /**
+        * @brief    Retrieves the result for the specified interned label, or nullptr if there isn't one.
+        */
+        const GPUProfileMarkerSample* const Find(const unsigned int markerId) const
+        {
+            return markerId < m_arrSampleIdx.size() && m_arrSampleIdx[markerId] != ~0u ? &m_arrSample[m_arrSampleIdx[markerId]] : nullptr;
+        }
+
+        /**
+        * @brief    Retrieves all results, in the order their markers were issued.
+        */
+        const std::vector<GPUProfileMarkerSample>& GetSamples() const { return m_arrSample; }
+
+    protected:
+        std::vector<GPUProfileMarkerSample> m_arrSample;    /**< @brief The results. */
+        std::vector<unsigned int>           m_arrSampleIdx; /**< @brief Index in @ref m_arrSample of each marker ID's result. */
 
         friend class Profiler;
     };
 
     class Profiler
     {
+        S3D_ALLOCATION_TAG(AT_PROFILER)
+
     public:
         /**
         * @brief    Marks the beginning of a user-defined event, viewable in graphical analysis tools.
@@ -122,7 +285,42 @@ namespace Synesthesia3D
         * @see Profiler::RetrieveGPUProfileMarker() @see Profiler::RetrieveGPUProfileMarkerResult() 
         * @see Profiler::RetrieveGPUProfileMarkerStart() @see Profiler::RetrieveGPUProfileMarkerEnd()
         */
-        virtual SYNESTHESIA3D_DLL                   void                PushProfileMarker(const char* const label, const bool issueGPUQuery = false);
+                SYNESTHESIA3D_DLL                   void                PushProfileMarker(const char* const label, const bool issueGPUQuery = false);
+
+        /**
+        * @brief    Marks the beginning of a user-defined event, identified by an interned label.
+        *
+        * @note Must be paried with a corresponding @ref PopProfileMarker().
+        *
+        * @param[in]    markerId        An identifier returned by @ref InternProfileMarkerLabel().
+        * @param[in]    issueGPUQuery   Whether to issue a GPU marker as well (only on the rendering thread)
+        */
+        virtual SYNESTHESIA3D_DLL                   void                PushProfileMarker(const unsigned int markerId, const bool issueGPUQuery = false);
+
+        /**
+        * @brief    Retrieves the identifier of a profile marker label, registering it if it's the first time it's seen.
+        *
+        * @note Does not allocate or lock once a label has been registered.
+        *
+        * @param[in]    label           A name for the event.
+        *
+        * @return   An identifier to pass to @ref PushProfileMarker(), or ~0u if the label table is full.
+        */
+                SYNESTHESIA3D_DLL           const unsigned int          InternProfileMarkerLabel(const char* const label);
+
+        /**
+        * @brief    Retrieves the identifier of an already registered profile marker label.
+        *
+        * @note Never locks or allocates.
+        *
+        * @return   The identifier of the label, or ~0u if it hasn't been registered.
+        */
+                SYNESTHESIA3D_DLL           const unsigned int          FindProfileMarkerLabel(const char* const label) const;
+
+        /**
+        * @brief    Retrieves the label of an interned profile marker.
+        */
+                SYNESTHESIA3D_DLL               const char* const       GetProfileMarkerLabel(const unsigned int markerId) const;
 
         /**
         * @brief    Marks the end of a user-defined event.
@@ -166,6 +364,31 @@ namespace Synesthesia3D
         */
                 SYNESTHESIA3D_DLL   const GPUProfileMarkerResult* const RetrieveGPUProfileMarker(const char* const label) const;
 
+        /**
+        * @brief    Retrieves the latest GPU profile marker result for the specified interned label.
+        *
+        * @note Returns nullptr if marker is still in flight, non-existant or otherwise invalid.
+        */
+                SYNESTHESIA3D_DLL   const GPUProfileMarkerResult* const RetrieveGPUProfileMarkerById(const unsigned int markerId) const;
+
+        /**
+        * @brief    Copies the latest GPU profile marker results of all labels, under a single lock.
+        *
+        * @param[out]   snapshot        Receives the results. Reusing it across frames avoids reallocating.
+        */
+                SYNESTHESIA3D_DLL                   void                RetrieveGPUProfileMarkerSnapshot(GPUProfileMarkerSnapshot& snapshot) const;
+
+        /**
+        * @brief    Retrieves the render counters issued within the scopes of the specified interned label during the last completed frame.
+        *
+        * @note Only scopes pushed on the rendering thread are counted. Nested scopes with the same label are counted once for each level.
+        *
+        * @return   The counters, or nullptr if no scope with this label was closed during the last completed frame.
+        *
+        * @see Renderer::GetFrameCounters()
+        */
+                SYNESTHESIA3D_DLL       const RenderCounters* const     RetrieveProfileMarkerCounters(const unsigned int markerId) const;
+
         /**
         * @brief    Retrieves the number of GPU profile markers.
         *
@@ -173,6 +396,38 @@ namespace Synesthesia3D
         */
                 SYNESTHESIA3D_DLL           const unsigned int          GetGPUProfileMarkerCount() const;
 
+        /**
+        * @brief    Records a CPU scope in the calling thread's trace buffer.
+        *
+        * @note Does not lock, except for the first scope recorded on each thread.
+        *
+        * @param[in]    markerId        An identifier returned by @ref InternProfileMarkerLabel().
+        * @param[in]    start           CPU timestamp at the start of the scope (see @ref GetCPUTimestamp()).
+        * @param[in]    end             CPU timestamp at the end of the scope.
+        */
+                SYNESTHESIA3D_DLL                   void                RecordCPUProfileScope(const unsigned int markerId, const long long start, const long long end);
+
+        /**
+        * @brief    Names the calling thread in exported traces.
+        */
+                SYNESTHESIA3D_DLL                   void                SetCPUProfileThreadName(const char* const name);
+
+        /**
+        * @brief    Writes the recorded CPU scopes and GPU profile marker results to a Chrome Trace Event / Perfetto JSON file.
+        *
+        * @note GPU timings are placed on the CPU timeline relative to the first GPU query, so they are only approximately aligned.
+        *
+        * @param[in]    filePath        Path of the JSON file to write.
+        *
+        * @return   Success of operation.
+        */
+                SYNESTHESIA3D_DLL               const bool              ExportTrace(const char* const filePath) const;
+
+        /**
+        * @brief    Retrieves a high resolution CPU timestamp, in nanoseconds.
+        */
+        static  SYNESTHESIA3D_DLL           const long long             GetCPUTimestamp();
+
     protected:
         Profiler();
         virtual ~Profiler();
@@ -180,11 +435,133 @@ namespace Synesthesia3D
         virtual void ReleaseGPUProfileMarkerResults();
         virtual void UpdateGPUProfileMarkerResults();
 
-        std::vector<GPUProfileMarkerResult*>    m_arrGPUProfileMarkerResult;    /**< @brief A list of issued GPU profile markers. */
-        static  int             ms_nProfileMarkerCounter;   /**< @brief Keeps track of profiler marker start/end pairs. */
+        /**
+        * @brief    Disposes of a GPU profile marker result that is no longer needed.
+        *
+        * @note Backends may keep it for reuse by later markers, instead of deleting it.
+        */
+        virtual void RecycleGPUProfileMarkerResult(GPUProfileMarkerResult* const result);
+
+        /**
+        * @brief    Checks whether the calling thread is the one the profiler was created on (the rendering thread).
+        */
+        const bool IsRenderThread() const;
+
+        /**
+        * @brief    Retrieves the wide character version of an interned profile marker label.
+        */
+        const wchar_t* const GetProfileMarkerWideLabel(const unsigned int markerId) const;
+
+        /**
+        * @brief    Marks the current CPU time as the origin of the GPU timeline, if it hasn't been marked already.
+        *
+        * @note Should be called when the first GPU query is issued.
+        */
+        void MarkGPUTimelineOrigin();
+
+        /**
+        * @brief    Makes the render counters of the current frame's scopes available through @ref RetrieveProfileMarkerCounters().
+        *
+        * @note Called by @ref Renderer::BeginFrame().
+        */
+        void ResetCounters();
+
+        enum { MAX_PROFILE_MARKER_LABELS = 2048 };  /**< @brief Capacity of the interned label table (must be a power of two). */
+
+        /**
+        * @brief    An interned profile marker label.
+        */
+        struct ProfileMarkerLabel
+        {
+            std::atomic<unsigned int>   nHash;          /**< @brief Hash of the label, published last. 0 marks a free slot. */
+            std::string                 szLabel;        /**< @brief The label. */
+            std::wstring                szWideLabel;    /**< @brief The label, as wide characters. */
+        };
+
+        enum { CPU_PROFILE_EVENT_BUFFER_SIZE = 16384 }; /**< @brief Capacity of each thread's CPU scope ring buffer. */
+        enum { GPU_PROFILE_EVENT_BUFFER_SIZE = 16384 }; /**< @brief Capacity of the GPU profile marker ring buffer. */
+
+        /**
+        * @brief    A timed CPU scope.
+        */
+        struct CPUProfileEvent
+        {
+            unsigned int    nMarkerId;  /**< @brief Interned label of the scope. */
+            long long       nStart;     /**< @brief Start of the scope, in nanoseconds. */
+            long long       nEnd;       /**< @brief End of the scope, in nanoseconds. */
+        };
+
+        /**
+        * @brief    Ring buffer of CPU scopes recorded by a single thread.
+        */
+        struct CPUProfileThreadBuffer
+        {
+            S3D_ALLOCATION_TAG(AT_PROFILER)
+
+            std::atomic<unsigned int>   nWriteCount;    /**< @brief Number of events ever written. */
+            unsigned int                nThreadIdx;     /**< @brief Index of the thread, in order of registration. */
+            std::string                 szThreadName;   /**< @brief Name of the thread, as shown in exported traces. */
+            CPUProfileEvent             arrEvent[CPU_PROFILE_EVENT_BUFFER_SIZE];    /**< @brief The events. */
+        };
+
+        /**
+        * @brief    A resolved GPU profile marker.
+        */
+        struct GPUProfileEvent
+        {
+            unsigned int    nMarkerId;  /**< @brief Interned label of the marker. */
+            float           fStart;     /**< @brief Start of the marker, in microseconds since the first GPU query. */
+            float           fEnd;       /**< @brief End of the marker, in microseconds since the first GPU query. */
+        };
+
+        enum { MAX_COUNTER_SCOPE_DEPTH = 64 };  /**< @brief Depth of nested profile marker scopes whose render counters are tracked. */
+
+        /**
+        * @brief    Render counters of the scopes of an interned label.
+        */
+        struct ProfileMarkerCounters
+        {
+            RenderCounters  tCurrent;       /**< @brief Counters accumulated during frame @ref nCurrentFrame. */
+            RenderCounters  tLastFrame;     /**< @brief Counters accumulated during frame @ref nLastFrame. */
+            unsigned int    nCurrentFrame;  /**< @brief The latest frame in which a scope was closed. */
+            unsigned int    nLastFrame;     /**< @brief The frame before it in which a scope was closed. */
+        };
+
+        /**
+        * @brief    An open profile marker scope on the rendering thread.
+        */
+        struct CounterScope
+        {
+            unsigned int    nMarkerId;      /**< @brief Interned label of the scope. */
+            RenderCounters  tStart;         /**< @brief Render counter totals when the scope was opened. */
+        };
+
+        /**
+        * @brief    Retrieves the calling thread's CPU scope ring buffer, creating it if required.
+        */
+        CPUProfileThreadBuffer* const GetCPUProfileThreadBuffer();
+
+        std::vector<GPUProfileMarkerResult*, StlAllocator<GPUProfileMarkerResult*, AT_PROFILER>> m_arrGPUProfileMarkerResult;  /**< @brief A list of issued GPU profile markers. */
+        std::vector<CPUProfileThreadBuffer*, StlAllocator<CPUProfileThreadBuffer*, AT_PROFILER>> m_arrCPUProfileThreadBuffer;  /**< @brief CPU scope ring buffers of every thread that recorded a scope. */
+        std::vector<GPUProfileEvent, StlAllocator<GPUProfileEvent, AT_PROFILER>>                 m_arrGPUProfileEvent;         /**< @brief Ring buffer of resolved GPU profile markers. */
+        unsigned int            m_nGPUProfileEventCount;    /**< @brief Number of GPU profile markers ever resolved. */
+        long long               m_nGPUTimelineOrigin;       /**< @brief CPU timestamp of the first GPU query, or -1 if none was issued yet. */
+        ProfileMarkerLabel      m_arrProfileMarkerLabel[MAX_PROFILE_MARKER_LABELS]; /**< @brief Interned profile marker labels, addressed by marker ID. */
+        GPUProfileMarkerResult* m_arrLatestGPUProfileMarkerResult[MAX_PROFILE_MARKER_LABELS];   /**< @brief Latest valid GPU profile marker result, addressed by marker ID. */
+        std::thread::id         m_tRenderThreadId;          /**< @brief The thread the profiler was created on. */
+        const unsigned int      m_nInstanceId;              /**< @brief Unique identifier of the profiler instance, for @ref ProfileMarkerLabelCache. */
+        ProfileMarkerCounters   m_arrProfileMarkerCounters[MAX_PROFILE_MARKER_LABELS];  /**< @brief Render counters of each label's scopes, addressed by marker ID. */
+        CounterScope            m_arrCounterScope[MAX_COUNTER_SCOPE_DEPTH]; /**< @brief Stack of open scopes on the rendering thread. */
+        unsigned int            m_nCounterScopeDepth;       /**< @brief Number of open scopes on the rendering thread (may exceed @ref MAX_COUNTER_SCOPE_DEPTH). */
+        unsigned int            m_nCounterFrame;            /**< @brief Index of the current frame, for @ref m_arrProfileMarkerCounters. */
+        static  thread_local int    ms_nProfileMarkerCounter;   /**< @brief Keeps track of profiler marker start/end pairs on each thread. */
+        static  thread_local CPUProfileThreadBuffer*    ms_pCPUProfileThreadBuffer; /**< @brief The calling thread's CPU scope ring buffer. */
+        static  thread_local unsigned int               ms_nCPUProfileThreadBufferOwnerId;  /**< @brief Instance ID of the profiler that owns @ref ms_pCPUProfileThreadBuffer. */
+        static  std::atomic<unsigned int>               ms_nInstanceCount;  /**< @brief Number of profiler instances ever created. */
 
         friend class Renderer;
         friend class ResourceManager;
+        friend class ProfileMarkerLabelCache;
     };
 }
 
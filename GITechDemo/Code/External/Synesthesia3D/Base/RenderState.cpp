@@ -25,13 +25,80 @@
 #include "RenderState.h"
 #include "Renderer.h"
 #include "Profiler.h"
+#include "RenderTrace.h"
 using namespace Synesthesia3D;
 
+// FNV-1a over the raw bytes of a single state
+template <typename T>
+static void HashState(unsigned int& hash, const T& state)
+{
+    const unsigned char* const bytes = (const unsigned char*)&state;
+    for (unsigned int i = 0; i < sizeof(T); i++)
+        hash = (hash ^ bytes[i]) * 16777619u;
+}
+
+static const unsigned int HashStateDesc(const BlendStateDesc& desc)
+{
+    unsigned int hash = 2166136261u;
+    HashState(hash, desc.bColorBlendEnabled);
+    HashState(hash, desc.eColorSrcBlend);
+    HashState(hash, desc.eColorDstBlend);
+    HashState(hash, desc.vColorBlendFactor);
+    HashState(hash, desc.bAlphaTestEnabled);
+    HashState(hash, desc.eAlphaFunc);
+    HashState(hash, desc.fAlphaRef);
+    HashState(hash, desc.bColorWriteRed);
+    HashState(hash, desc.bColorWriteGreen);
+    HashState(hash, desc.bColorWriteBlue);
+    HashState(hash, desc.bColorWriteAlpha);
+    HashState(hash, desc.bSRGBWriteEnabled);
+    return hash;
+}
+
+static const unsigned int HashStateDesc(const DepthStencilStateDesc& desc)
+{
+    unsigned int hash = 2166136261u;
+    HashState(hash, desc.eZEnabled);
+    HashState(hash, desc.eZFunc);
+    HashState(hash, desc.bZWriteEnabled);
+    HashState(hash, desc.bStencilEnabled);
+    HashState(hash, desc.eStencilFunc);
+    HashState(hash, desc.lStencilRef);
+    HashState(hash, desc.lStencilMask);
+    HashState(hash, desc.lStencilWriteMask);
+    HashState(hash, desc.eStencilFail);
+    HashState(hash, desc.eStencilZFail);
+    HashState(hash, desc.eStencilPass);
+    return hash;
+}
+
+static const unsigned int HashStateDesc(const RasterizerStateDesc& desc)
+{
+    unsigned int hash = 2166136261u;
+    HashState(hash, desc.eCullMode);
+    HashState(hash, desc.eFillMode);
+    HashState(hash, desc.fSlopeScaledDepthBias);
+    HashState(hash, desc.fDepthBias);
+    HashState(hash, desc.bScissorEnabled);
+    return hash;
+}
+
 RenderState::RenderState()
+    : m_bDirty(true)
+    , m_pBlendState(nullptr)
+    , m_pDepthStencilState(nullptr)
+    , m_pRasterizerState(nullptr)
 {}
 
 RenderState::~RenderState()
-{}
+{
+    for (auto it = m_arrBlendState.begin(); it != m_arrBlendState.end(); it++)
+        delete it->second;
+    for (auto it = m_arrDepthStencilState.begin(); it != m_arrDepthStencilState.end(); it++)
+        delete it->second;
+    for (auto it = m_arrRasterizerState.begin(); it != m_arrRasterizerState.end(); it++)
+        delete it->second;
+}
 
 void RenderState::Reset()
 {
@@ -71,12 +138,206 @@ void RenderState::Reset()
 
     SetSRGBWriteEnabled(false);
 
+    // The backend may have resynchronized its view
+    // of the device states, so push them regardless.
+    m_bDirty = true;
+
     Flush();
 }
 
+template <typename DESC>
+const RenderStateBlock<DESC>* const RenderState::FindOrCreateStateBlock(std::unordered_multimap<unsigned int, RenderStateBlock<DESC>*>& cache, const DESC& desc)
+{
+    const unsigned int hash = HashStateDesc(desc);
+
+    const auto range = cache.equal_range(hash);
+    for (auto it = range.first; it != range.second; it++)
+        if (it->second->GetDesc() == desc)
+            return it->second;
+
+    RenderStateBlock<DESC>* const block = new RenderStateBlock<DESC>(desc, hash);
+    cache.insert(std::make_pair(hash, block));
+
+    return block;
+}
+
+const BlendState* const RenderState::CreateBlendState(const BlendStateDesc& desc)
+{
+    return FindOrCreateStateBlock(m_arrBlendState, desc);
+}
+
+const DepthStencilState* const RenderState::CreateDepthStencilState(const DepthStencilStateDesc& desc)
+{
+    return FindOrCreateStateBlock(m_arrDepthStencilState, desc);
+}
+
+const RasterizerState* const RenderState::CreateRasterizerState(const RasterizerStateDesc& desc)
+{
+    return FindOrCreateStateBlock(m_arrRasterizerState, desc);
+}
+
+const bool RenderState::SetBlendState(const BlendState* const state)
+{
+    assert(state);
+    if (!state)
+        return false;
+
+    if (state == m_pBlendState)
+    {
+        Renderer::IncrementCounter(RC_FILTERED_STATE_BLOCKS);
+        return true;
+    }
+
+    // The setters only mark the states that differ
+    const BlendStateDesc& desc = state->GetDesc();
+    const bool ret =
+        SetColorBlendEnabled(desc.bColorBlendEnabled) &&
+        SetColorSrcBlend(desc.eColorSrcBlend) &&
+        SetColorDstBlend(desc.eColorDstBlend) &&
+        SetColorBlendFactor(desc.vColorBlendFactor) &&
+        SetAlphaTestEnabled(desc.bAlphaTestEnabled) &&
+        SetAlphaTestFunc(desc.eAlphaFunc) &&
+        SetAlphaTestRef(desc.fAlphaRef) &&
+        SetColorWriteEnabled(desc.bColorWriteRed, desc.bColorWriteGreen, desc.bColorWriteBlue, desc.bColorWriteAlpha) &&
+        SetSRGBWriteEnabled(desc.bSRGBWriteEnabled);
+
+    m_pBlendState = ret ? state : nullptr;
+    Renderer::IncrementCounter(RC_STATE_BLOCK_CHANGES);
+
+    return ret;
+}
+
+const bool RenderState::SetDepthStencilState(const DepthStencilState* const state)
+{
+    assert(state);
+    if (!state)
+        return false;
+
+    if (state == m_pDepthStencilState)
+    {
+        Renderer::IncrementCounter(RC_FILTERED_STATE_BLOCKS);
+        return true;
+    }
+
+    // The setters only mark the states that differ
+    const DepthStencilStateDesc& desc = state->GetDesc();
+    const bool ret =
+        SetZEnabled(desc.eZEnabled) &&
+        SetZFunc(desc.eZFunc) &&
+        SetZWriteEnabled(desc.bZWriteEnabled) &&
+        SetStencilEnabled(desc.bStencilEnabled) &&
+        SetStencilFunc(desc.eStencilFunc) &&
+        SetStencilRef(desc.lStencilRef) &&
+        SetStencilMask(desc.lStencilMask) &&
+        SetStencilWriteMask(desc.lStencilWriteMask) &&
+        SetStencilFail(desc.eStencilFail) &&
+        SetStencilZFail(desc.eStencilZFail) &&
+        SetStencilPass(desc.eStencilPass);
+
+    m_pDepthStencilState = ret ? state : nullptr;
+    Renderer::IncrementCounter(RC_STATE_BLOCK_CHANGES);
+
+    return ret;
+}
+
+const bool RenderState::SetRasterizerState(const RasterizerState* const state)
+{
+    assert(state);
+    if (!state)
+        return false;
+
+    if (state == m_pRasterizerState)
+    {
+        Renderer::IncrementCounter(RC_FILTERED_STATE_BLOCKS);
+        return true;
+    }
+
+    // The setters only mark the states that differ
+    const RasterizerStateDesc& desc = state->GetDesc();
+    const bool ret =
+        SetCullMode(desc.eCullMode) &&
+        SetFillMode(desc.eFillMode) &&
+        SetSlopeScaledDepthBias(desc.fSlopeScaledDepthBias) &&
+        SetDepthBias(desc.fDepthBias) &&
+        SetScissorEnabled(desc.bScissorEnabled);
+
+    m_pRasterizerState = ret ? state : nullptr;
+    Renderer::IncrementCounter(RC_STATE_BLOCK_CHANGES);
+
+    return ret;
+}
+
+const BlendState* const RenderState::GetBlendState()
+{
+    if (!m_pBlendState)
+    {
+        BlendStateDesc desc;
+        desc.bColorBlendEnabled = m_bColorBlendEnabled;
+        desc.eColorSrcBlend = m_eColorSrcBlend;
+        desc.eColorDstBlend = m_eColorDstBlend;
+        desc.vColorBlendFactor = m_vColorBlendFactor;
+        desc.bAlphaTestEnabled = m_bAlphaTestEnabled;
+        desc.eAlphaFunc = m_eAlphaFunc;
+        desc.fAlphaRef = m_fAlphaRef;
+        desc.bColorWriteRed = m_bColorWriteRed;
+        desc.bColorWriteGreen = m_bColorWriteGreen;
+        desc.bColorWriteBlue = m_bColorWriteBlue;
+        desc.bColorWriteAlpha = m_bColorWriteAlpha;
+        desc.bSRGBWriteEnabled = m_bSRGBEnabled;
+        m_pBlendState = FindOrCreateStateBlock(m_arrBlendState, desc);
+    }
+
+    return m_pBlendState;
+}
+
+const DepthStencilState* const RenderState::GetDepthStencilState()
+{
+    if (!m_pDepthStencilState)
+    {
+        DepthStencilStateDesc desc;
+        desc.eZEnabled = m_eZEnabled;
+        desc.eZFunc = m_eZFunc;
+        desc.bZWriteEnabled = m_bZWriteEnabled;
+        desc.bStencilEnabled = m_bStencilEnabled;
+        desc.eStencilFunc = m_eStencilFunc;
+        desc.lStencilRef = m_lStencilRef;
+        desc.lStencilMask = m_lStencilMask;
+        desc.lStencilWriteMask = m_lStencilWriteMask;
+        desc.eStencilFail = m_eStencilFail;
+        desc.eStencilZFail = m_eStencilZFail;
+        desc.eStencilPass = m_eStencilPass;
+        m_pDepthStencilState = FindOrCreateStateBlock(m_arrDepthStencilState, desc);
+    }
+
+    return m_pDepthStencilState;
+}
+
+const RasterizerState* const RenderState::GetRasterizerState()
+{
+    if (!m_pRasterizerState)
+    {
+        RasterizerStateDesc desc;
+        desc.eCullMode = m_eCullMode;
+        desc.eFillMode = m_eFillMode;
+        desc.fSlopeScaledDepthBias = m_fSlopeScaledDepthBias;
+        desc.fDepthBias = m_fDepthBias;
+        desc.bScissorEnabled = m_bScissorEnabled;
+        m_pRasterizerState = FindOrCreateStateBlock(m_arrRasterizerState, desc);
+    }
+
+    return m_pRasterizerState;
+}
+
 const bool RenderState::SetAlphaTestEnabled(const bool enabled)
 {
-    m_bAlphaTestEnabled = enabled;
+    if (m_bAlphaTestEnabled != enabled)
+    {
+        m_bAlphaTestEnabled = enabled;
+        m_pBlendState = nullptr;
+        m_bDirty = true;
+        Renderer::IncrementCounter(RC_RENDER_STATE_CHANGES);
+    }
+
     return true;
 }
 
@@ -84,7 +345,14 @@ const bool RenderState::SetAlphaTestFunc(const Cmp alphaFunc)
 {
     assert(alphaFunc > CMP && alphaFunc < CMP_MAX);
 
-    m_eAlphaFunc = alphaFunc;
+    if (m_eAlphaFunc != alphaFunc)
+    {
+        m_eAlphaFunc = alphaFunc;
+        m_pBlendState = nullptr;
+        m_bDirty = true;
+        Renderer::IncrementCounter(RC_RENDER_STATE_CHANGES);
+    }
+
     return true;
 }
 
@@ -92,13 +360,27 @@ const bool RenderState::SetAlphaTestRef(const float alphaRef)
 {
     assert(alphaRef >= 0.f && alphaRef <= 1.f);
 
-    m_fAlphaRef = alphaRef;
+    if (m_fAlphaRef != alphaRef)
+    {
+        m_fAlphaRef = alphaRef;
+        m_pBlendState = nullptr;
+        m_bDirty = true;
+        Renderer::IncrementCounter(RC_RENDER_STATE_CHANGES);
+    }
+
     return true;
 }
 
 const bool RenderState::SetColorBlendEnabled(const bool enabled)
 {
-    m_bColorBlendEnabled = enabled;
+    if (m_bColorBlendEnabled != enabled)
+    {
+        m_bColorBlendEnabled = enabled;
+        m_pBlendState = nullptr;
+        m_bDirty = true;
+        Renderer::IncrementCounter(RC_RENDER_STATE_CHANGES);
+    }
+
     return true;
 }
 
@@ -106,7 +388,14 @@ const bool RenderState::SetColorSrcBlend(const Blend colorSrc)
 {
     assert(colorSrc > BLEND && colorSrc < BLEND_MAX);
 
-    m_eColorSrcBlend = colorSrc;
+    if (m_eColorSrcBlend != colorSrc)
+    {
+        m_eColorSrcBlend = colorSrc;
+        m_pBlendState = nullptr;
+        m_bDirty = true;
+        Renderer::IncrementCounter(RC_RENDER_STATE_CHANGES);
+    }
+
     return true;
 }
 
@@ -114,7 +403,14 @@ const bool RenderState::SetColorDstBlend(const Blend colorDst)
 {
     assert(colorDst > BLEND && colorDst < BLEND_MAX);
 
-    m_eColorDstBlend = colorDst;
+    if (m_eColorDstBlend != colorDst)
+    {
+        m_eColorDstBlend = colorDst;
+        m_pBlendState = nullptr;
+        m_bDirty = true;
+        Renderer::IncrementCounter(RC_RENDER_STATE_CHANGES);
+    }
+
     return true;
 }
 
@@ -127,7 +423,14 @@ const bool RenderState::SetColorBlendFactor(const Vec4f rgba)
         rgba[3] >= 0.f && rgba[3] <= 1.f
         );
 
-    m_vColorBlendFactor = rgba;
+    if (m_vColorBlendFactor != rgba)
+    {
+        m_vColorBlendFactor = rgba;
+        m_pBlendState = nullptr;
+        m_bDirty = true;
+        Renderer::IncrementCounter(RC_RENDER_STATE_CHANGES);
+    }
+
     return true;
 }
 
@@ -135,7 +438,14 @@ const bool RenderState::SetCullMode(const Cull cullMode)
 {
     assert(cullMode > CULL && cullMode < CULL_MAX);
 
-    m_eCullMode = cullMode;
+    if (m_eCullMode != cullMode)
+    {
+        m_eCullMode = cullMode;
+        m_pRasterizerState = nullptr;
+        m_bDirty = true;
+        Renderer::IncrementCounter(RC_RENDER_STATE_CHANGES);
+    }
+
     return true;
 }
 
@@ -143,7 +453,14 @@ const bool RenderState::SetZEnabled(const ZBuffer enabled)
 {
     assert(enabled > ZB && enabled < ZB_MAX);
 
-    m_eZEnabled = enabled;
+    if (m_eZEnabled != enabled)
+    {
+        m_eZEnabled = enabled;
+        m_pDepthStencilState = nullptr;
+        m_bDirty = true;
+        Renderer::IncrementCounter(RC_RENDER_STATE_CHANGES);
+    }
+
     return true;
 }
 
@@ -151,40 +468,82 @@ const bool RenderState::SetZFunc(const Cmp zFunc)
 {
     assert(zFunc > CMP && zFunc < CMP_MAX);
 
-    m_eZFunc = zFunc;
+    if (m_eZFunc != zFunc)
+    {
+        m_eZFunc = zFunc;
+        m_pDepthStencilState = nullptr;
+        m_bDirty = true;
+        Renderer::IncrementCounter(RC_RENDER_STATE_CHANGES);
+    }
+
     return true;
 }
 
 const bool RenderState::SetZWriteEnabled(const bool enabled)
 {
-    m_bZWriteEnabled = enabled;
+    if (m_bZWriteEnabled != enabled)
+    {
+        m_bZWriteEnabled = enabled;
+        m_pDepthStencilState = nullptr;
+        m_bDirty = true;
+        Renderer::IncrementCounter(RC_RENDER_STATE_CHANGES);
+    }
+
     return true;
 }
 
 const bool RenderState::SetColorWriteEnabled(const bool red, const bool green, const bool blue, const bool alpha)
 {
-    m_bColorWriteRed = red;
-    m_bColorWriteGreen = green;
-    m_bColorWriteBlue = blue;
-    m_bColorWriteAlpha = alpha;
+    if (m_bColorWriteRed != red || m_bColorWriteGreen != green || m_bColorWriteBlue != blue || m_bColorWriteAlpha != alpha)
+    {
+        m_bColorWriteRed = red;
+        m_bColorWriteGreen = green;
+        m_bColorWriteBlue = blue;
+        m_bColorWriteAlpha = alpha;
+        m_pBlendState = nullptr;
+        m_bDirty = true;
+        Renderer::IncrementCounter(RC_RENDER_STATE_CHANGES);
+    }
+
     return true;
 }
 
 const bool RenderState::SetSlopeScaledDepthBias(const float scale)
 {
-    m_fSlopeScaledDepthBias = scale;
+    if (m_fSlopeScaledDepthBias != scale)
+    {
+        m_fSlopeScaledDepthBias = scale;
+        m_pRasterizerState = nullptr;
+        m_bDirty = true;
+        Renderer::IncrementCounter(RC_RENDER_STATE_CHANGES);
+    }
+
     return true;
 }
 
 const bool RenderState::SetDepthBias(const float bias)
 {
-    m_fDepthBias = bias;
+    if (m_fDepthBias != bias)
+    {
+        m_fDepthBias = bias;
+        m_pRasterizerState = nullptr;
+        m_bDirty = true;
+        Renderer::IncrementCounter(RC_RENDER_STATE_CHANGES);
+    }
+
     return true;
 }
 
 const bool RenderState::SetStencilEnabled(const bool enabled)
 {
-    m_bStencilEnabled = enabled;
+    if (m_bStencilEnabled != enabled)
+    {
+        m_bStencilEnabled = enabled;
+        m_pDepthStencilState = nullptr;
+        m_bDirty = true;
+        Renderer::IncrementCounter(RC_RENDER_STATE_CHANGES);
+    }
+
     return true;
 }
 
@@ -192,25 +551,53 @@ const bool RenderState::SetStencilFunc(const Cmp stencilFunc)
 {
     assert(stencilFunc > CMP && stencilFunc < CMP_MAX);
 
-    m_eStencilFunc = stencilFunc;
+    if (m_eStencilFunc != stencilFunc)
+    {
+        m_eStencilFunc = stencilFunc;
+        m_pDepthStencilState = nullptr;
+        m_bDirty = true;
+        Renderer::IncrementCounter(RC_RENDER_STATE_CHANGES);
+    }
+
     return true;
 }
 
 const bool RenderState::SetStencilRef(const unsigned long stencilRef)
 {
-    m_lStencilRef = stencilRef;
+    if (m_lStencilRef != stencilRef)
+    {
+        m_lStencilRef = stencilRef;
+        m_pDepthStencilState = nullptr;
+        m_bDirty = true;
+        Renderer::IncrementCounter(RC_RENDER_STATE_CHANGES);
+    }
+
     return true;
 }
 
 const bool RenderState::SetStencilMask(const unsigned long stencilMask)
 {
-    m_lStencilMask = stencilMask;
+    if (m_lStencilMask != stencilMask)
+    {
+        m_lStencilMask = stencilMask;
+        m_pDepthStencilState = nullptr;
+        m_bDirty = true;
+        Renderer::IncrementCounter(RC_RENDER_STATE_CHANGES);
+    }
+
     return true;
 }
 
 const bool RenderState::SetStencilWriteMask(const unsigned long stencilWriteMask)
 {
-    m_lStencilWriteMask = stencilWriteMask;
+    if (m_lStencilWriteMask != stencilWriteMask)
+    {
+        m_lStencilWriteMask = stencilWriteMask;
+        m_pDepthStencilState = nullptr;
+        m_bDirty = true;
+        Renderer::IncrementCounter(RC_RENDER_STATE_CHANGES);
+    }
+
     return true;
 }
 
@@ -218,7 +605,14 @@ const bool RenderState::SetStencilFail(const StencilOp stencilFail)
 {
     assert(stencilFail > STENCILOP && stencilFail < STENCILOP_MAX);
 
-    m_eStencilFail = stencilFail;
+    if (m_eStencilFail != stencilFail)
+    {
+        m_eStencilFail = stencilFail;
+        m_pDepthStencilState = nullptr;
+        m_bDirty = true;
+        Renderer::IncrementCounter(RC_RENDER_STATE_CHANGES);
+    }
+
     return true;
 }
 
@@ -226,7 +620,14 @@ const bool RenderState::SetStencilZFail(const StencilOp stencilZFail)
 {
     assert(stencilZFail > STENCILOP && stencilZFail < STENCILOP_MAX);
 
-    m_eStencilZFail = stencilZFail;
+    if (m_eStencilZFail != stencilZFail)
+    {
+        m_eStencilZFail = stencilZFail;
+        m_pDepthStencilState = nullptr;
+        m_bDirty = true;
+        Renderer::IncrementCounter(RC_RENDER_STATE_CHANGES);
+    }
+
     return true;
 }
 
@@ -234,7 +635,14 @@ const bool RenderState::SetStencilPass(const StencilOp stencilPass)
 {
     assert(stencilPass > STENCILOP && stencilPass < STENCILOP_MAX);
 
-    m_eStencilPass = stencilPass;
+    if (m_eStencilPass != stencilPass)
+    {
+        m_eStencilPass = stencilPass;
+        m_pDepthStencilState = nullptr;
+        m_bDirty = true;
+        Renderer::IncrementCounter(RC_RENDER_STATE_CHANGES);
+    }
+
     return true;
 }
 
@@ -242,19 +650,49 @@ const bool RenderState::SetFillMode(const Fill fillMode)
 {
     assert(fillMode > FILL && fillMode < FILL_MAX);
 
-    m_eFillMode = fillMode;
+    if (m_eFillMode != fillMode)
+    {
+        m_eFillMode = fillMode;
+        m_pRasterizerState = nullptr;
+        m_bDirty = true;
+        Renderer::IncrementCounter(RC_RENDER_STATE_CHANGES);
+    }
+
     return true;
 }
 
 const bool RenderState::SetScissorEnabled(const bool enabled)
 {
-    m_bScissorEnabled = enabled;
+    if (m_bScissorEnabled != enabled)
+    {
+        m_bScissorEnabled = enabled;
+        m_pRasterizerState = nullptr;
+        m_bDirty = true;
+        Renderer::IncrementCounter(RC_RENDER_STATE_CHANGES);
+    }
+
+    return true;
+}
+
+const bool RenderState::SetScissor(const Vec2i size, const Vec2i offset)
+{
+    RenderTrace* const trace = Renderer::GetInstance()->GetRenderTrace();
+    if (trace->IsRecording())
+        trace->RecordScissor(size, offset);
+
     return true;
 }
 
 const bool RenderState::SetSRGBWriteEnabled(const bool enabled)
 {
-    m_bSRGBEnabled = enabled;
+    if (m_bSRGBEnabled != enabled)
+    {
+        m_bSRGBEnabled = enabled;
+        m_pBlendState = nullptr;
+        m_bDirty = true;
+        Renderer::IncrementCounter(RC_RENDER_STATE_CHANGES);
+    }
+
     return true;
 }
 
@@ -23,11 +23,50 @@
 #ifndef RENDERSTATE_H
 #define RENDERSTATE_H
 
+#include <unordered_map>
+
 #include "ResourceData.h"
 
 namespace Synesthesia3D
 {
     class Renderer;
+    class RenderState;
+
+    /**
+     * @brief   An immutable, pre-baked group of render states.
+     * @note    Created through @ref RenderState::CreateBlendState(), @ref RenderState::CreateDepthStencilState()
+     *          or @ref RenderState::CreateRasterizerState(). Identical descriptions share the same block, so
+     *          blocks can be compared by address.
+     */
+    template <typename DESC>
+    class RenderStateBlock
+    {
+    public:
+        /**
+         * @brief   Retrieves the description of the states in this block.
+         */
+        const DESC&         GetDesc() const { return m_tDesc; }
+
+        /**
+         * @brief   Retrieves the hash of the states in this block.
+         */
+        const unsigned int  GetHash() const { return m_nHash; }
+
+    protected:
+        RenderStateBlock(const DESC& desc, const unsigned int hash)
+            : m_tDesc(desc)
+            , m_nHash(hash)
+        {}
+
+        const DESC          m_tDesc;    /**< @brief Description of the states in this block. */
+        const unsigned int  m_nHash;    /**< @brief Hash of the states in this block. */
+
+        friend class RenderState;
+    };
+
+    typedef RenderStateBlock<BlendStateDesc>        BlendState;         /**< @brief Color blending and writing states block. */
+    typedef RenderStateBlock<DepthStencilStateDesc> DepthStencilState;  /**< @brief Depth and stencil buffering states block. */
+    typedef RenderStateBlock<RasterizerStateDesc>   RasterizerState;    /**< @brief Rasterization states block. */
 
     /**
      * @brief   Render state manager class.
@@ -283,7 +322,7 @@ namespace Synesthesia3D
          *
          * @return  Success of operation.
          */
-        virtual SYNESTHESIA3D_DLL       const bool      SetScissor(const Vec2i size, const Vec2i offset = Vec2i(0, 0)) PURE_VIRTUAL;
+        virtual SYNESTHESIA3D_DLL       const bool      SetScissor(const Vec2i size, const Vec2i offset = Vec2i(0, 0));
 
 
 
@@ -473,6 +512,86 @@ namespace Synesthesia3D
          */
         virtual SYNESTHESIA3D_DLL           void        Reset();
 
+
+
+        /**
+         * @brief   Creates a block of color blending and writing states.
+         * @note    Meant to be called once, at resource allocation time.
+         *
+         * @param[in]   desc        Description of the states.
+         *
+         * @return  The block matching the description, shared with every other identical request.
+         */
+                SYNESTHESIA3D_DLL   const BlendState* const         CreateBlendState(const BlendStateDesc& desc);
+
+        /**
+         * @brief   Creates a block of depth and stencil buffering states.
+         * @note    Meant to be called once, at resource allocation time.
+         *
+         * @param[in]   desc        Description of the states.
+         *
+         * @return  The block matching the description, shared with every other identical request.
+         */
+                SYNESTHESIA3D_DLL   const DepthStencilState* const  CreateDepthStencilState(const DepthStencilStateDesc& desc);
+
+        /**
+         * @brief   Creates a block of rasterization states.
+         * @note    Meant to be called once, at resource allocation time.
+         *
+         * @param[in]   desc        Description of the states.
+         *
+         * @return  The block matching the description, shared with every other identical request.
+         */
+                SYNESTHESIA3D_DLL   const RasterizerState* const    CreateRasterizerState(const RasterizerStateDesc& desc);
+
+        /**
+         * @brief   Applies a block of color blending and writing states.
+         * @note    Applying the currently active block is a no-op.
+         *
+         * @param[in]   state       Block of states to apply.
+         *
+         * @return  Success of operation.
+         */
+                SYNESTHESIA3D_DLL   const bool      SetBlendState(const BlendState* const state);
+
+        /**
+         * @brief   Applies a block of depth and stencil buffering states.
+         * @note    Applying the currently active block is a no-op.
+         *
+         * @param[in]   state       Block of states to apply.
+         *
+         * @return  Success of operation.
+         */
+                SYNESTHESIA3D_DLL   const bool      SetDepthStencilState(const DepthStencilState* const state);
+
+        /**
+         * @brief   Applies a block of rasterization states.
+         * @note    Applying the currently active block is a no-op.
+         *
+         * @param[in]   state       Block of states to apply.
+         *
+         * @return  Success of operation.
+         */
+                SYNESTHESIA3D_DLL   const bool      SetRasterizerState(const RasterizerState* const state);
+
+        /**
+         * @brief   Retrieves the block matching the current color blending and writing states.
+         * @note    Useful for restoring the previous states after applying a block.
+         */
+                SYNESTHESIA3D_DLL   const BlendState* const         GetBlendState();
+
+        /**
+         * @brief   Retrieves the block matching the current depth and stencil buffering states.
+         * @note    Useful for restoring the previous states after applying a block.
+         */
+                SYNESTHESIA3D_DLL   const DepthStencilState* const  GetDepthStencilState();
+
+        /**
+         * @brief   Retrieves the block matching the current rasterization states.
+         * @note    Useful for restoring the previous states after applying a block.
+         */
+                SYNESTHESIA3D_DLL   const RasterizerState* const    GetRasterizerState();
+
     protected:
 
         /**
@@ -496,6 +615,12 @@ namespace Synesthesia3D
          */
         virtual const bool  Flush() PURE_VIRTUAL;
 
+        /**
+         * @brief   Retrieves the block matching a description, creating it if necessary.
+         */
+        template <typename DESC>
+        const RenderStateBlock<DESC>* const FindOrCreateStateBlock(std::unordered_multimap<unsigned int, RenderStateBlock<DESC>*>& cache, const DESC& desc);
+
 
 
         bool            m_bColorBlendEnabled;       /**< @brief Color blending state. */
@@ -536,6 +661,16 @@ namespace Synesthesia3D
 
         bool            m_bSRGBEnabled;             /**< @brief sRGB writing state. */
 
+        bool            m_bDirty;                   /**< @brief Some states have changed since the last @ref Flush(). */
+
+        const BlendState*           m_pBlendState;          /**< @brief Block matching the current blending states, or nullptr if they have been changed individually. */
+        const DepthStencilState*    m_pDepthStencilState;   /**< @brief Block matching the current depth / stencil states, or nullptr if they have been changed individually. */
+        const RasterizerState*      m_pRasterizerState;     /**< @brief Block matching the current rasterization states, or nullptr if they have been changed individually. */
+
+        std::unordered_multimap<unsigned int, BlendState*>          m_arrBlendState;        /**< @brief Color blending and writing state blocks, keyed by hash. */
+        std::unordered_multimap<unsigned int, DepthStencilState*>   m_arrDepthStencilState; /**< @brief Depth and stencil buffering state blocks, keyed by hash. */
+        std::unordered_multimap<unsigned int, RasterizerState*>     m_arrRasterizerState;   /**< @brief Rasterization state blocks, keyed by hash. */
+
 
 
         friend class Renderer;
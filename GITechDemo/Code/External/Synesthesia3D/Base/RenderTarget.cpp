@@ -26,7 +26,9 @@
 #include "Renderer.h"
 #include "Texture.h"
 #include "ResourceManager.h"
+#include "SamplerState.h"
 #include "Profiler.h"
+#include "RenderTrace.h"
 using namespace Synesthesia3D;
 
 std::vector<RenderTarget*> RenderTarget::ms_pActiveRenderTarget;
@@ -259,6 +261,21 @@ RenderTarget::~RenderTarget()
 {
     Unbind();
 
+    // The color and depth-stencil textures were created for this render target alone
+    if (Renderer::GetInstance())
+    {
+        ResourceManager* const resMan = Renderer::GetInstance()->GetResourceManager();
+        if (resMan)
+        {
+            for (unsigned int i = 0; m_nColorBufferTexIdx && i < m_nTargetCount; i++)
+                if (m_nColorBufferTexIdx[i] != ~0u)
+                    resMan->ReleaseTexture(m_nColorBufferTexIdx[i]);
+
+            if (m_bHasDepthStencil && m_nDepthBufferTexIdx != ~0u)
+                resMan->ReleaseTexture(m_nDepthBufferTexIdx);
+        }
+    }
+
     if (m_pColorBuffer)
         delete[] m_pColorBuffer;
 
@@ -337,6 +354,17 @@ RenderTarget* RenderTarget::GetActiveRenderTarget()
 
 void RenderTarget::Enable()
 {
+    RenderTrace* const trace = Renderer::GetInstance()->GetRenderTrace();
+    if (trace->IsRecording())
+        trace->RecordRenderTarget(this, true);
+
+    // Textures stay bound after a draw, so make sure
+    // we're not sampling from what we're rendering to
+    SamplerState* const ssm = Renderer::GetInstance()->GetSamplerStateManager();
+    for (unsigned int i = 0; i < m_nTargetCount; i++)
+        ssm->UnbindTexture(m_pColorBuffer[i]);
+    ssm->UnbindTexture(m_pDepthBuffer);
+
     //if(ms_pActiveRenderTarget.size() == 0 || ms_pActiveRenderTarget.back() != this)
     ms_pActiveRenderTarget.push_back(this);
 }
@@ -345,13 +373,20 @@ void RenderTarget::Disable()
 {
     assert(GetActiveRenderTarget() == this);
     ms_pActiveRenderTarget.pop_back();
+
+    RenderTrace* const trace = Renderer::GetInstance()->GetRenderTrace();
+    if (trace->IsRecording())
+        trace->RecordRenderTarget(this, false);
     
     // Set the last active render target
     if (GetActiveRenderTarget())
     {
         // Enable() will push a duplicate of the
         // this RT on the stack, so remove it.
+        // It's part of Disable(), so don't trace it.
+        trace->Suspend();
         GetActiveRenderTarget()->Enable();
+        trace->Resume();
         ms_pActiveRenderTarget.pop_back();
     }
 }
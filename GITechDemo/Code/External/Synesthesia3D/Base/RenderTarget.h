@@ -34,6 +34,7 @@ namespace Synesthesia3D
      */
     class RenderTarget
     {
+        S3D_ALLOCATION_TAG(AT_RESOURCES)
 
     public:
 
@@ -0,0 +1,1424 @@
+/**
+ * @file        RenderTrace.cpp
+ *
+ * @note        This file is part of the "Synesthesia3D" graphics engine
+ *
+ * @copyright   Copyright (C) Iftode Bogdan-Marius <iftode.bogdan@gmail.com>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * @copyright
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ * @copyright
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "stdafx.h"
+
+#include <fstream>
+#include <chrono>
+
+#include "RenderTrace.h"
+#include "Renderer.h"
+#include "ResourceManager.h"
+#include "RenderState.h"
+#include "VertexFormat.h"
+#include "IndexBuffer.h"
+#include "VertexBuffer.h"
+#include "ShaderProgram.h"
+#include "ShaderInput.h"
+#include "Texture.h"
+#include "RenderTarget.h"
+#include "Profiler.h"
+using namespace Synesthesia3D;
+
+#include <lz4/lz4.h>
+
+template <typename T>
+static void WriteValue(std::vector<s3dByte>& buffer, const T& val)
+{
+    const s3dByte* const bytes = (const s3dByte*)&val;
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+static void WriteString(std::vector<s3dByte>& buffer, const char* const str)
+{
+    const unsigned int length = str ? (unsigned int)strlen(str) : 0u;
+    WriteValue(buffer, length);
+    buffer.insert(buffer.end(), (const s3dByte*)str, (const s3dByte*)str + length);
+}
+
+// Bounds checked reads from a trace, which may come from a truncated or corrupt file
+class RenderTraceReader
+{
+public:
+    RenderTraceReader(const s3dByte* const data, const size_t size)
+        : m_pData(data)
+        , m_nSize(size)
+        , m_nOffset(0)
+        , m_bValid(true)
+    {}
+
+    template <typename T>
+    const T Read()
+    {
+        T val = T();
+        ReadBytes(&val, sizeof(T));
+        return val;
+    }
+
+    void ReadBytes(void* const dst, const size_t size)
+    {
+        if (!m_bValid || size > m_nSize - m_nOffset)
+        {
+            m_bValid = false;
+            return;
+        }
+
+        memcpy(dst, m_pData + m_nOffset, size);
+        m_nOffset += size;
+    }
+
+    void Skip(const size_t size)
+    {
+        if (!m_bValid || size > m_nSize - m_nOffset)
+        {
+            m_bValid = false;
+            return;
+        }
+
+        m_nOffset += size;
+    }
+
+    const std::string ReadString()
+    {
+        const unsigned int length = Read<unsigned int>();
+        if (!m_bValid || length > m_nSize - m_nOffset)
+        {
+            m_bValid = false;
+            return std::string();
+        }
+
+        const std::string str((const char*)m_pData + m_nOffset, length);
+        m_nOffset += length;
+        return str;
+    }
+
+    const size_t GetRemainingSize() const { return m_nSize - m_nOffset; }
+    const bool IsValid() const { return m_bValid; }
+
+private:
+    const s3dByte* const    m_pData;
+    const size_t            m_nSize;
+    size_t                  m_nOffset;
+    bool                    m_bValid;
+};
+
+// State block descriptions are traced field by field, so that
+// their padding doesn't end up in (or get read from) the trace
+static void WriteStateDesc(std::vector<s3dByte>& buffer, const BlendStateDesc& desc)
+{
+    WriteValue(buffer, (s3dByte)desc.bColorBlendEnabled);
+    WriteValue(buffer, (unsigned int)desc.eColorSrcBlend);
+    WriteValue(buffer, (unsigned int)desc.eColorDstBlend);
+    for (unsigned int c = 0; c < 4; c++)
+        WriteValue(buffer, desc.vColorBlendFactor[c]);
+    WriteValue(buffer, (s3dByte)desc.bAlphaTestEnabled);
+    WriteValue(buffer, (unsigned int)desc.eAlphaFunc);
+    WriteValue(buffer, desc.fAlphaRef);
+    WriteValue(buffer, (s3dByte)desc.bColorWriteRed);
+    WriteValue(buffer, (s3dByte)desc.bColorWriteGreen);
+    WriteValue(buffer, (s3dByte)desc.bColorWriteBlue);
+    WriteValue(buffer, (s3dByte)desc.bColorWriteAlpha);
+    WriteValue(buffer, (s3dByte)desc.bSRGBWriteEnabled);
+}
+
+static void WriteStateDesc(std::vector<s3dByte>& buffer, const DepthStencilStateDesc& desc)
+{
+    WriteValue(buffer, (unsigned int)desc.eZEnabled);
+    WriteValue(buffer, (unsigned int)desc.eZFunc);
+    WriteValue(buffer, (s3dByte)desc.bZWriteEnabled);
+    WriteValue(buffer, (s3dByte)desc.bStencilEnabled);
+    WriteValue(buffer, (unsigned int)desc.eStencilFunc);
+    WriteValue(buffer, (unsigned int)desc.lStencilRef);
+    WriteValue(buffer, (unsigned int)desc.lStencilMask);
+    WriteValue(buffer, (unsigned int)desc.lStencilWriteMask);
+    WriteValue(buffer, (unsigned int)desc.eStencilFail);
+    WriteValue(buffer, (unsigned int)desc.eStencilZFail);
+    WriteValue(buffer, (unsigned int)desc.eStencilPass);
+}
+
+static void WriteStateDesc(std::vector<s3dByte>& buffer, const RasterizerStateDesc& desc)
+{
+    WriteValue(buffer, (unsigned int)desc.eCullMode);
+    WriteValue(buffer, (unsigned int)desc.eFillMode);
+    WriteValue(buffer, desc.fSlopeScaledDepthBias);
+    WriteValue(buffer, desc.fDepthBias);
+    WriteValue(buffer, (s3dByte)desc.bScissorEnabled);
+}
+
+static void ReadStateDesc(RenderTraceReader& reader, BlendStateDesc& desc)
+{
+    desc.bColorBlendEnabled = reader.Read<s3dByte>() != 0;
+    desc.eColorSrcBlend = (Blend)reader.Read<unsigned int>();
+    desc.eColorDstBlend = (Blend)reader.Read<unsigned int>();
+    for (unsigned int c = 0; c < 4; c++)
+        desc.vColorBlendFactor[c] = reader.Read<float>();
+    desc.bAlphaTestEnabled = reader.Read<s3dByte>() != 0;
+    desc.eAlphaFunc = (Cmp)reader.Read<unsigned int>();
+    desc.fAlphaRef = reader.Read<float>();
+    desc.bColorWriteRed = reader.Read<s3dByte>() != 0;
+    desc.bColorWriteGreen = reader.Read<s3dByte>() != 0;
+    desc.bColorWriteBlue = reader.Read<s3dByte>() != 0;
+    desc.bColorWriteAlpha = reader.Read<s3dByte>() != 0;
+    desc.bSRGBWriteEnabled = reader.Read<s3dByte>() != 0;
+}
+
+static void ReadStateDesc(RenderTraceReader& reader, DepthStencilStateDesc& desc)
+{
+    desc.eZEnabled = (ZBuffer)reader.Read<unsigned int>();
+    desc.eZFunc = (Cmp)reader.Read<unsigned int>();
+    desc.bZWriteEnabled = reader.Read<s3dByte>() != 0;
+    desc.bStencilEnabled = reader.Read<s3dByte>() != 0;
+    desc.eStencilFunc = (Cmp)reader.Read<unsigned int>();
+    desc.lStencilRef = reader.Read<unsigned int>();
+    desc.lStencilMask = reader.Read<unsigned int>();
+    desc.lStencilWriteMask = reader.Read<unsigned int>();
+    desc.eStencilFail = (StencilOp)reader.Read<unsigned int>();
+    desc.eStencilZFail = (StencilOp)reader.Read<unsigned int>();
+    desc.eStencilPass = (StencilOp)reader.Read<unsigned int>();
+}
+
+static void ReadStateDesc(RenderTraceReader& reader, RasterizerStateDesc& desc)
+{
+    desc.eCullMode = (Cull)reader.Read<unsigned int>();
+    desc.eFillMode = (Fill)reader.Read<unsigned int>();
+    desc.fSlopeScaledDepthBias = reader.Read<float>();
+    desc.fDepthBias = reader.Read<float>();
+    desc.bScissorEnabled = reader.Read<s3dByte>() != 0;
+}
+
+RenderTrace::RenderTrace()
+    : m_bCapturePending(false)
+    , m_bRecording(false)
+    , m_nSuspendCount(0)
+    , m_nRenderTargetDepth(0)
+    , m_bRenderStatesRecorded(false)
+{}
+
+RenderTrace::~RenderTrace()
+{}
+
+const bool RenderTrace::RequestCapture(const char* const filePath)
+{
+    assert(filePath);
+    if (IsCapturing() || !filePath)
+        return false;
+
+    m_szCaptureFilePath = filePath;
+    m_bCapturePending = true;
+
+    return true;
+}
+
+const bool RenderTrace::IsCapturing() const
+{
+    return m_bCapturePending || m_bRecording;
+}
+
+const char* RenderTrace::GetLastCaptureFilePath() const
+{
+    return m_szLastCaptureFilePath.c_str();
+}
+
+const unsigned int RenderTrace::GetCommandCount() const
+{
+    return (unsigned int)m_arrCommand.size();
+}
+
+void RenderTrace::BeginFrame()
+{
+    if (!m_bCapturePending)
+        return;
+
+    m_bCapturePending = false;
+    m_bRecording = true;
+    m_tRecordingThreadId = std::this_thread::get_id();
+    m_nRenderTargetDepth = 0;
+    m_bRenderStatesRecorded = false;
+
+    m_arrCommand.clear();
+    m_arrPayload.clear();
+    m_arrResourceDesc.clear();
+    m_mapShaderInputData.clear();
+
+    IndexResources();
+}
+
+void RenderTrace::EndFrame()
+{
+    if (!m_bRecording)
+        return;
+
+    m_bRecording = false;
+
+    DescribeResources();
+
+    if (Write(m_szCaptureFilePath.c_str()))
+        m_szLastCaptureFilePath = m_szCaptureFilePath;
+    else
+    {
+        S3D_DBGPRINT("Error: Render trace %s could not be written", m_szCaptureFilePath.c_str());
+        m_szLastCaptureFilePath.clear();
+    }
+
+    for (unsigned int i = 0; i < RES_MAX; i++)
+        m_mapResourceIdx[i].clear();
+    m_mapShaderInputData.clear();
+}
+
+void RenderTrace::IndexResources()
+{
+    const ResourceManager* const resMan = Renderer::GetInstance()->GetResourceManager();
+
+    for (unsigned int i = 0; i < RES_MAX; i++)
+        m_mapResourceIdx[i].clear();
+
+    for (unsigned int i = 0, n = resMan->GetVertexFormatCount(); i < n; i++)
+        if (resMan->GetVertexFormat(i))
+            m_mapResourceIdx[RES_VERTEX_FORMAT][resMan->GetVertexFormat(i)] = i;
+
+    for (unsigned int i = 0, n = resMan->GetIndexBufferCount(); i < n; i++)
+        if (resMan->GetIndexBuffer(i))
+            m_mapResourceIdx[RES_INDEX_BUFFER][resMan->GetIndexBuffer(i)] = i;
+
+    for (unsigned int i = 0, n = resMan->GetVertexBufferCount(); i < n; i++)
+        if (resMan->GetVertexBuffer(i))
+            m_mapResourceIdx[RES_VERTEX_BUFFER][resMan->GetVertexBuffer(i)] = i;
+
+    for (unsigned int i = 0, n = resMan->GetShaderProgramCount(); i < n; i++)
+        if (resMan->GetShaderProgram(i))
+            m_mapResourceIdx[RES_SHADER_PROGRAM][resMan->GetShaderProgram(i)] = i;
+
+    for (unsigned int i = 0, n = resMan->GetShaderInputCount(); i < n; i++)
+        if (resMan->GetShaderInput(i))
+            m_mapResourceIdx[RES_SHADER_INPUT][resMan->GetShaderInput(i)] = i;
+
+    for (unsigned int i = 0, n = resMan->GetRenderTargetCount(); i < n; i++)
+        if (resMan->GetRenderTarget(i))
+            m_mapResourceIdx[RES_RENDER_TARGET][resMan->GetRenderTarget(i)] = i;
+
+    for (unsigned int i = 0, n = resMan->GetTextureCount(); i < n; i++)
+        if (resMan->GetTexture(i))
+            m_mapResourceIdx[RES_TEXTURE][resMan->GetTexture(i)] = i;
+}
+
+const unsigned int RenderTrace::FindResource(const ResourceType type, const void* const resource)
+{
+    if (!resource)
+        return ~0u;
+
+    std::unordered_map<const void*, unsigned int>::const_iterator iter = m_mapResourceIdx[type].find(resource);
+    if (iter != m_mapResourceIdx[type].end())
+        return iter->second;
+
+    // The resource may have been created during the capture
+    IndexResources();
+
+    iter = m_mapResourceIdx[type].find(resource);
+    if (iter != m_mapResourceIdx[type].end())
+        return iter->second;
+
+    return ~0u;
+}
+
+RenderTrace::Command& RenderTrace::AddCommand(const RenderTraceCommand type)
+{
+    Command cmd;
+    memset(&cmd, 0, sizeof(Command));
+    cmd.eType = type;
+    cmd.nResource[0] = cmd.nResource[1] = ~0u;
+
+    m_arrCommand.push_back(cmd);
+    return m_arrCommand.back();
+}
+
+const unsigned int RenderTrace::AddPayload(const void* const data, const unsigned int size)
+{
+    const unsigned int offset = (unsigned int)m_arrPayload.size();
+    m_arrPayload.insert(m_arrPayload.end(), (const s3dByte*)data, (const s3dByte*)data + size);
+    return offset;
+}
+
+void RenderTrace::RecordViewport(const Vec2i size, const Vec2i offset)
+{
+    Command& cmd = AddCommand(RTC_SET_VIEWPORT);
+    cmd.nArg[0] = size[0];
+    cmd.nArg[1] = size[1];
+    cmd.nArg[2] = offset[0];
+    cmd.nArg[3] = offset[1];
+}
+
+void RenderTrace::RecordScissor(const Vec2i size, const Vec2i offset)
+{
+    Command& cmd = AddCommand(RTC_SET_SCISSOR);
+    cmd.nArg[0] = size[0];
+    cmd.nArg[1] = size[1];
+    cmd.nArg[2] = offset[0];
+    cmd.nArg[3] = offset[1];
+}
+
+void RenderTrace::RecordClear(const Vec4f rgba, const float z, const unsigned int stencil)
+{
+    // The color write and scissor states affect clears
+    RecordRenderStates();
+
+    Command& cmd = AddCommand(RTC_CLEAR);
+    cmd.nArg[0] = stencil;
+    cmd.fArg[0] = rgba[0];
+    cmd.fArg[1] = rgba[1];
+    cmd.fArg[2] = rgba[2];
+    cmd.fArg[3] = rgba[3];
+    cmd.fArg[4] = z;
+}
+
+void RenderTrace::RecordRenderTarget(const RenderTarget* const renderTarget, const bool enable)
+{
+    // Render targets enabled before the capture started are left alone,
+    // so that the trace can be replayed with a balanced render target stack
+    if (!enable && m_nRenderTargetDepth == 0)
+        return;
+
+    const unsigned int rtIdx = FindResource(RES_RENDER_TARGET, renderTarget);
+    if (rtIdx == ~0u)
+        return;
+
+    Command& cmd = AddCommand(enable ? RTC_ENABLE_RENDER_TARGET : RTC_DISABLE_RENDER_TARGET);
+    cmd.nResource[0] = rtIdx;
+
+    if (enable)
+        m_nRenderTargetDepth++;
+    else
+        m_nRenderTargetDepth--;
+}
+
+void RenderTrace::RecordShaderInput(const ShaderProgram* const shaderProgram, const ShaderInput* const shaderInput, const bool enable)
+{
+    const unsigned int programIdx = FindResource(RES_SHADER_PROGRAM, shaderProgram);
+    const unsigned int inputIdx = FindResource(RES_SHADER_INPUT, shaderInput);
+    if (programIdx == ~0u || inputIdx == ~0u)
+        return;
+
+    // Only record the inputs modified since this shader input was last recorded
+    std::vector<s3dByte>& lastData = m_mapShaderInputData[shaderInput];
+    const bool recordAll = lastData.size() != shaderInput->GetSize();
+    const s3dByte* const data = shaderInput->GetData();
+
+    std::vector<s3dByte> payload;
+    unsigned int inputCount = 0;
+    WriteValue(payload, inputCount);
+
+    for (unsigned int i = 0, n = shaderInput->GetInputCount(); i < n; i++)
+    {
+        const ShaderInputDesc& desc = shaderInput->GetInputDesc(i);
+        if (!recordAll && memcmp(&lastData[desc.nOffsetInBytes], data + desc.nOffsetInBytes, desc.nBytes) == 0)
+            continue;
+
+        // Sampler inputs hold texture indices, which are traced as they are
+        WriteValue(payload, i);
+        WriteValue(payload, desc.nBytes);
+        payload.insert(payload.end(), data + desc.nOffsetInBytes, data + desc.nOffsetInBytes + desc.nBytes);
+        inputCount++;
+    }
+
+    memcpy(payload.data(), &inputCount, sizeof(unsigned int));
+    lastData.assign(data, data + shaderInput->GetSize());
+
+    Command& cmd = AddCommand(enable ? RTC_ENABLE_SHADER_PROGRAM : RTC_COMMIT_SHADER_INPUT);
+    cmd.nResource[0] = programIdx;
+    cmd.nResource[1] = inputIdx;
+    cmd.nPayloadOffset = AddPayload(payload.data(), (unsigned int)payload.size());
+    cmd.nPayloadSize = (unsigned int)payload.size();
+}
+
+void RenderTrace::RecordShaderProgramDisable(const ShaderProgram* const shaderProgram)
+{
+    const unsigned int programIdx = FindResource(RES_SHADER_PROGRAM, shaderProgram);
+    if (programIdx == ~0u)
+        return;
+
+    Command& cmd = AddCommand(RTC_DISABLE_SHADER_PROGRAM);
+    cmd.nResource[0] = programIdx;
+}
+
+void RenderTrace::RecordBufferUpdate(const VertexBuffer* const vertexBuffer, const BufferLocking lockMode, const unsigned int offset, const unsigned int count)
+{
+    const unsigned int vbIdx = FindResource(RES_VERTEX_BUFFER, vertexBuffer);
+    if (vbIdx == ~0u)
+        return;
+
+    Command& cmd = AddCommand(RTC_UPDATE_VERTEX_BUFFER);
+    cmd.nResource[0] = vbIdx;
+    cmd.nArg[0] = lockMode;
+    cmd.nArg[1] = offset;
+    cmd.nArg[2] = count;
+}
+
+void RenderTrace::RecordBufferUpdate(const IndexBuffer* const indexBuffer, const BufferLocking lockMode, const unsigned int offset, const unsigned int count)
+{
+    const unsigned int ibIdx = FindResource(RES_INDEX_BUFFER, indexBuffer);
+    if (ibIdx == ~0u)
+        return;
+
+    Command& cmd = AddCommand(RTC_UPDATE_INDEX_BUFFER);
+    cmd.nResource[0] = ibIdx;
+    cmd.nArg[0] = lockMode;
+    cmd.nArg[1] = offset;
+    cmd.nArg[2] = count;
+}
+
+void RenderTrace::RecordTextureUpdate(const Texture* const texture, const CubeFace cubeFace, const unsigned int mipmapLevel, const BufferLocking lockMode)
+{
+    const unsigned int texIdx = FindResource(RES_TEXTURE, texture);
+    if (texIdx == ~0u)
+        return;
+
+    Command& cmd = AddCommand(RTC_UPDATE_TEXTURE);
+    cmd.nResource[0] = texIdx;
+    cmd.nArg[0] = lockMode;
+    cmd.nArg[1] = cubeFace;
+    cmd.nArg[2] = mipmapLevel;
+}
+
+void RenderTrace::RecordDraw(const VertexBuffer* const vertexBuffer, const unsigned int vtxOffset, const unsigned int primCount, const unsigned int vtxCount, const unsigned int idxOffset)
+{
+    const unsigned int vbIdx = FindResource(RES_VERTEX_BUFFER, vertexBuffer);
+    if (vbIdx == ~0u)
+        return;
+
+    RecordRenderStates();
+
+    Command& cmd = AddCommand(RTC_DRAW);
+    cmd.nResource[0] = vbIdx;
+    cmd.nArg[0] = vtxOffset;
+    cmd.nArg[1] = primCount;
+    cmd.nArg[2] = vtxCount;
+    cmd.nArg[3] = idxOffset;
+}
+
+void RenderTrace::RecordRenderStates()
+{
+    const RenderState* const rs = Renderer::GetInstance()->GetRenderStateManager();
+
+    BlendStateDesc blendDesc;
+    blendDesc.bColorBlendEnabled = rs->GetColorBlendEnabled();
+    blendDesc.eColorSrcBlend = rs->GetColorSrcBlend();
+    blendDesc.eColorDstBlend = rs->GetColorDstBlend();
+    blendDesc.vColorBlendFactor = rs->GetColorBlendFactor();
+    blendDesc.bAlphaTestEnabled = rs->GetAlphaTestEnabled();
+    blendDesc.eAlphaFunc = rs->GetAlphaTestFunc();
+    blendDesc.fAlphaRef = rs->GetAlphaTestRef();
+    rs->GetColorWriteEnabled(blendDesc.bColorWriteRed, blendDesc.bColorWriteGreen, blendDesc.bColorWriteBlue, blendDesc.bColorWriteAlpha);
+    blendDesc.bSRGBWriteEnabled = rs->GetSRGBWriteEnabled();
+
+    DepthStencilStateDesc depthStencilDesc;
+    depthStencilDesc.eZEnabled = rs->GetZEnabled();
+    depthStencilDesc.eZFunc = rs->GetZFunc();
+    depthStencilDesc.bZWriteEnabled = rs->GetZWriteEnabled();
+    depthStencilDesc.bStencilEnabled = rs->GetStencilEnabled();
+    depthStencilDesc.eStencilFunc = rs->GetStencilFunc();
+    depthStencilDesc.lStencilRef = rs->GetStencilRef();
+    depthStencilDesc.lStencilMask = rs->GetStencilMask();
+    depthStencilDesc.lStencilWriteMask = rs->GetStencilWriteMask();
+    depthStencilDesc.eStencilFail = rs->GetStencilFail();
+    depthStencilDesc.eStencilZFail = rs->GetStencilZFail();
+    depthStencilDesc.eStencilPass = rs->GetStencilPass();
+
+    RasterizerStateDesc rasterizerDesc;
+    rasterizerDesc.eCullMode = rs->GetCullMode();
+    rasterizerDesc.eFillMode = rs->GetFillMode();
+    rasterizerDesc.fSlopeScaledDepthBias = rs->GetSlopeScaledDepthBias();
+    rasterizerDesc.fDepthBias = rs->GetDepthBias();
+    rasterizerDesc.bScissorEnabled = rs->GetScissorEnabled();
+
+    if (!m_bRenderStatesRecorded || !(blendDesc == m_tLastBlendDesc))
+    {
+        std::vector<s3dByte> payload;
+        WriteStateDesc(payload, blendDesc);
+
+        Command& cmd = AddCommand(RTC_SET_BLEND_STATE);
+        cmd.nPayloadOffset = AddPayload(payload.data(), (unsigned int)payload.size());
+        cmd.nPayloadSize = (unsigned int)payload.size();
+        m_tLastBlendDesc = blendDesc;
+    }
+
+    if (!m_bRenderStatesRecorded || !(depthStencilDesc == m_tLastDepthStencilDesc))
+    {
+        std::vector<s3dByte> payload;
+        WriteStateDesc(payload, depthStencilDesc);
+
+        Command& cmd = AddCommand(RTC_SET_DEPTH_STENCIL_STATE);
+        cmd.nPayloadOffset = AddPayload(payload.data(), (unsigned int)payload.size());
+        cmd.nPayloadSize = (unsigned int)payload.size();
+        m_tLastDepthStencilDesc = depthStencilDesc;
+    }
+
+    if (!m_bRenderStatesRecorded || !(rasterizerDesc == m_tLastRasterizerDesc))
+    {
+        std::vector<s3dByte> payload;
+        WriteStateDesc(payload, rasterizerDesc);
+
+        Command& cmd = AddCommand(RTC_SET_RASTERIZER_STATE);
+        cmd.nPayloadOffset = AddPayload(payload.data(), (unsigned int)payload.size());
+        cmd.nPayloadSize = (unsigned int)payload.size();
+        m_tLastRasterizerDesc = rasterizerDesc;
+    }
+
+    m_bRenderStatesRecorded = true;
+}
+
+void RenderTrace::DescribeResources()
+{
+    const ResourceManager* const resMan = Renderer::GetInstance()->GetResourceManager();
+    std::vector<s3dByte>& desc = m_arrResourceDesc;
+
+    desc.clear();
+    IndexResources();
+
+    // Every pool is written as its slot count, followed by a validity flag
+    // and, for valid slots, the arguments required to recreate the resource.
+    // Pools are written in the order in which they must be recreated.
+    WriteValue(desc, resMan->GetVertexFormatCount());
+    for (unsigned int i = 0, n = resMan->GetVertexFormatCount(); i < n; i++)
+    {
+        const VertexFormat* const vf = resMan->GetVertexFormat(i);
+        WriteValue(desc, (s3dByte)(vf != nullptr));
+        if (!vf)
+            continue;
+
+        WriteValue(desc, vf->GetAttributeCount());
+        for (unsigned int attr = 0, attrCount = vf->GetAttributeCount(); attr < attrCount; attr++)
+        {
+            WriteValue(desc, vf->GetOffset(attr));
+            WriteValue(desc, (unsigned int)vf->GetAttributeSemantic(attr));
+            WriteValue(desc, (unsigned int)vf->GetAttributeType(attr));
+            WriteValue(desc, vf->GetSemanticIndex(attr));
+        }
+        WriteValue(desc, vf->GetStride());
+    }
+
+    WriteValue(desc, resMan->GetIndexBufferCount());
+    for (unsigned int i = 0, n = resMan->GetIndexBufferCount(); i < n; i++)
+    {
+        const IndexBuffer* const ib = resMan->GetIndexBuffer(i);
+        WriteValue(desc, (s3dByte)(ib != nullptr));
+        if (!ib)
+            continue;
+
+        WriteValue(desc, ib->GetElementCount());
+        WriteValue(desc, (unsigned int)ib->GetIndexFormat());
+        WriteValue(desc, (unsigned int)ib->GetUsage());
+    }
+
+    WriteValue(desc, resMan->GetVertexBufferCount());
+    for (unsigned int i = 0, n = resMan->GetVertexBufferCount(); i < n; i++)
+    {
+        const VertexBuffer* const vb = resMan->GetVertexBuffer(i);
+        WriteValue(desc, (s3dByte)(vb != nullptr));
+        if (!vb)
+            continue;
+
+        WriteValue(desc, FindResource(RES_VERTEX_FORMAT, vb->GetVertexFormat()));
+        WriteValue(desc, vb->GetElementCount());
+        WriteValue(desc, FindResource(RES_INDEX_BUFFER, vb->GetIndexBuffer()));
+        WriteValue(desc, (unsigned int)vb->GetUsage());
+    }
+
+    WriteValue(desc, resMan->GetShaderProgramCount());
+    for (unsigned int i = 0, n = resMan->GetShaderProgramCount(); i < n; i++)
+    {
+        const ShaderProgram* const sp = resMan->GetShaderProgram(i);
+        WriteValue(desc, (s3dByte)(sp != nullptr));
+        if (!sp)
+            continue;
+
+        WriteValue(desc, (unsigned int)sp->GetProgramType());
+        WriteString(desc, sp->GetFilePath());
+        WriteString(desc, sp->GetEntryPoint());
+    }
+
+    WriteValue(desc, resMan->GetShaderInputCount());
+    for (unsigned int i = 0, n = resMan->GetShaderInputCount(); i < n; i++)
+    {
+        const ShaderInput* const si = resMan->GetShaderInput(i);
+        WriteValue(desc, (s3dByte)(si != nullptr));
+        if (!si)
+            continue;
+
+        WriteValue(desc, FindResource(RES_SHADER_PROGRAM, si->GetAssociatedShaderProgram()));
+    }
+
+    // Render targets are recreated with their current size,
+    // even if it was specified relative to the backbuffer's
+    WriteValue(desc, resMan->GetRenderTargetCount());
+    for (unsigned int i = 0, n = resMan->GetRenderTargetCount(); i < n; i++)
+    {
+        const RenderTarget* const rt = resMan->GetRenderTarget(i);
+        WriteValue(desc, (s3dByte)(rt != nullptr));
+        if (!rt)
+            continue;
+
+        WriteValue(desc, rt->GetTargetCount());
+        for (unsigned int target = 0, targetCount = rt->GetTargetCount(); target < targetCount; target++)
+        {
+            WriteValue(desc, (unsigned int)rt->GetPixelFormat(target));
+            WriteValue(desc, rt->GetColorBuffer(target));
+        }
+        WriteValue(desc, rt->GetWidth());
+        WriteValue(desc, rt->GetHeight());
+        WriteValue(desc, (s3dByte)rt->HasMipmaps());
+        WriteValue(desc, (s3dByte)rt->HasDepthBuffer());
+
+        const Texture* const depthBuffer = rt->HasDepthBuffer() ? resMan->GetTexture(rt->GetDepthBuffer()) : nullptr;
+        WriteValue(desc, (unsigned int)(depthBuffer ? depthBuffer->GetPixelFormat() : PF_NONE));
+        WriteValue(desc, depthBuffer ? rt->GetDepthBuffer() : ~0u);
+    }
+
+    WriteValue(desc, resMan->GetTextureCount());
+    for (unsigned int i = 0, n = resMan->GetTextureCount(); i < n; i++)
+    {
+        const Texture* const tex = resMan->GetTexture(i);
+        WriteValue(desc, (s3dByte)(tex != nullptr));
+        if (!tex)
+            continue;
+
+        WriteValue(desc, (unsigned int)tex->GetPixelFormat());
+        WriteValue(desc, (unsigned int)tex->GetTextureType());
+        WriteValue(desc, tex->GetWidth());
+        WriteValue(desc, tex->GetHeight());
+        WriteValue(desc, tex->GetDepth());
+        WriteValue(desc, tex->GetMipCount());
+        WriteValue(desc, (unsigned int)tex->GetUsage());
+
+        // Sampler states are set from the textures when committing shader inputs
+        WriteValue(desc, tex->GetAnisotropy());
+        WriteValue(desc, tex->GetMipLodBias());
+        WriteValue(desc, (unsigned int)tex->GetFilter());
+        const Vec4f borderColor = tex->GetBorderColor();
+        for (unsigned int c = 0; c < 4; c++)
+            WriteValue(desc, borderColor[c]);
+        WriteValue(desc, (unsigned int)tex->GetAddressingModeU());
+        WriteValue(desc, (unsigned int)tex->GetAddressingModeV());
+        WriteValue(desc, (unsigned int)tex->GetAddressingModeW());
+        WriteValue(desc, (s3dByte)tex->GetSRGBEnabled());
+    }
+}
+
+const bool RenderTrace::Write(const char* const filePath) const
+{
+    std::vector<s3dByte> trace;
+    WriteValue(trace, (unsigned int)m_arrResourceDesc.size());
+    trace.insert(trace.end(), m_arrResourceDesc.begin(), m_arrResourceDesc.end());
+    WriteValue(trace, (unsigned int)m_arrCommand.size());
+    trace.insert(trace.end(), (const s3dByte*)m_arrCommand.data(), (const s3dByte*)(m_arrCommand.data() + m_arrCommand.size()));
+    WriteValue(trace, (unsigned int)m_arrPayload.size());
+    trace.insert(trace.end(), m_arrPayload.begin(), m_arrPayload.end());
+
+    if (trace.size() > LZ4_MAX_INPUT_SIZE)
+        return false;
+
+    const int uncompressedSize = (int)trace.size();
+    const int compressedSizeMax = LZ4_compressBound(uncompressedSize);
+    char* const compressedBuffer = new char[compressedSizeMax];
+    const int compressedSize = LZ4_compress_default((const char*)trace.data(), compressedBuffer, uncompressedSize, compressedSizeMax);
+
+    std::ofstream traceFile;
+    if (compressedSize > 0)
+        traceFile.open(filePath, std::ofstream::trunc | std::ofstream::binary);
+
+    const bool isOpen = traceFile.is_open();
+    if (isOpen)
+    {
+        traceFile.write(S3D_RENDER_TRACE_FILE_HEADER, S3D_RENDER_TRACE_FILE_HEADER_SIZE);
+        const unsigned int fileVersion = S3D_RENDER_TRACE_FILE_VERSION;
+        traceFile.write((const char*)&fileVersion, sizeof(unsigned int));
+        traceFile.write((const char*)&compressedSize, sizeof(unsigned int));
+        traceFile.write((const char*)&uncompressedSize, sizeof(unsigned int));
+        traceFile.write(compressedBuffer, compressedSize);
+        traceFile.close();
+    }
+
+    delete[] compressedBuffer;
+
+    return isOpen;
+}
+
+const bool RenderTrace::Load(const char* const filePath)
+{
+    assert(!IsCapturing());
+    if (IsCapturing())
+        return false;
+
+    m_arrCommand.clear();
+    m_arrPayload.clear();
+    m_arrResourceDesc.clear();
+
+    std::ifstream traceFile;
+    traceFile.open(filePath, std::ios::binary);
+    if (!traceFile.is_open())
+    {
+        S3D_DBGPRINT("Error: Render trace %s could not be opened", filePath);
+        return false;
+    }
+
+    char fileSignature[S3D_RENDER_TRACE_FILE_HEADER_SIZE];
+    unsigned int fileVersion = 0, compressedSize = 0, uncompressedSize = 0;
+    traceFile.read(fileSignature, S3D_RENDER_TRACE_FILE_HEADER_SIZE);
+    traceFile.read((char*)&fileVersion, sizeof(unsigned int));
+    traceFile.read((char*)&compressedSize, sizeof(unsigned int));
+    traceFile.read((char*)&uncompressedSize, sizeof(unsigned int));
+
+    if (!traceFile || memcmp(S3D_RENDER_TRACE_FILE_HEADER, fileSignature, S3D_RENDER_TRACE_FILE_HEADER_SIZE) != 0)
+    {
+        S3D_DBGPRINT("Error: %s is not a render trace", filePath);
+        return false;
+    }
+
+    if (fileVersion != S3D_RENDER_TRACE_FILE_VERSION)
+    {
+        S3D_DBGPRINT("Error: Render trace %s is version %u but version %u was expected", filePath, fileVersion, S3D_RENDER_TRACE_FILE_VERSION);
+        return false;
+    }
+
+    if (compressedSize == 0 || compressedSize > (unsigned int)LZ4_COMPRESSBOUND(LZ4_MAX_INPUT_SIZE) ||
+        uncompressedSize == 0 || uncompressedSize > LZ4_MAX_INPUT_SIZE)
+    {
+        S3D_DBGPRINT("Error: Render trace %s has invalid data size", filePath);
+        return false;
+    }
+
+    std::vector<char> compressedBuffer(compressedSize);
+    std::vector<s3dByte> trace(uncompressedSize);
+    traceFile.read(compressedBuffer.data(), compressedSize);
+
+    if (!traceFile || LZ4_decompress_safe(compressedBuffer.data(), (char*)trace.data(), (int)compressedSize, (int)uncompressedSize) != (int)uncompressedSize)
+    {
+        S3D_DBGPRINT("Error: Render trace %s could not be decompressed", filePath);
+        return false;
+    }
+
+    RenderTraceReader reader(trace.data(), trace.size());
+
+    const unsigned int resourceDescSize = reader.Read<unsigned int>();
+    if (reader.IsValid() && resourceDescSize <= reader.GetRemainingSize())
+    {
+        m_arrResourceDesc.resize(resourceDescSize);
+        if (resourceDescSize > 0)
+            reader.ReadBytes(m_arrResourceDesc.data(), resourceDescSize);
+    }
+
+    const unsigned int commandCount = reader.Read<unsigned int>();
+    if (reader.IsValid() && commandCount <= reader.GetRemainingSize() / sizeof(Command))
+    {
+        m_arrCommand.resize(commandCount);
+        if (commandCount > 0)
+            reader.ReadBytes(m_arrCommand.data(), commandCount * sizeof(Command));
+    }
+    else
+        m_arrCommand.clear();
+
+    const unsigned int payloadSize = reader.Read<unsigned int>();
+    if (reader.IsValid() && payloadSize <= reader.GetRemainingSize())
+    {
+        m_arrPayload.resize(payloadSize);
+        if (payloadSize > 0)
+            reader.ReadBytes(m_arrPayload.data(), payloadSize);
+    }
+
+    bool valid =
+        reader.IsValid() &&
+        resourceDescSize == m_arrResourceDesc.size() &&
+        commandCount == m_arrCommand.size() &&
+        payloadSize == m_arrPayload.size();
+    for (unsigned int i = 0; i < m_arrCommand.size() && valid; i++)
+    {
+        const Command& cmd = m_arrCommand[i];
+        valid =
+            cmd.eType < RTC_MAX &&
+            cmd.nPayloadOffset <= m_arrPayload.size() &&
+            cmd.nPayloadSize <= m_arrPayload.size() - cmd.nPayloadOffset;
+    }
+
+    if (!valid)
+    {
+        S3D_DBGPRINT("Error: Render trace %s is corrupt", filePath);
+        m_arrCommand.clear();
+        m_arrPayload.clear();
+        m_arrResourceDesc.clear();
+        return false;
+    }
+
+    return true;
+}
+
+const unsigned int RenderTrace::GetReplayResource(const ResourceType type, const unsigned int tracedIdx) const
+{
+    return tracedIdx < m_arrReplayResource[type].size() ? m_arrReplayResource[type][tracedIdx] : ~0u;
+}
+
+const bool RenderTrace::CreateReplayResources()
+{
+    ResourceManager* const resMan = Renderer::GetInstance()->GetResourceManager();
+    RenderTraceReader reader(m_arrResourceDesc.data(), m_arrResourceDesc.size());
+
+    for (unsigned int i = 0; i < RES_MAX; i++)
+        m_arrReplayResource[i].clear();
+    m_arrReplayTexture.clear();
+
+    // Contents of buffers aren't traced, so they are zeroed (i.e. degenerate triangles)
+    m_arrReplayResource[RES_VERTEX_FORMAT].resize(reader.Read<unsigned int>(), ~0u);
+    for (unsigned int i = 0; i < m_arrReplayResource[RES_VERTEX_FORMAT].size() && reader.IsValid(); i++)
+    {
+        if (!reader.Read<s3dByte>())
+            continue;
+
+        const unsigned int attrCount = reader.Read<unsigned int>();
+        if (!reader.IsValid() || attrCount > m_arrResourceDesc.size())
+            return false;
+
+        const unsigned int vfIdx = resMan->CreateVertexFormat(attrCount);
+        m_arrReplayResource[RES_VERTEX_FORMAT][i] = vfIdx;
+        VertexFormat* const vf = resMan->GetVertexFormat(vfIdx);
+
+        for (unsigned int attr = 0; attr < attrCount; attr++)
+        {
+            const unsigned int offset = reader.Read<unsigned int>();
+            const VertexAttributeSemantic semantic = (VertexAttributeSemantic)reader.Read<unsigned int>();
+            const VertexAttributeType type = (VertexAttributeType)reader.Read<unsigned int>();
+            const unsigned int semanticIdx = reader.Read<unsigned int>();
+            vf->SetAttribute(attr, offset, semantic, type, semanticIdx);
+        }
+        vf->SetStride(reader.Read<unsigned int>());
+        vf->Update();
+    }
+
+    m_arrReplayResource[RES_INDEX_BUFFER].resize(reader.Read<unsigned int>(), ~0u);
+    for (unsigned int i = 0; i < m_arrReplayResource[RES_INDEX_BUFFER].size() && reader.IsValid(); i++)
+    {
+        if (!reader.Read<s3dByte>())
+            continue;
+
+        const unsigned int indexCount = reader.Read<unsigned int>();
+        const IndexBufferFormat indexFormat = (IndexBufferFormat)reader.Read<unsigned int>();
+        const BufferUsage usage = (BufferUsage)reader.Read<unsigned int>();
+        if (!reader.IsValid() || indexFormat >= IBF_MAX)
+            return false;
+
+        const unsigned int ibIdx = resMan->CreateIndexBuffer(indexCount, indexFormat, usage);
+        m_arrReplayResource[RES_INDEX_BUFFER][i] = ibIdx;
+
+        IndexBuffer* const ib = resMan->GetIndexBuffer(ibIdx);
+        if (ib->GetSize() > 0)
+        {
+            memset(ib->GetData(), 0, ib->GetSize());
+            ib->Lock(BL_WRITE_ONLY);
+            ib->Update();
+            ib->Unlock();
+        }
+    }
+
+    m_arrReplayResource[RES_VERTEX_BUFFER].resize(reader.Read<unsigned int>(), ~0u);
+    for (unsigned int i = 0; i < m_arrReplayResource[RES_VERTEX_BUFFER].size() && reader.IsValid(); i++)
+    {
+        if (!reader.Read<s3dByte>())
+            continue;
+
+        const unsigned int vfIdx = GetReplayResource(RES_VERTEX_FORMAT, reader.Read<unsigned int>());
+        const unsigned int vertexCount = reader.Read<unsigned int>();
+        const unsigned int tracedIbIdx = reader.Read<unsigned int>();
+        const unsigned int ibIdx = GetReplayResource(RES_INDEX_BUFFER, tracedIbIdx);
+        const BufferUsage usage = (BufferUsage)reader.Read<unsigned int>();
+        if (!reader.IsValid() || vfIdx == ~0u || (tracedIbIdx != ~0u && ibIdx == ~0u))
+            return false;
+
+        const unsigned int vbIdx = resMan->CreateVertexBuffer(
+            resMan->GetVertexFormat(vfIdx), vertexCount,
+            ibIdx != ~0u ? resMan->GetIndexBuffer(ibIdx) : nullptr, usage);
+        m_arrReplayResource[RES_VERTEX_BUFFER][i] = vbIdx;
+
+        VertexBuffer* const vb = resMan->GetVertexBuffer(vbIdx);
+        if (vb->GetSize() > 0)
+        {
+            memset(vb->GetData(), 0, vb->GetSize());
+            vb->Lock(BL_WRITE_ONLY);
+            vb->Update();
+            vb->Unlock();
+        }
+    }
+
+    m_arrReplayResource[RES_SHADER_PROGRAM].resize(reader.Read<unsigned int>(), ~0u);
+    for (unsigned int i = 0; i < m_arrReplayResource[RES_SHADER_PROGRAM].size() && reader.IsValid(); i++)
+    {
+        if (!reader.Read<s3dByte>())
+            continue;
+
+        const ShaderProgramType programType = (ShaderProgramType)reader.Read<unsigned int>();
+        const std::string filePath = reader.ReadString();
+        const std::string entryPoint = reader.ReadString();
+        if (!reader.IsValid() || programType <= SPT_NONE || programType >= SPT_MAX)
+            return false;
+
+        const unsigned int spIdx = resMan->CreateShaderProgram(filePath.c_str(), programType, entryPoint.c_str());
+        if (spIdx == ~0u)
+        {
+            S3D_DBGPRINT("Error: Shader program %s could not be created for the render trace", filePath.c_str());
+            return false;
+        }
+        m_arrReplayResource[RES_SHADER_PROGRAM][i] = spIdx;
+    }
+
+    m_arrReplayResource[RES_SHADER_INPUT].resize(reader.Read<unsigned int>(), ~0u);
+    for (unsigned int i = 0; i < m_arrReplayResource[RES_SHADER_INPUT].size() && reader.IsValid(); i++)
+    {
+        if (!reader.Read<s3dByte>())
+            continue;
+
+        const unsigned int spIdx = GetReplayResource(RES_SHADER_PROGRAM, reader.Read<unsigned int>());
+        if (!reader.IsValid() || spIdx == ~0u)
+            return false;
+
+        m_arrReplayResource[RES_SHADER_INPUT][i] = resMan->CreateShaderInput(resMan->GetShaderProgram(spIdx));
+    }
+
+    // Render targets create their own textures, which are matched to the traced ones
+    m_arrReplayResource[RES_RENDER_TARGET].resize(reader.Read<unsigned int>(), ~0u);
+    std::vector<std::pair<unsigned int, unsigned int>> rtTexture;
+    for (unsigned int i = 0; i < m_arrReplayResource[RES_RENDER_TARGET].size() && reader.IsValid(); i++)
+    {
+        if (!reader.Read<s3dByte>())
+            continue;
+
+        PixelFormat pixelFormat[4] = { PF_NONE, PF_NONE, PF_NONE, PF_NONE };
+        unsigned int colorBuffer[4] = { ~0u, ~0u, ~0u, ~0u };
+        const unsigned int targetCount = reader.Read<unsigned int>();
+        if (!reader.IsValid() || targetCount > 4)
+            return false;
+
+        for (unsigned int target = 0; target < targetCount; target++)
+        {
+            pixelFormat[target] = (PixelFormat)reader.Read<unsigned int>();
+            colorBuffer[target] = reader.Read<unsigned int>();
+        }
+        const unsigned int width = reader.Read<unsigned int>();
+        const unsigned int height = reader.Read<unsigned int>();
+        const bool hasMipmaps = reader.Read<s3dByte>() != 0;
+        const bool hasDepthBuffer = reader.Read<s3dByte>() != 0;
+        const PixelFormat depthFormat = (PixelFormat)reader.Read<unsigned int>();
+        const unsigned int depthBuffer = reader.Read<unsigned int>();
+        if (!reader.IsValid())
+            return false;
+
+        const unsigned int rtIdx = resMan->CreateRenderTarget(
+            targetCount, pixelFormat[0], pixelFormat[1], pixelFormat[2], pixelFormat[3],
+            width, height, hasMipmaps, hasDepthBuffer, depthFormat);
+        m_arrReplayResource[RES_RENDER_TARGET][i] = rtIdx;
+
+        const RenderTarget* const rt = resMan->GetRenderTarget(rtIdx);
+        for (unsigned int target = 0; target < targetCount && target < rt->GetTargetCount(); target++)
+            rtTexture.push_back(std::pair<unsigned int, unsigned int>(colorBuffer[target], rt->GetColorBuffer(target)));
+        if (hasDepthBuffer && rt->HasDepthBuffer())
+            rtTexture.push_back(std::pair<unsigned int, unsigned int>(depthBuffer, rt->GetDepthBuffer()));
+    }
+
+    m_arrReplayResource[RES_TEXTURE].resize(reader.Read<unsigned int>(), ~0u);
+    for (unsigned int i = 0; i < rtTexture.size(); i++)
+        if (rtTexture[i].first < m_arrReplayResource[RES_TEXTURE].size())
+            m_arrReplayResource[RES_TEXTURE][rtTexture[i].first] = rtTexture[i].second;
+
+    for (unsigned int i = 0; i < m_arrReplayResource[RES_TEXTURE].size() && reader.IsValid(); i++)
+    {
+        if (!reader.Read<s3dByte>())
+            continue;
+
+        const PixelFormat pixelFormat = (PixelFormat)reader.Read<unsigned int>();
+        const TextureType texType = (TextureType)reader.Read<unsigned int>();
+        const unsigned int width = reader.Read<unsigned int>();
+        const unsigned int height = reader.Read<unsigned int>();
+        const unsigned int depth = reader.Read<unsigned int>();
+        const unsigned int mipCount = reader.Read<unsigned int>();
+        const BufferUsage usage = (BufferUsage)reader.Read<unsigned int>();
+        const unsigned int anisotropy = reader.Read<unsigned int>();
+        const float lodBias = reader.Read<float>();
+        const SamplerFilter filter = (SamplerFilter)reader.Read<unsigned int>();
+        Vec4f borderColor;
+        for (unsigned int c = 0; c < 4; c++)
+            borderColor[c] = reader.Read<float>();
+        const SamplerAddressingMode addressingModeU = (SamplerAddressingMode)reader.Read<unsigned int>();
+        const SamplerAddressingMode addressingModeV = (SamplerAddressingMode)reader.Read<unsigned int>();
+        const SamplerAddressingMode addressingModeW = (SamplerAddressingMode)reader.Read<unsigned int>();
+        const bool sRGBEnabled = reader.Read<s3dByte>() != 0;
+        if (!reader.IsValid())
+            return false;
+
+        if (m_arrReplayResource[RES_TEXTURE][i] == ~0u && pixelFormat != PF_NONE)
+        {
+            const unsigned int texIdx = resMan->CreateTexture(pixelFormat, texType, width, height, depth, mipCount, usage);
+            m_arrReplayResource[RES_TEXTURE][i] = texIdx;
+            m_arrReplayTexture.push_back(texIdx);
+        }
+
+        if (m_arrReplayResource[RES_TEXTURE][i] == ~0u)
+            continue;
+
+        Texture* const tex = resMan->GetTexture(m_arrReplayResource[RES_TEXTURE][i]);
+        tex->SetAnisotropy(anisotropy);
+        tex->SetMipLodBias(lodBias);
+        tex->SetFilter(filter);
+        tex->SetBorderColor(borderColor);
+        tex->SetAddressingModeU(addressingModeU);
+        tex->SetAddressingModeV(addressingModeV);
+        tex->SetAddressingModeW(addressingModeW);
+        tex->SetSRGBEnabled(sRGBEnabled);
+    }
+
+    if (!reader.IsValid())
+        return false;
+
+    // Create the render state blocks up front, so that their creation isn't timed
+    RenderState* const rs = Renderer::GetInstance()->GetRenderStateManager();
+    m_arrReplayStateBlock.assign(m_arrCommand.size(), nullptr);
+    for (unsigned int i = 0; i < m_arrCommand.size(); i++)
+    {
+        const Command& cmd = m_arrCommand[i];
+        const s3dByte* const payload = m_arrPayload.data() + cmd.nPayloadOffset;
+
+        if (cmd.eType == RTC_SET_BLEND_STATE)
+        {
+            BlendStateDesc desc;
+            RenderTraceReader stateReader(payload, cmd.nPayloadSize);
+            ReadStateDesc(stateReader, desc);
+            if (stateReader.IsValid())
+                m_arrReplayStateBlock[i] = rs->CreateBlendState(desc);
+        }
+
+        if (cmd.eType == RTC_SET_DEPTH_STENCIL_STATE)
+        {
+            DepthStencilStateDesc desc;
+            RenderTraceReader stateReader(payload, cmd.nPayloadSize);
+            ReadStateDesc(stateReader, desc);
+            if (stateReader.IsValid())
+                m_arrReplayStateBlock[i] = rs->CreateDepthStencilState(desc);
+        }
+
+        if (cmd.eType == RTC_SET_RASTERIZER_STATE)
+        {
+            RasterizerStateDesc desc;
+            RenderTraceReader stateReader(payload, cmd.nPayloadSize);
+            ReadStateDesc(stateReader, desc);
+            if (stateReader.IsValid())
+                m_arrReplayStateBlock[i] = rs->CreateRasterizerState(desc);
+        }
+    }
+
+    return true;
+}
+
+void RenderTrace::ReleaseReplayResources()
+{
+    ResourceManager* const resMan = Renderer::GetInstance()->GetResourceManager();
+
+    for (unsigned int i = 0; i < m_arrReplayResource[RES_SHADER_INPUT].size(); i++)
+        if (m_arrReplayResource[RES_SHADER_INPUT][i] != ~0u)
+            resMan->ReleaseShaderInput(m_arrReplayResource[RES_SHADER_INPUT][i]);
+
+    for (unsigned int i = 0; i < m_arrReplayResource[RES_SHADER_PROGRAM].size(); i++)
+        if (m_arrReplayResource[RES_SHADER_PROGRAM][i] != ~0u)
+            resMan->ReleaseShaderProgram(m_arrReplayResource[RES_SHADER_PROGRAM][i]);
+
+    for (unsigned int i = 0; i < m_arrReplayResource[RES_VERTEX_BUFFER].size(); i++)
+        if (m_arrReplayResource[RES_VERTEX_BUFFER][i] != ~0u)
+            resMan->ReleaseVertexBuffer(m_arrReplayResource[RES_VERTEX_BUFFER][i]);
+
+    for (unsigned int i = 0; i < m_arrReplayResource[RES_INDEX_BUFFER].size(); i++)
+        if (m_arrReplayResource[RES_INDEX_BUFFER][i] != ~0u)
+            resMan->ReleaseIndexBuffer(m_arrReplayResource[RES_INDEX_BUFFER][i]);
+
+    for (unsigned int i = 0; i < m_arrReplayResource[RES_VERTEX_FORMAT].size(); i++)
+        if (m_arrReplayResource[RES_VERTEX_FORMAT][i] != ~0u)
+            resMan->ReleaseVertexFormat(m_arrReplayResource[RES_VERTEX_FORMAT][i]);
+
+    for (unsigned int i = 0; i < m_arrReplayResource[RES_RENDER_TARGET].size(); i++)
+        if (m_arrReplayResource[RES_RENDER_TARGET][i] != ~0u)
+            resMan->ReleaseRenderTarget(m_arrReplayResource[RES_RENDER_TARGET][i]);
+
+    for (unsigned int i = 0; i < m_arrReplayTexture.size(); i++)
+        resMan->ReleaseTexture(m_arrReplayTexture[i]);
+
+    for (unsigned int i = 0; i < RES_MAX; i++)
+        m_arrReplayResource[i].clear();
+    m_arrReplayTexture.clear();
+    m_arrReplayStateBlock.clear();
+}
+
+const bool RenderTrace::Replay(const unsigned int iterations, RenderTraceReplayStats& stats)
+{
+    stats.Reset();
+
+    Renderer* const renderer = Renderer::GetInstance();
+    assert(renderer && !IsCapturing());
+    if (!renderer || IsCapturing())
+        return false;
+
+    if (!CreateReplayResources())
+    {
+        S3D_DBGPRINT("Error: Render trace resources could not be created");
+        ReleaseReplayResources();
+        return false;
+    }
+
+    for (unsigned int i = 0; i < m_arrCommand.size(); i++)
+        stats.nCommandCount[m_arrCommand[i].eType]++;
+
+    // Measure the cost of the timestamps around each command, so that it
+    // doesn't dominate the timings of very cheap commands (e.g. state changes)
+    const unsigned int calibrationCount = 1000;
+    long long calibrationTime = 0;
+    for (unsigned int i = 0; i < calibrationCount; i++)
+    {
+        const long long start = Profiler::GetCPUTimestamp();
+        calibrationTime += Profiler::GetCPUTimestamp() - start;
+    }
+    stats.nTimerOverhead = calibrationTime / calibrationCount;
+
+    const long long replayStart = Profiler::GetCPUTimestamp();
+    long long stallTime = 0;
+    unsigned int failedFrameCount = 0;
+
+    while (stats.nIterationCount < iterations)
+    {
+        if (!renderer->BeginFrame())
+        {
+            // The device may be lost (e.g. the window is minimized), so give it
+            // some time to be restored, but don't wait on it indefinitely
+            if (++failedFrameCount > S3D_RENDER_TRACE_REPLAY_MAX_FRAME_RETRIES)
+            {
+                S3D_DBGPRINT("Error: Could not begin a frame after %u retries, aborting the render trace replay", S3D_RENDER_TRACE_REPLAY_MAX_FRAME_RETRIES);
+                ReleaseReplayResources();
+                return false;
+            }
+
+            const long long stallStart = Profiler::GetCPUTimestamp();
+            std::this_thread::sleep_for(std::chrono::milliseconds(S3D_RENDER_TRACE_REPLAY_FRAME_RETRY_DELAY));
+            stallTime += Profiler::GetCPUTimestamp() - stallStart;
+            continue;
+        }
+
+        failedFrameCount = 0;
+
+        for (unsigned int i = 0; i < m_arrCommand.size(); i++)
+        {
+            const long long start = Profiler::GetCPUTimestamp();
+            ReplayCommand(m_arrCommand[i], i);
+            const long long time = Profiler::GetCPUTimestamp() - start - stats.nTimerOverhead;
+            stats.nCommandTime[m_arrCommand[i].eType] += time > 0 ? time : 0;
+        }
+
+        // Don't leave render targets enabled across iterations
+        while (RenderTarget::GetActiveRenderTarget())
+            RenderTarget::GetActiveRenderTarget()->Disable();
+
+        renderer->EndFrame();
+        renderer->SwapBuffers();
+
+        stats.nIterationCount++;
+    }
+
+    stats.nFrameTime = Profiler::GetCPUTimestamp() - replayStart - stallTime;
+
+    ReleaseReplayResources();
+
+    return true;
+}
+
+void RenderTrace::ReplayCommand(const Command& cmd, const unsigned int cmdIdx)
+{
+    Renderer* const renderer = Renderer::GetInstance();
+    ResourceManager* const resMan = renderer->GetResourceManager();
+    RenderState* const rs = renderer->GetRenderStateManager();
+
+    switch (cmd.eType)
+    {
+    case RTC_SET_VIEWPORT:
+        renderer->SetViewport(Vec2i((int)cmd.nArg[0], (int)cmd.nArg[1]), Vec2i((int)cmd.nArg[2], (int)cmd.nArg[3]));
+        break;
+
+    case RTC_SET_SCISSOR:
+        rs->SetScissor(Vec2i((int)cmd.nArg[0], (int)cmd.nArg[1]), Vec2i((int)cmd.nArg[2], (int)cmd.nArg[3]));
+        break;
+
+    case RTC_CLEAR:
+        renderer->Clear(Vec4f(cmd.fArg[0], cmd.fArg[1], cmd.fArg[2], cmd.fArg[3]), cmd.fArg[4], cmd.nArg[0]);
+        break;
+
+    case RTC_SET_BLEND_STATE:
+        if (m_arrReplayStateBlock[cmdIdx])
+            rs->SetBlendState((const BlendState*)m_arrReplayStateBlock[cmdIdx]);
+        break;
+
+    case RTC_SET_DEPTH_STENCIL_STATE:
+        if (m_arrReplayStateBlock[cmdIdx])
+            rs->SetDepthStencilState((const DepthStencilState*)m_arrReplayStateBlock[cmdIdx]);
+        break;
+
+    case RTC_SET_RASTERIZER_STATE:
+        if (m_arrReplayStateBlock[cmdIdx])
+            rs->SetRasterizerState((const RasterizerState*)m_arrReplayStateBlock[cmdIdx]);
+        break;
+
+    case RTC_ENABLE_RENDER_TARGET:
+    case RTC_DISABLE_RENDER_TARGET:
+    {
+        const unsigned int rtIdx = GetReplayResource(RES_RENDER_TARGET, cmd.nResource[0]);
+        RenderTarget* const rt = rtIdx != ~0u ? resMan->GetRenderTarget(rtIdx) : nullptr;
+        if (!rt)
+            break;
+
+        if (cmd.eType == RTC_ENABLE_RENDER_TARGET)
+            rt->Enable();
+        else if (RenderTarget::GetActiveRenderTarget() == rt)
+            rt->Disable();
+        break;
+    }
+
+    case RTC_ENABLE_SHADER_PROGRAM:
+    case RTC_COMMIT_SHADER_INPUT:
+    {
+        const unsigned int spIdx = GetReplayResource(RES_SHADER_PROGRAM, cmd.nResource[0]);
+        const unsigned int siIdx = GetReplayResource(RES_SHADER_INPUT, cmd.nResource[1]);
+        if (spIdx == ~0u || siIdx == ~0u)
+            break;
+
+        ShaderProgram* const sp = resMan->GetShaderProgram(spIdx);
+        ShaderInput* const si = resMan->GetShaderInput(siIdx);
+
+        // Inputs which don't match the recreated shader input are skipped,
+        // e.g. when replaying on a backend that doesn't reflect shader constants
+        RenderTraceReader reader(m_arrPayload.data() + cmd.nPayloadOffset, cmd.nPayloadSize);
+        const unsigned int inputCount = reader.Read<unsigned int>();
+        for (unsigned int i = 0; i < inputCount && reader.IsValid(); i++)
+        {
+            const unsigned int handle = reader.Read<unsigned int>();
+            const unsigned int size = reader.Read<unsigned int>();
+            if (!reader.IsValid())
+                break;
+
+            if (handle < si->GetInputCount() && si->GetInputDesc(handle).nBytes == size)
+            {
+                const ShaderInputDesc& desc = si->GetInputDesc(handle);
+                s3dByte* const data = si->GetData() + desc.nOffsetInBytes;
+                reader.ReadBytes(data, size);
+
+                if (desc.eInputType >= IT_SAMPLER && desc.eInputType <= IT_SAMPLERCUBE && size >= sizeof(unsigned int))
+                {
+                    unsigned int texIdx = ~0u;
+                    memcpy(&texIdx, data, sizeof(unsigned int));
+                    texIdx = GetReplayResource(RES_TEXTURE, texIdx);
+                    memcpy(data, &texIdx, sizeof(unsigned int));
+                }
+
+                si->m_arrDirtyInput[handle] = true;
+            }
+            else
+            {
+                reader.Skip(size);
+            }
+        }
+
+        if (cmd.eType == RTC_ENABLE_SHADER_PROGRAM)
+            sp->Enable(si);
+        else
+            sp->CommitShaderInput(si);
+        break;
+    }
+
+    case RTC_DISABLE_SHADER_PROGRAM:
+    {
+        const unsigned int spIdx = GetReplayResource(RES_SHADER_PROGRAM, cmd.nResource[0]);
+        if (spIdx != ~0u)
+            resMan->GetShaderProgram(spIdx)->Disable();
+        break;
+    }
+
+    case RTC_UPDATE_VERTEX_BUFFER:
+    {
+        const unsigned int vbIdx = GetReplayResource(RES_VERTEX_BUFFER, cmd.nResource[0]);
+        if (vbIdx == ~0u || cmd.nArg[0] >= BL_MAX)
+            break;
+
+        VertexBuffer* const vb = resMan->GetVertexBuffer(vbIdx);
+        if (cmd.nArg[1] > vb->GetElementCount() || cmd.nArg[2] > vb->GetElementCount() - cmd.nArg[1])
+            break;
+
+        vb->Lock((BufferLocking)cmd.nArg[0], cmd.nArg[1], cmd.nArg[2]);
+        vb->Update();
+        vb->Unlock();
+        break;
+    }
+
+    case RTC_UPDATE_INDEX_BUFFER:
+    {
+        const unsigned int ibIdx = GetReplayResource(RES_INDEX_BUFFER, cmd.nResource[0]);
+        if (ibIdx == ~0u || cmd.nArg[0] >= BL_MAX)
+            break;
+
+        IndexBuffer* const ib = resMan->GetIndexBuffer(ibIdx);
+        if (cmd.nArg[1] > ib->GetElementCount() || cmd.nArg[2] > ib->GetElementCount() - cmd.nArg[1])
+            break;
+
+        ib->Lock((BufferLocking)cmd.nArg[0], cmd.nArg[1], cmd.nArg[2]);
+        ib->Update();
+        ib->Unlock();
+        break;
+    }
+
+    case RTC_UPDATE_TEXTURE:
+    {
+        const unsigned int texIdx = GetReplayResource(RES_TEXTURE, cmd.nResource[0]);
+        if (texIdx == ~0u || cmd.nArg[0] >= BL_MAX)
+            break;
+
+        Texture* const tex = resMan->GetTexture(texIdx);
+        if (cmd.nArg[2] >= tex->GetMipCount())
+            break;
+
+        const bool locked = (CubeFace)cmd.nArg[1] == FACE_NONE ?
+            tex->Lock(cmd.nArg[2], (BufferLocking)cmd.nArg[0]) :
+            tex->Lock((CubeFace)cmd.nArg[1], cmd.nArg[2], (BufferLocking)cmd.nArg[0]);
+
+        if (locked)
+        {
+            tex->Update();
+            tex->Unlock();
+        }
+        break;
+    }
+
+    case RTC_DRAW:
+    {
+        const unsigned int vbIdx = GetReplayResource(RES_VERTEX_BUFFER, cmd.nResource[0]);
+        if (vbIdx != ~0u)
+            renderer->DrawVertexBuffer(resMan->GetVertexBuffer(vbIdx), cmd.nArg[0], cmd.nArg[1], cmd.nArg[2], cmd.nArg[3]);
+        break;
+    }
+
+    default:
+        assert(false);
+    }
+}
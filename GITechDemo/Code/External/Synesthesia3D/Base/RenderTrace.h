@@ -0,0 +1,292 @@
+/**
+ * @file        RenderTrace.h
+ *
+ * @note        This file is part of the "Synesthesia3D" graphics engine
+ *
+ * @copyright   Copyright (C) Iftode Bogdan-Marius <iftode.bogdan@gmail.com>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * @copyright
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ * @copyright
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RENDERTRACE_H
+#define RENDERTRACE_H
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "ResourceData.h"
+
+#define S3D_RENDER_TRACE_FILE_VERSION (2)
+#define S3D_RENDER_TRACE_FILE_HEADER "\x89S3DTRC\x0d\x0a\x1a\x0a"
+#define S3D_RENDER_TRACE_FILE_HEADER_SIZE (sizeof(S3D_RENDER_TRACE_FILE_HEADER) - 1)
+
+// Frames that fail to begin during a replay (e.g. on device loss) are retried this many times, this many ms apart
+#define S3D_RENDER_TRACE_REPLAY_MAX_FRAME_RETRIES (100)
+#define S3D_RENDER_TRACE_REPLAY_FRAME_RETRY_DELAY (100)
+
+namespace Synesthesia3D
+{
+    class Renderer;
+    class RenderState;
+    class RenderTarget;
+    class ShaderProgram;
+    class ShaderInput;
+    class VertexBuffer;
+    class IndexBuffer;
+    class Texture;
+
+    /**
+     * @brief   Captures a frame's renderer calls to a compact binary trace and replays them.
+     *
+     * @details A capture records every @ref RenderTraceCommand issued on the rendering thread between
+     *          the next @ref Renderer::BeginFrame() and @ref Renderer::EndFrame(), then writes them to
+     *          a file along with a description of every resource in the @ref ResourceManager.
+     *          Replaying a trace recreates the resources (without their contents) on the current
+     *          render context and issues the recorded commands, timing each of them on the CPU.
+     *
+     * @note    Render states are recorded as whole blocks, when they change before a clear or a draw.
+     *          Sampler states are derived from the textures referenced by the shader inputs, as in
+     *          @ref ShaderProgram::CommitShaderInput(). Buffer and texture contents are not recorded.
+     */
+    class RenderTrace
+    {
+
+    public:
+
+        /**
+         * @brief   Captures the next frame to a trace file.
+         *
+         * @param[in]   filePath    Path of the trace file to write when the frame ends.
+         *
+         * @return  False if a capture is already in progress.
+         */
+                SYNESTHESIA3D_DLL       const bool      RequestCapture(const char* const filePath);
+
+        /**
+         * @brief   Checks whether a capture has been requested or is in progress.
+         */
+                SYNESTHESIA3D_DLL       const bool      IsCapturing() const;
+
+        /**
+         * @brief   Retrieves the path of the last trace file written, or an empty string if the last capture failed.
+         */
+                SYNESTHESIA3D_DLL       const char*     GetLastCaptureFilePath() const;
+
+        /**
+         * @brief   Checks whether calls from the calling thread are currently being recorded.
+         */
+                inline                  const bool      IsRecording() const
+                {
+                    return m_bRecording && m_nSuspendCount == 0 && std::this_thread::get_id() == m_tRecordingThreadId;
+                }
+
+        /**
+         * @brief   Loads a trace file, replacing any previously loaded or captured trace.
+         *
+         * @param[in]   filePath    Path of the trace file.
+         *
+         * @return  Success of operation.
+         */
+                SYNESTHESIA3D_DLL       const bool      Load(const char* const filePath);
+
+        /**
+         * @brief   Replays the loaded trace on the current render context.
+         *
+         * @details Creates the traced resources, issues the traced commands between @ref Renderer::BeginFrame()
+         *          and @ref Renderer::EndFrame() / @ref Renderer::SwapBuffers() for each iteration, then releases
+         *          the resources. Must be called on the rendering thread, outside of a frame.
+         *
+         * @param[in]   iterations  Number of times to replay the trace.
+         * @param[out]  stats       CPU cost of each type of command.
+         *
+         * @return  Success of operation.
+         */
+                SYNESTHESIA3D_DLL       const bool      Replay(const unsigned int iterations, RenderTraceReplayStats& stats);
+
+        /**
+         * @brief   Retrieves the number of commands in the loaded trace.
+         */
+                SYNESTHESIA3D_DLL   const unsigned int  GetCommandCount() const;
+
+    protected:
+
+        /**
+         * @brief   Constructor.
+         *
+         * @details Meant to be used only by @ref Renderer.
+         */
+        RenderTrace();
+
+        /**
+         * @brief   Destructor.
+         *
+         * @details Meant to be used only by @ref Renderer.
+         */
+        ~RenderTrace();
+
+        /**
+         * @brief   Resource pools of the @ref ResourceManager referenced by commands.
+         */
+        enum ResourceType
+        {
+            RES_VERTEX_FORMAT,
+            RES_INDEX_BUFFER,
+            RES_VERTEX_BUFFER,
+            RES_SHADER_PROGRAM,
+            RES_SHADER_INPUT,
+            RES_RENDER_TARGET,
+            RES_TEXTURE,
+
+            RES_MAX
+        };
+
+        /**
+         * @brief   A recorded command, as stored in trace files.
+         */
+        struct Command
+        {
+            unsigned int    eType;          /**< @brief The @ref RenderTraceCommand. */
+            unsigned int    nResource[2];   /**< @brief Resource manager indices of the resources the command operates on. */
+            unsigned int    nArg[4];        /**< @brief Integer arguments. */
+            float           fArg[5];        /**< @brief Floating point arguments. */
+            unsigned int    nPayloadOffset; /**< @brief Offset of the command's variable sized data in the payload. */
+            unsigned int    nPayloadSize;   /**< @brief Size of the command's variable sized data. */
+        };
+
+        /**
+         * @brief   Starts a requested capture.
+         * @note    To be used only by @ref Renderer::BeginFrame().
+         */
+                void    BeginFrame();
+
+        /**
+         * @brief   Finishes the capture in progress and writes it to the trace file.
+         * @note    To be used only by @ref Renderer::EndFrame().
+         */
+                void    EndFrame();
+
+        /**
+         * @brief   Stops recording calls until @ref Resume() (e.g. calls made internally by other recorded calls).
+         */
+                void    Suspend() { m_nSuspendCount++; }
+                void    Resume() { assert(m_nSuspendCount > 0); m_nSuspendCount--; }
+
+        /**
+         * @brief   Recording hooks, to be called only when @ref IsRecording().
+         */
+                void    RecordViewport(const Vec2i size, const Vec2i offset);
+                void    RecordScissor(const Vec2i size, const Vec2i offset);
+                void    RecordClear(const Vec4f rgba, const float z, const unsigned int stencil);
+                void    RecordRenderTarget(const RenderTarget* const renderTarget, const bool enable);
+                void    RecordShaderInput(const ShaderProgram* const shaderProgram, const ShaderInput* const shaderInput, const bool enable);
+                void    RecordShaderProgramDisable(const ShaderProgram* const shaderProgram);
+                void    RecordBufferUpdate(const VertexBuffer* const vertexBuffer, const BufferLocking lockMode, const unsigned int offset, const unsigned int count);
+                void    RecordBufferUpdate(const IndexBuffer* const indexBuffer, const BufferLocking lockMode, const unsigned int offset, const unsigned int count);
+                void    RecordTextureUpdate(const Texture* const texture, const CubeFace cubeFace, const unsigned int mipmapLevel, const BufferLocking lockMode);
+                void    RecordDraw(const VertexBuffer* const vertexBuffer, const unsigned int vtxOffset, const unsigned int primCount, const unsigned int vtxCount, const unsigned int idxOffset);
+
+        /**
+         * @brief   Records the render state blocks which changed since they were last recorded.
+         */
+                void    RecordRenderStates();
+
+        /**
+         * @brief   Adds a command with no resources or arguments, returning it so that they can be filled in.
+         */
+                Command&    AddCommand(const RenderTraceCommand type);
+
+        /**
+         * @brief   Appends data to the payload, returning its offset.
+         */
+        const unsigned int  AddPayload(const void* const data, const unsigned int size);
+
+        /**
+         * @brief   Retrieves the resource manager index of a resource, or ~0u if it's not managed.
+         */
+        const unsigned int  FindResource(const ResourceType type, const void* const resource);
+
+        /**
+         * @brief   Rebuilds the lookup tables used by @ref FindResource().
+         */
+                void    IndexResources();
+
+        /**
+         * @brief   Serializes the descriptions of the resources in the resource manager to @ref m_arrResourceDesc.
+         */
+                void    DescribeResources();
+
+        /**
+         * @brief   Writes the resource descriptions, commands and payload to a trace file.
+         */
+        const bool  Write(const char* const filePath) const;
+
+        /**
+         * @brief   Recreates the resources of the loaded trace, filling in @ref m_arrReplayResource.
+         */
+        const bool  CreateReplayResources();
+
+        /**
+         * @brief   Releases the resources created by @ref CreateReplayResources().
+         */
+                void    ReleaseReplayResources();
+
+        /**
+         * @brief   Retrieves the index of the resource recreated for a traced resource, or ~0u if there is none.
+         */
+        const unsigned int  GetReplayResource(const ResourceType type, const unsigned int tracedIdx) const;
+
+        /**
+         * @brief   Issues a single command of the loaded trace.
+         */
+                void    ReplayCommand(const Command& cmd, const unsigned int cmdIdx);
+
+        std::string     m_szCaptureFilePath;            /**< @brief Path of the requested or in progress capture. */
+        std::string     m_szLastCaptureFilePath;        /**< @brief Path of the last trace file written. */
+        bool            m_bCapturePending;              /**< @brief A capture will start at the next @ref BeginFrame(). */
+        bool            m_bRecording;                   /**< @brief A capture is in progress. */
+        unsigned int    m_nSuspendCount;                /**< @brief Nesting level of @ref Suspend() calls. */
+        unsigned int    m_nRenderTargetDepth;           /**< @brief Number of render targets enabled during the capture and not yet disabled. */
+        std::thread::id m_tRecordingThreadId;           /**< @brief The thread the capture was started on (the rendering thread). */
+
+        std::vector<Command>    m_arrCommand;           /**< @brief Recorded or loaded commands. */
+        std::vector<s3dByte>    m_arrPayload;           /**< @brief Variable sized data of the commands. */
+        std::vector<s3dByte>    m_arrResourceDesc;      /**< @brief Serialized descriptions of the resources in the resource manager at the end of the capture. */
+
+        std::unordered_map<const void*, unsigned int>   m_mapResourceIdx[RES_MAX];   /**< @brief Resource manager indices of the resources, while recording. */
+
+        BlendStateDesc          m_tLastBlendDesc;           /**< @brief Blending states last recorded. */
+        DepthStencilStateDesc   m_tLastDepthStencilDesc;    /**< @brief Depth / stencil states last recorded. */
+        RasterizerStateDesc     m_tLastRasterizerDesc;      /**< @brief Rasterization states last recorded. */
+        bool                    m_bRenderStatesRecorded;    /**< @brief The render states have been recorded at least once during this capture. */
+
+        std::unordered_map<const ShaderInput*, std::vector<s3dByte>>    m_mapShaderInputData;   /**< @brief Shader input data last recorded, to only record modified inputs. */
+
+        std::vector<unsigned int>   m_arrReplayResource[RES_MAX];   /**< @brief Indices of the recreated resources, indexed by the traced indices. */
+        std::vector<unsigned int>   m_arrReplayTexture;             /**< @brief Indices of the recreated textures which aren't owned by render targets. */
+        std::vector<const void*>    m_arrReplayStateBlock;          /**< @brief Render state blocks used by state commands, indexed by command. */
+
+        friend class Renderer;
+        friend class RenderState;
+        friend class RenderTarget;
+        friend class ShaderProgram;
+        friend class VertexBuffer;
+        friend class IndexBuffer;
+        friend class Texture;
+    };
+}
+
+#endif // RENDERTRACE_H
@@ -27,6 +27,12 @@
 #include "RenderState.h"
 #include "SamplerState.h"
 #include "Profiler.h"
+#include "ShaderProgram.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "RenderTrace.h"
+#include "ShaderCache.h"
+#include "Utility/FrameAllocator.h"
 using namespace Synesthesia3D;
 
 #ifdef _WINDOWS
@@ -46,9 +52,13 @@ Renderer::Renderer()
     , m_pRenderStateManager(nullptr)
     , m_pSamplerStateManager(nullptr)
     , m_pProfiler(nullptr)
+    , m_pRenderTrace(new RenderTrace())
+    , m_pShaderCache(new ShaderCache())
+    , m_pFrameAllocator(new FrameAllocator())
     , m_eDeviceState(DS_NOT_READY)
 {
-
+    for (unsigned int i = 0; i < RC_MAX; i++)
+        m_nCounterTotal[i] = 0;
 }
 
 Renderer::~Renderer()
@@ -64,20 +74,33 @@ Renderer::~Renderer()
 
     if (m_pProfiler)
         delete m_pProfiler;
+
+    if (m_pRenderTrace)
+        delete m_pRenderTrace;
+
+    if (m_pShaderCache)
+        delete m_pShaderCache;
+
+    if (m_pFrameAllocator)
+        delete m_pFrameAllocator;
 }
 
-void Renderer::CreateInstance(API api)
+void Renderer::CreateInstance(API api, Allocator* const allocator)
 {
     assert(ms_pInstance == nullptr);
     if (ms_pInstance != nullptr)
         return;
 
+    Allocator::SetCurrent(allocator);
+
     switch (api)
     {
+#ifdef _WINDOWS
         case API_DX9:
             ms_pInstance = new RendererDX9;
             ms_eAPI = API_DX9;
             break;
+#endif
         case API_NULL:
             ms_pInstance = new RendererNULL;
             ms_eAPI = API_NULL;
@@ -95,6 +118,9 @@ void Renderer::DestroyInstance()
         Renderer* tmp = ms_pInstance;
         ms_pInstance = nullptr;
         delete tmp;
+
+        // Memory still allocated is freed through the allocator which allocated it
+        Allocator::SetCurrent(nullptr);
     }
 }
 
@@ -190,25 +216,78 @@ Profiler* const Renderer::GetProfiler() const
     return m_pProfiler;
 }
 
+RenderTrace* const Renderer::GetRenderTrace() const
+{
+    return m_pRenderTrace;
+}
+
+ShaderCache* const Renderer::GetShaderCache() const
+{
+    return m_pShaderCache;
+}
+
+FrameAllocator* const Renderer::GetFrameAllocator() const
+{
+    return m_pFrameAllocator;
+}
+
 const DeviceCaps& Renderer::GetDeviceCaps() const
 {
     return m_tDeviceCaps;
 }
 
+void Renderer::SetViewport(const Vec2i size, const Vec2i offset)
+{
+    if (m_pRenderTrace->IsRecording())
+        m_pRenderTrace->RecordViewport(size, offset);
+}
+
+void Renderer::Clear(const Vec4f rgba, const float z, const unsigned int stencil)
+{
+    if (m_pRenderTrace->IsRecording())
+        m_pRenderTrace->RecordClear(rgba, z, stencil);
+}
+
 void Renderer::DrawVertexBuffer(VertexBuffer* const vb, const unsigned int vtxOffset, const unsigned int primCount, const unsigned int vtxCount, const unsigned int idxOffset)
 {
+    if (m_pRenderTrace->IsRecording())
+        m_pRenderTrace->RecordDraw(vb, vtxOffset, primCount, vtxCount, idxOffset);
+
     GetSamplerStateManager()->Flush();
     GetRenderStateManager()->Flush();
+
+    assert(vb);
+    const unsigned int primitives =
+        primCount > 0 ? primCount :
+        vb->GetIndexBuffer() ? vb->GetIndexBuffer()->GetElementCount() / 3 :
+        vb->GetElementCount() / 3;
+
+    IncrementCounter(RC_DRAW_CALLS);
+    IncrementCounter(RC_PRIMITIVES, primitives);
 }
 
 const bool Renderer::BeginFrame()
 {
+    RenderCounters counters;
+    GetCounterTotals(counters);
+    for (unsigned int i = 0; i < RC_MAX; i++)
+        m_tLastFrameCounters.nCount[i] = counters.nCount[i] - m_tFrameStartCounters.nCount[i];
+    m_tFrameStartCounters = counters;
+
+    if (m_pProfiler)
+        m_pProfiler->ResetCounters();
+
+    m_pRenderTrace->BeginFrame();
+    m_pFrameAllocator->BeginFrame();
+
     SetDeviceState(DS_RENDERING);
     return true;
 }
 
 void Renderer::EndFrame()
 {
+    m_pRenderTrace->EndFrame();
+
     SetDeviceState(DS_PRESENTING);
 }
 
@@ -217,6 +296,17 @@ void Renderer::SwapBuffers()
     SetDeviceState(DS_READY);
 }
 
+const RenderCounters& Renderer::GetFrameCounters() const
+{
+    return m_tLastFrameCounters;
+}
+
+void Renderer::GetCounterTotals(RenderCounters& counters) const
+{
+    for (unsigned int i = 0; i < RC_MAX; i++)
+        counters.nCount[i] = m_nCounterTotal[i].load(std::memory_order_relaxed);
+}
+
 const DeviceState Renderer::GetDeviceState() const
 {
     return m_eDeviceState;
@@ -366,3 +456,119 @@ const char* Renderer::GetEnumString(CubeFace val)
         return "";
     }
 }
+
+const char* Renderer::GetEnumString(RenderCounter val)
+{
+    switch (val)
+    {
+    case RC_DRAW_CALLS:
+        return "Draw calls";
+    case RC_PRIMITIVES:
+        return "Primitives";
+    case RC_RENDER_STATE_CHANGES:
+        return "Render state changes";
+    case RC_STATE_BLOCK_CHANGES:
+        return "State block changes";
+    case RC_FILTERED_STATE_BLOCKS:
+        return "Filtered state blocks";
+    case RC_SAMPLER_STATE_CHANGES:
+        return "Sampler state changes";
+    case RC_FILTERED_SAMPLER_STATE_CHANGES:
+        return "Filtered sampler state changes";
+    case RC_TEXTURE_BINDS:
+        return "Texture binds";
+    case RC_FILTERED_TEXTURE_BINDS:
+        return "Filtered texture binds";
+    case RC_CONSTANT_UPLOADS:
+        return "Constant uploads";
+    case RC_CONSTANT_BYTES:
+        return "Constant bytes";
+    case RC_BUFFER_LOCKS:
+        return "Buffer locks";
+    case RC_RESOURCE_CREATIONS:
+        return "Resource creations";
+    default:
+        assert(false);
+        return "";
+    }
+}
+
+const char* Renderer::GetEnumString(RenderTraceCommand val)
+{
+    switch (val)
+    {
+    case RTC_SET_VIEWPORT:
+        return "SetViewport";
+    case RTC_SET_SCISSOR:
+        return "SetScissor";
+    case RTC_CLEAR:
+        return "Clear";
+    case RTC_SET_BLEND_STATE:
+        return "SetBlendState";
+    case RTC_SET_DEPTH_STENCIL_STATE:
+        return "SetDepthStencilState";
+    case RTC_SET_RASTERIZER_STATE:
+        return "SetRasterizerState";
+    case RTC_ENABLE_RENDER_TARGET:
+        return "RenderTarget::Enable";
+    case RTC_DISABLE_RENDER_TARGET:
+        return "RenderTarget::Disable";
+    case RTC_ENABLE_SHADER_PROGRAM:
+        return "ShaderProgram::Enable";
+    case RTC_COMMIT_SHADER_INPUT:
+        return "ShaderProgram::CommitShaderInput";
+    case RTC_DISABLE_SHADER_PROGRAM:
+        return "ShaderProgram::Disable";
+    case RTC_UPDATE_VERTEX_BUFFER:
+        return "VertexBuffer update";
+    case RTC_UPDATE_INDEX_BUFFER:
+        return "IndexBuffer update";
+    case RTC_UPDATE_TEXTURE:
+        return "Texture update";
+    case RTC_DRAW:
+        return "DrawVertexBuffer";
+    default:
+        assert(false);
+        return "";
+    }
+}
+
+const char* Renderer::GetEnumString(ResourceLoadPhase val)
+{
+    switch (val)
+    {
+    case RLP_IO:
+        return "I/O";
+    case RLP_DECOMPRESSION:
+        return "Decompression";
+    case RLP_DESERIALIZATION:
+        return "Deserialization";
+    case RLP_SHADER_COMPILATION:
+        return "Shader compilation";
+    case RLP_GPU_UPLOAD:
+        return "GPU upload";
+    default:
+        assert(false);
+        return "";
+    }
+}
+
+const char* Renderer::GetEnumString(MemoryResourceType val)
+{
+    switch (val)
+    {
+    case MRT_VERTEX_BUFFER:
+        return "Vertex buffers";
+    case MRT_INDEX_BUFFER:
+        return "Index buffers";
+    case MRT_SHADER_INPUT:
+        return "Shader inputs";
+    case MRT_TEXTURE:
+        return "Textures";
+    case MRT_RENDER_TARGET:
+        return "Render targets";
+    default:
+        assert(false);
+        return "";
+    }
+}
@@ -23,13 +23,19 @@
 #ifndef RENDERER_H
 #define RENDERER_H
 
+#include <atomic>
+
 #include "ResourceData.h"
 
 namespace Synesthesia3D
 {
+    class ResourceManager;
     class RenderState;
     class SamplerState;
     class Profiler;
+    class RenderTrace;
+    class ShaderCache;
+    class FrameAllocator;
 
     /**
      * @brief   Render context interface.
@@ -50,14 +56,17 @@ namespace Synesthesia3D
          * @brief   Creates a rendering context based on API of choice.
          * @see     Initialize()
          *
-         * @param[in]   api     Underlying rendering API to be used.
+         * @param[in]   api         Underlying rendering API to be used.
+         * @param[in]   allocator   Allocator through which the engine allocates memory, until @ref DestroyInstance()
+         *                          (nullptr to allocate from the heap). It must outlive the memory it allocates.
+         *                          See @ref Allocator.
          *
          * @note    At the moment, only one rendering context can be created,
          *          allowing a single thread to issue rendering commands.
          *
          * @todo    Add support for multiple rendering contexts for multithreaded rendering.
          */
-        static  SYNESTHESIA3D_DLL           void        CreateInstance(API api);
+        static  SYNESTHESIA3D_DLL           void        CreateInstance(API api, Allocator* const allocator = nullptr);
 
         /**
          * @brief   Destroys the current rendering context.
@@ -160,7 +169,7 @@ namespace Synesthesia3D
          * @note    This function differs from @ref SetDisplayResolution() since the viewport transformation is
          *          applied when the geometry in clip space is converted to pixel coordinates (screen space).
          */
-        virtual SYNESTHESIA3D_DLL           void        SetViewport(const Vec2i size, const Vec2i offset = Vec2i(0, 0)) PURE_VIRTUAL;
+        virtual SYNESTHESIA3D_DLL           void        SetViewport(const Vec2i size, const Vec2i offset = Vec2i(0, 0));
 
         /**
          * @brief   Creates a perspective projection matrix fit for the current platform standards.
@@ -246,7 +255,7 @@ namespace Synesthesia3D
          * @param[in]   z           Value for clearing depth buffer.
          * @param[in]   stencil     Value for clearing stencil buffer.
          */
-        virtual SYNESTHESIA3D_DLL           void        Clear(const Vec4f rgba, const float z, const unsigned int stencil) PURE_VIRTUAL;
+        virtual SYNESTHESIA3D_DLL           void        Clear(const Vec4f rgba, const float z, const unsigned int stencil);
 
         /**
          * @brief   Renders the specified vertex buffer - index buffer pair.
@@ -281,11 +290,33 @@ namespace Synesthesia3D
          */
                 SYNESTHESIA3D_DLL   Profiler* const         GetProfiler() const;
 
+        /**
+         * @brief   Retrieves a pointer to the render trace, which allows for capturing frames to be replayed later.
+         */
+                SYNESTHESIA3D_DLL   RenderTrace* const      GetRenderTrace() const;
+
+        /**
+         * @brief   Retrieves a pointer to the persistent cache of compiled shader programs.
+         */
+                SYNESTHESIA3D_DLL   ShaderCache* const      GetShaderCache() const;
+
+        /**
+         * @brief   Retrieves a pointer to the allocator of transient memory, valid until the end of the next frame.
+         */
+                SYNESTHESIA3D_DLL   FrameAllocator* const   GetFrameAllocator() const;
+
         /**
          * @brief   Retrieves the device's capabilities.
          */
                 SYNESTHESIA3D_DLL   const DeviceCaps&       GetDeviceCaps() const;
 
+        /**
+         * @brief   Retrieves the render counters of the last completed frame.
+         *
+         * @note    Counters of individual profile marker scopes are available through @ref Profiler::RetrieveProfileMarkerCounters().
+         */
+                SYNESTHESIA3D_DLL   const RenderCounters&   GetFrameCounters() const;
+
                 SYNESTHESIA3D_DLL   const DeviceState       GetDeviceState() const;
                 SYNESTHESIA3D_DLL           void            SetDeviceState(const DeviceState deviceState);
 
@@ -297,6 +328,10 @@ namespace Synesthesia3D
                 SYNESTHESIA3D_DLL   static const char*      GetEnumString(SamplerFilter val);
                 SYNESTHESIA3D_DLL   static const char*      GetEnumString(SamplerAddressingMode val);
                 SYNESTHESIA3D_DLL   static const char*      GetEnumString(CubeFace val);
+                SYNESTHESIA3D_DLL   static const char*      GetEnumString(RenderCounter val);
+                SYNESTHESIA3D_DLL   static const char*      GetEnumString(RenderTraceCommand val);
+                SYNESTHESIA3D_DLL   static const char*      GetEnumString(ResourceLoadPhase val);
+                SYNESTHESIA3D_DLL   static const char*      GetEnumString(MemoryResourceType val);
 
     protected:
 
@@ -314,16 +349,50 @@ namespace Synesthesia3D
          */
         virtual ~Renderer();
 
+        /**
+         * @brief   Adds to a render counter.
+         *
+         * @details Meant to be used by the base classes, so that every backend reports the same counters.
+         *          Safe to call from any thread (e.g. resource loading threads).
+         */
+        static  inline              void        IncrementCounter(const RenderCounter counter, const unsigned int value = 1u)
+        {
+            if (ms_pInstance)
+                ms_pInstance->m_nCounterTotal[counter].fetch_add(value, std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief   Retrieves the render counters accumulated since the renderer was created.
+         *
+         * @note    Counters wrap around, so only differences between two retrieved values are meaningful.
+         */
+                                    void        GetCounterTotals(RenderCounters& counters) const;
+
                 Vec2i           m_vBackBufferOffset;        /**< @brief The backbuffer offset in pixels. */
             ResourceManager*    m_pResourceManager;         /**< @brief Pointer to the resource manage.r */
             RenderState*        m_pRenderStateManager;      /**< @brief Pointer to the render state manager. */
             SamplerState*       m_pSamplerStateManager;     /**< @brief Pointer to the texture sampler state manager. */
             Profiler*           m_pProfiler;                /**< @brief Pointer to the profiler instance. */
+            RenderTrace*        m_pRenderTrace;             /**< @brief Pointer to the render trace instance. */
+            ShaderCache*        m_pShaderCache;             /**< @brief Pointer to the shader cache instance. */
+            FrameAllocator*     m_pFrameAllocator;          /**< @brief Pointer to the per-frame allocator instance. */
             DeviceCaps          m_tDeviceCaps;              /**< @brief Structure describing device capabilities. */
             DeviceState         m_eDeviceState;             /**< @brief Current device state. @see DeviceState */
+            RenderCounters      m_tFrameStartCounters;      /**< @brief Render counter totals at the beginning of the current frame. */
+            RenderCounters      m_tLastFrameCounters;       /**< @brief Render counters of the last completed frame. */
+    std::atomic<unsigned int>   m_nCounterTotal[RC_MAX];    /**< @brief Render counters accumulated since the renderer was created. */
 
         static  Renderer*       ms_pInstance;               /**< @brief Holds the current instance of the rendering class. */
         static  API             ms_eAPI;                    /**< @brief Holds the currently instanced rendering API. */
+
+        friend class ResourceManager;
+        friend class RenderState;
+        friend class SamplerState;
+        friend class ShaderProgram;
+        friend class VertexBuffer;
+        friend class IndexBuffer;
+        friend class Texture;
+        friend class Profiler;
     };
 }
 
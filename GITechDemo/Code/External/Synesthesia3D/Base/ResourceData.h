@@ -33,6 +33,8 @@
 
 #include <string>
 #include <vector>
+#include <map>
+#include <climits>
 #include <gmtl/gmtl.h>
 using namespace gmtl;
 
@@ -43,6 +45,7 @@ using namespace gmtl;
     #define PURE_VIRTUAL = 0    /**< @brief Used to mark pure virtual functions. */
 #endif
 
+#include "Utility/Allocator.h"
 #include "Utility/Debug.h"
 #include "Utility/HalfFloat.h"
 
@@ -126,6 +129,9 @@ namespace Synesthesia3D
         BL_WRITE_ONLY,  /**< @brief The application will ONLY write to the buffer. */
         BL_READ_WRITE,  /**< @brief The application will both read and write to the buffer. */
 
+        BL_WRITE_DISCARD,       /**< @brief The application will overwrite the buffer, whose previous contents may still be in use by the GPU, which keeps reading them from another memory block. Only for @ref BU_DYNAMIC vertex/index buffers. */
+        BL_WRITE_NO_OVERWRITE,  /**< @brief The application will only write to a range of the buffer which the GPU does not use, so it does not need to wait for it. Only for @ref BU_DYNAMIC vertex/index buffers. */
+
         BL_MAX          /**< @brief DO NOT USE! INTERNAL USAGE ONLY! */
     };
 
@@ -258,6 +264,138 @@ namespace Synesthesia3D
         RS_MAX = FILL_MAX + 1   /**< @brief DO NOT USE! INTERNAL USAGE ONLY! */
     };
 
+    /**
+     * @brief   A structure that describes the color blending and writing states.
+     * @note    Defaults to the values set by @ref RenderState::Reset().
+     */
+    struct BlendStateDesc
+    {
+        bool            bColorBlendEnabled;     /**< @brief Color blending state. */
+        Blend           eColorSrcBlend;         /**< @brief Source color blending operation. */
+        Blend           eColorDstBlend;         /**< @brief Destination color blending operation. */
+        Vec4f           vColorBlendFactor;      /**< @brief Color blending factor. */
+        bool            bAlphaTestEnabled;      /**< @brief Alpha testing state. */
+        Cmp             eAlphaFunc;             /**< @brief Alpha testing comparison function. */
+        float           fAlphaRef;              /**< @brief Alpha testing reference value. */
+        bool            bColorWriteRed;         /**< @brief Color writing on red channel. */
+        bool            bColorWriteGreen;       /**< @brief Color writing on green channel. */
+        bool            bColorWriteBlue;        /**< @brief Color writing on blue channel. */
+        bool            bColorWriteAlpha;       /**< @brief Color writing on alpha channel. */
+        bool            bSRGBWriteEnabled;      /**< @brief sRGB writing state. */
+
+        BlendStateDesc()
+            : bColorBlendEnabled(false)
+            , eColorSrcBlend(BLEND_ONE)
+            , eColorDstBlend(BLEND_ZERO)
+            , vColorBlendFactor(1.f, 1.f, 1.f, 1.f)
+            , bAlphaTestEnabled(false)
+            , eAlphaFunc(CMP_ALWAYS)
+            , fAlphaRef(0.f)
+            , bColorWriteRed(true)
+            , bColorWriteGreen(true)
+            , bColorWriteBlue(true)
+            , bColorWriteAlpha(true)
+            , bSRGBWriteEnabled(false)
+        {}
+
+        const bool operator==(const BlendStateDesc& other) const
+        {
+            return
+                bColorBlendEnabled == other.bColorBlendEnabled &&
+                eColorSrcBlend == other.eColorSrcBlend &&
+                eColorDstBlend == other.eColorDstBlend &&
+                vColorBlendFactor == other.vColorBlendFactor &&
+                bAlphaTestEnabled == other.bAlphaTestEnabled &&
+                eAlphaFunc == other.eAlphaFunc &&
+                fAlphaRef == other.fAlphaRef &&
+                bColorWriteRed == other.bColorWriteRed &&
+                bColorWriteGreen == other.bColorWriteGreen &&
+                bColorWriteBlue == other.bColorWriteBlue &&
+                bColorWriteAlpha == other.bColorWriteAlpha &&
+                bSRGBWriteEnabled == other.bSRGBWriteEnabled;
+        }
+    };
+
+    /**
+     * @brief   A structure that describes the depth and stencil buffering states.
+     * @note    Defaults to the values set by @ref RenderState::Reset().
+     */
+    struct DepthStencilStateDesc
+    {
+        ZBuffer         eZEnabled;              /**< @brief Z buffering state. */
+        Cmp             eZFunc;                 /**< @brief Depth comparison function. */
+        bool            bZWriteEnabled;         /**< @brief Depth writing state. */
+        bool            bStencilEnabled;        /**< @brief Stencil buffering state. */
+        Cmp             eStencilFunc;           /**< @brief Stencil comparison function. */
+        unsigned long   lStencilRef;            /**< @brief Stencil reference value. */
+        unsigned long   lStencilMask;           /**< @brief Stencil mask. */
+        unsigned long   lStencilWriteMask;      /**< @brief Stencil write mask. */
+        StencilOp       eStencilFail;           /**< @brief Stencil fail operation. */
+        StencilOp       eStencilZFail;          /**< @brief Stencil pass / depth fail operation. */
+        StencilOp       eStencilPass;           /**< @brief Stencil pass operation. */
+
+        DepthStencilStateDesc()
+            : eZEnabled(ZB_ENABLED)
+            , eZFunc(CMP_LESSEQUAL)
+            , bZWriteEnabled(true)
+            , bStencilEnabled(false)
+            , eStencilFunc(CMP_ALWAYS)
+            , lStencilRef(0)
+            , lStencilMask(ULONG_MAX)
+            , lStencilWriteMask(ULONG_MAX)
+            , eStencilFail(STENCILOP_KEEP)
+            , eStencilZFail(STENCILOP_KEEP)
+            , eStencilPass(STENCILOP_KEEP)
+        {}
+
+        const bool operator==(const DepthStencilStateDesc& other) const
+        {
+            return
+                eZEnabled == other.eZEnabled &&
+                eZFunc == other.eZFunc &&
+                bZWriteEnabled == other.bZWriteEnabled &&
+                bStencilEnabled == other.bStencilEnabled &&
+                eStencilFunc == other.eStencilFunc &&
+                lStencilRef == other.lStencilRef &&
+                lStencilMask == other.lStencilMask &&
+                lStencilWriteMask == other.lStencilWriteMask &&
+                eStencilFail == other.eStencilFail &&
+                eStencilZFail == other.eStencilZFail &&
+                eStencilPass == other.eStencilPass;
+        }
+    };
+
+    /**
+     * @brief   A structure that describes the rasterization states.
+     * @note    Defaults to the values set by @ref RenderState::Reset().
+     */
+    struct RasterizerStateDesc
+    {
+        Cull            eCullMode;              /**< @brief Culling mode. */
+        Fill            eFillMode;              /**< @brief Triangle rasterization fill mode. */
+        float           fSlopeScaledDepthBias;  /**< @brief Slope scaled depth bias value. */
+        float           fDepthBias;             /**< @brief Depth bias value. */
+        bool            bScissorEnabled;        /**< @brief Scissor state. */
+
+        RasterizerStateDesc()
+            : eCullMode(CULL_CCW)
+            , eFillMode(FILL_SOLID)
+            , fSlopeScaledDepthBias(0.f)
+            , fDepthBias(0.f)
+            , bScissorEnabled(false)
+        {}
+
+        const bool operator==(const RasterizerStateDesc& other) const
+        {
+            return
+                eCullMode == other.eCullMode &&
+                eFillMode == other.eFillMode &&
+                fSlopeScaledDepthBias == other.fSlopeScaledDepthBias &&
+                fDepthBias == other.fDepthBias &&
+                bScissorEnabled == other.bScissorEnabled;
+        }
+    };
+
     ///////////////////////////////////////////////////////////
 
     // SAMPLER STATES /////////////////////////////////////////
@@ -407,7 +545,7 @@ namespace Synesthesia3D
 
     #define S3D_TEXTURE_FILE_VERSION (1)
     #define S3D_TEXTURE_FILE_HEADER "\x89S3DTEX\x0d\x0a\x1a\x0a"
-    #define S3D_TEXTURE_FILE_HEADER_SIZE (ARRAYSIZE(S3D_TEXTURE_FILE_HEADER) - 1)
+    #define S3D_TEXTURE_FILE_HEADER_SIZE (sizeof(S3D_TEXTURE_FILE_HEADER) - 1)
 
     /**
      * @brief   Specifies the format of the pixel.
@@ -576,17 +714,23 @@ namespace Synesthesia3D
 
     #define S3D_MODEL_FILE_VERSION (1)
     #define S3D_MODEL_FILE_HEADER "\x89S3DMDL\x0d\x0a\x1a\x0a"
-    #define S3D_MODEL_FILE_HEADER_SIZE (ARRAYSIZE(S3D_MODEL_FILE_HEADER) - 1)
+    #define S3D_MODEL_FILE_HEADER_SIZE (sizeof(S3D_MODEL_FILE_HEADER) - 1)
 
     class VertexFormat;
     class VertexBuffer;
     class IndexBuffer;
+    class LinearAllocator;
 
     /**
      * @brief   A structure describind a model and its meshes.
+     *
+     * @note    When deserialized, the meshes, materials, texture descriptions and the data of the meshes'
+     *          buffers are allocated from the model's own @ref LinearAllocator and freed all at once with the model.
      */
     struct Model
     {
+        S3D_ALLOCATION_TAG(AT_RESOURCES)
+
         // Forward declarations
         struct Mesh;
         struct Material;
@@ -622,8 +766,11 @@ namespace Synesthesia3D
             friend std::istream& operator>>(std::istream& s_in, Model& model_out);
 
         private:
-            Mesh() {}
+            Mesh() : pAllocator(nullptr) {}
             ~Mesh();
+
+            LinearAllocator* pAllocator;    /**< The allocator of the model, if deserialized, for the data of the mesh's buffers. */
+
             friend struct Model;
             friend class Synesthesia3DTools::ModelCompiler;
         };
@@ -796,8 +943,11 @@ namespace Synesthesia3D
             friend std::istream& operator>>(std::istream& s_in, Model& model_out);
 
         private:
-            Material() {}
+            Material() : pAllocator(nullptr) {}
             ~Material();
+
+            LinearAllocator* pAllocator;    /**< The allocator of the model, if deserialized, for the texture descriptions. */
+
             friend struct Model;
             friend class Synesthesia3DTools::ModelCompiler;
         };
@@ -808,6 +958,8 @@ namespace Synesthesia3D
 
         std::string             szSourceFile;   /**< File from which model was loaded. */
 
+        LinearAllocator*        pAllocator;     /**< Allocator for the model's data, if deserialized. */
+
         /**
          * @brief   Serializes a model object.
          */
@@ -819,7 +971,7 @@ namespace Synesthesia3D
         friend std::istream& operator>>(std::istream& s_in, Model& model_out);
 
         private:
-            Model() {}
+            Model() : pAllocator(nullptr) {}
             SYNESTHESIA3D_DLL ~Model();
             friend class ResourceManager;
             friend class Synesthesia3DTools::ModelCompiler;
@@ -883,6 +1035,293 @@ namespace Synesthesia3D
     };
 
     //////////////////////////////////////////////////////////////////
+
+    // RENDER COUNTERS ///////////////////////////////////////////////
+
+    /**
+     * @brief   Work issued by the renderer, counted per frame and per profile marker scope.
+     *
+     * @see     Renderer::GetFrameCounters() @see Profiler::RetrieveProfileMarkerCounters()
+     */
+    enum RenderCounter
+    {
+        RC_DRAW_CALLS,                      /**< @brief Calls to @ref Renderer::DrawVertexBuffer(). */
+        RC_PRIMITIVES,                      /**< @brief Primitives drawn. */
+        RC_RENDER_STATE_CHANGES,            /**< @brief Render states changed, individually or through a state block (redundant ones are filtered). */
+        RC_STATE_BLOCK_CHANGES,             /**< @brief Render state blocks applied. */
+        RC_FILTERED_STATE_BLOCKS,           /**< @brief Redundant render state blocks filtered. */
+        RC_SAMPLER_STATE_CHANGES,           /**< @brief Sampler states applied (redundant ones are filtered). */
+        RC_FILTERED_SAMPLER_STATE_CHANGES,  /**< @brief Redundant sampler state changes filtered. */
+        RC_TEXTURE_BINDS,                   /**< @brief Textures bound (redundant bindings are filtered). */
+        RC_FILTERED_TEXTURE_BINDS,          /**< @brief Redundant texture bindings filtered. */
+        RC_CONSTANT_UPLOADS,                /**< @brief Uploads of contiguous shader constant register ranges. */
+        RC_CONSTANT_BYTES,                  /**< @brief Bytes of shader constants uploaded. */
+        RC_BUFFER_LOCKS,                    /**< @brief Vertex buffers, index buffers and texture mips locked. */
+        RC_RESOURCE_CREATIONS,              /**< @brief Resources added to the resource manager. */
+
+        RC_MAX                              /**< @brief DO NOT USE! INTERNAL USAGE ONLY! */
+    };
+
+    /**
+     * @brief   A set of render counters.
+     */
+    struct RenderCounters
+    {
+        unsigned int nCount[RC_MAX];    /**< @brief The value of each counter, indexed by @ref RenderCounter. */
+
+        RenderCounters() { Reset(); }
+
+        void Reset()
+        {
+            for (unsigned int i = 0; i < RC_MAX; i++)
+                nCount[i] = 0;
+        }
+
+        const unsigned int operator[](const RenderCounter counter) const { return nCount[counter]; }
+    };
+
+    //////////////////////////////////////////////////////////////////
+
+    // RENDER TRACES /////////////////////////////////////////////////
+
+    /**
+     * @brief   Renderer calls recorded in a render trace.
+     *
+     * @see     RenderTrace
+     */
+    enum RenderTraceCommand
+    {
+        RTC_SET_VIEWPORT,               /**< @brief @ref Renderer::SetViewport(). */
+        RTC_SET_SCISSOR,                /**< @brief @ref RenderState::SetScissor(). */
+        RTC_CLEAR,                      /**< @brief @ref Renderer::Clear(). */
+        RTC_SET_BLEND_STATE,            /**< @brief Blending states, recorded when they change before a clear or a draw. */
+        RTC_SET_DEPTH_STENCIL_STATE,    /**< @brief Depth / stencil states, recorded when they change before a clear or a draw. */
+        RTC_SET_RASTERIZER_STATE,       /**< @brief Rasterization states, recorded when they change before a clear or a draw. */
+        RTC_ENABLE_RENDER_TARGET,       /**< @brief @ref RenderTarget::Enable(). */
+        RTC_DISABLE_RENDER_TARGET,      /**< @brief @ref RenderTarget::Disable(). */
+        RTC_ENABLE_SHADER_PROGRAM,      /**< @brief @ref ShaderProgram::Enable(), along with the modified shader inputs. */
+        RTC_COMMIT_SHADER_INPUT,        /**< @brief @ref ShaderProgram::CommitShaderInput() on an enabled program, along with the modified shader inputs. */
+        RTC_DISABLE_SHADER_PROGRAM,     /**< @brief @ref ShaderProgram::Disable(). */
+        RTC_UPDATE_VERTEX_BUFFER,       /**< @brief @ref VertexBuffer::Lock(), replayed as a lock, update and unlock. */
+        RTC_UPDATE_INDEX_BUFFER,        /**< @brief @ref IndexBuffer::Lock(), replayed as a lock, update and unlock. */
+        RTC_UPDATE_TEXTURE,             /**< @brief @ref Texture::Lock(), replayed as a lock, update and unlock. */
+        RTC_DRAW,                       /**< @brief @ref Renderer::DrawVertexBuffer(). */
+
+        RTC_MAX                         /**< @brief DO NOT USE! INTERNAL USAGE ONLY! */
+    };
+
+    /**
+     * @brief   CPU cost of replaying a render trace.
+     *
+     * @see     RenderTrace::Replay()
+     */
+    struct RenderTraceReplayStats
+    {
+        unsigned int    nIterationCount;            /**< @brief Number of times the trace was replayed. */
+        unsigned int    nCommandCount[RTC_MAX];     /**< @brief Number of commands of each type in a single replay of the trace. */
+        long long       nCommandTime[RTC_MAX];      /**< @brief Time spent in the commands of each type over all iterations, in nanoseconds. */
+        long long       nFrameTime;                 /**< @brief Time spent replaying all iterations, including frame begin / end, in nanoseconds. */
+        long long       nTimerOverhead;             /**< @brief Measured cost of timing a single command, subtracted from @ref nCommandTime, in nanoseconds. */
+
+        RenderTraceReplayStats() { Reset(); }
+
+        void Reset()
+        {
+            nIterationCount = 0;
+            for (unsigned int i = 0; i < RTC_MAX; i++)
+            {
+                nCommandCount[i] = 0;
+                nCommandTime[i] = 0;
+            }
+            nFrameTime = 0;
+            nTimerOverhead = 0;
+        }
+    };
+
+    //////////////////////////////////////////////////////////////////
+
+    // RESOURCE LOAD TIMINGS /////////////////////////////////////////
+
+    /**
+     * @brief   Phases of loading a resource from a file.
+     *
+     * @see     ResourceManager::GetThreadLoadTimings()
+     */
+    enum ResourceLoadPhase
+    {
+        RLP_IO,                     /**< @brief Opening and reading resource files. */
+        RLP_DECOMPRESSION,          /**< @brief Decompressing the contents of resource files. */
+        RLP_DESERIALIZATION,        /**< @brief Reading resources from decompressed data. */
+        RLP_SHADER_COMPILATION,     /**< @brief Compiling shader programs, including reading their source files. */
+        RLP_GPU_UPLOAD,             /**< @brief Creating device resources and copying data to them. */
+
+        RLP_MAX                     /**< @brief DO NOT USE! INTERNAL USAGE ONLY! */
+    };
+
+    /**
+     * @brief   Time spent in each phase of loading resources.
+     */
+    struct ResourceLoadTimings
+    {
+        long long           nTime[RLP_MAX];     /**< @brief Time spent in each @ref ResourceLoadPhase, in nanoseconds. */
+        unsigned long long  nBytesRead;         /**< @brief Bytes read from resource files (excluding shader sources). */
+
+        ResourceLoadTimings() { Reset(); }
+
+        void Reset()
+        {
+            for (unsigned int i = 0; i < RLP_MAX; i++)
+                nTime[i] = 0;
+            nBytesRead = 0;
+        }
+    };
+
+    //////////////////////////////////////////////////////////////////
+
+    // MEMORY ACCOUNTING /////////////////////////////////////////////
+
+    /**
+     * @brief   Kinds of resources whose memory is accounted for.
+     *
+     * @see     ResourceManager::RetrieveMemorySnapshot()
+     */
+    enum MemoryResourceType
+    {
+        MRT_VERTEX_BUFFER,  /**< @brief Vertex buffers. */
+        MRT_INDEX_BUFFER,   /**< @brief Index buffers. */
+        MRT_SHADER_INPUT,   /**< @brief Shader constant data (CPU only). */
+        MRT_TEXTURE,        /**< @brief Textures, excluding the ones owned by render targets. */
+        MRT_RENDER_TARGET,  /**< @brief Color and depth-stencil textures of render targets. */
+
+        MRT_MAX             /**< @brief DO NOT USE! INTERNAL USAGE ONLY! */
+    };
+
+    /**
+     * @brief   Memory used by a set of resources.
+     *
+     * @note    Values are signed so that they can hold the difference between two snapshots.
+     */
+    struct MemoryUsage
+    {
+        int         nCount;     /**< @brief Number of resources. */
+        long long   nCPUBytes;  /**< @brief Bytes of CPU side copies of the resources' data. */
+        long long   nGPUBytes;  /**< @brief Estimated bytes of device memory (all mips and faces of textures, excluding driver overhead). */
+
+        MemoryUsage() { Reset(); }
+
+        void Reset()
+        {
+            nCount = 0;
+            nCPUBytes = 0;
+            nGPUBytes = 0;
+        }
+
+        MemoryUsage& operator+=(const MemoryUsage& usage)
+        {
+            nCount += usage.nCount;
+            nCPUBytes += usage.nCPUBytes;
+            nGPUBytes += usage.nGPUBytes;
+            return *this;
+        }
+
+        MemoryUsage& operator-=(const MemoryUsage& usage)
+        {
+            nCount -= usage.nCount;
+            nCPUBytes -= usage.nCPUBytes;
+            nGPUBytes -= usage.nGPUBytes;
+            return *this;
+        }
+
+        const bool IsEmpty() const { return nCount == 0 && nCPUBytes == 0 && nGPUBytes == 0; }
+    };
+
+    /**
+     * @brief   Memory used by the resources of the resource manager, aggregated by type, source file and owner.
+     *
+     * @see     ResourceManager::RetrieveMemorySnapshot() @see ResourceManager::PushMemoryOwner()
+     */
+    struct MemorySnapshot
+    {
+        MemoryUsage                         tTotal;                 /**< @brief All accounted resources. */
+        MemoryUsage                         tType[MRT_MAX];         /**< @brief Resources of each @ref MemoryResourceType. */
+        std::map<std::string, MemoryUsage>  mapSourceFile;          /**< @brief Resources by the file they were loaded from (empty for resources created at runtime). */
+        std::map<std::string, MemoryUsage>  mapOwner;               /**< @brief Resources by the owner they were created under (empty for resources created outside of any owner scope). */
+        int                                 nCreationCount[MRT_MAX];    /**< @brief Resources of each type created since the resource manager was initialized. */
+        int                                 nReleaseCount[MRT_MAX];     /**< @brief Resources of each type released since the resource manager was initialized. */
+
+        MemorySnapshot() { Reset(); }
+
+        void Reset()
+        {
+            tTotal.Reset();
+            for (unsigned int i = 0; i < MRT_MAX; i++)
+            {
+                tType[i].Reset();
+                nCreationCount[i] = 0;
+                nReleaseCount[i] = 0;
+            }
+            mapSourceFile.clear();
+            mapOwner.clear();
+        }
+
+        /**
+         * @brief   Computes what changed since an earlier snapshot. Source files and owners whose usage didn't change are left out.
+         */
+        void Diff(const MemorySnapshot& base, MemorySnapshot& diff) const
+        {
+            diff = *this;
+
+            diff.tTotal -= base.tTotal;
+            for (unsigned int i = 0; i < MRT_MAX; i++)
+            {
+                diff.tType[i] -= base.tType[i];
+                diff.nCreationCount[i] -= base.nCreationCount[i];
+                diff.nReleaseCount[i] -= base.nReleaseCount[i];
+            }
+
+            for (std::map<std::string, MemoryUsage>::const_iterator iter = base.mapSourceFile.begin(); iter != base.mapSourceFile.end(); iter++)
+                if ((diff.mapSourceFile[iter->first] -= iter->second).IsEmpty())
+                    diff.mapSourceFile.erase(iter->first);
+
+            for (std::map<std::string, MemoryUsage>::const_iterator iter = base.mapOwner.begin(); iter != base.mapOwner.end(); iter++)
+                if ((diff.mapOwner[iter->first] -= iter->second).IsEmpty())
+                    diff.mapOwner.erase(iter->first);
+        }
+    };
+
+    //////////////////////////////////////////////////////////////////
+
+    // ASSET PACKS ///////////////////////////////////////////////////
+
+    /**
+     * @brief   Compression applied to the entries of an asset pack.
+     *
+     * @see     AssetPack
+     */
+    enum AssetPackCodec
+    {
+        APC_NONE,   /**< @brief Stored as is. */
+        APC_LZ4,    /**< @brief Compressed with LZ4. */
+
+        APC_MAX     /**< @brief DO NOT USE! INTERNAL USAGE ONLY! */
+    };
+
+    /**
+     * @brief   Table of contents entry of an asset pack.
+     *
+     * @see     AssetPack
+     */
+    struct AssetPackEntry
+    {
+        unsigned long long  nPathHash;          /**< @brief Hash of the entry's normalized path (see @ref AssetPack::HashPath()). */
+        unsigned long long  nOffset;            /**< @brief Offset of the entry's data from the start of the pack. */
+        unsigned int        nSize;              /**< @brief Size of the entry's data in the pack. */
+        unsigned int        nUncompressedSize;  /**< @brief Size of the entry's data once decompressed. */
+        AssetPackCodec      eCodec;             /**< @brief Compression applied to the entry's data. */
+        unsigned long long  nContentHash;       /**< @brief Hash of the entry's uncompressed data (see @ref AssetPack::HashContents()), for finding identical assets under different paths. */
+    };
+
+    //////////////////////////////////////////////////////////////////
 }
 
 #endif // RESOURCEDATA_H
\ No newline at end of file
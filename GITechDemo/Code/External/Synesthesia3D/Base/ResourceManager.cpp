@@ -29,14 +29,18 @@
 #include "ShaderProgram.h"
 #include "Texture.h"
 #include "RenderTarget.h"
+#include "SamplerState.h"
 #include "Renderer.h"
 #include "ResourceManager.h"
 #include "Profiler.h"
+#include "AssetPack.h"
 using namespace Synesthesia3D;
 
 #include <fstream>
+#include <stdarg.h>
 
 #include <Utility/Mutex.h>
+#include <Utility/LinearAllocator.h>
 
 #include <lz4/lz4hc.h>
 
@@ -50,6 +54,8 @@ MUTEX   TexMutex;
 MUTEX   RTMutex;
 MUTEX   ModelMutex;
 
+std::vector<AssetPack*> ResourceManager::ms_arrAssetPack;
+
 struct membuf : std::streambuf {
     membuf(char const* base, size_t size) {
         char* p(const_cast<char*>(base));
@@ -64,6 +70,39 @@ struct imemstream : virtual membuf, std::istream {
     }
 };
 
+// Memory owner and source file that the resources created on a thread are attributed to
+struct MemoryTags
+{
+    std::vector<std::string>    arrOwner;
+    std::string                 szSourceFile;
+};
+
+static MemoryTags& GetThreadMemoryTags()
+{
+    static thread_local MemoryTags memoryTags;
+    return memoryTags;
+}
+
+// Attributes the resources created while loading a file to that file
+struct MemorySourceFileScope
+{
+    MemorySourceFileScope(const char* const sourceFile) { GetThreadMemoryTags().szSourceFile = sourceFile; }
+    ~MemorySourceFileScope() { GetThreadMemoryTags().szSourceFile.clear(); }
+};
+
+static void AccountMemory(MemorySnapshot& snapshot, const MemoryResourceType type, const std::string& sourceFile, const std::string& owner, const long long cpuBytes, const long long gpuBytes)
+{
+    MemoryUsage usage;
+    usage.nCount = 1;
+    usage.nCPUBytes = cpuBytes;
+    usage.nGPUBytes = gpuBytes;
+
+    snapshot.tTotal += usage;
+    snapshot.tType[type] += usage;
+    snapshot.mapSourceFile[sourceFile] += usage;
+    snapshot.mapOwner[owner] += usage;
+}
+
 ResourceManager::ResourceManager()
 {
     MUTEX_INIT(VFMutex);
@@ -74,6 +113,12 @@ ResourceManager::ResourceManager()
     MUTEX_INIT(TexMutex);
     MUTEX_INIT(RTMutex);
     MUTEX_INIT(ModelMutex);
+
+    for (unsigned int i = 0; i < MRT_MAX; i++)
+    {
+        m_nMemoryCreationCount[i] = 0;
+        m_nMemoryReleaseCount[i] = 0;
+    }
 }
 
 ResourceManager::~ResourceManager()
@@ -101,6 +146,15 @@ ResourceManager::~ResourceManager()
     MUTEX_DESTROY(ModelMutex);
 }
 
+// The sampler state manager keeps track of the bound textures, so
+// it must forget about them before they are deleted on any backend
+static void UnbindReleasedTexture(const Texture* const texture)
+{
+    SamplerState* const ssm = Renderer::GetInstance() ? Renderer::GetInstance()->GetSamplerStateManager() : nullptr;
+    if (ssm && texture)
+        ssm->UnbindTexture(texture);
+}
+
 void ResourceManager::ReleaseAll()
 {
     UnbindAll();
@@ -120,7 +174,10 @@ void ResourceManager::ReleaseAll()
     for (unsigned int i = 0; i < m_arrRenderTarget.size(); i++)
         delete m_arrRenderTarget[i];
     for (unsigned int i = 0; i < m_arrTexture.size(); i++)
+    {
+        UnbindReleasedTexture(m_arrTexture[i]);
         delete m_arrTexture[i];
+    }
 
     m_arrModel.clear();
     m_arrVertexFormat.clear();
@@ -130,6 +187,17 @@ void ResourceManager::ReleaseAll()
     m_arrShaderProgram.clear();
     m_arrTexture.clear();
     m_arrRenderTarget.clear();
+
+    m_arrModelFreeSlots.clear();
+    m_arrVertexFormatFreeSlots.clear();
+    m_arrIndexBufferFreeSlots.clear();
+    m_arrVertexBufferFreeSlots.clear();
+    m_arrShaderInputFreeSlots.clear();
+    m_arrShaderProgramFreeSlots.clear();
+    m_arrTextureFreeSlots.clear();
+    m_arrRenderTargetFreeSlots.clear();
+
+    m_mapVertexFormatCache.clear();
 }
 
 void ResourceManager::BindAll()
@@ -175,28 +243,150 @@ void ResourceManager::UnbindAll()
         if (m_arrRenderTarget[i])
             m_arrRenderTarget[i]->Unbind();
 
+    // Shader constants have to be uploaded again after a device reset
+    ShaderProgram::ResetResidentShaderInputs();
+
     if(Renderer::GetInstance()->GetProfiler())
         Renderer::GetInstance()->GetProfiler()->ReleaseGPUProfileMarkerResults();
 }
 
+// 64 bit FNV-1a hash of a vertex format's layout
+static const unsigned long long HashVertexLayout(const VertexElement* const elements, const unsigned int attributeCount, const unsigned int stride)
+{
+    unsigned long long hash = 14695981039346656037ull;
+    const auto hashValue = [&hash](const unsigned int value)
+    {
+        for (unsigned int i = 0; i < sizeof(value); i++)
+            hash = (hash ^ ((value >> (i * 8)) & 0xFF)) * 1099511628211ull;
+    };
+
+    hashValue(attributeCount);
+    for (unsigned int i = 0; i < attributeCount; i++)
+    {
+        hashValue(elements[i].nOffset);
+        hashValue(elements[i].eType);
+        hashValue(elements[i].eSemantic);
+        hashValue(elements[i].nSemanticIdx);
+    }
+    hashValue(stride);
+
+    return hash;
+}
+
+static const bool HasVertexLayout(const VertexFormat* const vf, const VertexElement* const elements, const unsigned int attributeCount, const unsigned int stride)
+{
+    if (vf->GetAttributeCount() != attributeCount || vf->GetStride() != stride)
+        return false;
+
+    for (unsigned int i = 0; i < attributeCount; i++)
+        if (vf->GetOffset(i) != elements[i].nOffset ||
+            vf->GetAttributeType(i) != elements[i].eType ||
+            vf->GetAttributeSemantic(i) != elements[i].eSemantic ||
+            vf->GetSemanticIndex(i) != elements[i].nSemanticIdx)
+            return false;
+
+    return true;
+}
+
+const unsigned int ResourceManager::GetOrCreateVertexFormat(
+    const unsigned int attributeCount, const VertexAttributeSemantic semantic,
+    const VertexAttributeType type, const unsigned int semanticIdx, ...)
+{
+    assert(attributeCount > 0 && attributeCount <= VF_MAX_ATTRIBUTES);
+
+    VertexElement elements[VF_MAX_ATTRIBUTES];
+    unsigned int offset = 0;
+
+    elements[0].nOffset = offset;
+    elements[0].eType = type;
+    elements[0].eSemantic = semantic;
+    elements[0].nSemanticIdx = semanticIdx;
+    offset += VertexFormat::GetAttributeTypeSize(type);
+
+    va_list args;
+    va_start(args, semanticIdx);
+    for (unsigned int i = 1; i < attributeCount && i < VF_MAX_ATTRIBUTES; i++)
+    {
+        elements[i].nOffset = offset;
+        elements[i].eSemantic = va_arg(args, VertexAttributeSemantic);
+        elements[i].eType = va_arg(args, VertexAttributeType);
+        elements[i].nSemanticIdx = va_arg(args, unsigned int);
+        offset += VertexFormat::GetAttributeTypeSize(elements[i].eType);
+    }
+    va_end(args);
+
+    return GetOrCreateVertexFormat(elements, Math::Min(attributeCount, (unsigned int)VF_MAX_ATTRIBUTES), offset);
+}
+
+const unsigned int ResourceManager::GetOrCreateVertexFormat(const VertexElement* const elements, const unsigned int attributeCount, const unsigned int stride)
+{
+    assert(attributeCount > 0 && attributeCount <= VF_MAX_ATTRIBUTES);
+
+    const unsigned long long layoutHash = HashVertexLayout(elements, attributeCount, stride);
+
+    MUTEX_LOCK(VFMutex);
+    const auto cached = m_mapVertexFormatCache.find(layoutHash);
+    if (cached != m_mapVertexFormatCache.end() && HasVertexLayout(m_arrVertexFormat[cached->second], elements, attributeCount, stride))
+    {
+        m_arrVertexFormat[cached->second]->m_nRefCount++;
+        const unsigned int idx = cached->second;
+        MUTEX_UNLOCK(VFMutex);
+
+        return idx;
+    }
+    MUTEX_UNLOCK(VFMutex);
+
+    // Create the platform specific resource outside of the lock, then check
+    // whether another thread has created the same layout in the meantime
+    const unsigned int idx = CreateVertexFormat(attributeCount);
+    VertexFormat* const vf = GetVertexFormat(idx);
+    for (unsigned int i = 0; i < attributeCount; i++)
+        vf->SetAttribute(i, elements[i].nOffset, elements[i].eSemantic, elements[i].eType, elements[i].nSemanticIdx);
+    vf->SetStride(stride);
+    vf->Bind();
+
+    MUTEX_LOCK(VFMutex);
+    const auto inserted = m_mapVertexFormatCache.insert(std::make_pair(layoutHash, idx));
+    if (inserted.second)
+    {
+        vf->m_nLayoutHash = layoutHash;
+        vf->m_nRefCount = 1;
+    }
+    else if (HasVertexLayout(m_arrVertexFormat[inserted.first->second], elements, attributeCount, stride))
+    {
+        m_arrVertexFormat[inserted.first->second]->m_nRefCount++;
+        const unsigned int sharedIdx = inserted.first->second;
+        MUTEX_UNLOCK(VFMutex);
+
+        ReleaseVertexFormat(idx);
+        return sharedIdx;
+    }
+    // else: a different layout with the same hash; this one is not shared
+    MUTEX_UNLOCK(VFMutex);
+
+    return idx;
+}
+
 const unsigned int ResourceManager::CreateShaderInput(ShaderProgram* const shaderProgram)
 {
     ShaderInput* const shdIn = new ShaderInput(shaderProgram);
     return AddShaderInput(shdIn);
 }
 
-const unsigned int ResourceManager::CreateTexture(const char* pathToFile)
+const bool ResourceManager::ReadTextureFile(const char* pathToFile, std::vector<char>& texData)
 {
-    unsigned int texIdx = ~0u;
-    std::ifstream texFile;
-    texFile.open(pathToFile, std::ios::binary);
+    bool success = false;
+    ResourceLoadTimings& loadTimings = GetThreadLoadTimings();
 
-    if (texFile.is_open())
+    std::vector<char> fileData;
+    if (ReadAssetFile(pathToFile, fileData))
     {
+        imemstream  texFile(fileData.data(), fileData.size());
+
         char fileSignature[S3D_TEXTURE_FILE_HEADER_SIZE];
         texFile.read(fileSignature, S3D_TEXTURE_FILE_HEADER_SIZE);
 
-        if (memcmp(S3D_TEXTURE_FILE_HEADER, fileSignature, S3D_TEXTURE_FILE_HEADER_SIZE) == 0)
+        if (texFile && memcmp(S3D_TEXTURE_FILE_HEADER, fileSignature, S3D_TEXTURE_FILE_HEADER_SIZE) == 0)
         {
             unsigned int fileVersion = 0;
             texFile.read((char*)&fileVersion, sizeof(unsigned int));
@@ -207,31 +397,29 @@ const unsigned int ResourceManager::CreateTexture(const char* pathToFile)
                 texFile.read((char*)&compressedBufferSize, sizeof(unsigned int));
                 texFile.read((char*)&decompressedBufferSize, sizeof(unsigned int));
 
-                if (compressedBufferSize > 0 && compressedBufferSize <= LZ4_COMPRESSBOUND(LZ4_MAX_INPUT_SIZE) &&
+                const size_t headerSize = S3D_TEXTURE_FILE_HEADER_SIZE + 3 * sizeof(unsigned int);
+
+                if (texFile && compressedBufferSize > 0 && compressedBufferSize <= fileData.size() - headerSize &&
                     decompressedBufferSize > 0 && decompressedBufferSize <= LZ4_MAX_INPUT_SIZE)
                 {
-                    char* const compressedBuffer = new char[compressedBufferSize];
-                    char* const decompressedBuffer = new char[decompressedBufferSize];
-                    texFile.read(compressedBuffer, compressedBufferSize);
-                    const int readBytes = LZ4_decompress_fast(compressedBuffer, decompressedBuffer, decompressedBufferSize);
+                    texData.resize(decompressedBufferSize);
+
+                    const long long phaseStart = Profiler::GetCPUTimestamp();
+
+                    // Decompress straight from the file's contents
+                    const int readBytes = LZ4_decompress_fast(fileData.data() + headerSize, texData.data(), decompressedBufferSize);
+
+                    loadTimings.nTime[RLP_DECOMPRESSION] += Profiler::GetCPUTimestamp() - phaseStart;
 
                     if (readBytes == compressedBufferSize)
                     {
-                        imemstream  texBuffer(decompressedBuffer, decompressedBufferSize);
-                        //MUTEX_LOCK(TexMutex);
-                        texIdx = CreateTexture(PF_NONE, TT_1D, 0, 0, 0, 0, BU_NONE);
-                        GetTexture(texIdx)->m_szSourceFile = pathToFile;
-                        //MUTEX_UNLOCK(TexMutex);
-                        texBuffer >> *GetTexture(texIdx);
+                        success = true;
                     }
                     else
                     {
                         S3D_DBGPRINT("Error: Texture %s could not be decompressed", pathToFile);
                         assert(0);
                     }
-
-                    delete[] compressedBuffer;
-                    delete[] decompressedBuffer;
                 }
                 else
                 {
@@ -250,25 +438,92 @@ const unsigned int ResourceManager::CreateTexture(const char* pathToFile)
             S3D_DBGPRINT("Error: File %s is not a Synesthesia3D texture file", pathToFile);
             assert(0);
         }
+    }
+
+    if (!success)
+        texData.clear();
+
+    return success;
+}
 
-        texFile.close();
+const unsigned int ResourceManager::CreateTexture(const char* pathToFile, const unsigned int maxMipSize)
+{
+    unsigned int texIdx = ~0u;
+
+    std::vector<char> texData;
+    if (ReadTextureFile(pathToFile, texData))
+    {
+        ResourceLoadTimings& loadTimings = GetThreadLoadTimings();
+        const long long phaseStart = Profiler::GetCPUTimestamp();
+
+        // Device resources are created while deserializing, so account for them separately
+        const long long uploadTime = loadTimings.nTime[RLP_GPU_UPLOAD];
+
+        imemstream  texBuffer(texData.data(), texData.size());
+        MemorySourceFileScope memorySourceFile(pathToFile);
+        //MUTEX_LOCK(TexMutex);
+        texIdx = CreateTexture(PF_NONE, TT_1D, 0, 0, 0, 0, BU_NONE);
+        Texture* const tex = GetTexture(texIdx);
+        tex->m_szSourceFile = pathToFile;
+        tex->m_nMaxResidentMipSize = maxMipSize;
+        //MUTEX_UNLOCK(TexMutex);
+        texBuffer >> *tex;
+
+        loadTimings.nTime[RLP_DESERIALIZATION] += Profiler::GetCPUTimestamp() - phaseStart - (loadTimings.nTime[RLP_GPU_UPLOAD] - uploadTime);
     }
 
     return texIdx;
 }
 
+const bool ResourceManager::StreamTextureMips(const unsigned int idx, const std::vector<char>& texData, const unsigned int maxMipSize)
+{
+    Texture* const tex = GetTexture(idx);
+    if (!tex || texData.empty())
+        return false;
+
+    assert(!tex->IsLocked() && !tex->IsRenderTarget() && !tex->IsDepthStencil());
+
+    // Deserializing recreates the platform specific resource
+    tex->Unbind();
+
+    imemstream  texBuffer(texData.data(), texData.size());
+    tex->m_nMaxResidentMipSize = maxMipSize;
+    texBuffer >> *tex;
+
+    return true;
+}
+
+const bool ResourceManager::EvictTextureMips(const unsigned int idx, const unsigned int maxMipSize)
+{
+    Texture* const tex = GetTexture(idx);
+    if (!tex || maxMipSize == 0)
+        return false;
+
+    assert(!tex->IsRenderTarget() && !tex->IsDepthStencil());
+
+    if (!tex->DiscardTopMips(maxMipSize))
+        return false;
+
+    tex->Unbind();
+    tex->Bind();
+
+    return true;
+}
+
 const unsigned int ResourceManager::CreateModel(const char* pathToFile)
 {
     unsigned int modelIdx = ~0u;
-    std::ifstream modelFile;
-    modelFile.open(pathToFile, std::ios::binary);
+    ResourceLoadTimings& loadTimings = GetThreadLoadTimings();
 
-    if (modelFile.is_open())
+    std::vector<char> fileData;
+    if (ReadAssetFile(pathToFile, fileData))
     {
+        imemstream  modelFile(fileData.data(), fileData.size());
+
         char fileSignature[S3D_MODEL_FILE_HEADER_SIZE];
         modelFile.read(fileSignature, S3D_MODEL_FILE_HEADER_SIZE);
 
-        if (memcmp(S3D_MODEL_FILE_HEADER, fileSignature, S3D_MODEL_FILE_HEADER_SIZE) == 0)
+        if (modelFile && memcmp(S3D_MODEL_FILE_HEADER, fileSignature, S3D_MODEL_FILE_HEADER_SIZE) == 0)
         {
             unsigned int fileVersion = 0;
             modelFile.read((char*)&fileVersion, sizeof(unsigned int));
@@ -279,21 +534,39 @@ const unsigned int ResourceManager::CreateModel(const char* pathToFile)
                 modelFile.read((char*)&compressedBufferSize, sizeof(unsigned int));
                 modelFile.read((char*)&decompressedBufferSize, sizeof(unsigned int));
 
-                if (compressedBufferSize > 0 && compressedBufferSize <= LZ4_COMPRESSBOUND(LZ4_MAX_INPUT_SIZE) &&
+                const size_t headerSize = S3D_MODEL_FILE_HEADER_SIZE + 3 * sizeof(unsigned int);
+
+                if (modelFile && compressedBufferSize > 0 && compressedBufferSize <= fileData.size() - headerSize &&
                     decompressedBufferSize > 0 && decompressedBufferSize <= LZ4_MAX_INPUT_SIZE)
                 {
-                    char* const compressedBuffer = new char[compressedBufferSize];
-                    char* const decompressedBuffer = new char[decompressedBufferSize];
-                    modelFile.read(compressedBuffer, compressedBufferSize);
-                    const int readBytes = LZ4_decompress_fast(compressedBuffer, decompressedBuffer, decompressedBufferSize);
+                    char* const decompressedBuffer = (char*)Allocator::AllocateMemory(decompressedBufferSize, AT_SERIALIZATION);
+
+                    long long phaseStart = Profiler::GetCPUTimestamp();
+
+                    // Decompress straight from the file's contents
+                    const int readBytes = LZ4_decompress_fast(fileData.data() + headerSize, decompressedBuffer, decompressedBufferSize);
+
+                    loadTimings.nTime[RLP_DECOMPRESSION] += Profiler::GetCPUTimestamp() - phaseStart;
+                    phaseStart = Profiler::GetCPUTimestamp();
+
+                    // Device resources are created while deserializing, so account for them separately
+                    const long long uploadTime = loadTimings.nTime[RLP_GPU_UPLOAD];
 
                     if (readBytes == compressedBufferSize)
                     {
                         imemstream  modelBuffer(decompressedBuffer, decompressedBufferSize);
+                        MemorySourceFileScope memorySourceFile(pathToFile);
                         Model* const mdl = new Model;
                         mdl->szSourceFile = pathToFile;
+
+                        // The model's data takes up about as much memory as its decompressed file, so that
+                        // most of it (meshes, materials and buffer data) comes from a single block
+                        mdl->pAllocator = new LinearAllocator(decompressedBufferSize + decompressedBufferSize / 4, AT_RESOURCES);
+
                         modelIdx = AddModel(mdl);
                         modelBuffer >> *mdl;
+
+                        loadTimings.nTime[RLP_DESERIALIZATION] += Profiler::GetCPUTimestamp() - phaseStart - (loadTimings.nTime[RLP_GPU_UPLOAD] - uploadTime);
                     }
                     else
                     {
@@ -301,8 +574,7 @@ const unsigned int ResourceManager::CreateModel(const char* pathToFile)
                         assert(0);
                     }
 
-                    delete[] compressedBuffer;
-                    delete[] decompressedBuffer;
+                    Allocator::FreeMemory(decompressedBuffer);
                 }
                 else
                 {
@@ -321,13 +593,200 @@ const unsigned int ResourceManager::CreateModel(const char* pathToFile)
             S3D_DBGPRINT("Error: File %s is not a Synesthesia3D model file", pathToFile);
             assert(0);
         }
-
-        modelFile.close();
     }
 
     return modelIdx;
 }
 
+ResourceLoadTimings& ResourceManager::GetThreadLoadTimings()
+{
+    static thread_local ResourceLoadTimings loadTimings;
+    return loadTimings;
+}
+
+const bool ResourceManager::MountAssetPack(const char* pathToFile)
+{
+    AssetPack* const pack = new AssetPack;
+    if (!pack->Open(pathToFile))
+    {
+        delete pack;
+        return false;
+    }
+
+    ms_arrAssetPack.push_back(pack);
+
+    return true;
+}
+
+void ResourceManager::UnmountAssetPacks()
+{
+    for (unsigned int i = 0; i < ms_arrAssetPack.size(); i++)
+        delete ms_arrAssetPack[i];
+    ms_arrAssetPack.clear();
+}
+
+const bool ResourceManager::FindAssetContentHash(const char* pathToFile, unsigned long long& contentHash)
+{
+    for (int i = (int)ms_arrAssetPack.size() - 1; i >= 0; i--)
+    {
+        const AssetPackEntry* const entry = ms_arrAssetPack[i]->FindEntry(pathToFile);
+        if (entry)
+        {
+            contentHash = entry->nContentHash;
+            return true;
+        }
+    }
+
+    contentHash = 0;
+    return false;
+}
+
+const bool ResourceManager::ReadAssetFile(const char* pathToFile, std::vector<char>& fileData)
+{
+    ResourceLoadTimings& loadTimings = GetThreadLoadTimings();
+    long long phaseStart = Profiler::GetCPUTimestamp();
+
+    for (int i = (int)ms_arrAssetPack.size() - 1; i >= 0; i--)
+    {
+        const AssetPackEntry* const entry = ms_arrAssetPack[i]->FindEntry(pathToFile);
+        if (!entry)
+            continue;
+
+        bool success = false;
+        if (entry->eCodec == APC_NONE)
+        {
+            success = ms_arrAssetPack[i]->ReadRawEntry(*entry, fileData);
+
+            loadTimings.nTime[RLP_IO] += Profiler::GetCPUTimestamp() - phaseStart;
+        }
+        else
+        {
+            std::vector<char> rawData;
+            success = ms_arrAssetPack[i]->ReadRawEntry(*entry, rawData);
+
+            loadTimings.nTime[RLP_IO] += Profiler::GetCPUTimestamp() - phaseStart;
+            phaseStart = Profiler::GetCPUTimestamp();
+
+            success = success && AssetPack::DecompressEntry(*entry, rawData, fileData);
+
+            loadTimings.nTime[RLP_DECOMPRESSION] += Profiler::GetCPUTimestamp() - phaseStart;
+        }
+
+        loadTimings.nBytesRead += entry->nSize;
+
+        if (!success)
+        {
+            S3D_DBGPRINT("Error: Could not read %s from asset pack %s", pathToFile, ms_arrAssetPack[i]->GetFilePath());
+            assert(0);
+        }
+
+        return success;
+    }
+
+    std::ifstream assetFile;
+    assetFile.open(pathToFile, std::ios::binary);
+
+    if (!assetFile.is_open())
+        return false;
+
+    assetFile.seekg(0, std::ios::end);
+    fileData.resize((size_t)assetFile.tellg());
+    assetFile.seekg(0, std::ios::beg);
+    assetFile.read(fileData.data(), fileData.size());
+
+    const bool success = assetFile.gcount() == (std::streamsize)fileData.size();
+    assetFile.close();
+
+    loadTimings.nTime[RLP_IO] += Profiler::GetCPUTimestamp() - phaseStart;
+    loadTimings.nBytesRead += fileData.size();
+
+    if (!success)
+        fileData.clear();
+
+    return success;
+}
+
+void ResourceManager::PushMemoryOwner(const char* const owner)
+{
+    GetThreadMemoryTags().arrOwner.push_back(owner);
+}
+
+void ResourceManager::PopMemoryOwner()
+{
+    MemoryTags& memoryTags = GetThreadMemoryTags();
+    assert(!memoryTags.arrOwner.empty());
+    if (!memoryTags.arrOwner.empty())
+        memoryTags.arrOwner.pop_back();
+}
+
+void ResourceManager::RetrieveMemorySnapshot(MemorySnapshot& snapshot) const
+{
+    snapshot.Reset();
+
+    MUTEX_LOCK(IBMutex);
+    for (unsigned int i = 0; i < m_arrIndexBuffer.size(); i++)
+    {
+        const IndexBuffer* const ib = m_arrIndexBuffer[i];
+        if (ib)
+            AccountMemory(snapshot, MRT_INDEX_BUFFER, ib->m_szMemorySourceFile, ib->m_szMemoryOwner, ib->m_pData ? ib->m_nSize : 0, ib->m_nSize);
+    }
+    snapshot.nCreationCount[MRT_INDEX_BUFFER] = m_nMemoryCreationCount[MRT_INDEX_BUFFER];
+    snapshot.nReleaseCount[MRT_INDEX_BUFFER] = m_nMemoryReleaseCount[MRT_INDEX_BUFFER];
+    MUTEX_UNLOCK(IBMutex);
+
+    MUTEX_LOCK(VBMutex);
+    for (unsigned int i = 0; i < m_arrVertexBuffer.size(); i++)
+    {
+        const VertexBuffer* const vb = m_arrVertexBuffer[i];
+        if (vb)
+            AccountMemory(snapshot, MRT_VERTEX_BUFFER, vb->m_szMemorySourceFile, vb->m_szMemoryOwner, vb->m_pData ? vb->m_nSize : 0, vb->m_nSize);
+    }
+    snapshot.nCreationCount[MRT_VERTEX_BUFFER] = m_nMemoryCreationCount[MRT_VERTEX_BUFFER];
+    snapshot.nReleaseCount[MRT_VERTEX_BUFFER] = m_nMemoryReleaseCount[MRT_VERTEX_BUFFER];
+    MUTEX_UNLOCK(VBMutex);
+
+    // Shader constants are uploaded from their CPU copy every time they're committed
+    MUTEX_LOCK(ShdInMutex);
+    for (unsigned int i = 0; i < m_arrShaderInput.size(); i++)
+    {
+        const ShaderInput* const shdIn = m_arrShaderInput[i];
+        if (shdIn)
+            AccountMemory(snapshot, MRT_SHADER_INPUT, shdIn->m_szMemorySourceFile, shdIn->m_szMemoryOwner, shdIn->m_pData ? shdIn->m_nSize : 0, 0);
+    }
+    snapshot.nCreationCount[MRT_SHADER_INPUT] = m_nMemoryCreationCount[MRT_SHADER_INPUT];
+    snapshot.nReleaseCount[MRT_SHADER_INPUT] = m_nMemoryReleaseCount[MRT_SHADER_INPUT];
+    MUTEX_UNLOCK(ShdInMutex);
+
+    // Sizes are those of the last time the textures were (re)created, e.g. after a dynamic render target was resized
+    MUTEX_LOCK(TexMutex);
+    for (unsigned int i = 0; i < m_arrTexture.size(); i++)
+    {
+        const Texture* const tex = m_arrTexture[i];
+        if (tex)
+            AccountMemory(snapshot, GetMemoryResourceType(tex), tex->m_szMemorySourceFile, tex->m_szMemoryOwner, tex->m_pData ? tex->m_nSize : 0, tex->m_nSize);
+    }
+    snapshot.nCreationCount[MRT_TEXTURE] = m_nMemoryCreationCount[MRT_TEXTURE];
+    snapshot.nReleaseCount[MRT_TEXTURE] = m_nMemoryReleaseCount[MRT_TEXTURE];
+    snapshot.nCreationCount[MRT_RENDER_TARGET] = m_nMemoryCreationCount[MRT_RENDER_TARGET];
+    snapshot.nReleaseCount[MRT_RENDER_TARGET] = m_nMemoryReleaseCount[MRT_RENDER_TARGET];
+    MUTEX_UNLOCK(TexMutex);
+}
+
+void ResourceManager::TrackMemory(Buffer* const buffer, const MemoryResourceType type)
+{
+    const MemoryTags& memoryTags = GetThreadMemoryTags();
+    buffer->m_szMemorySourceFile = memoryTags.szSourceFile;
+    if (!memoryTags.arrOwner.empty())
+        buffer->m_szMemoryOwner = memoryTags.arrOwner.back();
+
+    m_nMemoryCreationCount[type]++;
+}
+
+const MemoryResourceType ResourceManager::GetMemoryResourceType(const Texture* const tex)
+{
+    return tex->IsRenderTarget() || tex->IsDepthStencil() ? MRT_RENDER_TARGET : MRT_TEXTURE;
+}
+
 const unsigned int ResourceManager::FindTexture(const char * pathToFile, const bool strict)
 {
     //MUTEX_LOCK(TexMutex);
@@ -482,12 +941,24 @@ void ResourceManager::ReleaseVertexFormat(const unsigned int idx)
     if (idx >= m_arrVertexFormat.size())
         return;
 
-    delete m_arrVertexFormat[idx];
-    m_arrVertexFormat[idx] = nullptr;
-
     MUTEX_LOCK(VFMutex);
+    VertexFormat* const vf = m_arrVertexFormat[idx];
+    if (vf && vf->m_nRefCount > 0)
+    {
+        // Shared vertex formats are only destroyed along with their last reference
+        if (--vf->m_nRefCount > 0)
+        {
+            MUTEX_UNLOCK(VFMutex);
+            return;
+        }
+
+        m_mapVertexFormatCache.erase(vf->m_nLayoutHash);
+    }
+    m_arrVertexFormat[idx] = nullptr;
     m_arrVertexFormatFreeSlots.push_back(idx);
     MUTEX_UNLOCK(VFMutex);
+
+    delete vf;
 }
 
 void ResourceManager::ReleaseIndexBuffer(const unsigned int idx)
@@ -496,11 +967,14 @@ void ResourceManager::ReleaseIndexBuffer(const unsigned int idx)
     if (idx >= m_arrIndexBuffer.size())
         return;
 
+    const bool wasCreated = m_arrIndexBuffer[idx] != nullptr;
     delete m_arrIndexBuffer[idx];
     m_arrIndexBuffer[idx] = nullptr;
 
     MUTEX_LOCK(IBMutex);
     m_arrIndexBufferFreeSlots.push_back(idx);
+    if (wasCreated)
+        m_nMemoryReleaseCount[MRT_INDEX_BUFFER]++;
     MUTEX_UNLOCK(IBMutex);
 }
 
@@ -510,11 +984,14 @@ void ResourceManager::ReleaseVertexBuffer(const unsigned int idx)
     if (idx >= m_arrVertexBuffer.size())
         return;
 
+    const bool wasCreated = m_arrVertexBuffer[idx] != nullptr;
     delete m_arrVertexBuffer[idx];
     m_arrVertexBuffer[idx] = nullptr;
 
     MUTEX_LOCK(VBMutex);
     m_arrVertexBufferFreeSlots.push_back(idx);
+    if (wasCreated)
+        m_nMemoryReleaseCount[MRT_VERTEX_BUFFER]++;
     MUTEX_UNLOCK(VBMutex);
 }
 
@@ -524,11 +1001,14 @@ void ResourceManager::ReleaseShaderInput(const unsigned int idx)
     if (idx >= m_arrShaderInput.size())
         return;
 
+    const bool wasCreated = m_arrShaderInput[idx] != nullptr;
     delete m_arrShaderInput[idx];
     m_arrShaderInput[idx] = nullptr;
 
     MUTEX_LOCK(ShdInMutex);
     m_arrShaderInputFreeSlots.push_back(idx);
+    if (wasCreated)
+        m_nMemoryReleaseCount[MRT_SHADER_INPUT]++;
     MUTEX_UNLOCK(ShdInMutex);
 }
 
@@ -552,11 +1032,19 @@ void ResourceManager::ReleaseTexture(const unsigned int idx)
     if (idx >= m_arrTexture.size())
         return;
 
+    // Releasing a free slot again would put it on the free list twice,
+    // so that two textures created later would end up sharing it
+    if (m_arrTexture[idx] == nullptr)
+        return;
+
+    const MemoryResourceType memoryType = GetMemoryResourceType(m_arrTexture[idx]);
+    UnbindReleasedTexture(m_arrTexture[idx]);
     delete m_arrTexture[idx];
     m_arrTexture[idx] = nullptr;
 
     MUTEX_LOCK(TexMutex);
     m_arrTextureFreeSlots.push_back(idx);
+    m_nMemoryReleaseCount[memoryType]++;
     MUTEX_UNLOCK(TexMutex);
 }
 
@@ -605,6 +1093,7 @@ const unsigned int ResourceManager::AddVertexFormat(VertexFormat* vf)
         idx = (unsigned int)m_arrVertexFormat.size() - 1;
     }
     MUTEX_UNLOCK(VFMutex);
+    Renderer::IncrementCounter(RC_RESOURCE_CREATIONS);
 
     return idx;
 }
@@ -625,7 +1114,9 @@ const unsigned int ResourceManager::AddIndexBuffer(IndexBuffer* ib)
         m_arrIndexBuffer.push_back(ib);
         idx = (unsigned int)m_arrIndexBuffer.size() - 1;
     }
+    TrackMemory(ib, MRT_INDEX_BUFFER);
     MUTEX_UNLOCK(IBMutex);
+    Renderer::IncrementCounter(RC_RESOURCE_CREATIONS);
 
     return idx;
 }
@@ -646,7 +1137,9 @@ const unsigned int ResourceManager::AddVertexBuffer(VertexBuffer* vb)
         m_arrVertexBuffer.push_back(vb);
         idx = (unsigned int)m_arrVertexBuffer.size() - 1;
     }
+    TrackMemory(vb, MRT_VERTEX_BUFFER);
     MUTEX_UNLOCK(VBMutex);
+    Renderer::IncrementCounter(RC_RESOURCE_CREATIONS);
 
     return idx;
 }
@@ -668,6 +1161,7 @@ const unsigned int ResourceManager::AddShaderProgram(ShaderProgram* shdProg)
         idx = (unsigned int)m_arrShaderProgram.size() - 1;
     }
     MUTEX_UNLOCK(ShdProgMutex);
+    Renderer::IncrementCounter(RC_RESOURCE_CREATIONS);
 
     return idx;
 }
@@ -688,7 +1182,9 @@ const unsigned int ResourceManager::AddTexture(Texture* tex)
         m_arrTexture.push_back(tex);
         idx = (unsigned int)m_arrTexture.size() - 1;
     }
+    TrackMemory(tex, GetMemoryResourceType(tex));
     MUTEX_UNLOCK(TexMutex);
+    Renderer::IncrementCounter(RC_RESOURCE_CREATIONS);
 
     return idx;
 }
@@ -710,6 +1206,7 @@ const unsigned int ResourceManager::AddRenderTarget(RenderTarget* rt)
         idx = (unsigned int)m_arrRenderTarget.size() - 1;
     }
     MUTEX_UNLOCK(RTMutex);
+    Renderer::IncrementCounter(RC_RESOURCE_CREATIONS);
 
     return idx;
 }
@@ -730,7 +1227,9 @@ const unsigned int ResourceManager::AddShaderInput(ShaderInput* shdIn)
         m_arrShaderInput.push_back(shdIn);
         idx = (unsigned int)m_arrShaderInput.size() - 1;
     }
+    TrackMemory(shdIn, MRT_SHADER_INPUT);
     MUTEX_UNLOCK(ShdInMutex);
+    Renderer::IncrementCounter(RC_RESOURCE_CREATIONS);
 
     return idx;
 }
@@ -752,6 +1251,7 @@ const unsigned int ResourceManager::AddModel(Model* mdl)
         idx = (unsigned int)m_arrModel.size() - 1;
     }
     MUTEX_UNLOCK(ModelMutex);
+    Renderer::IncrementCounter(RC_RESOURCE_CREATIONS);
 
     return idx;
 }
@@ -23,10 +23,13 @@
 #ifndef RESOURCEMANAGER_H
 #define RESOURCEMANAGER_H
 
+#include <unordered_map>
+
 #include "ResourceData.h"
 
 namespace Synesthesia3D
 {
+    class Buffer;
     class VertexFormat;
     class VertexBuffer;
     class IndexBuffer;
@@ -35,6 +38,7 @@ namespace Synesthesia3D
     class ShaderProgram;
     class ShaderInput;
     class RenderTarget;
+    class AssetPack;
 
     /**
      * @brief   Manages all allocated resources.
@@ -90,6 +94,39 @@ namespace Synesthesia3D
          */
         virtual SYNESTHESIA3D_DLL   const unsigned int      CreateVertexFormat(const unsigned int attributeCount, const VertexAttributeSemantic semantic, const VertexAttributeType type, const unsigned int semanticIdx, ...) PURE_VIRTUAL;
 
+        /**
+         * @brief   Retrieves a vertex format with the specified layout, shared with all other users of the same layout.
+         *
+         * @details Vertex formats are cached by the hash of their layout, so that identical layouts share
+         *          a single object and a single platform specific resource (e.g. vertex declaration).
+         *          Each call adds a reference to the vertex format, which is destroyed when all of them
+         *          have been released with @ref ReleaseVertexFormat().
+         *
+         * @param[in]   attributeCount  The number of vertex format attributes.
+         * @param[in]   semantic        Vertex semantic.
+         * @param[in]   type            Data type.
+         * @param[in]   semanticIdx     Semantic index.
+         * @param[in]   ...             attributeCount - 1 pairs of semantic and semanticIdx.
+         *
+         * @return  Resource ID corresponding to the shared resource.
+         *
+         * @note    Shared vertex formats must not be modified.
+         */
+                SYNESTHESIA3D_DLL   const unsigned int      GetOrCreateVertexFormat(const unsigned int attributeCount, const VertexAttributeSemantic semantic, const VertexAttributeType type, const unsigned int semanticIdx, ...);
+
+        /**
+         * @brief   Retrieves a vertex format with the specified layout, shared with all other users of the same layout.
+         *
+         * @param[in]   elements        The attributes of the vertex format.
+         * @param[in]   attributeCount  The number of vertex format attributes.
+         * @param[in]   stride          The stride of the vertex format.
+         *
+         * @return  Resource ID corresponding to the shared resource.
+         *
+         * @see     GetOrCreateVertexFormat(const unsigned int, const VertexAttributeSemantic, const VertexAttributeType, const unsigned int, ...)
+         */
+                SYNESTHESIA3D_DLL   const unsigned int      GetOrCreateVertexFormat(const VertexElement* const elements, const unsigned int attributeCount, const unsigned int stride);
+
         /**
          * @brief   Creates an index buffer.
          *
@@ -162,12 +199,54 @@ namespace Synesthesia3D
          * @brief   Creates a texture and load data from an image file.
          *
          * @param[in]   pathToFile  Path to texture file (*.s3dtex)
+         * @param[in]   maxMipSize  Maximum width, height and depth of the largest mip to keep resident (0 for all mips).
+         *                          The top mips can be loaded later on with @ref StreamTextureMips().
          *
          * @return  Resource ID corresponding to the created resource.
          *
          * @see     Texture
          */
-                SYNESTHESIA3D_DLL   const unsigned int      CreateTexture(const char* pathToFile);
+                SYNESTHESIA3D_DLL   const unsigned int      CreateTexture(const char* pathToFile, const unsigned int maxMipSize = 0);
+
+        /**
+         * @brief   Reads and decompresses an image file, without creating any resources.
+         *
+         * @details Can be called from any thread, so that streaming textures does not stall rendering on I/O.
+         *
+         * @param[in]   pathToFile  Path to texture file (*.s3dtex)
+         * @param[out]  texData     The decompressed contents of the file.
+         *
+         * @return  Success of operation.
+         *
+         * @see     StreamTextureMips()
+         */
+        static  SYNESTHESIA3D_DLL   const bool              ReadTextureFile(const char* pathToFile, std::vector<char>& texData);
+
+        /**
+         * @brief   Reloads a texture from the contents of its file, keeping a different number of its mips resident.
+         *
+         * @note    The platform specific resource is recreated, so it must not be used concurrently (e.g. call it
+         *          from the rendering thread, between frames). Sampler states are preserved.
+         *
+         * @param[in]   idx         Resource ID of the texture.
+         * @param[in]   texData     The contents of the texture's file, as retrieved by @ref ReadTextureFile().
+         * @param[in]   maxMipSize  Maximum width, height and depth of the largest mip to keep resident (0 for all mips).
+         *
+         * @return  Success of operation.
+         */
+                SYNESTHESIA3D_DLL   const bool              StreamTextureMips(const unsigned int idx, const std::vector<char>& texData, const unsigned int maxMipSize);
+
+        /**
+         * @brief   Discards the top mips of a texture, so that the largest resident one fits in the specified size.
+         *
+         * @note    The platform specific resource is recreated, so the same restrictions as for @ref StreamTextureMips() apply.
+         *
+         * @param[in]   idx         Resource ID of the texture.
+         * @param[in]   maxMipSize  Maximum width, height and depth of the largest mip to keep resident.
+         *
+         * @return  Whether any mips have been discarded.
+         */
+                SYNESTHESIA3D_DLL   const bool              EvictTextureMips(const unsigned int idx, const unsigned int maxMipSize);
 
         /**
          * @brief   Creates a render target.
@@ -448,11 +527,97 @@ namespace Synesthesia3D
          */
                 SYNESTHESIA3D_DLL   const unsigned int      FindModel(const char* pathToFile, const bool strict = true);
 
+        /**
+         * @brief   Retrieves the time the calling thread spent loading resources, in each @ref ResourceLoadPhase.
+         *
+         * @details Accumulated by @ref CreateTexture(const char*), @ref CreateModel() and @ref CreateShaderProgram()
+         *          on the thread calling them. Reset it before loading a resource to time that resource alone.
+         */
+        static  SYNESTHESIA3D_DLL   ResourceLoadTimings&    GetThreadLoadTimings();
+
+        /**
+         * @brief   Serves subsequent texture and model loads from an asset pack (*.s3dpak), where it contains them.
+         *
+         * @details Packs mounted later take precedence. Assets missing from all mounted packs are read
+         *          from their own files, as usual.
+         *
+         * @note    Must not be called while resources are being loaded.
+         *
+         * @param[in]   pathToFile  Path to the asset pack.
+         *
+         * @return  Success of operation.
+         *
+         * @see     AssetPack
+         */
+        static  SYNESTHESIA3D_DLL   const bool              MountAssetPack(const char* pathToFile);
+
+        /**
+         * @brief   Closes all mounted asset packs.
+         *
+         * @note    Must not be called while resources are being loaded.
+         */
+        static  SYNESTHESIA3D_DLL           void            UnmountAssetPacks();
+
+        /**
+         * @brief   Reads the contents of an asset file, from the mounted asset packs or from the file itself.
+         *
+         * @details Can be called from any thread. The time spent is accounted to @ref RLP_IO and, for entries
+         *          compressed in the pack, @ref RLP_DECOMPRESSION of the calling thread's load timings.
+         *
+         * @param[in]   pathToFile  Path to the asset file.
+         * @param[out]  fileData    The contents of the file.
+         *
+         * @return  Success of operation.
+         */
+        static  SYNESTHESIA3D_DLL   const bool              ReadAssetFile(const char* pathToFile, std::vector<char>& fileData);
+
+        /**
+         * @brief   Retrieves the hash of an asset's contents from the mounted asset packs, without reading it.
+         *
+         * @details Assets with the same contents hash can be loaded once and shared, regardless of their paths.
+         *
+         * @param[in]   pathToFile      Path to the asset file.
+         * @param[out]  contentHash     Hash of the asset's contents (see @ref AssetPack::HashContents()).
+         *
+         * @return  False if the asset isn't in any of the mounted asset packs.
+         */
+        static  SYNESTHESIA3D_DLL   const bool              FindAssetContentHash(const char* pathToFile, unsigned long long& contentHash);
+
+        /**
+         * @brief   Attributes the memory of the resources subsequently created on the calling thread to an owner (e.g. a render pass).
+         *
+         * @details Owner scopes can be nested, in which case resources are attributed to the innermost one.
+         *          Must be paired with a corresponding @ref PopMemoryOwner().
+         *
+         * @param[in]   owner   Name of the owner.
+         *
+         * @see RetrieveMemorySnapshot()
+         */
+        static  SYNESTHESIA3D_DLL           void            PushMemoryOwner(const char* const owner);
+
+        /**
+         * @brief   Ends the owner scope started by the last call to @ref PushMemoryOwner() on the calling thread.
+         */
+        static  SYNESTHESIA3D_DLL           void            PopMemoryOwner();
+
+        /**
+         * @brief   Retrieves the memory currently used by vertex buffers, index buffers, shader inputs, textures and render targets.
+         *
+         * @details Usage is aggregated by @ref MemoryResourceType, by the file the resources were loaded from and by the owner
+         *          they were created under. Take snapshots at different times and use @ref MemorySnapshot::Diff() to find leaks.
+         *
+         * @param[out]  snapshot    The memory usage.
+         */
+                SYNESTHESIA3D_DLL           void            RetrieveMemorySnapshot(MemorySnapshot& snapshot) const;
+
         /**
          * @brief   Destroys a vertex format.
          *
          * @param[in]   idx     Resource ID.
          *
+         * @note    Vertex formats retrieved with @ref GetOrCreateVertexFormat() are only
+         *          destroyed when the last of their references is released.
+         *
          * @see CreateVertexFormat()
          */
                 SYNESTHESIA3D_DLL           void            ReleaseVertexFormat(const unsigned int idx);
@@ -498,12 +663,14 @@ namespace Synesthesia3D
          *
          * @param[in]   idx     Resource ID.
          *
+         * @note    Releasing a texture which has already been released has no effect.
+         *
          * @see CreateTexture()
          */
                 SYNESTHESIA3D_DLL           void            ReleaseTexture(const unsigned int idx);
                 
         /**
-         * @brief   Destroys a render target.
+         * @brief   Destroys a render target, along with its color and depth-stencil textures.
          *
          * @param[in]   idx     Resource ID.
          *
@@ -547,23 +714,51 @@ namespace Synesthesia3D
         const unsigned int AddShaderInput(ShaderInput* shdIn);          /**< @brief Adds a shader input resource object to the corresponding resource list and returns the resource handle. */
         const unsigned int AddModel(Model* mdl);                        /**< @brief Adds a model resource object to the corresponding resource list and returns the resource handle. */
 
-        std::vector<VertexFormat*>      m_arrVertexFormat;      /**< @brief Array of vertex formats created by the resource manager. */
-        std::vector<IndexBuffer*>       m_arrIndexBuffer;       /**< @brief Array of index buffers created by the resource manager. */
-        std::vector<VertexBuffer*>      m_arrVertexBuffer;      /**< @brief Array of vertex buffers created by the resource manager. */
-        std::vector<ShaderInput*>       m_arrShaderInput;       /**< @brief Array of shader inputs created by the resource manager */
-        std::vector<ShaderProgram*>     m_arrShaderProgram;     /**< @brief Array of shader programs created by the resource manager. */
-        std::vector<Texture*>           m_arrTexture;           /**< @brief Array of textures created by the resource manager. */
-        std::vector<RenderTarget*>      m_arrRenderTarget;      /**< @brief Array of render targets created by the resource manager. */
-        std::vector<Model*>             m_arrModel;             /**< @brief Array of models created by the resource manager. */
-
-        std::vector<unsigned int>       m_arrVertexFormatFreeSlots;     /**< @brief Array of vertex format resource handles that have been freed and can be reused. */
-        std::vector<unsigned int>       m_arrIndexBufferFreeSlots;      /**< @brief Array of index buffer resource handles that have been freed and can be reused. */
-        std::vector<unsigned int>       m_arrVertexBufferFreeSlots;     /**< @brief Array of vertex buffer resource handles that have been freed and can be reused. */
-        std::vector<unsigned int>       m_arrShaderInputFreeSlots;      /**< @brief Array of shader input resource handles that have been freed and can be reused. */
-        std::vector<unsigned int>       m_arrShaderProgramFreeSlots;    /**< @brief Array of shader program resource handles that have been freed and can be reused. */
-        std::vector<unsigned int>       m_arrTextureFreeSlots;          /**< @brief Array of texture resource handles that have been freed and can be reused. */
-        std::vector<unsigned int>       m_arrRenderTargetFreeSlots;     /**< @brief Array of render target resource handles that have been freed and can be reused. */
-        std::vector<unsigned int>       m_arrModelFreeSlots;            /**< @brief Array of model resource handles that have been freed and can be reused. */
+        /**
+         * @brief   Tags a newly created buffer with the calling thread's memory owner and source file, and counts its creation.
+         */
+        void TrackMemory(Buffer* const buffer, const MemoryResourceType type);
+
+        /**
+         * @brief   Retrieves the @ref MemoryResourceType a texture is accounted as.
+         */
+        static const MemoryResourceType GetMemoryResourceType(const Texture* const tex);
+
+        /**
+         * @brief   Array of resources, or of resource handles, allocated on behalf of the resource manager (see @ref AT_RESOURCES).
+         */
+        template <typename T>
+        using ResourceArray = std::vector<T, StlAllocator<T, AT_RESOURCES>>;
+
+        ResourceArray<VertexFormat*>        m_arrVertexFormat;              /**< @brief Array of vertex formats created by the resource manager. */
+        ResourceArray<IndexBuffer*>         m_arrIndexBuffer;               /**< @brief Array of index buffers created by the resource manager. */
+        ResourceArray<VertexBuffer*>        m_arrVertexBuffer;              /**< @brief Array of vertex buffers created by the resource manager. */
+        ResourceArray<ShaderInput*>         m_arrShaderInput;               /**< @brief Array of shader inputs created by the resource manager */
+        ResourceArray<ShaderProgram*>       m_arrShaderProgram;             /**< @brief Array of shader programs created by the resource manager. */
+        ResourceArray<Texture*>             m_arrTexture;                   /**< @brief Array of textures created by the resource manager. */
+        ResourceArray<RenderTarget*>        m_arrRenderTarget;              /**< @brief Array of render targets created by the resource manager. */
+        ResourceArray<Model*>               m_arrModel;                     /**< @brief Array of models created by the resource manager. */
+
+        ResourceArray<unsigned int>         m_arrVertexFormatFreeSlots;     /**< @brief Array of vertex format resource handles that have been freed and can be reused. */
+        ResourceArray<unsigned int>         m_arrIndexBufferFreeSlots;      /**< @brief Array of index buffer resource handles that have been freed and can be reused. */
+        ResourceArray<unsigned int>         m_arrVertexBufferFreeSlots;     /**< @brief Array of vertex buffer resource handles that have been freed and can be reused. */
+        ResourceArray<unsigned int>         m_arrShaderInputFreeSlots;      /**< @brief Array of shader input resource handles that have been freed and can be reused. */
+        ResourceArray<unsigned int>         m_arrShaderProgramFreeSlots;    /**< @brief Array of shader program resource handles that have been freed and can be reused. */
+        ResourceArray<unsigned int>         m_arrTextureFreeSlots;          /**< @brief Array of texture resource handles that have been freed and can be reused. */
+        ResourceArray<unsigned int>         m_arrRenderTargetFreeSlots;     /**< @brief Array of render target resource handles that have been freed and can be reused. */
+        ResourceArray<unsigned int>         m_arrModelFreeSlots;            /**< @brief Array of model resource handles that have been freed and can be reused. */
+
+        /**
+         * @brief   Handles of the shared vertex formats, indexed by the hash of their layout (see @ref GetOrCreateVertexFormat()).
+         */
+        std::unordered_map<unsigned long long, unsigned int,
+            std::hash<unsigned long long>, std::equal_to<unsigned long long>,
+            StlAllocator<std::pair<const unsigned long long, unsigned int>, AT_RESOURCES>>  m_mapVertexFormatCache;
+
+        int     m_nMemoryCreationCount[MRT_MAX];    /**< @brief Resources of each type created, for memory accounting. */
+        int     m_nMemoryReleaseCount[MRT_MAX];     /**< @brief Resources of each type released, for memory accounting. */
+
+        static std::vector<AssetPack*>  ms_arrAssetPack;    /**< @brief Mounted asset packs, in the order they were mounted. */
 
         friend class Renderer;
     };
@@ -29,9 +29,20 @@
 #include "VertexBuffer.h"
 #include "IndexBuffer.h"
 #include "Texture.h"
+#include "Profiler.h"
+
+#include <Utility/LinearAllocator.h>
 
 namespace Synesthesia3D
 {
+    // Reads straight into the string, instead of going through a temporary buffer
+    static void ReadString(std::istream& s_in, std::string& str_out, const unsigned int length)
+    {
+        str_out.resize(length);
+        if (length > 0)
+            s_in.read(&str_out[0], length);
+    }
+
     std::ostream& operator<<(std::ostream& output_out, const Model& model_in)
     {
         // model name size
@@ -67,12 +78,7 @@ namespace Synesthesia3D
         s_in.read((char*)&modelNameSize, sizeof(unsigned int));
 
         // model name
-        char* modelName = nullptr;
-        modelName = new char[modelNameSize + 1];
-        s_in.read(modelName, modelNameSize);
-        modelName[modelNameSize] = '\0';
-        model_out.szName = modelName;
-        delete[] modelName;
+        ReadString(s_in, model_out.szName, modelNameSize);
 
         // mesh count
         unsigned int meshCount = 0;
@@ -82,8 +88,12 @@ namespace Synesthesia3D
         // meshes
         for (unsigned int mesh = 0; mesh < meshCount; mesh++)
         {
-            model_out.arrMesh.push_back(new Model::Mesh);
-            s_in >> *model_out.arrMesh.back();
+            Model::Mesh* const meshData = model_out.pAllocator ?
+                new (model_out.pAllocator->Allocate(sizeof(Model::Mesh), alignof(Model::Mesh))) Model::Mesh :
+                new Model::Mesh;
+            meshData->pAllocator = model_out.pAllocator;
+            model_out.arrMesh.push_back(meshData);
+            s_in >> *meshData;
         }
 
         // material count
@@ -94,8 +104,12 @@ namespace Synesthesia3D
         // materials
         for (unsigned int mat = 0; mat < matCount; mat++)
         {
-            model_out.arrMaterial.push_back(new Model::Material);
-            s_in >> *model_out.arrMaterial.back();
+            Model::Material* const matData = model_out.pAllocator ?
+                new (model_out.pAllocator->Allocate(sizeof(Model::Material), alignof(Model::Material))) Model::Material :
+                new Model::Material;
+            matData->pAllocator = model_out.pAllocator;
+            model_out.arrMaterial.push_back(matData);
+            s_in >> *matData;
         }
 
         return s_in;
@@ -190,8 +204,10 @@ namespace Synesthesia3D
         s_in.read((char*)&buf_out.m_nElementSize, sizeof(unsigned int));
         s_in.read((char*)&buf_out.m_eBufferUsage, sizeof(BufferUsage));
         s_in.read((char*)&buf_out.m_nSize, sizeof(unsigned int));
-        delete[] buf_out.m_pData;
-        buf_out.m_pData = new s3dByte[buf_out.m_nSize];
+        if (buf_out.m_pDataAllocator)
+            buf_out.m_pData = (s3dByte*)buf_out.m_pDataAllocator->Allocate(buf_out.m_nSize);
+        else
+            buf_out.AllocateData();
         s_in.read((char*)buf_out.m_pData, buf_out.m_nSize);
 
         return s_in;
@@ -232,24 +248,31 @@ namespace Synesthesia3D
         s_in.read((char*)&meshNameSize, sizeof(unsigned int));
 
         // mesh name
-        char* meshName = nullptr;
-        meshName = new char[meshNameSize + 1];
-        s_in.read(meshName, meshNameSize);
-        meshName[meshNameSize] = '\0';
-        mesh_out.szName = meshName;
-        delete[] meshName;
-
-        // vertex format data
-        mesh_out.nVfIdx = resMan->CreateVertexFormat(0);
+        ReadString(s_in, mesh_out.szName, meshNameSize);
+
+        // vertex format data (meshes with the same layout share their vertex format)
+        unsigned int attributeCount = 0;
+        s_in.read((char*)&attributeCount, sizeof(unsigned int));
+        assert(attributeCount > 0 && attributeCount <= VF_MAX_ATTRIBUTES);
+        attributeCount = Math::clamp(attributeCount, 1u, (unsigned int)VF_MAX_ATTRIBUTES);
+        VertexElement elements[VF_MAX_ATTRIBUTES];
+        for (unsigned int i = 0; i < attributeCount; i++)
+            s_in >> elements[i];
+        unsigned int stride = 0;
+        s_in.read((char*)&stride, sizeof(unsigned int));
+        long long uploadStart = Profiler::GetCPUTimestamp();
+        mesh_out.nVfIdx = resMan->GetOrCreateVertexFormat(elements, attributeCount, stride);
         mesh_out.pVertexFormat = resMan->GetVertexFormat(mesh_out.nVfIdx);
-        s_in >> *(mesh_out.pVertexFormat);
-        mesh_out.pVertexFormat->Bind();
+        ResourceManager::GetThreadLoadTimings().nTime[RLP_GPU_UPLOAD] += Profiler::GetCPUTimestamp() - uploadStart;
 
         // index buffer data
         mesh_out.nIbIdx = resMan->CreateIndexBuffer(0);
         mesh_out.pIndexBuffer = resMan->GetIndexBuffer(mesh_out.nIbIdx);
+        mesh_out.pIndexBuffer->m_pDataAllocator = mesh_out.pAllocator;
         s_in >> *(mesh_out.pIndexBuffer);
+        uploadStart = Profiler::GetCPUTimestamp();
         mesh_out.pIndexBuffer->Bind();
+        ResourceManager::GetThreadLoadTimings().nTime[RLP_GPU_UPLOAD] += Profiler::GetCPUTimestamp() - uploadStart;
 
         // vertex buffer data
         mesh_out.nVbIdx = resMan->CreateVertexBuffer(
@@ -257,8 +280,11 @@ namespace Synesthesia3D
             0,
             mesh_out.pIndexBuffer);
         mesh_out.pVertexBuffer = resMan->GetVertexBuffer(mesh_out.nVbIdx);
+        mesh_out.pVertexBuffer->m_pDataAllocator = mesh_out.pAllocator;
         s_in >> *(mesh_out.pVertexBuffer);
+        uploadStart = Profiler::GetCPUTimestamp();
         mesh_out.pVertexBuffer->Bind();
+        ResourceManager::GetThreadLoadTimings().nTime[RLP_GPU_UPLOAD] += Profiler::GetCPUTimestamp() - uploadStart;
 
         // material index
         s_in.read((char*)&mesh_out.nMaterialIdx, sizeof(unsigned int));
@@ -341,12 +367,7 @@ namespace Synesthesia3D
         s_in.read((char*)&matNameSize, sizeof(unsigned int));
 
         // material name
-        char* matName = nullptr;
-        matName = new char[matNameSize + 1];
-        s_in.read(matName, matNameSize);
-        matName[matNameSize] = '\0';
-        mat_out.szName = matName;
-        delete[] matName;
+        ReadString(s_in, mat_out.szName, matNameSize);
 
         // culling
         s_in.read((char*)&mat_out.bTwoSided, sizeof(bool));
@@ -401,9 +422,13 @@ namespace Synesthesia3D
         s_in.read((char*)&texCount, sizeof(unsigned int));
 
         // texture descriptors
+        mat_out.arrTexture.reserve(texCount);
         for (unsigned int tex = 0; tex < texCount; tex++)
         {
-            mat_out.arrTexture.push_back(new Model::TextureDesc);
+            Model::TextureDesc* const texData = mat_out.pAllocator ?
+                new (mat_out.pAllocator->Allocate(sizeof(Model::TextureDesc), alignof(Model::TextureDesc))) Model::TextureDesc :
+                new Model::TextureDesc;
+            mat_out.arrTexture.push_back(texData);
             s_in >> *mat_out.arrTexture.back();
         }
 
@@ -453,12 +478,7 @@ namespace Synesthesia3D
         s_in.read((char*)&filePathSize, sizeof(unsigned int));
 
         // file path
-        char* filePath = nullptr;
-        filePath = new char[filePathSize + 1];
-        s_in.read(filePath, filePathSize);
-        filePath[filePathSize] = '\0';
-        tex_out.szFilePath = filePath;
-        delete[] filePath;
+        ReadString(s_in, tex_out.szFilePath, filePathSize);
 
         // texture type
         s_in.read((char*)&tex_out.eTexType, sizeof(Model::TextureDesc::TextureType));
@@ -511,7 +531,11 @@ namespace Synesthesia3D
         {
             if (arrTexture[tex] != nullptr)
             {
-                delete arrTexture[tex];
+                // Allocated from the model's allocator, which frees the memory along with the model
+                if (pAllocator)
+                    arrTexture[tex]->~TextureDesc();
+                else
+                    delete arrTexture[tex];
                 arrTexture[tex] = nullptr;
             }
         }
@@ -523,7 +547,10 @@ namespace Synesthesia3D
         {
             if (arrMesh[mesh] != nullptr)
             {
-                delete arrMesh[mesh];
+                if (pAllocator)
+                    arrMesh[mesh]->~Mesh();
+                else
+                    delete arrMesh[mesh];
                 arrMesh[mesh] = nullptr;
             }
         }
@@ -532,10 +559,17 @@ namespace Synesthesia3D
         {
             if (arrMaterial[mat] != nullptr)
             {
-                delete arrMaterial[mat];
+                if (pAllocator)
+                    arrMaterial[mat]->~Material();
+                else
+                    delete arrMaterial[mat];
                 arrMaterial[mat] = nullptr;
             }
         }
+
+        // The meshes' buffers were released above, so their data can go too
+        delete pAllocator;
+        pAllocator = nullptr;
     }
 
     std::ostream& operator<<(std::ostream& output_out, Texture& tex_in)
@@ -573,7 +607,13 @@ namespace Synesthesia3D
         for (unsigned int i = 0; i < tex_out.m_nMipCount; i++)
             s_in.read((char*)&tex_out.m_nMipOffset[i], sizeof(unsigned int));
 
+        // Streamed textures keep only part of the file's mip chain resident
+        tex_out.m_nSkippedMipCount = 0;
+        tex_out.DiscardTopMips(tex_out.m_nMaxResidentMipSize);
+
+        const long long uploadStart = Profiler::GetCPUTimestamp();
         tex_out.Bind();
+        ResourceManager::GetThreadLoadTimings().nTime[RLP_GPU_UPLOAD] += Profiler::GetCPUTimestamp() - uploadStart;
 
         return s_in;
     }
@@ -23,9 +23,12 @@
 #include "stdafx.h"
 
 #include "SamplerState.h"
+#include "Texture.h"
+#include "Renderer.h"
 using namespace Synesthesia3D;
 
 SamplerState::SamplerState()
+    : m_nDirtySlotMask((1u << MAX_NUM_PSAMPLERS) - 1u)
 {
     for (unsigned int i = 0; i < MAX_NUM_PSAMPLERS; i++)
     {
@@ -36,6 +39,7 @@ SamplerState::SamplerState()
         for (unsigned int j = 0; j < 3; j++)
             m_tCurrentState[i].eAddressingMode[j] = SAM_WRAP;
         m_tCurrentState[i].bSRGBEnabled = false;
+        m_pBoundTexture[i] = nullptr;
     }
 }
 
@@ -45,21 +49,43 @@ SamplerState::~SamplerState()
 const bool SamplerState::SetAnisotropy(const unsigned int slot, const unsigned int anisotropy)
 {
     assert(slot < MAX_NUM_PSAMPLERS);
-    m_tCurrentState[slot].nAnisotropy = Math::clamp(anisotropy, 1u, (unsigned int)MAX_ANISOTROPY);
+    const unsigned int clampedAnisotropy = Math::clamp(anisotropy, 1u, (unsigned int)MAX_ANISOTROPY);
+    if (m_tCurrentState[slot].nAnisotropy == clampedAnisotropy)
+    {
+        Renderer::IncrementCounter(RC_FILTERED_SAMPLER_STATE_CHANGES);
+        return true;
+    }
+
+    m_tCurrentState[slot].nAnisotropy = clampedAnisotropy;
+    MarkSlotDirty(slot);
     return true;
 }
 
 const bool SamplerState::SetMipLodBias(const unsigned int slot, const float lodBias)
 {
     assert(slot < MAX_NUM_PSAMPLERS);
+    if (m_tCurrentState[slot].fLodBias == lodBias)
+    {
+        Renderer::IncrementCounter(RC_FILTERED_SAMPLER_STATE_CHANGES);
+        return true;
+    }
+
     m_tCurrentState[slot].fLodBias = lodBias;
+    MarkSlotDirty(slot);
     return true;
 }
 
 const bool SamplerState::SetFilter(const unsigned int slot, const SamplerFilter filter)
 {
     assert(slot < MAX_NUM_PSAMPLERS);
+    if (m_tCurrentState[slot].eFilter == filter)
+    {
+        Renderer::IncrementCounter(RC_FILTERED_SAMPLER_STATE_CHANGES);
+        return true;
+    }
+
     m_tCurrentState[slot].eFilter = filter;
+    MarkSlotDirty(slot);
     return true;
 }
 
@@ -73,28 +99,56 @@ const bool SamplerState::SetBorderColor(const unsigned int slot, const Vec4f& rg
         );
 
     assert(slot < MAX_NUM_PSAMPLERS);
+    if (m_tCurrentState[slot].vBorderColor == rgba)
+    {
+        Renderer::IncrementCounter(RC_FILTERED_SAMPLER_STATE_CHANGES);
+        return true;
+    }
+
     m_tCurrentState[slot].vBorderColor = rgba;
+    MarkSlotDirty(slot);
     return true;
 }
 
 const bool SamplerState::SetAddressingModeU(const unsigned int slot, const SamplerAddressingMode samU)
 {
     assert(slot < MAX_NUM_PSAMPLERS);
+    if (m_tCurrentState[slot].eAddressingMode[0] == samU)
+    {
+        Renderer::IncrementCounter(RC_FILTERED_SAMPLER_STATE_CHANGES);
+        return true;
+    }
+
     m_tCurrentState[slot].eAddressingMode[0] = samU;
+    MarkSlotDirty(slot);
     return true;
 }
 
 const bool SamplerState::SetAddressingModeV(const unsigned int slot, const SamplerAddressingMode samV)
 {
     assert(slot < MAX_NUM_PSAMPLERS);
+    if (m_tCurrentState[slot].eAddressingMode[1] == samV)
+    {
+        Renderer::IncrementCounter(RC_FILTERED_SAMPLER_STATE_CHANGES);
+        return true;
+    }
+
     m_tCurrentState[slot].eAddressingMode[1] = samV;
+    MarkSlotDirty(slot);
     return true;
 }
 
 const bool SamplerState::SetAddressingModeW(const unsigned int slot, const SamplerAddressingMode samW)
 {
     assert(slot < MAX_NUM_PSAMPLERS);
+    if (m_tCurrentState[slot].eAddressingMode[2] == samW)
+    {
+        Renderer::IncrementCounter(RC_FILTERED_SAMPLER_STATE_CHANGES);
+        return true;
+    }
+
     m_tCurrentState[slot].eAddressingMode[2] = samW;
+    MarkSlotDirty(slot);
     return true;
 }
 
@@ -109,7 +163,14 @@ const bool SamplerState::SetAddressingMode(const unsigned int slot, const Sample
 const bool SamplerState::SetSRGBEnabled(const unsigned int slot, const bool enabled)
 {
     assert(slot < MAX_NUM_PSAMPLERS);
+    if (m_tCurrentState[slot].bSRGBEnabled == enabled)
+    {
+        Renderer::IncrementCounter(RC_FILTERED_SAMPLER_STATE_CHANGES);
+        return true;
+    }
+
     m_tCurrentState[slot].bSRGBEnabled = enabled;
+    MarkSlotDirty(slot);
     return true;
 }
 
@@ -182,5 +243,56 @@ void SamplerState::Reset()
         SetSRGBEnabled(slot, false);
     }
 
+    // The backend may have resynchronized its view of the device
+    // states, so push all slots regardless of what has changed.
+    m_nDirtySlotMask = (1u << MAX_NUM_PSAMPLERS) - 1u;
+
     Flush();
 }
+
+void SamplerState::BindTexture(const unsigned int slot, const Texture* const texture)
+{
+    assert(slot < MAX_NUM_PSAMPLERS);
+    if (m_pBoundTexture[slot] == texture)
+    {
+        Renderer::IncrementCounter(RC_FILTERED_TEXTURE_BINDS);
+        return;
+    }
+
+    if (texture)
+        texture->Enable(slot);
+    else
+        m_pBoundTexture[slot]->Disable(slot);
+
+    m_pBoundTexture[slot] = texture;
+    Renderer::IncrementCounter(RC_TEXTURE_BINDS);
+}
+
+void SamplerState::UnbindTexture(const Texture* const texture)
+{
+    if (texture == nullptr)
+        return;
+
+    for (unsigned int slot = 0; slot < MAX_NUM_PSAMPLERS; slot++)
+    {
+        if (m_pBoundTexture[slot] == texture)
+        {
+            texture->Disable(slot);
+            m_pBoundTexture[slot] = nullptr;
+            Renderer::IncrementCounter(RC_TEXTURE_BINDS);
+        }
+    }
+}
+
+const Texture* const SamplerState::GetBoundTexture(const unsigned int slot) const
+{
+    assert(slot < MAX_NUM_PSAMPLERS);
+    return m_pBoundTexture[slot];
+}
+
+void SamplerState::MarkSlotDirty(const unsigned int slot)
+{
+    assert(slot < MAX_NUM_PSAMPLERS);
+    m_nDirtySlotMask |= (1u << slot);
+    Renderer::IncrementCounter(RC_SAMPLER_STATE_CHANGES);
+}
@@ -28,6 +28,7 @@
 namespace Synesthesia3D
 {
     class Renderer;
+    class Texture;
 
     /**
      * @brief   Manages texture sampler states.
@@ -221,6 +222,35 @@ namespace Synesthesia3D
          */
         virtual SYNESTHESIA3D_DLL       void    Reset();
 
+
+
+        /**
+         * @brief   Binds a texture to the specified sampler slot.
+         * @note    The call does not reach the underlying API if the texture
+         *          is already bound to that slot. Passing nullptr unbinds
+         *          whatever texture is bound to the slot.
+         *
+         * @param[in]   slot        Texture sampler index.
+         * @param[in]   texture     Texture to bind.
+         */
+                SYNESTHESIA3D_DLL   void    BindTexture(const unsigned int slot, const Texture* const texture);
+
+        /**
+         * @brief   Unbinds a texture from all the sampler slots it is bound to.
+         *
+         * @param[in]   texture     Texture to unbind.
+         */
+                SYNESTHESIA3D_DLL   void    UnbindTexture(const Texture* const texture);
+
+        /**
+         * @brief   Retrieves the texture bound to the specified sampler slot.
+         *
+         * @param[in]   slot        Texture sampler index.
+         *
+         * @return  Bound texture, or nullptr if the slot is empty.
+         */
+                SYNESTHESIA3D_DLL   const Texture* const    GetBoundTexture(const unsigned int slot) const;
+
     protected:
 
         /**
@@ -240,7 +270,16 @@ namespace Synesthesia3D
          */
         virtual const bool  Flush() PURE_VIRTUAL;
 
+        /**
+         * @brief   Marks the specified sampler slot as needing a flush.
+         *
+         * @param[in]   slot        Texture sampler index.
+         */
+                    void    MarkSlotDirty(const unsigned int slot);
+
         SamplerStateDesc m_tCurrentState[MAX_NUM_PSAMPLERS];    /**< @brief The current sampler states for all @ref MAX_NUM_PSAMPLERS slots. */
+        unsigned int    m_nDirtySlotMask;                       /**< @brief Bit mask of slots with sampler states not yet pushed by @ref Flush(). */
+        const Texture*  m_pBoundTexture[MAX_NUM_PSAMPLERS];     /**< @brief The textures currently bound to all @ref MAX_NUM_PSAMPLERS slots. */
 
         friend class Renderer;
     };
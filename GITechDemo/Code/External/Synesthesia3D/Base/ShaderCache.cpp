@@ -0,0 +1,347 @@
+/**
+ * @file        ShaderCache.cpp
+ *
+ * @note        This file is part of the "Synesthesia3D" graphics engine
+ *
+ * @copyright   Copyright (C) Iftode Bogdan-Marius <iftode.bogdan@gmail.com>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * @copyright
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ * @copyright
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "stdafx.h"
+
+#include "ShaderCache.h"
+#include "AssetPack.h"
+using namespace Synesthesia3D;
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <thread>
+#include <cstdio>
+
+#ifndef WIN32
+    #include <sys/stat.h>
+#endif
+
+// 64 bit FNV-1a
+static void HashData(unsigned long long& hash, const void* const data, const size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= ((const unsigned char*)data)[i];
+        hash *= 1099511628211ull;
+    }
+}
+
+static void HashString(unsigned long long& hash, const std::string& str)
+{
+    // Include the terminator, so that consecutive strings can't be split differently to the same hash
+    HashData(hash, str.c_str(), str.length() + 1);
+}
+
+static const bool ReadWholeFile(const std::string& filePath, std::string& contents)
+{
+    std::ifstream file(filePath.c_str(), std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    std::ostringstream oss;
+    oss << file.rdbuf();
+    contents = oss.str();
+
+    return true;
+}
+
+ShaderCache::ShaderCache()
+    : m_nHitCount(0)
+    , m_nMissCount(0)
+{}
+
+ShaderCache::~ShaderCache()
+{}
+
+void ShaderCache::SetDirectory(const char* const dirPath)
+{
+    m_szDirectory = dirPath ? dirPath : "";
+
+    while (!m_szDirectory.empty() && (m_szDirectory.back() == '/' || m_szDirectory.back() == '\\'))
+        m_szDirectory.pop_back();
+
+    if (!m_szDirectory.empty())
+    {
+#ifdef WIN32
+        CreateDirectoryA(m_szDirectory.c_str(), NULL);
+#else
+        mkdir(m_szDirectory.c_str(), 0755);
+#endif
+    }
+}
+
+const char* ShaderCache::GetDirectory() const
+{
+    return m_szDirectory.c_str();
+}
+
+const bool ShaderCache::IsEnabled() const
+{
+    return !m_szDirectory.empty();
+}
+
+const unsigned long long ShaderCache::ComputeKey(
+    const char* const filePath, const std::vector<std::string>& macros, const char* const entryPoint,
+    const char* const profile, const unsigned int flags, const unsigned int compilerVersion,
+    std::vector<std::string>* const includeFiles)
+{
+    if (!std::ifstream(filePath).is_open())
+        return 0;
+
+    unsigned long long hash = 14695981039346656037ull;
+
+    std::vector<std::string> visitedFiles;
+    HashSourceFile(filePath, hash, visitedFiles);
+
+    const unsigned int macroCount = (unsigned int)macros.size();
+    HashData(hash, &macroCount, sizeof(macroCount));
+    for (unsigned int i = 0; i < macroCount; i++)
+        HashString(hash, macros[i]);
+
+    HashString(hash, entryPoint);
+    HashString(hash, profile);
+    HashData(hash, &flags, sizeof(flags));
+    HashData(hash, &compilerVersion, sizeof(compilerVersion));
+
+    if (includeFiles)
+        *includeFiles = visitedFiles;
+
+    // 0 is reserved for failure
+    return hash ? hash : 1;
+}
+
+void ShaderCache::HashSourceFile(const std::string& filePath, unsigned long long& hash, std::vector<std::string>& visitedFiles)
+{
+    // Each file contributes once, which also guards against circular includes
+    const std::string normalizedPath = AssetPack::NormalizePath(filePath.c_str());
+    for (unsigned int i = 0; i < visitedFiles.size(); i++)
+        if (AssetPack::NormalizePath(visitedFiles[i].c_str()) == normalizedPath)
+            return;
+
+    visitedFiles.push_back(filePath);
+
+    std::string source;
+    const bool found = ReadWholeFile(filePath, source);
+
+    // Missing files are accounted for, so that creating them changes the key
+    HashString(hash, normalizedPath);
+    HashData(hash, &found, sizeof(found));
+    HashString(hash, source);
+
+    if (!found)
+        return;
+
+    const size_t dirEnd = filePath.find_last_of("/\\");
+    const std::string dirPath = dirEnd != std::string::npos ? filePath.substr(0, dirEnd + 1) : "";
+
+    std::istringstream sourceStream(source);
+    std::string line;
+    while (std::getline(sourceStream, line))
+    {
+        size_t pos = line.find_first_not_of(" \t");
+        if (pos == std::string::npos || line[pos] != '#')
+            continue;
+
+        pos = line.find_first_not_of(" \t", pos + 1);
+        if (pos == std::string::npos || line.compare(pos, 7, "include") != 0)
+            continue;
+
+        pos = line.find_first_not_of(" \t", pos + 7);
+        if (pos == std::string::npos || (line[pos] != '"' && line[pos] != '<'))
+            continue;
+
+        const size_t nameEnd = line.find(line[pos] == '"' ? '"' : '>', pos + 1);
+        if (nameEnd == std::string::npos)
+            continue;
+
+        const std::string includeName = line.substr(pos + 1, nameEnd - pos - 1);
+
+        // Same search order as the default include handler: the including file's directory, then the current one
+        std::string includePath = dirPath + includeName;
+        if (!std::ifstream(includePath.c_str()).is_open() && std::ifstream(includeName.c_str()).is_open())
+            includePath = includeName;
+
+        HashSourceFile(includePath, hash, visitedFiles);
+    }
+}
+
+const std::string ShaderCache::GetEntryFilePath(const unsigned long long key) const
+{
+    std::ostringstream oss;
+    oss << m_szDirectory << "/" << std::hex << std::setw(16) << std::setfill('0') << key << S3D_SHADER_CACHE_FILE_EXTENSION;
+    return oss.str();
+}
+
+const bool ShaderCache::Load(const unsigned long long key, std::vector<char>& bytecode, std::vector<ShaderInputDesc>& inputDesc)
+{
+    if (!IsEnabled() || key == 0)
+        return false;
+
+    std::string fileData;
+    if (!ReadWholeFile(GetEntryFilePath(key), fileData))
+    {
+        m_nMissCount++;
+        return false;
+    }
+
+    std::istringstream entryFile(fileData);
+
+    char fileSignature[S3D_SHADER_CACHE_FILE_HEADER_SIZE];
+    entryFile.read(fileSignature, S3D_SHADER_CACHE_FILE_HEADER_SIZE);
+
+    unsigned int fileVersion = 0;
+    unsigned long long fileKey = 0;
+    unsigned int bytecodeSize = 0;
+    entryFile.read((char*)&fileVersion, sizeof(unsigned int));
+    entryFile.read((char*)&fileKey, sizeof(unsigned long long));
+    entryFile.read((char*)&bytecodeSize, sizeof(unsigned int));
+
+    // Entries of other versions are recompiled and overwritten
+    bool valid =
+        entryFile &&
+        memcmp(S3D_SHADER_CACHE_FILE_HEADER, fileSignature, S3D_SHADER_CACHE_FILE_HEADER_SIZE) == 0 &&
+        fileVersion == S3D_SHADER_CACHE_FILE_VERSION &&
+        fileKey == key &&
+        bytecodeSize > 0 && bytecodeSize <= fileData.size();
+
+    if (valid)
+    {
+        bytecode.resize(bytecodeSize);
+        entryFile.read(bytecode.data(), bytecodeSize);
+
+        unsigned int inputCount = 0;
+        entryFile.read((char*)&inputCount, sizeof(unsigned int));
+        valid = entryFile && inputCount <= fileData.size();
+
+        inputDesc.clear();
+        for (unsigned int i = 0; i < inputCount && valid; i++)
+        {
+            ShaderInputDesc desc;
+            unsigned int nameLength = 0, inputType = IT_NONE, registerType = RT_NONE;
+            entryFile.read((char*)&nameLength, sizeof(unsigned int));
+            valid = entryFile && nameLength <= fileData.size();
+            if (!valid)
+                break;
+            desc.szName.resize(nameLength);
+            entryFile.read(&desc.szName[0], nameLength);
+            entryFile.read((char*)&desc.nNameHash, sizeof(unsigned int));
+            entryFile.read((char*)&inputType, sizeof(unsigned int));
+            entryFile.read((char*)&registerType, sizeof(unsigned int));
+            entryFile.read((char*)&desc.nRegisterIndex, sizeof(unsigned int));
+            entryFile.read((char*)&desc.nRegisterCount, sizeof(unsigned int));
+            entryFile.read((char*)&desc.nRows, sizeof(unsigned int));
+            entryFile.read((char*)&desc.nColumns, sizeof(unsigned int));
+            entryFile.read((char*)&desc.nArrayElements, sizeof(unsigned int));
+            entryFile.read((char*)&desc.nBytes, sizeof(unsigned int));
+            entryFile.read((char*)&desc.nOffsetInBytes, sizeof(unsigned int));
+            desc.eInputType = (InputType)inputType;
+            desc.eRegisterType = (RegisterType)registerType;
+            valid = !entryFile.fail();
+            inputDesc.push_back(desc);
+        }
+    }
+
+    if (!valid)
+    {
+        bytecode.clear();
+        inputDesc.clear();
+        m_nMissCount++;
+        return false;
+    }
+
+    m_nHitCount++;
+    return true;
+}
+
+const bool ShaderCache::Store(const unsigned long long key, const void* const bytecode, const unsigned int bytecodeSize, const std::vector<ShaderInputDesc>& inputDesc)
+{
+    if (!IsEnabled() || key == 0 || !bytecode || bytecodeSize == 0)
+        return false;
+
+    // Write to a temporary file first, so that other threads (or instances) never read a partial entry
+    const std::string entryFilePath = GetEntryFilePath(key);
+    std::ostringstream tempFilePath;
+    tempFilePath << entryFilePath << "." << std::hash<std::thread::id>()(std::this_thread::get_id()) << ".tmp";
+
+    std::ofstream entryFile(tempFilePath.str().c_str(), std::ios::binary | std::ios::trunc);
+    if (!entryFile.is_open())
+        return false;
+
+    const unsigned int fileVersion = S3D_SHADER_CACHE_FILE_VERSION;
+    const unsigned int inputCount = (unsigned int)inputDesc.size();
+    entryFile.write(S3D_SHADER_CACHE_FILE_HEADER, S3D_SHADER_CACHE_FILE_HEADER_SIZE);
+    entryFile.write((const char*)&fileVersion, sizeof(unsigned int));
+    entryFile.write((const char*)&key, sizeof(unsigned long long));
+    entryFile.write((const char*)&bytecodeSize, sizeof(unsigned int));
+    entryFile.write((const char*)bytecode, bytecodeSize);
+    entryFile.write((const char*)&inputCount, sizeof(unsigned int));
+
+    for (unsigned int i = 0; i < inputCount; i++)
+    {
+        const ShaderInputDesc& desc = inputDesc[i];
+        const unsigned int nameLength = (unsigned int)desc.szName.length();
+        const unsigned int inputType = desc.eInputType;
+        const unsigned int registerType = desc.eRegisterType;
+        entryFile.write((const char*)&nameLength, sizeof(unsigned int));
+        entryFile.write(desc.szName.c_str(), nameLength);
+        entryFile.write((const char*)&desc.nNameHash, sizeof(unsigned int));
+        entryFile.write((const char*)&inputType, sizeof(unsigned int));
+        entryFile.write((const char*)&registerType, sizeof(unsigned int));
+        entryFile.write((const char*)&desc.nRegisterIndex, sizeof(unsigned int));
+        entryFile.write((const char*)&desc.nRegisterCount, sizeof(unsigned int));
+        entryFile.write((const char*)&desc.nRows, sizeof(unsigned int));
+        entryFile.write((const char*)&desc.nColumns, sizeof(unsigned int));
+        entryFile.write((const char*)&desc.nArrayElements, sizeof(unsigned int));
+        entryFile.write((const char*)&desc.nBytes, sizeof(unsigned int));
+        entryFile.write((const char*)&desc.nOffsetInBytes, sizeof(unsigned int));
+    }
+
+    const bool success = !entryFile.fail();
+    entryFile.close();
+
+    if (!success)
+    {
+        std::remove(tempFilePath.str().c_str());
+        return false;
+    }
+
+    // Renaming doesn't replace existing files on all platforms
+    std::remove(entryFilePath.c_str());
+    if (std::rename(tempFilePath.str().c_str(), entryFilePath.c_str()) != 0)
+    {
+        std::remove(tempFilePath.str().c_str());
+        return false;
+    }
+
+    return true;
+}
+
+const unsigned int ShaderCache::GetHitCount() const
+{
+    return m_nHitCount;
+}
+
+const unsigned int ShaderCache::GetMissCount() const
+{
+    return m_nMissCount;
+}
@@ -0,0 +1,166 @@
+/**
+ * @file        ShaderCache.h
+ *
+ * @note        This file is part of the "Synesthesia3D" graphics engine
+ *
+ * @copyright   Copyright (C) Iftode Bogdan-Marius <iftode.bogdan@gmail.com>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * @copyright
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ * @copyright
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SHADERCACHE_H
+#define SHADERCACHE_H
+
+#include <vector>
+#include <string>
+#include <atomic>
+
+#include "ResourceData.h"
+
+#define S3D_SHADER_CACHE_FILE_VERSION (2)
+#define S3D_SHADER_CACHE_FILE_HEADER "\x89S3DSHC\x0d\x0a\x1a\x0a"
+#define S3D_SHADER_CACHE_FILE_HEADER_SIZE (sizeof(S3D_SHADER_CACHE_FILE_HEADER) - 1)
+#define S3D_SHADER_CACHE_FILE_EXTENSION ".s3dshc"
+
+namespace Synesthesia3D
+{
+    /**
+     * @brief   Persistent cache of compiled shader programs.
+     *
+     * @details Each entry holds the bytecode of a shader program along with its reflected @ref ShaderInputDesc
+     *          table, so that a cache hit needs neither compilation nor reflection. Entries are stored on disk,
+     *          one file per entry, named after their key. The key is a hash of everything the compiler's output
+     *          depends on: the contents of the source file and of every file it includes (recursively), the
+     *          macros, the entry point, the profile, the compilation flags and the compiler's version. Stale
+     *          entries are never matched again, as editing any of these changes the key.
+     *
+     * @note    Platform independent; backends compute the key before compiling (see @ref ComputeKey()), then
+     *          either @ref Load() the entry or compile the program and @ref Store() it. All methods can be
+     *          called concurrently from multiple threads.
+     */
+    class ShaderCache
+    {
+
+    public:
+
+        /**
+         * @brief   Sets the directory in which entries are stored, creating it if needed.
+         *
+         * @param[in]   dirPath     Path to the cache directory. An empty path disables the cache.
+         *
+         * @note    Must not be called while shader programs are being compiled.
+         */
+                SYNESTHESIA3D_DLL       void            SetDirectory(const char* const dirPath);
+
+        /**
+         * @brief   Retrieves the directory in which entries are stored.
+         */
+                SYNESTHESIA3D_DLL       const char*     GetDirectory() const;
+
+        /**
+         * @brief   Checks whether entries are looked up and stored.
+         */
+                SYNESTHESIA3D_DLL       const bool      IsEnabled() const;
+
+        /**
+         * @brief   Computes the key of a shader program.
+         *
+         * @details Files referenced by #include directives are resolved relative to the including file, then to
+         *          the current directory. Conditional compilation is not evaluated, so all files referenced by the
+         *          source contribute to the key, even if the preprocessor would skip some of them.
+         *
+         * @param[in]   filePath            Path to the shader's source file.
+         * @param[in]   macros              Macro definitions, as "NAME=VALUE" strings.
+         * @param[in]   entryPoint          Entry function name.
+         * @param[in]   profile             Target profile.
+         * @param[in]   flags               Compilation flags.
+         * @param[in]   compilerVersion     Version of the compiler.
+         * @param[out]  includeFiles        Optional. Receives the source file and the files it includes.
+         *
+         * @return  The key, or 0 if the source file could not be read.
+         */
+        static  SYNESTHESIA3D_DLL   const unsigned long long ComputeKey(
+                    const char* const filePath, const std::vector<std::string>& macros, const char* const entryPoint,
+                    const char* const profile, const unsigned int flags, const unsigned int compilerVersion,
+                    std::vector<std::string>* const includeFiles = nullptr);
+
+        /**
+         * @brief   Loads an entry.
+         *
+         * @param[in]   key         Key of the entry, as computed by @ref ComputeKey().
+         * @param[out]  bytecode    Compiled shader program.
+         * @param[out]  inputDesc   Reflected shader inputs of the program.
+         *
+         * @return  True if the entry was found and is valid.
+         */
+                SYNESTHESIA3D_DLL       const bool      Load(const unsigned long long key, std::vector<char>& bytecode, std::vector<ShaderInputDesc>& inputDesc);
+
+        /**
+         * @brief   Stores an entry, replacing any existing one with the same key.
+         *
+         * @param[in]   key             Key of the entry, as computed by @ref ComputeKey().
+         * @param[in]   bytecode        Compiled shader program.
+         * @param[in]   bytecodeSize    Size, in bytes, of the compiled shader program.
+         * @param[in]   inputDesc       Reflected shader inputs of the program.
+         *
+         * @return  Success of operation.
+         */
+                SYNESTHESIA3D_DLL       const bool      Store(const unsigned long long key, const void* const bytecode, const unsigned int bytecodeSize, const std::vector<ShaderInputDesc>& inputDesc);
+
+        /**
+         * @brief   Retrieves the number of entries found by @ref Load().
+         */
+                SYNESTHESIA3D_DLL   const unsigned int  GetHitCount() const;
+
+        /**
+         * @brief   Retrieves the number of entries not found by @ref Load().
+         */
+                SYNESTHESIA3D_DLL   const unsigned int  GetMissCount() const;
+
+    protected:
+
+        /**
+         * @brief   Constructor.
+         *
+         * @details Meant to be used only by @ref Renderer. The cache is disabled until @ref SetDirectory() is called.
+         */
+        ShaderCache();
+
+        /**
+         * @brief   Destructor.
+         *
+         * @details Meant to be used only by @ref Renderer.
+         */
+        ~ShaderCache();
+
+        /**
+         * @brief   Retrieves the path of the file holding an entry.
+         */
+        const std::string GetEntryFilePath(const unsigned long long key) const;
+
+        /**
+         * @brief   Hashes a file and, recursively, the files it includes.
+         */
+        static void HashSourceFile(const std::string& filePath, unsigned long long& hash, std::vector<std::string>& visitedFiles);
+
+        std::string                 m_szDirectory;      /**< @brief Directory in which entries are stored. */
+        std::atomic<unsigned int>   m_nHitCount;        /**< @brief Number of entries found. */
+        std::atomic<unsigned int>   m_nMissCount;       /**< @brief Number of entries not found. */
+
+        friend class Renderer;
+    };
+}
+
+#endif // SHADERCACHE_H
@@ -46,27 +46,70 @@ using namespace Synesthesia3D;
 
 
 ShaderInput::ShaderInput(ShaderProgram* const shaderProgram)
-    : Buffer(shaderProgram->GetTotalSizeOfInputConstants(), 1u, BU_NONE)
+    : Buffer(shaderProgram->GetTotalSizeOfInputConstants(), 1u, BU_NONE, AT_SHADER_INPUTS)
     , m_pShaderProgram(shaderProgram)
 {
     assert(shaderProgram);
+
+    // Nothing has been uploaded yet
+    m_arrDirtyInput.resize(shaderProgram->m_arrInputDesc.size(), true);
+
+    BuildUploadPlan();
 }
 
 ShaderInput::~ShaderInput()
-{}
+{
+    // Don't let a shader input allocated at the same address be mistaken for this one
+    for (unsigned int spt = SPT_NONE; spt < SPT_MAX; spt++)
+        if (ShaderProgram::ms_pResidentShaderInput[spt] == this)
+            ShaderProgram::ms_pResidentShaderInput[spt] = nullptr;
+}
 
-const bool ShaderInput::GetInputHandleByName(const char* const inputName, unsigned int& inputHandle) const
+void ShaderInput::BuildUploadPlan()
 {
-    const unsigned int nNameHash = S3DHASH(inputName);
+    m_arrUploadPlan.clear();
 
-    for (unsigned int i = 0, n = (unsigned int)m_pShaderProgram->m_arrInputDesc.size(); i < n; i++)
+    const std::vector<ShaderInputDesc>& inputDesc = m_pShaderProgram->m_arrInputDesc;
+    for (unsigned int i = 0, n = (unsigned int)inputDesc.size(); i < n; i++)
     {
-        //if (m_pShaderProgram->m_arrInputDesc[i].szName.compare(inputName) == 0)
-        if (m_pShaderProgram->m_arrInputDesc[i].nNameHash == nNameHash)
+        if (inputDesc[i].eInputType < IT_STRUCT || inputDesc[i].eInputType > IT_FLOAT)
+            continue;
+
+        // Inputs are laid out in the buffer in the same order as their descriptors, so only consecutive
+        // descriptors can be merged: they have to continue both the register range and the data of the
+        // previous input (bool inputs use one byte per register, the others a full 4 component register)
+        if (m_arrUploadPlan.size())
         {
-            inputHandle = i;
-            return true;
+            UploadRange& range = m_arrUploadPlan.back();
+            const ShaderInputDesc& prevDesc = inputDesc[range.nFirstInput + range.nInputCount - 1];
+            const unsigned int registerSize = prevDesc.eRegisterType == RT_BOOL ? sizeof(bool) : sizeof(float) * 4u;
+
+            if (range.nFirstInput + range.nInputCount == i &&
+                prevDesc.eRegisterType == inputDesc[i].eRegisterType &&
+                prevDesc.nRegisterIndex + prevDesc.nRegisterCount == inputDesc[i].nRegisterIndex &&
+                prevDesc.nOffsetInBytes + prevDesc.nRegisterCount * registerSize == inputDesc[i].nOffsetInBytes)
+            {
+                range.nInputCount++;
+                continue;
+            }
         }
+
+        UploadRange range;
+        range.nFirstInput = i;
+        range.nInputCount = 1;
+        m_arrUploadPlan.push_back(range);
+    }
+}
+
+const bool ShaderInput::GetInputHandleByName(const char* const inputName, unsigned int& inputHandle) const
+{
+    const unsigned int nNameHash = S3DHASH(inputName);
+
+    const auto it = m_pShaderProgram->m_mapInputHandle.find(nNameHash);
+    if (it != m_pShaderProgram->m_mapInputHandle.end())
+    {
+        inputHandle = it->second;
+        return true;
     }
 
     inputHandle = ~0u;
@@ -83,13 +126,11 @@ const bool ShaderInput::GetInputHandleByName(const char* const inputName, unsign
 
 const bool ShaderInput::GetInputHandleByNameHash(const unsigned int inputNameHash, unsigned int& inputHandle) const
 {
-    for (unsigned int i = 0, n = (unsigned int)m_pShaderProgram->m_arrInputDesc.size(); i < n; i++)
+    const auto it = m_pShaderProgram->m_mapInputHandle.find(inputNameHash);
+    if (it != m_pShaderProgram->m_mapInputHandle.end())
     {
-        if (m_pShaderProgram->m_arrInputDesc[i].nNameHash == inputNameHash)
-        {
-            inputHandle = i;
-            return true;
-        }
+        inputHandle = it->second;
+        return true;
     }
 
     inputHandle = ~0u;
@@ -108,6 +149,7 @@ void ShaderInput::SetBoolArray(const unsigned int handle, const bool* const data
 {
     assert(handle < m_pShaderProgram->m_arrInputDesc.size());
     const ShaderInputDesc& desc = m_pShaderProgram->m_arrInputDesc[handle];
+    m_arrDirtyInput[handle] = true;
     
     switch (desc.eRegisterType)
     {
@@ -173,6 +215,7 @@ void ShaderInput::SetFloatArray(const unsigned int handle, const float* const da
 {
     assert(handle < m_pShaderProgram->m_arrInputDesc.size());
     const ShaderInputDesc& desc = m_pShaderProgram->m_arrInputDesc[handle];
+    m_arrDirtyInput[handle] = true;
     for (unsigned int i = 0; i < desc.nArrayElements; i++)
     {
         memcpy(
@@ -222,6 +265,7 @@ void ShaderInput::SetIntArray(const unsigned int handle, const int* const data)
 {
     assert(handle < m_pShaderProgram->m_arrInputDesc.size());
     const ShaderInputDesc& desc = m_pShaderProgram->m_arrInputDesc[handle];
+    m_arrDirtyInput[handle] = true;
 
     switch (desc.eRegisterType)
     {
@@ -533,6 +577,7 @@ void ShaderInput::SetTexture(const unsigned int handle, const unsigned int texId
 {
     assert(handle < m_pShaderProgram->m_arrInputDesc.size());
     const ShaderInputDesc& desc = m_pShaderProgram->m_arrInputDesc[handle];
+    m_arrDirtyInput[handle] = true;
 
     assert(
         texIdx == -1 ||
@@ -572,6 +617,7 @@ inline void ShaderInput::SetStructArray(const unsigned int handle, const void* c
 {
     assert(handle < m_pShaderProgram->m_arrInputDesc.size());
     const ShaderInputDesc& desc = m_pShaderProgram->m_arrInputDesc[handle];
+    m_arrDirtyInput[handle] = true;
     assert(desc.eInputType == IT_STRUCT);
     memcpy(
         m_pData + desc.nOffsetInBytes,
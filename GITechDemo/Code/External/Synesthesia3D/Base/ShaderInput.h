@@ -35,6 +35,7 @@ namespace Synesthesia3D
      */
     class ShaderInput : public Buffer
     {
+        S3D_ALLOCATION_TAG(AT_SHADER_INPUTS)
 
     public:
 
@@ -534,7 +535,7 @@ namespace Synesthesia3D
         
         /**
          * @brief   Retrieves the handle of the shader constant which matches the supplied name hash.
-         * @note    Use @ref S3DHASH() from Utility/Hash.h to generate the hash.
+         * @note    Use @ref S3DHASH() or @ref StringHash from Utility/Hash.h to generate the hash.
          *
          * @param[in]   inputNameHash   Hash of the name of the shader constant (as appears in the shader).
          * @param[out]  inputHandle     Handle for the shader constant.
@@ -580,9 +581,28 @@ namespace Synesthesia3D
          */
         virtual ~ShaderInput();
 
-        ShaderProgram* m_pShaderProgram;    /**< @brief Pointer to the corresponding shader program. */
+        /**
+         * @brief   A run of consecutive shader inputs occupying adjacent registers of the same type,
+         *          whose data is also laid out contiguously, so that they can be uploaded with a single call.
+         */
+        struct UploadRange
+        {
+            unsigned int nFirstInput;   /**< @brief Handle of the first shader input in the range. */
+            unsigned int nInputCount;   /**< @brief Number of shader inputs in the range. */
+        };
+
+        /**
+         * @brief   Groups the constant shader inputs into ranges that can be uploaded together.
+         */
+        void BuildUploadPlan();
+
+        ShaderProgram* m_pShaderProgram;            /**< @brief Pointer to the corresponding shader program. */
+        std::vector<bool, StlAllocator<bool, AT_SHADER_INPUTS>> m_arrDirtyInput;            /**< @brief Flags the shader inputs which have been modified since their registers were last uploaded. */
+        std::vector<UploadRange, StlAllocator<UploadRange, AT_SHADER_INPUTS>> m_arrUploadPlan; /**< @brief Ranges of constant shader inputs which can be merged into a single upload. */
 
         friend class ResourceManager;
+        friend class ShaderProgram;
+        friend class RenderTrace;
     };
 }
 
@@ -37,6 +37,7 @@ namespace Synesthesia3D
         assert((desc.eRegisterType == RT_BOOL) == (typeid(T) == typeid(bool)));
         assert((desc.eRegisterType == RT_INT4) == (typeid(T) == typeid(int)));
         assert((desc.eRegisterType == RT_FLOAT4) == (typeid(T) == typeid(float)));
+        m_arrDirtyInput[handle] = true;
         for (unsigned int i = 0; i < desc.nArrayElements; i++)
         {
             for (unsigned int j = 0; j < desc.nColumns; j++)
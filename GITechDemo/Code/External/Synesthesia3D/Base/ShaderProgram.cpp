@@ -29,10 +29,13 @@
 #include "Texture.h"
 #include "ResourceManager.h"
 #include "Profiler.h"
+#include "RenderTrace.h"
 using namespace Synesthesia3D;
 
 #include "Utility/Hash.h"
 
+ShaderInput* ShaderProgram::ms_pResidentShaderInput[SPT_MAX] = { nullptr };
+
 ShaderProgram::ShaderProgram(const ShaderProgramType programType)
     : m_eProgramType(programType)
     , m_pShaderInput(nullptr)
@@ -48,6 +51,9 @@ void ShaderProgram::DescribeShaderInputs()
     const unsigned int paramCount = GetConstantCount();
     unsigned int offset = 0;
 
+    // Recompiling (e.g. after a device reset) describes the inputs anew
+    m_arrInputDesc.clear();
+
     for (unsigned int i = 0; i < paramCount; i++)
     {
         ShaderInputDesc inputDesc;
@@ -67,6 +73,18 @@ void ShaderProgram::DescribeShaderInputs()
 
         m_arrInputDesc.push_back(inputDesc);
     }
+
+    IndexShaderInputs();
+}
+
+void ShaderProgram::IndexShaderInputs()
+{
+    m_mapInputHandle.clear();
+    m_mapInputHandle.reserve(m_arrInputDesc.size());
+
+    // In case of name hash collisions, the first input wins, same as a linear search would
+    for (unsigned int i = 0, n = (unsigned int)m_arrInputDesc.size(); i < n; i++)
+        m_mapInputHandle.emplace(m_arrInputDesc[i].nNameHash, i);
 }
 
 const unsigned int ShaderProgram::GetTotalNumberOfUsedRegisters() const
@@ -101,16 +119,13 @@ void ShaderProgram::Disable()
 {
     //assert((m_pShaderInput && m_arrInputDesc.size()) || (!m_pShaderInput && !m_arrInputDesc.size()) || (Renderer::GetAPI() == API_NULL));
 
-    for (unsigned int i = 0, n = (unsigned int)m_arrInputDesc.size(); i < n; i++)
-    {
-        if (m_arrInputDesc[i].eInputType >= IT_SAMPLER && m_arrInputDesc[i].eInputType <= IT_SAMPLERCUBE)
-        {
-            const unsigned int texIdx = *(unsigned int*)(m_pShaderInput->GetData() + m_arrInputDesc[i].nOffsetInBytes);
-            const Texture* const tex = texIdx != -1 ? Renderer::GetInstance()->GetResourceManager()->GetTexture(texIdx) : nullptr;
-            if (tex)
-                tex->Disable(m_arrInputDesc[i].nRegisterIndex);
-        }
-    }
+    // Textures are left bound so that the next draw sampling from the same
+    // slots can skip rebinding them. The sampler state manager unbinds them
+    // when they become render targets or their resources are released.
+
+    RenderTrace* const trace = Renderer::GetInstance()->GetRenderTrace();
+    if (trace->IsRecording())
+        trace->RecordShaderProgramDisable(this);
 
     m_pShaderInput = nullptr;
 }
@@ -126,38 +141,83 @@ void ShaderProgram::CommitShaderInput(ShaderInput* const shaderInput)
     assert(shaderInput->GetAssociatedShaderProgram() == this);
     //assert((shaderInput && m_arrInputDesc.size()) || (!shaderInput && !m_arrInputDesc.size()) || (Renderer::GetAPI() == API_NULL));
 
+    // Enable() commits the shader input of a program that isn't enabled yet
+    RenderTrace* const trace = Renderer::GetInstance()->GetRenderTrace();
+    if (trace->IsRecording())
+        trace->RecordShaderInput(this, shaderInput ? shaderInput : m_pShaderInput, m_pShaderInput == nullptr);
+
     if(shaderInput != nullptr)
         m_pShaderInput = shaderInput;
 
     assert(m_pShaderInput != nullptr);
 
-    for (unsigned int i = 0, n = (unsigned int)m_arrInputDesc.size(); i < n; i++)
-    {
-        PUSH_PROFILE_MARKER(m_arrInputDesc[i].szName.c_str());
+    // The constant registers are shared by all shader programs of the same type, so they
+    // only hold this shader input's data if it was the last one to be uploaded to them
+    const bool uploadAll = ms_pResidentShaderInput[m_eProgramType] != m_pShaderInput;
+    ms_pResidentShaderInput[m_eProgramType] = m_pShaderInput;
 
-        if (m_arrInputDesc[i].eInputType >= IT_STRUCT && m_arrInputDesc[i].eInputType <= IT_FLOAT)
+    // Merge the dirty inputs of each upload range into as few uploads as possible
+    std::vector<bool, StlAllocator<bool, AT_SHADER_INPUTS>>& dirtyInput = m_pShaderInput->m_arrDirtyInput;
+    const std::vector<ShaderInput::UploadRange, StlAllocator<ShaderInput::UploadRange, AT_SHADER_INPUTS>>& uploadPlan = m_pShaderInput->m_arrUploadPlan;
+    for (unsigned int r = 0, n = (unsigned int)uploadPlan.size(); r < n; r++)
+    {
+        const unsigned int rangeEnd = uploadPlan[r].nFirstInput + uploadPlan[r].nInputCount;
+        unsigned int i = uploadPlan[r].nFirstInput;
+        while (i < rangeEnd)
         {
+            if (!uploadAll && !dirtyInput[i])
+            {
+                i++;
+                continue;
+            }
+
+            unsigned int registerCount = 0;
+            unsigned int j = i;
+            for (; j < rangeEnd && (uploadAll || dirtyInput[j]); j++)
+            {
+                registerCount += m_arrInputDesc[j].nRegisterCount;
+                dirtyInput[j] = false;
+            }
+
+            PUSH_DETAIL_PROFILE_MARKER(m_arrInputDesc[i].szName.c_str());
+
             SetValue(
                 m_arrInputDesc[i].eRegisterType,
                 m_arrInputDesc[i].nRegisterIndex,
                 m_pShaderInput->GetData() + m_arrInputDesc[i].nOffsetInBytes,
-                m_arrInputDesc[i].nRegisterCount
+                registerCount
             );
+
+            const unsigned int uploadBytes = registerCount * (m_arrInputDesc[i].eRegisterType == RT_BOOL ? sizeof(bool) : sizeof(float) * 4u);
+            Renderer::IncrementCounter(RC_CONSTANT_UPLOADS);
+            Renderer::IncrementCounter(RC_CONSTANT_BYTES, uploadBytes);
+
+            POP_DETAIL_PROFILE_MARKER();
+
+            i = j;
         }
-        else
+    }
+
+    for (unsigned int i = 0, n = (unsigned int)m_arrInputDesc.size(); i < n; i++)
+    {
+        if (m_arrInputDesc[i].eInputType < IT_STRUCT || m_arrInputDesc[i].eInputType > IT_FLOAT)
         {
+            PUSH_DETAIL_PROFILE_MARKER(m_arrInputDesc[i].szName.c_str());
+
             if (m_arrInputDesc[i].eInputType >= IT_SAMPLER && m_arrInputDesc[i].eInputType <= IT_SAMPLERCUBE)
             {
                 const unsigned int texIdx = *(unsigned int*)(m_pShaderInput->GetData() + m_arrInputDesc[i].nOffsetInBytes);
                 const Texture* const tex = texIdx != -1 ? Renderer::GetInstance()->GetResourceManager()->GetTexture(texIdx) : nullptr;
+                SamplerState* ssm = Renderer::GetInstance()->GetSamplerStateManager();
+
+                // Don't leave a stale texture bound to an unassigned sampler
+                ssm->BindTexture(m_arrInputDesc[i].nRegisterIndex, tex);
 
                 if (tex)
                 {
                     if (strlen(tex->GetSourceFileName()))
-                        PUSH_PROFILE_MARKER(tex->GetSourceFileName());
+                        PUSH_DETAIL_PROFILE_MARKER(tex->GetSourceFileName());
 
-                    tex->Enable(m_arrInputDesc[i].nRegisterIndex);
-                    SamplerState* ssm = Renderer::GetInstance()->GetSamplerStateManager();
                     ssm->SetAnisotropy(m_arrInputDesc[i].nRegisterIndex, tex->GetAnisotropy());
                     ssm->SetMipLodBias(m_arrInputDesc[i].nRegisterIndex, tex->GetMipLodBias());
                     ssm->SetFilter(m_arrInputDesc[i].nRegisterIndex, tex->GetFilter());
@@ -168,14 +228,14 @@ void ShaderProgram::CommitShaderInput(ShaderInput* const shaderInput)
                     ssm->SetSRGBEnabled(m_arrInputDesc[i].nRegisterIndex, tex->GetSRGBEnabled());
 
                     if (strlen(tex->GetSourceFileName()))
-                        POP_PROFILE_MARKER();
+                        POP_DETAIL_PROFILE_MARKER();
                 }
             }
             else
                 assert(false); // shouldn't happen
-        }
 
-        POP_PROFILE_MARKER();
+            POP_DETAIL_PROFILE_MARKER();
+        }
     }
 }
 
@@ -189,6 +249,12 @@ void ShaderProgram::CommitShaderInput()
     CommitShaderInput(nullptr);
 }
 
+void ShaderProgram::ResetResidentShaderInputs()
+{
+    for (unsigned int spt = SPT_NONE; spt < SPT_MAX; spt++)
+        ms_pResidentShaderInput[spt] = nullptr;
+}
+
 const std::vector<ShaderInputDesc> ShaderProgram::GetConstantTable()
 {
     return m_arrInputDesc;
@@ -235,7 +301,9 @@ const bool ShaderProgram::Compile(const char* filePath, const char* entryPoint)
     m_szSrcFile = filePath;
     m_szEntryPoint = entryPoint;
 
+    const long long describeStart = Profiler::GetCPUTimestamp();
     DescribeShaderInputs();
+    ResourceManager::GetThreadLoadTimings().nTime[RLP_SHADER_COMPILATION] += Profiler::GetCPUTimestamp() - describeStart;
 
     return true;
 }
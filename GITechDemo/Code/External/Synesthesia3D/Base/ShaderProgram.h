@@ -23,6 +23,8 @@
 #ifndef SHADERPROGRAM_H
 #define SHADERPROGRAM_H
 
+#include <unordered_map>
+
 #include "ResourceData.h"
 
 namespace Synesthesia3D
@@ -36,6 +38,7 @@ namespace Synesthesia3D
      */
     class ShaderProgram
     {
+        S3D_ALLOCATION_TAG(AT_RESOURCES)
 
     public:
 
@@ -127,6 +130,12 @@ namespace Synesthesia3D
          */
         void DescribeShaderInputs();
 
+        /**
+         * @brief   Builds the lookup table of shader input handles by name hash, from the @ref ShaderInputDesc array.
+         * @see     ShaderInput::GetInputHandleByNameHash()
+         */
+        void IndexShaderInputs();
+
         /**
          * @brief   Retrieves the total number of registers used by the shader program.
          */
@@ -249,6 +258,11 @@ namespace Synesthesia3D
          */
         virtual const unsigned int GetConstantSizeBytes(const unsigned int handle) const PURE_VIRTUAL;
         
+        /**
+         * @brief   Forgets which shader inputs reside in the constant registers (e.g. after a device reset).
+         */
+        static void ResetResidentShaderInputs();
+
         /**
          * @brief   Sets an array of arbitrary data type values to the registers.
          *
@@ -299,10 +313,14 @@ namespace Synesthesia3D
         std::string m_szErrors;                         /**< @brief Compilation errors. */
         std::string m_szEntryPoint;                     /**< @brief Shader entry point function. */
         std::vector<ShaderInputDesc> m_arrInputDesc;    /**< @brief An array containing metadata regarding each shader input. */
+        std::unordered_map<unsigned int, unsigned int> m_mapInputHandle;    /**< @brief Shader input handles, indexed by the hash of their names. */
         ShaderInput* m_pShaderInput;                    /**< @brief A pointer to the currently active shader input */
 
+        static ShaderInput* ms_pResidentShaderInput[SPT_MAX];   /**< @brief The shader input last uploaded to the constant registers of each shader type, for which only modified inputs need to be uploaded again. */
+
         friend class ShaderInput;
         friend class ResourceManager;
+        friend class Renderer;
     };
 }
 
@@ -25,6 +25,7 @@
 #include "Texture.h"
 #include "Renderer.h"
 #include "Profiler.h"
+#include "RenderTrace.h"
 #include "../Utility/ColorUtility.h"
 using namespace Synesthesia3D;
 
@@ -285,6 +286,8 @@ Texture::Texture(
     , m_ePixelFormat(pixelFormat)
     , m_eTexType(texType)
     , m_nMipCount(mipCount)
+    , m_nSkippedMipCount(0)
+    , m_nMaxResidentMipSize(0)
     , m_bIsLocked(false)
     , m_nLockedMip(~0u)
     , m_eLockedCubeFace(FACE_NONE)
@@ -329,11 +332,11 @@ Texture::Texture(
     // Allocate memory for our texture
     if (!IsRenderTarget() && !IsDepthStencil())
     {
-        m_pData = new s3dByte[m_nSize];
+        AllocateData();
     }
     else
     {
-        m_pData = nullptr;
+        FreeData();
     }
 }
 
@@ -384,12 +387,17 @@ void Texture::ComputeTextureProperties(const Vec3i dimensions)
         // with the integer approximation of logarithm to the base 2 of the value
         // we feed to _BitScanReverse(), which in turn coincides with the maximum
         // number of mipmaps we can have for that texture size - 1 (because math!).
-        // It's fast, but most likely not cross-platform so when the time comes,
-        // a replacement will have to be found.
+        // Other compilers count the leading zero bits instead.
         unsigned int maxMipmapLevelsX, maxMipmapLevelsY, maxMipmapLevelsZ;
+#ifdef _MSC_VER
         _BitScanReverse((unsigned long*)&maxMipmapLevelsX, m_nDimension[0][0]);
         _BitScanReverse((unsigned long*)&maxMipmapLevelsY, m_nDimension[0][1]);
         _BitScanReverse((unsigned long*)&maxMipmapLevelsZ, m_nDimension[0][2]);
+#else
+        maxMipmapLevelsX = 31u - __builtin_clz(m_nDimension[0][0]);
+        maxMipmapLevelsY = 31u - __builtin_clz(m_nDimension[0][1]);
+        maxMipmapLevelsZ = 31u - __builtin_clz(m_nDimension[0][2]);
+#endif
         unsigned int maxMipmapLevels = (unsigned int)Math::Max(maxMipmapLevelsX, maxMipmapLevelsY, maxMipmapLevelsX) + 1;
 
         if (m_nMipCount == 0 || m_nMipCount > maxMipmapLevels || IsRenderTarget())
@@ -484,13 +492,57 @@ void Texture::SetDynamicSizeRatios(const float widthRatio, const float heightRat
         ComputeTextureProperties(Vec3i(0, 0, 1));
 
         // Reallocate memory for our texture
-        delete[] m_pData;
-        // m_pData = new s3dByte[m_nSize];
+        FreeData();
 
         Bind();
     }
 }
 
+const bool Texture::DiscardTopMips(const unsigned int maxMipSize)
+{
+    if (maxMipSize == 0 || m_pData == nullptr || IsLocked())
+        return false;
+
+    // Always keep the last mip and, for compressed formats, keep the top mip a whole block in size
+    unsigned int discardCount = 0;
+    while (discardCount + 1 < m_nMipCount &&
+        Math::Max(GetWidth(discardCount), GetHeight(discardCount), GetDepth(discardCount)) > maxMipSize &&
+        (!IsCompressed() || Math::Min(GetWidth(discardCount + 1), GetHeight(discardCount + 1)) >= 4u))
+    {
+        discardCount++;
+    }
+
+    if (discardCount == 0)
+        return false;
+
+    // Mips are stored contiguously, from the largest to the smallest, for each cube face
+    const unsigned int faceCount = (m_eTexType == TT_CUBE ? FACE_MAX : 1u);
+    const unsigned int oldFaceSize = m_nSize / faceCount;
+    const unsigned int newFaceSize = oldFaceSize - m_nMipOffset[discardCount];
+
+    s3dByte* const data = (s3dByte*)Allocator::AllocateMemory(newFaceSize * faceCount, m_eDataTag);
+    for (unsigned int face = 0; face < faceCount; face++)
+        memcpy(data + face * newFaceSize, m_pData + face * oldFaceSize + m_nMipOffset[discardCount], newFaceSize);
+
+    FreeData();
+    m_pData = data;
+
+    const unsigned int discardedBytes = m_nMipOffset[discardCount];
+    for (unsigned int level = discardCount; level < m_nMipCount; level++)
+    {
+        m_nDimension[level - discardCount] = m_nDimension[level];
+        m_nMipSizeBytes[level - discardCount] = m_nMipSizeBytes[level];
+        m_nMipOffset[level - discardCount] = m_nMipOffset[level] - discardedBytes;
+    }
+
+    m_nMipCount -= discardCount;
+    m_nSkippedMipCount += discardCount;
+    m_nSize = newFaceSize * faceCount;
+    m_nElementCount = m_nSize / m_nElementSize;
+
+    return true;
+}
+
 s3dByte* const Texture::GetMipData(const unsigned int mipmapLevel)
 {
     if (m_eTexType == TT_CUBE)
@@ -503,8 +555,7 @@ s3dByte* const Texture::GetMipData(const unsigned int mipmapLevel)
     // when we create render targets so as to reduce their memory footprint.
     if ((IsRenderTarget() || IsDepthStencil()) && m_pData == nullptr)
     {
-        m_pData = new s3dByte[m_nSize];
-        assert(m_pData != nullptr);
+        AllocateData();
         memset(m_pData, 0, m_nSize);
     }
 
@@ -634,8 +685,7 @@ void Texture::Bind()
         ComputeTextureProperties(Vec3i(0, 0, 1));
 
         // Reallocate memory for our texture
-        delete[] m_pData;
-        //m_pData = new s3dByte[m_nSize];
+        FreeData();
     }
 }
 
@@ -654,6 +704,11 @@ const unsigned int Texture::GetMipCount() const
     return m_nMipCount;
 }
 
+const unsigned int Texture::GetSkippedMipCount() const
+{
+    return m_nSkippedMipCount;
+}
+
 const unsigned int Texture::GetWidth(const unsigned int mipmapLevel) const
 {
     return m_nDimension[mipmapLevel][0];
@@ -717,21 +772,35 @@ const bool Texture::IsMipmapable() const
     return g_bMipmapable[m_ePixelFormat];
 }
 
-const bool Texture::Lock(const unsigned int mipmapLevel, const BufferLocking /*lockMode*/)
+const bool Texture::Lock(const unsigned int mipmapLevel, const BufferLocking lockMode)
 {
     assert(!m_bIsLocked);
+    assert(lockMode < BL_WRITE_DISCARD);
     m_bIsLocked = true;
     m_nLockedMip = mipmapLevel;
     m_eLockedCubeFace = FACE_XNEG;
+    Renderer::IncrementCounter(RC_BUFFER_LOCKS);
+
+    RenderTrace* const trace = Renderer::GetInstance()->GetRenderTrace();
+    if (trace->IsRecording())
+        trace->RecordTextureUpdate(this, FACE_NONE, mipmapLevel, lockMode);
+
     return true;
 }
 
-const bool Texture::Lock(const CubeFace cubeFace, const unsigned int mipmapLevel, const BufferLocking /*lockMode*/)
+const bool Texture::Lock(const CubeFace cubeFace, const unsigned int mipmapLevel, const BufferLocking lockMode)
 {
     assert(!m_bIsLocked);
+    assert(lockMode < BL_WRITE_DISCARD);
     m_bIsLocked = true;
     m_nLockedMip = mipmapLevel;
     m_eLockedCubeFace = cubeFace;
+    Renderer::IncrementCounter(RC_BUFFER_LOCKS);
+
+    RenderTrace* const trace = Renderer::GetInstance()->GetRenderTrace();
+    if (trace->IsRecording())
+        trace->RecordTextureUpdate(this, cubeFace, mipmapLevel, lockMode);
+
     return true;
 }
 
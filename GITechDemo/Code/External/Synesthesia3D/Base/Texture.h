@@ -70,6 +70,16 @@ namespace Synesthesia3D
          */
                 SYNESTHESIA3D_DLL   const   unsigned int    GetMipCount() const;
 
+        /**
+         * @brief   Retrieves the number of mip levels at the top of the texture file's mip chain which are not resident.
+         * @note    Streamed textures only load their top mips on demand. Mip level 0 is always the largest resident one.
+         *
+         * @return  The number of mip levels which have been discarded.
+         *
+         * @see     ResourceManager::StreamTextureMips()
+         */
+                SYNESTHESIA3D_DLL   const   unsigned int    GetSkippedMipCount() const;
+
 
 
         /**
@@ -494,10 +504,23 @@ namespace Synesthesia3D
          */
         void            SetDynamicSizeRatios(const float widthRatio, const float heightRatio);
 
+        /**
+         * @brief   Discards the top mips so that the largest remaining one fits in the specified size.
+         * @note    Only the data in system memory is affected, the platform specific resource has to be recreated afterwards.
+         *
+         * @param[in]   maxMipSize  The maximum width, height and depth of the largest mip to keep. Use 0 to keep all mips.
+         *
+         * @return  Whether any mips have been discarded.
+         */
+        const bool      DiscardTopMips(const unsigned int maxMipSize);
+
         PixelFormat     m_ePixelFormat; /**< @brief Holds the format of the texture. */
         TextureType     m_eTexType;     /**< @brief Holds the type of texture. */
         unsigned int    m_nMipCount;    /**< @brief Holds the number of mips. */
 
+        unsigned int    m_nSkippedMipCount;     /**< @brief Holds the number of mips from the top of the file's mip chain which are not resident. */
+        unsigned int    m_nMaxResidentMipSize;  /**< @brief Largest mip size to be kept resident when loading the texture from file (0 for all mips). */
+
         unsigned int            m_nDimensionCount; /**< @brief Holds the number of valid dimensions based on the type. */
         Vec<unsigned int, 3U>   m_nDimension[TEX_MAX_MIPMAP_LEVELS]; /**< @brief Holds the dimensions of each mip. */
         unsigned int            m_nMipSizeBytes[TEX_MAX_MIPMAP_LEVELS]; /**< @brief Holds the sizes in bytes of each mip level. */
@@ -25,12 +25,16 @@
 #include "VertexBuffer.h"
 #include "VertexFormat.h"
 #include "IndexBuffer.h"
+#include "Renderer.h"
+#include "RenderTrace.h"
 using namespace Synesthesia3D;
 
 VertexBuffer::VertexBuffer(VertexFormat* const vertexFormat, const unsigned int vertexCount, IndexBuffer* const indexBuffer, const BufferUsage usage)
     : Buffer(vertexCount, vertexFormat->GetStride(), usage)
     , m_pVertexFormat(vertexFormat)
     , m_pIndexBuffer(indexBuffer)
+    , m_nLockOffset(0u)
+    , m_nLockCount(0u)
 {
     assert(vertexFormat != nullptr);
 }
@@ -38,6 +42,21 @@ VertexBuffer::VertexBuffer(VertexFormat* const vertexFormat, const unsigned int
 VertexBuffer::~VertexBuffer()
 {}
 
+void VertexBuffer::Lock(const BufferLocking lockMode, const unsigned int offset, const unsigned int count)
+{
+    assert(lockMode < BL_WRITE_DISCARD || m_eBufferUsage == BU_DYNAMIC);
+    assert(offset + count <= GetElementCount());
+
+    m_nLockOffset = offset;
+    m_nLockCount = count > 0 ? count : GetElementCount() - offset;
+
+    Renderer::IncrementCounter(RC_BUFFER_LOCKS);
+
+    RenderTrace* const trace = Renderer::GetInstance()->GetRenderTrace();
+    if (trace->IsRecording())
+        trace->RecordBufferUpdate(this, lockMode, m_nLockOffset, m_nLockCount);
+}
+
 VertexFormat* VertexBuffer::GetVertexFormat() const
 {
     return m_pVertexFormat;
@@ -54,8 +54,14 @@ namespace Synesthesia3D
 
         /**
          * @brief   Locks the buffer so that modifications can be made to its' contents. The general workflow is @ref Lock() -> @ref Update() -> @ref Unlock().
+         *
+         * @param[in]   lockMode    Specifies the type of operation for which the resource is locked.
+         * @param[in]   offset      The first vertex of the locked range.
+         * @param[in]   count       The number of vertices in the locked range (0 for all vertices following @p offset).
+         *
+         * @note    Only the locked range is flushed by @ref Update().
          */
-        virtual SYNESTHESIA3D_DLL       void        Lock(const BufferLocking lockMode) PURE_VIRTUAL;
+        virtual SYNESTHESIA3D_DLL       void        Lock(const BufferLocking lockMode, const unsigned int offset = 0u, const unsigned int count = 0u);
 
         /**
          * @brief   Unlocks the buffer.
@@ -207,6 +213,8 @@ namespace Synesthesia3D
 
         VertexFormat*   m_pVertexFormat;    /**< @brief Holds a pointer to the associated vertex format. */
         IndexBuffer*    m_pIndexBuffer;     /**< @brief Holds a pointer to the associated index buffer. */
+        unsigned int    m_nLockOffset;      /**< @brief First vertex of the range locked by @ref Lock(). */
+        unsigned int    m_nLockCount;       /**< @brief Number of vertices in the range locked by @ref Lock(). */
 
         friend class ResourceManager;
 
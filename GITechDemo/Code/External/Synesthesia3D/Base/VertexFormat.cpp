@@ -45,6 +45,8 @@ const unsigned int VertexFormat::VertexAttributeTypeSize[VAT_MAX] =
 VertexFormat::VertexFormat(const unsigned int attributeCount)
     : m_nAttributeCount(attributeCount)
     , m_nStride(0)
+    , m_nLayoutHash(0)
+    , m_nRefCount(0)
 {
     assert(attributeCount <= VF_MAX_ATTRIBUTES);
 
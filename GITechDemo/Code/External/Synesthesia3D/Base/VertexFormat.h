@@ -32,6 +32,7 @@ namespace Synesthesia3D
      */
     class VertexFormat
     {
+        S3D_ALLOCATION_TAG(AT_RESOURCES)
 
     public:
 
@@ -163,6 +164,9 @@ namespace Synesthesia3D
         VertexElement*  m_pElements;        /**< @brief A pointer to the array of elements. */
         unsigned int    m_nStride;          /**< @brief The stride of the vertex format. */
 
+        unsigned long long  m_nLayoutHash;  /**< @brief Hash of the layout, if shared (see @ref ResourceManager::GetOrCreateVertexFormat()). */
+        unsigned int        m_nRefCount;    /**< @brief Number of references to the vertex format, if shared; 0 otherwise. */
+
         static const unsigned int VertexAttributeTypeSize[VAT_MAX]; /**< @brief The size, in bytes, of each vertex attribute type. */
 
         friend class ResourceManager;
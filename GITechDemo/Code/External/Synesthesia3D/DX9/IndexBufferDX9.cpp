@@ -69,10 +69,12 @@ void IndexBufferDX9::Disable()
     S3D_VALIDATE_HRESULT(hr);
 }
 
-void IndexBufferDX9::Lock(const BufferLocking lockMode)
+void IndexBufferDX9::Lock(const BufferLocking lockMode, const unsigned int offset, const unsigned int count)
 {
+    IndexBuffer::Lock(lockMode, offset, count);
+
     assert(m_pTempBuffer == nullptr);
-    HRESULT hr = m_pIndexBuffer->Lock(0, 0, &m_pTempBuffer, BufferLockingDX9[lockMode]);
+    HRESULT hr = m_pIndexBuffer->Lock(m_nLockOffset * m_nElementSize, m_nLockCount * m_nElementSize, &m_pTempBuffer, BufferLockingDX9[lockMode]);
     S3D_VALIDATE_HRESULT(hr);
 }
 
@@ -87,7 +89,7 @@ void IndexBufferDX9::Unlock()
 void IndexBufferDX9::Update()
 {
     assert(m_pTempBuffer != nullptr);
-    memcpy(m_pTempBuffer, GetData(), GetSize());
+    memcpy(m_pTempBuffer, GetData() + m_nLockOffset * m_nElementSize, m_nLockCount * m_nElementSize);
 }
 
 void IndexBufferDX9::Bind()
@@ -33,7 +33,7 @@ namespace Synesthesia3D
     public:
         void    Enable();
         void    Disable();
-        void    Lock(const BufferLocking lockMode);
+        void    Lock(const BufferLocking lockMode, const unsigned int offset = 0u, const unsigned int count = 0u);
         void    Unlock();
         void    Update();
 
@@ -42,7 +42,9 @@ namespace Synesthesia3D
     {
         D3DLOCK_READONLY,       // BL_READ_ONLY
         0,                      // BL_WRITE_ONLY
-        0                       // BL_READ_WRITE
+        0,                      // BL_READ_WRITE
+        D3DLOCK_DISCARD,        // BL_WRITE_DISCARD
+        D3DLOCK_NOOVERWRITE     // BL_WRITE_NO_OVERWRITE
     };
 
     //Translates vertex attribute type flags from platform independent format to D3D9 format
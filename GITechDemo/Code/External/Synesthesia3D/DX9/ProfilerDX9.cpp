@@ -43,40 +43,43 @@ ProfilerDX9::~ProfilerDX9()
 
 }
 
-void ProfilerDX9::PushProfileMarker(const char* const label, const bool issueGPUQuery)
+void ProfilerDX9::PushProfileMarker(const unsigned int markerId, const bool issueGPUQuery)
 {
 #if ENABLE_PROFILE_MARKERS
-    MUTEX_LOCK(gProfileMarkerMutex);
+    Profiler::PushProfileMarker(markerId);
+    D3DPERF_BeginEvent((D3DCOLOR)0xffffffff, GetProfileMarkerWideLabel(markerId));
 
-    Profiler::PushProfileMarker(label);
-    unsigned int len = (unsigned int)strlen(label) + 1;
-    wchar_t* labelWide = new wchar_t[len];
-    MultiByteToWideChar(CP_ACP, 0, label, -1, labelWide, len);
-    D3DPERF_BeginEvent((D3DCOLOR)0xffffffff, labelWide);
-    delete[] labelWide;
-
-    if (m_arrD3DDisjointQuery.size() > 0)
+    // GPU queries and their stack are owned by the rendering thread,
+    // so markers pushed from other threads only get the counter and the PIX event.
+    if (IsRenderThread() && m_arrD3DDisjointQuery.size() > 0)
     {
         // Issue GPU begin query for current label
         GPUProfileMarkerResultDX9* marker = nullptr;
-        if (issueGPUQuery && RendererDX9::GetInstance()->GetDeviceState() != DS_NOT_READY)
+        if (issueGPUQuery && markerId != ~0u && RendererDX9::GetInstance()->GetDeviceState() != DS_NOT_READY)
         {
-            marker = new GPUProfileMarkerResultDX9(label, m_arrD3DDisjointQuery.back());
+            MarkGPUTimelineOrigin();
+            if (m_arrGPUProfileMarkerResultPool.size() > 0)
+            {
+                marker = m_arrGPUProfileMarkerResultPool.back();
+                m_arrGPUProfileMarkerResultPool.pop_back();
+                marker->Reset(markerId, GetProfileMarkerLabel(markerId), m_arrD3DDisjointQuery.back());
+            }
+            else
+                marker = new GPUProfileMarkerResultDX9(markerId, GetProfileMarkerLabel(markerId), m_arrD3DDisjointQuery.back());
+
+            MUTEX_LOCK(gProfileMarkerMutex);
             m_arrGPUProfileMarkerResult.push_back(marker);
+            MUTEX_UNLOCK(gProfileMarkerMutex);
         }
         m_arrGPUProfileMarkerDX9Stack.push(marker);
     }
-
-    MUTEX_UNLOCK(gProfileMarkerMutex);
 #endif
 }
 
 void ProfilerDX9::PopProfileMarker()
 {
 #if ENABLE_PROFILE_MARKERS
-    MUTEX_LOCK(gProfileMarkerMutex);
-
-    if (m_arrGPUProfileMarkerDX9Stack.size() > 0)
+    if (IsRenderThread() && m_arrGPUProfileMarkerDX9Stack.size() > 0)
     {
         // Issue GPU end query for current label
         GPUProfileMarkerResultDX9* marker = m_arrGPUProfileMarkerDX9Stack.top();
@@ -87,7 +90,6 @@ void ProfilerDX9::PopProfileMarker()
 
     D3DPERF_EndEvent();
     Profiler::PopProfileMarker();
-    MUTEX_UNLOCK(gProfileMarkerMutex);
 #endif
 }
 
@@ -126,6 +128,10 @@ void ProfilerDX9::ReleaseGPUProfileMarkerResults()
 #if ENABLE_PROFILE_MARKERS
     Profiler::ReleaseGPUProfileMarkerResults();
 
+    for (unsigned int i = 0; i < (unsigned int)m_arrGPUProfileMarkerResultPool.size(); i++)
+        delete m_arrGPUProfileMarkerResultPool[i];
+    m_arrGPUProfileMarkerResultPool.clear();
+
     for (unsigned int i = 0; i < (unsigned int)m_arrD3DDisjointQuery.size(); i++)
     {
         m_arrD3DDisjointQuery[i].disjointQuery->Release();
@@ -157,7 +163,7 @@ void ProfilerDX9::UpdateGPUProfileMarkerResults()
                     GPUProfileMarkerResultDX9* result = (GPUProfileMarkerResultDX9*)m_arrGPUProfileMarkerResult[j];
                     if (result && result->m_tD3DDisjointQuery.disjointQuery == djQuery)
                     {
-                        delete result;
+                        RecycleGPUProfileMarkerResult(result);
                         m_arrGPUProfileMarkerResult.erase(m_arrGPUProfileMarkerResult.begin() + j);
                         j--;
                         continue;
@@ -232,7 +238,7 @@ void ProfilerDX9::UpdateGPUProfileMarkerResults()
                             GPUProfileMarkerResultDX9* result = (GPUProfileMarkerResultDX9*)m_arrGPUProfileMarkerResult[k];
                             if (result && result->m_tD3DDisjointQuery.disjointQuery == oldDjQuery)
                             {
-                                delete result;
+                                RecycleGPUProfileMarkerResult(result);
                                 m_arrGPUProfileMarkerResult.erase(m_arrGPUProfileMarkerResult.begin() + k);
                                 k--;
                             }
@@ -253,19 +259,47 @@ void ProfilerDX9::UpdateGPUProfileMarkerResults()
 #endif
 }
 
-GPUProfileMarkerResultDX9::GPUProfileMarkerResultDX9(const char* const label, DisjointQuery disjointQuery)
-    : GPUProfileMarkerResult(label)
+void ProfilerDX9::RecycleGPUProfileMarkerResult(GPUProfileMarkerResult* const result)
+{
+    m_arrGPUProfileMarkerResultPool.push_back((GPUProfileMarkerResultDX9*)result);
+}
+
+GPUProfileMarkerResultDX9::GPUProfileMarkerResultDX9(const unsigned int markerId, const char* const label, DisjointQuery disjointQuery)
+    : GPUProfileMarkerResult(markerId, label)
     , m_pD3DBeginQuery(nullptr)
     , m_pD3DEndQuery(nullptr)
     , m_tD3DDisjointQuery(disjointQuery)
+{
+    IssueBeginQuery();
+}
+
+GPUProfileMarkerResultDX9::~GPUProfileMarkerResultDX9()
+{
+    if (m_pD3DBeginQuery)
+        m_pD3DBeginQuery->Release();
+    if (m_pD3DEndQuery)
+        m_pD3DEndQuery->Release();
+}
+
+void GPUProfileMarkerResultDX9::Reset(const unsigned int markerId, const char* const label, DisjointQuery disjointQuery)
+{
+    GPUProfileMarkerResult::Reset(markerId, label);
+    m_tD3DDisjointQuery = disjointQuery;
+
+    IssueBeginQuery();
+}
+
+void GPUProfileMarkerResultDX9::IssueBeginQuery()
 {
 #if ENABLE_PROFILE_MARKERS
-    HRESULT hr = E_FAIL;
+    HRESULT hr = S_OK;
     IDirect3DDevice9* device = RendererDX9::GetInstance()->GetDevice();
 
     if (device)
     {
-        hr = device->CreateQuery(D3DQUERYTYPE_TIMESTAMP, &m_pD3DBeginQuery);
+        // Timestamp queries are created once and reissued when the result is reused
+        if (!m_pD3DBeginQuery)
+            hr = device->CreateQuery(D3DQUERYTYPE_TIMESTAMP, &m_pD3DBeginQuery);
         S3D_VALIDATE_HRESULT(hr);
 
         if (SUCCEEDED(hr))
@@ -275,23 +309,16 @@ GPUProfileMarkerResultDX9::GPUProfileMarkerResultDX9(const char* const label, Di
 #endif
 }
 
-GPUProfileMarkerResultDX9::~GPUProfileMarkerResultDX9()
-{
-    if (m_pD3DBeginQuery)
-        m_pD3DBeginQuery->Release();
-    if (m_pD3DEndQuery)
-        m_pD3DEndQuery->Release();
-}
-
 void GPUProfileMarkerResultDX9::IssueEndQuery()
 {
 #if ENABLE_PROFILE_MARKERS
-    HRESULT hr = E_FAIL;
+    HRESULT hr = S_OK;
     IDirect3DDevice9* device = RendererDX9::GetInstance()->GetDevice();
 
     if (device)
     {
-        hr = device->CreateQuery(D3DQUERYTYPE_TIMESTAMP, &m_pD3DEndQuery);
+        if (!m_pD3DEndQuery)
+            hr = device->CreateQuery(D3DQUERYTYPE_TIMESTAMP, &m_pD3DEndQuery);
         S3D_VALIDATE_HRESULT(hr);
 
         if (SUCCEEDED(hr))
@@ -41,9 +41,13 @@ namespace Synesthesia3D
     class GPUProfileMarkerResultDX9 : public GPUProfileMarkerResult
     {
     private:
-        GPUProfileMarkerResultDX9(const char* const label, DisjointQuery disjointQuery);
+        GPUProfileMarkerResultDX9(const unsigned int markerId, const char* const label, DisjointQuery disjointQuery);
         ~GPUProfileMarkerResultDX9();
 
+        // Reinitializes a pooled result for a new marker, reusing its timestamp queries
+        void Reset(const unsigned int markerId, const char* const label, DisjointQuery disjointQuery);
+
+        void IssueBeginQuery();
         void IssueEndQuery();
 
         LPDIRECT3DQUERY9    m_pD3DBeginQuery;
@@ -56,7 +60,8 @@ namespace Synesthesia3D
     class ProfilerDX9 : public Profiler
     {
     public:
-        void PushProfileMarker(const char* const label, const bool issueGPUQuery = false);
+        using Profiler::PushProfileMarker;
+        void PushProfileMarker(const unsigned int markerId, const bool issueGPUQuery = false);
         void PopProfileMarker();
 
     private:
@@ -68,10 +73,14 @@ namespace Synesthesia3D
 
         void ReleaseGPUProfileMarkerResults();
         void UpdateGPUProfileMarkerResults();
+        void RecycleGPUProfileMarkerResult(GPUProfileMarkerResult* const result);
 
         std::vector<DisjointQuery>              m_arrD3DDisjointQuery;
         std::stack<GPUProfileMarkerResultDX9*>  m_arrGPUProfileMarkerDX9Stack;
 
+        // Results (and their timestamp queries) no longer in use, reused by later markers
+        std::vector<GPUProfileMarkerResultDX9*, StlAllocator<GPUProfileMarkerResultDX9*, AT_PROFILER>> m_arrGPUProfileMarkerResultPool;
+
         static UINT64   ms_nFirstQueryBeginTime;
 
         friend class RendererDX9;
@@ -82,6 +82,8 @@ const unsigned int RenderStateDX9::MatchRenderState(const DWORD rs, const unsign
 
 const bool RenderStateDX9::SetScissor(const Vec2i size, const Vec2i offset)
 {
+    RenderState::SetScissor(size, offset);
+
     IDirect3DDevice9* device = RendererDX9::GetInstance()->GetDevice();
     const RECT scissorRect = { offset[0], offset[1], offset[0] + size[0], offset[1] + size[1] };
     HRESULT hr = device->SetScissorRect(&scissorRect);
@@ -227,6 +229,10 @@ void RenderStateDX9::Reset()
 
 const bool RenderStateDX9::Flush()
 {
+    // Nothing has been changed since the last flush
+    if (!m_bDirty)
+        return true;
+
     IDirect3DDevice9* device = RendererDX9::GetInstance()->GetDevice();
     HRESULT hr = E_FAIL;
 
@@ -521,5 +527,7 @@ const bool RenderStateDX9::Flush()
             return false;
     }
 
+    m_bDirty = false;
+
     return true;
 }
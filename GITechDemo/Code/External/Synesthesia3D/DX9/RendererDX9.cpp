@@ -490,6 +490,8 @@ const bool RendererDX9::SetDisplayResolution(const Vec2i size, const Vec2i offse
 
 void RendererDX9::SetViewport(const Vec2i size, const Vec2i offset)
 {
+    Renderer::SetViewport(size, offset);
+
     D3DVIEWPORT9 vp;
     vp.X = offset[0];
     vp.Y = offset[1];
@@ -618,6 +620,8 @@ void RendererDX9::Clear(const Vec4f rgba, const float z, const unsigned int sten
 {
     PUSH_PROFILE_MARKER(__FUNCSIG__);
 
+    Renderer::Clear(rgba, z, stencil);
+
     HRESULT hr;
     DWORD flags = D3DCLEAR_TARGET;
     IDirect3DSurface9* depthStencil = nullptr;
@@ -99,6 +99,10 @@ const bool SamplerStateDX9::Flush()
 
     for (unsigned int slot = 0; slot < MAX_NUM_PSAMPLERS; slot++)
     {
+        // Nothing has been changed on this slot since the last flush
+        if (!(m_nDirtySlotMask & (1u << slot)))
+            continue;
+
         if (m_tCurrentStateDX9[slot].nAnisotropy != GetAnisotropy(slot))
         {
             hr = device->SetSamplerState(slot, D3DSAMP_MAXANISOTROPY, (DWORD)GetAnisotropy(slot));
@@ -228,5 +232,7 @@ const bool SamplerStateDX9::Flush()
         }
     }
 
+    m_nDirtySlotMask = 0;
+
     return true;
 }
@@ -26,6 +26,8 @@
 #include "RendererDX9.h"
 #include "TextureDX9.h"
 #include "ProfilerDX9.h"
+#include "ResourceManager.h"
+#include "ShaderCache.h"
 using namespace Synesthesia3D;
 
 #define CONST_MAX_ARRAY_SIZE 16;
@@ -146,8 +148,31 @@ const bool ShaderProgramDX9::Compile(const char* filePath, const char* entryPoin
 
     macroList.push_back({ "DX9", "" });
 
-    HRESULT hr = D3DXCompileShaderFromFile(filePath, macroList.c_str(), NULL, entryPoint, profile,
-        flags, &compiledData, &errorMsg, &m_pConstantTable);
+    ResourceLoadTimings& loadTimings = ResourceManager::GetThreadLoadTimings();
+    const long long compileStart = Profiler::GetCPUTimestamp();
+
+    // Programs compiled on previous runs are loaded from the shader cache, along with their reflected inputs
+    ShaderCache* const shaderCache = RendererDX9::GetInstance()->GetShaderCache();
+    unsigned long long cacheKey = 0;
+    std::vector<char> cachedBytecode;
+    std::vector<ShaderInputDesc> cachedInputDesc;
+    bool cacheHit = false;
+    if (shaderCache->IsEnabled())
+    {
+        std::vector<std::string> macros;
+        for (unsigned int i = 0; i < macroList.size(); i++)
+            macros.push_back(std::string(macroList[i].Name) + "=" + macroList[i].Definition);
+
+        cacheKey = ShaderCache::ComputeKey(filePath, macros, entryPoint, profile, flags, D3DX_SDK_VERSION);
+        cacheHit = shaderCache->Load(cacheKey, cachedBytecode, cachedInputDesc);
+    }
+
+    HRESULT hr = S_OK;
+    if (!cacheHit)
+        hr = D3DXCompileShaderFromFile(filePath, macroList.c_str(), NULL, entryPoint, profile,
+            flags, &compiledData, &errorMsg, &m_pConstantTable);
+
+    loadTimings.nTime[RLP_SHADER_COMPILATION] += Profiler::GetCPUTimestamp() - compileStart;
 
 #ifdef _DEBUG
     if (errorMsg)
@@ -168,6 +193,10 @@ const bool ShaderProgramDX9::Compile(const char* filePath, const char* entryPoin
     if (FAILED(hr))
         return false;
 
+    const DWORD* const bytecode = cacheHit ? (const DWORD*)cachedBytecode.data() : (const DWORD*)compiledData->GetBufferPointer();
+
+    const long long uploadStart = Profiler::GetCPUTimestamp();
+
     unsigned int refCount = 0;
     switch (m_eProgramType)
     {
@@ -175,16 +204,35 @@ const bool ShaderProgramDX9::Compile(const char* filePath, const char* entryPoin
         if (m_pVertexShader)
             refCount = m_pVertexShader->Release();
         assert(refCount == 0);
-        hr = device->CreateVertexShader((DWORD*)(compiledData->GetBufferPointer()), &m_pVertexShader);
+        hr = device->CreateVertexShader(bytecode, &m_pVertexShader);
         break;
     case SPT_PIXEL:
         if (m_pPixelShader)
             refCount = m_pPixelShader->Release();
         assert(refCount == 0);
-        hr = device->CreatePixelShader((DWORD*)(compiledData->GetBufferPointer()), &m_pPixelShader);
+        hr = device->CreatePixelShader(bytecode, &m_pPixelShader);
     }
     assert(SUCCEEDED(hr));
 
+    loadTimings.nTime[RLP_GPU_UPLOAD] += Profiler::GetCPUTimestamp() - uploadStart;
+
+    bool success = true;
+    if (cacheHit)
+    {
+        // No constant table to reflect, the inputs come from the cache
+        m_szSrcFile = filePath;
+        m_szEntryPoint = entryPoint;
+        m_arrInputDesc = cachedInputDesc;
+        IndexShaderInputs();
+    }
+    else
+    {
+        success = ShaderProgram::Compile(filePath, entryPoint);
+
+        if (success && cacheKey)
+            shaderCache->Store(cacheKey, compiledData->GetBufferPointer(), (unsigned int)compiledData->GetBufferSize(), m_arrInputDesc);
+    }
+
     if (compiledData)
         refCount = compiledData->Release();
     assert(refCount == 0);
@@ -193,7 +241,7 @@ const bool ShaderProgramDX9::Compile(const char* filePath, const char* entryPoin
         refCount = errorMsg->Release();
     assert(refCount == 0);
 
-    return ShaderProgram::Compile(filePath, entryPoint);
+    return success;
 }
 
 const unsigned int ShaderProgramDX9::GetConstantCount() const
@@ -26,6 +26,7 @@
 #include "MappingsDX9.h"
 #include "TextureDX9.h"
 #include "ProfilerDX9.h"
+#include "SamplerState.h"
 using namespace Synesthesia3D;
 
 TextureDX9::TextureDX9(
@@ -67,7 +68,8 @@ void TextureDX9::Disable(const unsigned int texUnit) const
     S3D_VALIDATE_HRESULT(hr);
     assert(activeTex == m_pTexture);
     unsigned int refCount = 1;
-    refCount = activeTex->Release();
+    if (activeTex)
+        refCount = activeTex->Release();
     // Inconsistent between the retail and debug DX9 runtimes
     //assert(refCount == 1/* + IsRenderTarget() ? 1 : 0*/);
 #endif
@@ -291,6 +293,11 @@ void TextureDX9::Bind()
 
 void TextureDX9::Unbind()
 {
+    // The device holds a reference to the texture for as long as it is bound
+    SamplerState* const ssm = Renderer::GetInstance() ? Renderer::GetInstance()->GetSamplerStateManager() : nullptr;
+    if (ssm)
+        ssm->UnbindTexture(this);
+
     unsigned int refCount = 0;
     if (m_pTexture)
         refCount = m_pTexture->Release();
@@ -90,11 +90,13 @@ void VertexBufferDX9::Disable()
     m_pVertexFormat->Disable();
 }
 
-void VertexBufferDX9::Lock(const BufferLocking lockMode)
+void VertexBufferDX9::Lock(const BufferLocking lockMode, const unsigned int offset, const unsigned int count)
 {
+    VertexBuffer::Lock(lockMode, offset, count);
+
     //The pointer to the locked data is saved for future use
     assert(m_pTempBuffer == nullptr);
-    HRESULT hr = m_pVertexBuffer->Lock(0, 0, &m_pTempBuffer, BufferLockingDX9[lockMode]);
+    HRESULT hr = m_pVertexBuffer->Lock(m_nLockOffset * m_nElementSize, m_nLockCount * m_nElementSize, &m_pTempBuffer, BufferLockingDX9[lockMode]);
     S3D_VALIDATE_HRESULT(hr);
 }
 
@@ -111,7 +113,7 @@ void VertexBufferDX9::Update()
 {
     //Copy the local changes to our vertex buffer to where the locked data is
     assert(m_pTempBuffer != nullptr);
-    memcpy(m_pTempBuffer, GetData(), GetSize());
+    memcpy(m_pTempBuffer, GetData() + m_nLockOffset * m_nElementSize, m_nLockCount * m_nElementSize);
 }
 
 void VertexBufferDX9::Bind()
@@ -71,11 +71,13 @@ extern "C" {
 *****************************************************************/
 
 // Export/import LZ4 functions alongside Synesthesia3D ones
+#ifdef _WIN32
 #ifdef SYNESTHESIA3D_EXPORTS
 #define LZ4_DLL_EXPORT (1)
 #else
 #define LZ4_DLL_IMPORT (1)
 #endif // SYNESTHESIA3D_EXPORTS
+#endif // _WIN32
 
 /*
 *  LZ4_DLL_EXPORT :
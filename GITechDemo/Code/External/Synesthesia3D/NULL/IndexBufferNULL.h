@@ -32,7 +32,7 @@ namespace Synesthesia3D
     public:
         void    Enable() {}
         void    Disable() {}
-        void    Lock(const BufferLocking /*lockMode*/) {}
+        void    Lock(const BufferLocking lockMode, const unsigned int offset = 0u, const unsigned int count = 0u) { IndexBuffer::Lock(lockMode, offset, count); }
         void    Unlock() {}
         void    Update() {}
 
@@ -40,11 +40,11 @@ namespace Synesthesia3D
         void    Unbind() {}
 
     private:
-        IndexBufferNULL::IndexBufferNULL(
+        IndexBufferNULL(
             const unsigned int indexCount, const IndexBufferFormat indexFormat,
             const BufferUsage usage = BU_STATIC)
             : IndexBuffer(indexCount, indexFormat, usage) {}
-        IndexBufferNULL::~IndexBufferNULL() {}
+        ~IndexBufferNULL() {}
 
         friend class ResourceManagerNULL;
     };
@@ -33,8 +33,8 @@ namespace Synesthesia3D
         RenderStateNULL() {}
         ~RenderStateNULL() {}
 
-        const bool  SetScissor(const Vec2i /*size*/, const Vec2i /*offset = Vec2i(0, 0)*/) { return true; }
-        const bool  Flush() { return true; }
+        const bool  SetScissor(const Vec2i size, const Vec2i offset = Vec2i(0, 0)) { return RenderState::SetScissor(size, offset); }
+        const bool  Flush() { m_bDirty = false; return true; }
 
         friend class RendererNULL;
     };
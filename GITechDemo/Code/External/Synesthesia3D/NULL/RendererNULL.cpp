@@ -23,6 +23,7 @@
 #include "stdafx.h"
 
 #include "RendererNULL.h"
+#include "ProfilerNULL.h"
 #include "ResourceManagerNULL.h"
 #include "RenderStateNULL.h"
 #include "SamplerStateNULL.h"
@@ -34,6 +35,8 @@ void RendererNULL::Initialize(void* /*hWnd*/)
     m_pRenderStateManager = new RenderStateNULL();
     m_pSamplerStateManager = new SamplerStateNULL();
 
+    m_pProfiler = new ProfilerNULL();
+
     m_pSamplerStateManager->Reset();
     m_pRenderStateManager->Reset();
 }
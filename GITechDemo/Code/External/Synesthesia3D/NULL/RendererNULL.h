@@ -40,7 +40,7 @@ namespace Synesthesia3D
         static  RendererNULL* const GetInstance() { assert(ms_eAPI == API_NULL); return (RendererNULL*)ms_pInstance; };
 
         void    Initialize(void* hWnd);
-        void    SetViewport(const Vec2i /*size*/, const Vec2i /*offset = Vec2i(0, 0)*/) {}
+        void    SetViewport(const Vec2i size, const Vec2i offset = Vec2i(0, 0)) { Renderer::SetViewport(size, offset); }
         void    CreatePerspectiveMatrix(Matrix44f& matProj, const float fovYRad, const float aspectRatio, const float zNear, const float zFar) const;
         void    CreateInfinitePerspectiveMatrix(Matrix44f& matProj, const float fovYRad, const float aspectRatio, const float zNear) const;
         void    CreateOrthographicMatrix(Matrix44f& matProj, const float left, const float top, const float right, const float bottom, const float zNear, const float zFar) const;
@@ -55,7 +55,7 @@ namespace Synesthesia3D
         const bool  BeginFrame() { return Renderer::BeginFrame(); }
         void        EndFrame() { Renderer::EndFrame(); }
         void        SwapBuffers() { Renderer::SwapBuffers(); }
-        void        Clear(const Vec4f /*rgba*/, const float /*z*/, const unsigned int /*stencil*/) {}
+        void        Clear(const Vec4f rgba, const float z, const unsigned int stencil) { Renderer::Clear(rgba, z, stencil); }
         void        DrawVertexBuffer(VertexBuffer* const vb, const unsigned int vtxOffset, const unsigned int primCount, const unsigned int vtxCount, const unsigned int idxOffset) { Renderer::DrawVertexBuffer(vb, vtxOffset, primCount, vtxCount, idxOffset); }
 
         friend class Renderer;
@@ -40,7 +40,7 @@ namespace Synesthesia3D
         const bool  SetAddressingMode(const unsigned int slot, const SamplerAddressingMode samUVW);
 
         void        Reset() {}
-        const bool  Flush() { return true; }
+        const bool  Flush() { m_nDirtySlotMask = 0; return true; }
 
     protected:
         SamplerStateNULL() {}
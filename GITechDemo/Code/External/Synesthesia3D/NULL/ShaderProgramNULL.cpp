@@ -24,3 +24,9 @@
 
 #include "ShaderProgramNULL.h"
 using namespace Synesthesia3D;
+
+void ShaderProgramNULL::SetReflectedInputs(const std::vector<ShaderInputDesc>& inputDesc)
+{
+    m_arrReflectedInput = inputDesc;
+    DescribeShaderInputs();
+}
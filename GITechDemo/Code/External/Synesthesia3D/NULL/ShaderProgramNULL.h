@@ -31,6 +31,17 @@ namespace Synesthesia3D
 
     class ShaderProgramNULL : public ShaderProgram
     {
+    public:
+        /**
+         * @brief   Sets the inputs the program reports, in place of the reflection of a compiled program.
+         *
+         * @details The NULL backend doesn't compile shaders, so its programs have no inputs unless they
+         *          are described here. Shader inputs for the program have to be created afterwards.
+         *
+         * @param[in]   inputDesc   Inputs of the program, in the order of their data in the shader input buffer.
+         */
+        SYNESTHESIA3D_DLL void SetReflectedInputs(const std::vector<ShaderInputDesc>& inputDesc);
+
     private:
         ShaderProgramNULL(const ShaderProgramType programType, const char* /*srcData = ""*/, const char* /*entryPoint = ""*/, const char* /*profile = ""*/)
             : ShaderProgram(programType) {}
@@ -39,23 +50,25 @@ namespace Synesthesia3D
         void Bind() {}
         void Unbind() {}
 
-        const unsigned int GetConstantCount() const { return 0; }
-        const char* GetConstantName(const unsigned int /*handle*/) const { return ""; }
-        const InputType GetConstantType(const unsigned int /*handle*/) const { return IT_NONE; }
-        const RegisterType GetConstantRegisterType(const unsigned int /*handle*/) const { return RT_NONE; }
-        const unsigned int GetConstantRegisterIndex(const unsigned int /*handle*/) const { return 0; }
-        const unsigned int GetConstantRegisterCount(const unsigned int /*handle*/) const { return 0; }
-        const unsigned int GetConstantRowCount(const unsigned int /*handle*/) const { return 0; }
-        const unsigned int GetConstantColumnCount(const unsigned int /*handle*/) const { return 0; }
-        const unsigned int GetConstantArrayElementCount(const unsigned int /*handle*/) const { return 0; }
+        const unsigned int GetConstantCount() const { return (unsigned int)m_arrReflectedInput.size(); }
+        const char* GetConstantName(const unsigned int handle) const { return m_arrReflectedInput[handle].szName.c_str(); }
+        const InputType GetConstantType(const unsigned int handle) const { return m_arrReflectedInput[handle].eInputType; }
+        const RegisterType GetConstantRegisterType(const unsigned int handle) const { return m_arrReflectedInput[handle].eRegisterType; }
+        const unsigned int GetConstantRegisterIndex(const unsigned int handle) const { return m_arrReflectedInput[handle].nRegisterIndex; }
+        const unsigned int GetConstantRegisterCount(const unsigned int handle) const { return m_arrReflectedInput[handle].nRegisterCount; }
+        const unsigned int GetConstantRowCount(const unsigned int handle) const { return m_arrReflectedInput[handle].nRows; }
+        const unsigned int GetConstantColumnCount(const unsigned int handle) const { return m_arrReflectedInput[handle].nColumns; }
+        const unsigned int GetConstantArrayElementCount(const unsigned int handle) const { return m_arrReflectedInput[handle].nArrayElements; }
         const unsigned int GetConstantStructMemberCount(const unsigned int /*handle*/) const { return 0; }
-        const unsigned int GetConstantSizeBytes(const unsigned int /*handle*/) const { return 0; }
+        const unsigned int GetConstantSizeBytes(const unsigned int handle) const { return m_arrReflectedInput[handle].nBytes; }
 
         void SetFloat(const unsigned int /*registerIndex*/, const float* const /*data*/, const unsigned int /*registerCount*/) {}
         void SetInt(const unsigned int /*registerIndex*/, const int* const /*data*/, const unsigned int /*registerCount*/) {}
         void SetBool(const unsigned int /*registerIndex*/, const bool* const /*data*/, const unsigned int /*registerCount*/) {}
         void SetTexture(const unsigned int /*registerIndex*/, const Texture* const /*tex*/) {}
 
+        std::vector<ShaderInputDesc> m_arrReflectedInput;  /**< @brief Inputs set by @ref SetReflectedInputs(). */
+
         friend class ResourceManagerNULL;
     };
 }
@@ -0,0 +1,205 @@
+/**
+ * @file        FrameAllocatorTests.cpp
+ *
+ * @note        This file is part of the "Synesthesia3D" graphics engine
+ *
+ * @copyright   Copyright (C) Iftode Bogdan-Marius <iftode.bogdan@gmail.com>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * @copyright
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ * @copyright
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <atomic>
+#include <new>
+#include <cstdlib>
+
+#include <Renderer.h>
+#include <Profiler.h>
+#include <Utility/Allocator.h>
+#include <Utility/FrameAllocator.h>
+using namespace Synesthesia3D;
+
+#include "Synesthesia3DTests.h"
+using namespace Synesthesia3DTests;
+
+#define FRAME_COUNT (1000)
+#define WARMUP_FRAME_COUNT (10)
+
+// Counts all heap allocations of the process, including those that don't go through the engine's
+// allocator (e.g. STL containers with the default allocator), for the whole test executable
+static std::atomic<unsigned long long> gHeapAllocationCount(0);
+
+void* operator new(const size_t size)
+{
+    gHeapAllocationCount++;
+    void* const ptr = malloc(size > 0 ? size : 1);
+    if (ptr == nullptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](const size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* const ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* const ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void* const ptr, const size_t) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void* const ptr, const size_t) noexcept
+{
+    free(ptr);
+}
+
+// Counts the engine's allocations, per tag, and checks that all of them are freed
+class CountingAllocator : public Allocator
+{
+public:
+    CountingAllocator()
+    {
+        for (unsigned int tag = 0; tag < AT_MAX; tag++)
+        {
+            m_nAllocationCount[tag] = 0;
+            m_nFreeCount[tag] = 0;
+        }
+    }
+
+    void* Allocate(const size_t size, const size_t alignment, const AllocationTag tag)
+    {
+        m_nAllocationCount[tag]++;
+        return aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    }
+
+    void Free(void* const ptr, const AllocationTag tag)
+    {
+        m_nFreeCount[tag]++;
+        free(ptr);
+    }
+
+    const unsigned long long GetAllocationCount() const
+    {
+        unsigned long long count = 0;
+        for (unsigned int tag = 0; tag < AT_MAX; tag++)
+            count += m_nAllocationCount[tag];
+        return count;
+    }
+
+    std::atomic<unsigned long long> m_nAllocationCount[AT_MAX];
+    std::atomic<unsigned long long> m_nFreeCount[AT_MAX];
+};
+
+// Transient data of a frame, similar to what the render passes allocate; its size
+// varies from frame to frame, but stays below that of the largest warmup frame
+static void AllocateFrameData(FrameAllocator* const frameAllocator, const unsigned int frame)
+{
+    const char* const label = frameAllocator->Format("Frame %u, cascade %u", frame, frame % 4);
+    S3D_CHECK(label != nullptr && label[0] == 'F');
+
+    float* const distances = frameAllocator->NewArray<float>(256 + frame % 64);
+    S3D_CHECK(distances != nullptr && distances[0] == 0.f);
+
+    FrameVector<unsigned int> indices{ FrameStlAllocator<unsigned int>(*frameAllocator) };
+    for (unsigned int i = 0; i < 4096 + frame % 1024; i++)
+        indices.push_back(i);
+
+    FrameString text{ FrameStlAllocator<char>(*frameAllocator) };
+    for (unsigned int i = 0; i < 64; i++)
+        text += label;
+
+    // Larger than a block of the frame allocator, so that both buffers have to grow during warmup
+    if (frame < S3D_FRAME_ALLOCATOR_BUFFER_COUNT)
+        frameAllocator->Allocate(1024u * 1024u);
+}
+
+// Profile markers and CPU scopes of a frame, labeled the way the render passes label them
+static void ProfileFrame(Profiler* const profiler, FrameAllocator* const frameAllocator, const unsigned int frame)
+{
+    CPU_PROFILE_SCOPE("Frame");
+    PUSH_PROFILE_MARKER("Shadow map");
+
+    for (unsigned int cascade = 0; cascade < 4; cascade++)
+    {
+        // A new label every frame, for the same few strings
+        const char* const label = frameAllocator->Format("Cascade %u", cascade);
+        PUSH_DYNAMIC_PROFILE_MARKER(label);
+        CPU_PROFILE_SCOPE(label);
+        AllocateFrameData(frameAllocator, frame);
+        POP_PROFILE_MARKER();
+    }
+
+    POP_PROFILE_MARKER();
+
+    // Read back the counters of the previous frame's scopes, as the profiler UI does
+    const unsigned int markerId = profiler->FindProfileMarkerLabel("Cascade 0");
+    S3D_CHECK(markerId != ~0u);
+    S3D_CHECK(frame == 0 || profiler->RetrieveProfileMarkerCounters(markerId) != nullptr);
+}
+
+S3D_TEST(FrameAllocator, SteadyStateFramesDontAllocate)
+{
+    CountingAllocator allocator;
+    const AllocationStats frameStatsBefore = Allocator::GetStats(AT_FRAME);
+
+    {
+        NullRendererScope renderer(&allocator);
+        FrameAllocator* const frameAllocator = renderer->GetFrameAllocator();
+        Profiler* const profiler = renderer->GetProfiler();
+        S3D_CHECK(frameAllocator != nullptr && profiler != nullptr);
+
+        unsigned long long heapAllocationCount = 0;
+        unsigned long long engineAllocationCount = 0;
+        size_t reservedSize = 0;
+
+        for (unsigned int frame = 0; frame < FRAME_COUNT; frame++)
+        {
+            if (frame == WARMUP_FRAME_COUNT)
+            {
+                heapAllocationCount = gHeapAllocationCount;
+                engineAllocationCount = allocator.GetAllocationCount();
+                reservedSize = frameAllocator->GetReservedSize();
+            }
+
+            S3D_CHECK(renderer->BeginFrame());
+            ProfileFrame(profiler, frameAllocator, frame);
+            renderer->EndFrame();
+            renderer->SwapBuffers();
+        }
+
+        S3D_CHECK(gHeapAllocationCount == heapAllocationCount);
+        S3D_CHECK(allocator.GetAllocationCount() == engineAllocationCount);
+        S3D_CHECK(frameAllocator->GetReservedSize() == reservedSize);
+    }
+
+    // Everything the per-frame allocator allocated is freed along with the renderer
+    for (unsigned int tag = 0; tag < AT_MAX; tag++)
+        S3D_CHECK(allocator.m_nAllocationCount[tag] == allocator.m_nFreeCount[tag]);
+
+    const AllocationStats frameStatsAfter = Allocator::GetStats(AT_FRAME);
+    S3D_CHECK(frameStatsAfter.nAllocationCount > frameStatsBefore.nAllocationCount);
+    S3D_CHECK(frameStatsAfter.nAllocationCount - frameStatsBefore.nAllocationCount == frameStatsAfter.nFreeCount - frameStatsBefore.nFreeCount);
+    S3D_CHECK(frameStatsAfter.nAllocatedBytes == frameStatsBefore.nAllocatedBytes);
+}
@@ -0,0 +1,73 @@
+/**
+ * @file        ResourceManagerTests.cpp
+ *
+ * @note        This file is part of the "Synesthesia3D" graphics engine
+ *
+ * @copyright   Copyright (C) Iftode Bogdan-Marius <iftode.bogdan@gmail.com>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * @copyright
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ * @copyright
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <Renderer.h>
+#include <ResourceManager.h>
+#include <RenderTarget.h>
+#include <Texture.h>
+using namespace Synesthesia3D;
+
+#include "Synesthesia3DTests.h"
+using namespace Synesthesia3DTests;
+
+S3D_TEST(ResourceManager, ReleaseRenderTargetTextures)
+{
+    NullRendererScope renderer;
+    ResourceManager* const resMan = renderer->GetResourceManager();
+
+    const unsigned int rtIdx = resMan->CreateRenderTarget(1, PF_A8R8G8B8, 16u, 16u, false, true, PF_D24S8);
+    const RenderTarget* const rt = resMan->GetRenderTarget(rtIdx);
+    S3D_CHECK(rt != nullptr);
+    if (!rt)
+        return;
+
+    const unsigned int colorIdx = rt->GetColorBuffer();
+    const unsigned int depthIdx = rt->GetDepthBuffer();
+    const unsigned int textureCount = resMan->GetTextureCount();
+
+    // The render target releases its own textures
+    resMan->ReleaseRenderTarget(rtIdx);
+    S3D_CHECK(resMan->GetTexture(colorIdx) == nullptr);
+    S3D_CHECK(resMan->GetTexture(depthIdx) == nullptr);
+
+    // Releasing them again must not free their slots twice
+    resMan->ReleaseTexture(colorIdx);
+    resMan->ReleaseTexture(depthIdx);
+
+    const unsigned int texIdx[] =
+    {
+        resMan->CreateTexture(PF_A8R8G8B8, TT_2D, 4, 4),
+        resMan->CreateTexture(PF_A8R8G8B8, TT_2D, 4, 4),
+        resMan->CreateTexture(PF_A8R8G8B8, TT_2D, 4, 4),
+        resMan->CreateTexture(PF_A8R8G8B8, TT_2D, 4, 4)
+    };
+
+    for (unsigned int i = 0; i < 4; i++)
+        for (unsigned int j = i + 1; j < 4; j++)
+            S3D_CHECK(texIdx[i] != texIdx[j]);
+
+    for (unsigned int i = 0; i < 4; i++)
+        S3D_CHECK(resMan->GetTexture(texIdx[i]) != nullptr);
+
+    S3D_CHECK(resMan->GetTextureCount() == textureCount + 2);
+}
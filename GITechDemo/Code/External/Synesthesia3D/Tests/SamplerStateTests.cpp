@@ -0,0 +1,104 @@
+/**
+ * @file        SamplerStateTests.cpp
+ *
+ * @note        This file is part of the "Synesthesia3D" graphics engine
+ *
+ * @copyright   Copyright (C) Iftode Bogdan-Marius <iftode.bogdan@gmail.com>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * @copyright
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ * @copyright
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <Renderer.h>
+#include <ResourceManager.h>
+#include <SamplerState.h>
+#include <Texture.h>
+using namespace Synesthesia3D;
+
+#include "Synesthesia3DTests.h"
+using namespace Synesthesia3DTests;
+
+S3D_TEST(SamplerState, ReleaseBoundTexture)
+{
+    NullRendererScope renderer;
+    ResourceManager* const resMan = renderer->GetResourceManager();
+    SamplerState* const ssm = renderer->GetSamplerStateManager();
+
+    const unsigned int texIdx = resMan->CreateTexture(PF_A8R8G8B8, TT_2D, 4, 4);
+    const Texture* const texture = resMan->GetTexture(texIdx);
+    S3D_CHECK(texture != nullptr);
+
+    ssm->BindTexture(0, texture);
+    ssm->BindTexture(3, texture);
+    S3D_CHECK(ssm->GetBoundTexture(0) == texture);
+    S3D_CHECK(ssm->GetBoundTexture(3) == texture);
+
+    // Freeing the texture must not leave it bound to any slot
+    resMan->ReleaseTexture(texIdx);
+    S3D_CHECK(ssm->GetBoundTexture(0) == nullptr);
+    S3D_CHECK(ssm->GetBoundTexture(3) == nullptr);
+
+    // Unbinding the slot afterwards is filtered, instead of going through the freed texture
+    ssm->BindTexture(0, nullptr);
+    ssm->BindTexture(3, nullptr);
+    S3D_CHECK(ssm->GetBoundTexture(0) == nullptr);
+    S3D_CHECK(ssm->GetBoundTexture(3) == nullptr);
+}
+
+S3D_TEST(SamplerState, ReleaseAllBoundTextures)
+{
+    NullRendererScope renderer;
+    ResourceManager* const resMan = renderer->GetResourceManager();
+    SamplerState* const ssm = renderer->GetSamplerStateManager();
+
+    const unsigned int texIdx = resMan->CreateTexture(PF_A8R8G8B8, TT_2D, 4, 4);
+    ssm->BindTexture(1, resMan->GetTexture(texIdx));
+
+    resMan->ReleaseAll();
+    S3D_CHECK(ssm->GetBoundTexture(1) == nullptr);
+
+    ssm->BindTexture(1, nullptr);
+    S3D_CHECK(ssm->GetBoundTexture(1) == nullptr);
+}
+
+S3D_TEST(SamplerState, FrameCounters)
+{
+    NullRendererScope renderer;
+    ResourceManager* const resMan = renderer->GetResourceManager();
+    SamplerState* const ssm = renderer->GetSamplerStateManager();
+
+    const unsigned int texIdx = resMan->CreateTexture(PF_A8R8G8B8, TT_2D, 4, 4);
+    const Texture* const texture = resMan->GetTexture(texIdx);
+
+    S3D_CHECK(renderer->BeginFrame());
+    ssm->BindTexture(0, texture);
+    ssm->BindTexture(0, texture);
+    ssm->BindTexture(0, nullptr);
+    ssm->SetAnisotropy(0, 4u);
+    ssm->SetAnisotropy(0, 4u);
+    ssm->SetAnisotropy(0, 4u);
+    renderer->EndFrame();
+    renderer->SwapBuffers();
+
+    // Counters are reported for the frame that has ended
+    S3D_CHECK(renderer->BeginFrame());
+    const RenderCounters& counters = renderer->GetFrameCounters();
+    S3D_CHECK(counters[RC_TEXTURE_BINDS] == 2);
+    S3D_CHECK(counters[RC_FILTERED_TEXTURE_BINDS] == 1);
+    S3D_CHECK(counters[RC_SAMPLER_STATE_CHANGES] == 1);
+    S3D_CHECK(counters[RC_FILTERED_SAMPLER_STATE_CHANGES] == 2);
+    renderer->EndFrame();
+    renderer->SwapBuffers();
+}
@@ -0,0 +1,281 @@
+/**
+ * @file        ShaderCacheTests.cpp
+ *
+ * @note        This file is part of the "Synesthesia3D" graphics engine
+ *
+ * @copyright   Copyright (C) Iftode Bogdan-Marius <iftode.bogdan@gmail.com>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * @copyright
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ * @copyright
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <cstdio>
+#include <cstring>
+
+#ifdef WIN32
+    #include <direct.h>
+#else
+    #include <sys/stat.h>
+#endif
+
+#include <ShaderCache.h>
+using namespace Synesthesia3D;
+
+#include "Synesthesia3DTests.h"
+using namespace Synesthesia3DTests;
+
+#define SOURCE_DIRECTORY "ShaderCacheTests"
+#define CACHE_DIRECTORY SOURCE_DIRECTORY "/Cache"
+#define SOURCE_FILE SOURCE_DIRECTORY "/Test.hlsl"
+#define INCLUDE_FILE SOURCE_DIRECTORY "/Common.hlsli"
+#define SHADER_PROFILE "ps_3_0"
+#define SHADER_ENTRY_POINT "psmain"
+
+static void WriteFile(const char* const filePath, const std::string& contents)
+{
+    std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+    file << contents;
+}
+
+static const std::string ReadFile(const char* const filePath)
+{
+    std::ifstream file(filePath, std::ios::binary);
+    std::ostringstream oss;
+    oss << file.rdbuf();
+    return oss.str();
+}
+
+static const std::string GetEntryFilePath(const unsigned long long key)
+{
+    std::ostringstream oss;
+    oss << CACHE_DIRECTORY << "/" << std::hex << std::setw(16) << std::setfill('0') << key << S3D_SHADER_CACHE_FILE_EXTENSION;
+    return oss.str();
+}
+
+// Writes the shader sources and points the cache to an empty directory
+static void SetUp(ShaderCache* const shaderCache)
+{
+#ifdef WIN32
+    _mkdir(SOURCE_DIRECTORY);
+#else
+    mkdir(SOURCE_DIRECTORY, 0755);
+#endif
+
+    WriteFile(SOURCE_FILE, "#include \"Common.hlsli\"\nfloat4 psmain() : COLOR { return GetColor(); }\n");
+    WriteFile(INCLUDE_FILE, "float4 GetColor() { return float4(1, 0, 0, 1); }\n");
+
+    shaderCache->SetDirectory(CACHE_DIRECTORY);
+}
+
+static const unsigned long long ComputeKey()
+{
+    return ShaderCache::ComputeKey(SOURCE_FILE, std::vector<std::string>(), SHADER_ENTRY_POINT, SHADER_PROFILE, 0, 1);
+}
+
+// Stores a dummy program for the current sources, making sure no entry of a previous run is found instead
+static const unsigned long long StoreEntry(ShaderCache* const shaderCache, const std::string& bytecode)
+{
+    const unsigned long long key = ComputeKey();
+    std::remove(GetEntryFilePath(key).c_str());
+
+    ShaderInputDesc desc;
+    desc.szName = "f4Color";
+    desc.nNameHash = 42;
+    desc.eInputType = IT_FLOAT;
+    desc.eRegisterType = RT_FLOAT4;
+    desc.nRegisterIndex = 3;
+    desc.nRegisterCount = 1;
+    desc.nRows = 1;
+    desc.nColumns = 4;
+    desc.nArrayElements = 1;
+    desc.nBytes = 16;
+    desc.nOffsetInBytes = 48;
+
+    S3D_CHECK(shaderCache->Store(key, bytecode.data(), (unsigned int)bytecode.size(), std::vector<ShaderInputDesc>(1, desc)));
+
+    return key;
+}
+
+S3D_TEST(ShaderCache, Miss)
+{
+    NullRendererScope renderer;
+    ShaderCache* const shaderCache = renderer->GetShaderCache();
+    SetUp(shaderCache);
+
+    const unsigned long long key = ComputeKey();
+    S3D_CHECK(key != 0);
+    std::remove(GetEntryFilePath(key).c_str());
+
+    std::vector<char> bytecode;
+    std::vector<ShaderInputDesc> inputDesc;
+    S3D_CHECK(!shaderCache->Load(key, bytecode, inputDesc));
+    S3D_CHECK(bytecode.empty() && inputDesc.empty());
+    S3D_CHECK(shaderCache->GetHitCount() == 0);
+    S3D_CHECK(shaderCache->GetMissCount() == 1);
+}
+
+S3D_TEST(ShaderCache, Hit)
+{
+    NullRendererScope renderer;
+    ShaderCache* const shaderCache = renderer->GetShaderCache();
+    SetUp(shaderCache);
+
+    const std::string storedBytecode = "dummy bytecode";
+    const unsigned long long key = StoreEntry(shaderCache, storedBytecode);
+
+    std::vector<char> bytecode;
+    std::vector<ShaderInputDesc> inputDesc;
+    S3D_CHECK(shaderCache->Load(key, bytecode, inputDesc));
+    S3D_CHECK(std::string(bytecode.begin(), bytecode.end()) == storedBytecode);
+    S3D_CHECK(inputDesc.size() == 1);
+    if (inputDesc.size() == 1)
+    {
+        S3D_CHECK(inputDesc[0].szName == "f4Color");
+        S3D_CHECK(inputDesc[0].nNameHash == 42);
+        S3D_CHECK(inputDesc[0].eInputType == IT_FLOAT);
+        S3D_CHECK(inputDesc[0].eRegisterType == RT_FLOAT4);
+        S3D_CHECK(inputDesc[0].nRegisterIndex == 3);
+        S3D_CHECK(inputDesc[0].nColumns == 4);
+        S3D_CHECK(inputDesc[0].nBytes == 16);
+        S3D_CHECK(inputDesc[0].nOffsetInBytes == 48);
+    }
+    S3D_CHECK(shaderCache->GetHitCount() == 1);
+    S3D_CHECK(shaderCache->GetMissCount() == 0);
+
+    // The key depends on the compilation parameters, too
+    S3D_CHECK(ShaderCache::ComputeKey(SOURCE_FILE, std::vector<std::string>(1, "FOO=1"), SHADER_ENTRY_POINT, SHADER_PROFILE, 0, 1) != key);
+    S3D_CHECK(ShaderCache::ComputeKey(SOURCE_FILE, std::vector<std::string>(), SHADER_ENTRY_POINT, "ps_2_0", 0, 1) != key);
+    S3D_CHECK(ShaderCache::ComputeKey(SOURCE_FILE, std::vector<std::string>(), SHADER_ENTRY_POINT, SHADER_PROFILE, 0, 2) != key);
+}
+
+S3D_TEST(ShaderCache, SourceEditInvalidates)
+{
+    NullRendererScope renderer;
+    ShaderCache* const shaderCache = renderer->GetShaderCache();
+    SetUp(shaderCache);
+
+    const unsigned long long oldKey = StoreEntry(shaderCache, "dummy bytecode");
+
+    WriteFile(SOURCE_FILE, "#include \"Common.hlsli\"\nfloat4 psmain() : COLOR { return GetColor() * 0.5f; }\n");
+    const unsigned long long newKey = ComputeKey();
+    S3D_CHECK(newKey != 0 && newKey != oldKey);
+    std::remove(GetEntryFilePath(newKey).c_str());
+
+    std::vector<char> bytecode;
+    std::vector<ShaderInputDesc> inputDesc;
+    S3D_CHECK(!shaderCache->Load(newKey, bytecode, inputDesc));
+    S3D_CHECK(shaderCache->GetMissCount() == 1);
+}
+
+S3D_TEST(ShaderCache, IncludeEditInvalidates)
+{
+    NullRendererScope renderer;
+    ShaderCache* const shaderCache = renderer->GetShaderCache();
+    SetUp(shaderCache);
+
+    std::vector<std::string> includeFiles;
+    const unsigned long long oldKey = ShaderCache::ComputeKey(SOURCE_FILE, std::vector<std::string>(), SHADER_ENTRY_POINT, SHADER_PROFILE, 0, 1, &includeFiles);
+    S3D_CHECK(includeFiles.size() == 2);
+    S3D_CHECK(StoreEntry(shaderCache, "dummy bytecode") == oldKey);
+
+    WriteFile(INCLUDE_FILE, "float4 GetColor() { return float4(0, 1, 0, 1); }\n");
+    const unsigned long long newKey = ComputeKey();
+    S3D_CHECK(newKey != 0 && newKey != oldKey);
+    std::remove(GetEntryFilePath(newKey).c_str());
+
+    std::vector<char> bytecode;
+    std::vector<ShaderInputDesc> inputDesc;
+    S3D_CHECK(!shaderCache->Load(newKey, bytecode, inputDesc));
+    S3D_CHECK(shaderCache->GetMissCount() == 1);
+
+    // Reverting the edit finds the original entry again
+    SetUp(shaderCache);
+    S3D_CHECK(ComputeKey() == oldKey);
+    S3D_CHECK(shaderCache->Load(oldKey, bytecode, inputDesc));
+    S3D_CHECK(shaderCache->GetHitCount() == 1);
+}
+
+S3D_TEST(ShaderCache, CorruptEntryRejected)
+{
+    NullRendererScope renderer;
+    ShaderCache* const shaderCache = renderer->GetShaderCache();
+    SetUp(shaderCache);
+
+    const unsigned long long key = StoreEntry(shaderCache, "dummy bytecode");
+    const std::string entryFilePath = GetEntryFilePath(key);
+    const std::string entry = ReadFile(entryFilePath.c_str());
+    S3D_CHECK(entry.size() > S3D_SHADER_CACHE_FILE_HEADER_SIZE);
+
+    // The signature is stored without its terminator
+    S3D_CHECK(S3D_SHADER_CACHE_FILE_HEADER_SIZE == strlen(S3D_SHADER_CACHE_FILE_HEADER));
+    S3D_CHECK(entry.compare(0, S3D_SHADER_CACHE_FILE_HEADER_SIZE, S3D_SHADER_CACHE_FILE_HEADER) == 0);
+
+    std::vector<char> bytecode;
+    std::vector<ShaderInputDesc> inputDesc;
+
+    // Bad signature
+    std::string corruptEntry = entry;
+    corruptEntry[1] = 'X';
+    WriteFile(entryFilePath.c_str(), corruptEntry);
+    S3D_CHECK(!shaderCache->Load(key, bytecode, inputDesc));
+
+    // Truncated inside the reflected inputs
+    WriteFile(entryFilePath.c_str(), entry.substr(0, entry.size() - 8));
+    S3D_CHECK(!shaderCache->Load(key, bytecode, inputDesc));
+    S3D_CHECK(bytecode.empty() && inputDesc.empty());
+
+    // Bytecode size past the end of the file
+    corruptEntry = entry;
+    const unsigned int bytecodeSize = 0x7FFFFFFF;
+    corruptEntry.replace(S3D_SHADER_CACHE_FILE_HEADER_SIZE + sizeof(unsigned int) + sizeof(unsigned long long), sizeof(bytecodeSize), (const char*)&bytecodeSize, sizeof(bytecodeSize));
+    WriteFile(entryFilePath.c_str(), corruptEntry);
+    S3D_CHECK(!shaderCache->Load(key, bytecode, inputDesc));
+
+    // Empty file
+    WriteFile(entryFilePath.c_str(), "");
+    S3D_CHECK(!shaderCache->Load(key, bytecode, inputDesc));
+
+    S3D_CHECK(shaderCache->GetHitCount() == 0);
+    S3D_CHECK(shaderCache->GetMissCount() == 4);
+
+    // Storing the entry again repairs it
+    StoreEntry(shaderCache, "dummy bytecode");
+    S3D_CHECK(shaderCache->Load(key, bytecode, inputDesc));
+    S3D_CHECK(shaderCache->GetHitCount() == 1);
+}
+
+S3D_TEST(ShaderCache, OldVersionRejected)
+{
+    NullRendererScope renderer;
+    ShaderCache* const shaderCache = renderer->GetShaderCache();
+    SetUp(shaderCache);
+
+    const unsigned long long key = StoreEntry(shaderCache, "dummy bytecode");
+    const std::string entryFilePath = GetEntryFilePath(key);
+
+    std::string entry = ReadFile(entryFilePath.c_str());
+    const unsigned int fileVersion = S3D_SHADER_CACHE_FILE_VERSION - 1;
+    entry.replace(S3D_SHADER_CACHE_FILE_HEADER_SIZE, sizeof(fileVersion), (const char*)&fileVersion, sizeof(fileVersion));
+    WriteFile(entryFilePath.c_str(), entry);
+
+    std::vector<char> bytecode;
+    std::vector<ShaderInputDesc> inputDesc;
+    S3D_CHECK(!shaderCache->Load(key, bytecode, inputDesc));
+    S3D_CHECK(shaderCache->GetHitCount() == 0);
+    S3D_CHECK(shaderCache->GetMissCount() == 1);
+}
@@ -0,0 +1,117 @@
+/**
+ * @file        ShaderProgramTests.cpp
+ *
+ * @note        This file is part of the "Synesthesia3D" graphics engine
+ *
+ * @copyright   Copyright (C) Iftode Bogdan-Marius <iftode.bogdan@gmail.com>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * @copyright
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ * @copyright
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <Renderer.h>
+#include <ResourceManager.h>
+#include <ShaderInput.h>
+#include <ShaderProgramNULL.h>
+using namespace Synesthesia3D;
+
+#include "Synesthesia3DTests.h"
+using namespace Synesthesia3DTests;
+
+static const ShaderInputDesc DescribeFloat4(const char* const name, const unsigned int registerIndex)
+{
+    ShaderInputDesc desc;
+    desc.szName = name;
+    desc.nNameHash = 0;
+    desc.eInputType = IT_FLOAT;
+    desc.eRegisterType = RT_FLOAT4;
+    desc.nRegisterIndex = registerIndex;
+    desc.nRegisterCount = 1;
+    desc.nRows = 1;
+    desc.nColumns = 4;
+    desc.nArrayElements = 1;
+    desc.nBytes = sizeof(float) * 4u;
+    desc.nOffsetInBytes = 0;
+    return desc;
+}
+
+// Commits the shader input in a frame of its own and returns the counters of that frame
+static const RenderCounters CommitFrame(NullRendererScope& renderer, ShaderProgram* const shaderProgram, ShaderInput* const shaderInput)
+{
+    S3D_CHECK(renderer->BeginFrame());
+    shaderProgram->Enable(shaderInput);
+    shaderProgram->Disable();
+    renderer->EndFrame();
+    renderer->SwapBuffers();
+
+    S3D_CHECK(renderer->BeginFrame());
+    const RenderCounters counters = renderer->GetFrameCounters();
+    renderer->EndFrame();
+    renderer->SwapBuffers();
+
+    return counters;
+}
+
+S3D_TEST(ShaderProgram, MergeConstantUploads)
+{
+    NullRendererScope renderer;
+    ResourceManager* const resMan = renderer->GetResourceManager();
+
+    const unsigned int spIdx = resMan->CreateShaderProgram("Test.hlsl", SPT_PIXEL, "psmain");
+    ShaderProgramNULL* const shaderProgram = (ShaderProgramNULL*)resMan->GetShaderProgram(spIdx);
+    S3D_CHECK(shaderProgram != nullptr);
+
+    // c0 to c3 can be uploaded together, c10 has to be uploaded on its own
+    std::vector<ShaderInputDesc> inputDesc;
+    inputDesc.push_back(DescribeFloat4("f4Input0", 0));
+    inputDesc.push_back(DescribeFloat4("f4Input1", 1));
+    inputDesc.push_back(DescribeFloat4("f4Input2", 2));
+    inputDesc.push_back(DescribeFloat4("f4Input3", 3));
+    inputDesc.push_back(DescribeFloat4("f4Input10", 10));
+    shaderProgram->SetReflectedInputs(inputDesc);
+
+    ShaderInput* const shaderInput = resMan->GetShaderInput(resMan->CreateShaderInput(shaderProgram));
+    S3D_CHECK(shaderInput->GetSize() == 5 * sizeof(float) * 4u);
+    unsigned int handle[5];
+    for (unsigned int i = 0; i < 5; i++)
+        S3D_CHECK(shaderInput->GetInputHandleByName(inputDesc[i].szName.c_str(), handle[i]));
+
+    // Everything is uploaded the first time, one upload per register range
+    RenderCounters counters = CommitFrame(renderer, shaderProgram, shaderInput);
+    S3D_CHECK(counters[RC_CONSTANT_UPLOADS] == 2);
+    S3D_CHECK(counters[RC_CONSTANT_BYTES] == 5 * sizeof(float) * 4u);
+
+    // Nothing has changed since
+    counters = CommitFrame(renderer, shaderProgram, shaderInput);
+    S3D_CHECK(counters[RC_CONSTANT_UPLOADS] == 0);
+    S3D_CHECK(counters[RC_CONSTANT_BYTES] == 0);
+
+    // Adjacent constants are uploaded together, the non-adjacent one separately
+    shaderInput->SetFloat4(handle[0], Vec4f(1.f, 2.f, 3.f, 4.f));
+    shaderInput->SetFloat4(handle[1], Vec4f(5.f, 6.f, 7.f, 8.f));
+    shaderInput->SetFloat4(handle[3], Vec4f(9.f, 10.f, 11.f, 12.f));
+    counters = CommitFrame(renderer, shaderProgram, shaderInput);
+    S3D_CHECK(counters[RC_CONSTANT_UPLOADS] == 2);
+    S3D_CHECK(counters[RC_CONSTANT_BYTES] == 3 * sizeof(float) * 4u);
+
+    // Constants from different register ranges are never merged
+    shaderInput->SetFloat4(handle[3], Vec4f(0.f, 0.f, 0.f, 0.f));
+    shaderInput->SetFloat4(handle[4], Vec4f(0.f, 0.f, 0.f, 0.f));
+    counters = CommitFrame(renderer, shaderProgram, shaderInput);
+    S3D_CHECK(counters[RC_CONSTANT_UPLOADS] == 2);
+    S3D_CHECK(counters[RC_CONSTANT_BYTES] == 2 * sizeof(float) * 4u);
+
+    const float* const data = (const float*)shaderInput->GetData();
+    S3D_CHECK(data[4] == 5.f && data[8] == 0.f && data[12] == 0.f);
+}
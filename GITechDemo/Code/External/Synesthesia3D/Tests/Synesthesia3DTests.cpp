@@ -0,0 +1,100 @@
+/**
+ * @file        Synesthesia3DTests.cpp
+ *
+ * @note        This file is part of the "Synesthesia3D" graphics engine
+ *
+ * @copyright   Copyright (C) Iftode Bogdan-Marius <iftode.bogdan@gmail.com>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * @copyright
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ * @copyright
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include <cstring>
+
+#include "Synesthesia3DTests.h"
+using namespace Synesthesia3DTests;
+
+static unsigned int gFailureCount = 0;
+
+std::vector<TestCase>& Synesthesia3DTests::GetTestCases()
+{
+    static std::vector<TestCase> testCases;
+    return testCases;
+}
+
+void Synesthesia3DTests::ReportFailure(const char* const file, const unsigned int line, const char* const expression)
+{
+    std::cerr << file << "(" << line << "): check failed: " << expression << std::endl;
+    gFailureCount++;
+}
+
+TestRegistrar::TestRegistrar(const char* const suite, const char* const name, TestFunction function)
+{
+    const TestCase testCase = { suite, name, function };
+    GetTestCases().push_back(testCase);
+}
+
+NullRendererScope::NullRendererScope(Synesthesia3D::Allocator* const allocator)
+{
+    Synesthesia3D::Renderer::CreateInstance(Synesthesia3D::API_NULL, allocator);
+    Synesthesia3D::Renderer::GetInstance()->Initialize(nullptr);
+}
+
+NullRendererScope::~NullRendererScope()
+{
+    Synesthesia3D::Renderer::DestroyInstance();
+}
+
+Synesthesia3D::Renderer* const NullRendererScope::operator->() const
+{
+    return Synesthesia3D::Renderer::GetInstance();
+}
+
+// Usage: Synesthesia3DTests [suite]
+// Runs every registered test case, or only those of the given suite.
+int main(int argc, char* argv[])
+{
+    const char* const suite = argc > 1 ? argv[1] : nullptr;
+
+    unsigned int runCount = 0;
+    unsigned int failedCount = 0;
+
+    const std::vector<TestCase>& testCases = GetTestCases();
+    for (unsigned int i = 0; i < testCases.size(); i++)
+    {
+        if (suite && strcmp(suite, testCases[i].szSuite) != 0)
+            continue;
+
+        const unsigned int failureCount = gFailureCount;
+        testCases[i].pFunction();
+        runCount++;
+
+        const bool passed = gFailureCount == failureCount;
+        if (!passed)
+            failedCount++;
+
+        std::cout << (passed ? "[PASSED] " : "[FAILED] ") << testCases[i].szSuite << "." << testCases[i].szName << std::endl;
+    }
+
+    if (runCount == 0)
+    {
+        std::cerr << "No test cases found" << (suite ? " in suite " : "") << (suite ? suite : "") << std::endl;
+        return 1;
+    }
+
+    std::cout << runCount - failedCount << "/" << runCount << " test cases passed" << std::endl;
+
+    return failedCount > 0 ? 1 : 0;
+}
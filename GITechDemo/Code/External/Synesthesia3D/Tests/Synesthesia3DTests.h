@@ -0,0 +1,88 @@
+/**
+ * @file        Synesthesia3DTests.h
+ *
+ * @note        This file is part of the "Synesthesia3D" graphics engine
+ *
+ * @copyright   Copyright (C) Iftode Bogdan-Marius <iftode.bogdan@gmail.com>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * @copyright
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ * @copyright
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SYNESTHESIA3DTESTS_H
+#define SYNESTHESIA3DTESTS_H
+
+#include <vector>
+
+#include <Renderer.h>
+
+namespace Synesthesia3DTests
+{
+    typedef void (*TestFunction)();
+
+    /**
+     * @brief   A test case, registered through @ref S3D_TEST().
+     */
+    struct TestCase
+    {
+        const char*     szSuite;    /**< @brief Name of the suite the test belongs to. */
+        const char*     szName;     /**< @brief Name of the test. */
+        TestFunction    pFunction;  /**< @brief Function running the test. */
+    };
+
+    /**
+     * @brief   Retrieves all registered test cases.
+     */
+    std::vector<TestCase>& GetTestCases();
+
+    /**
+     * @brief   Records a failed check of the running test case.
+     */
+    void ReportFailure(const char* const file, const unsigned int line, const char* const expression);
+
+    /**
+     * @brief   Registers a test case on construction.
+     */
+    class TestRegistrar
+    {
+    public:
+        TestRegistrar(const char* const suite, const char* const name, TestFunction function);
+    };
+
+    /**
+     * @brief   Creates and initializes a NULL renderer for the lifetime of the scope.
+     */
+    class NullRendererScope
+    {
+    public:
+        NullRendererScope(Synesthesia3D::Allocator* const allocator = nullptr);
+        ~NullRendererScope();
+
+        Synesthesia3D::Renderer* const operator->() const;
+
+    private:
+        NullRendererScope(const NullRendererScope&);
+        NullRendererScope& operator=(const NullRendererScope&);
+    };
+}
+
+#define S3D_TEST(suite, name) \
+    static void suite##_##name(); \
+    static Synesthesia3DTests::TestRegistrar suite##_##name##_Registrar(#suite, #name, suite##_##name); \
+    static void suite##_##name()
+
+#define S3D_CHECK(expr) \
+    do { if (!(expr)) Synesthesia3DTests::ReportFailure(__FILE__, __LINE__, #expr); } while (0)
+
+#endif // SYNESTHESIA3DTESTS_H
@@ -0,0 +1,167 @@
+/**
+ * @file        Allocator.cpp
+ *
+ * @note        This file is part of the "Synesthesia3D" graphics engine
+ *
+ * @copyright   Copyright (C) Iftode Bogdan-Marius <iftode.bogdan@gmail.com>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * @copyright
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ * @copyright
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "stdafx.h"
+
+#include <atomic>
+#include <stdlib.h>
+
+#include "Allocator.h"
+#include "Debug.h"
+using namespace Synesthesia3D;
+
+namespace
+{
+    // Used when no allocator is registered; these don't depend on the order of initialization of
+    // static objects, since memory may be allocated before main() (e.g. by static containers)
+    void* HeapAllocate(const size_t size, const size_t alignment)
+    {
+    #ifdef WIN32
+        return _aligned_malloc(size, alignment);
+    #else
+        return aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    #endif
+    }
+
+    void HeapFree(void* const ptr)
+    {
+    #ifdef WIN32
+        _aligned_free(ptr);
+    #else
+        free(ptr);
+    #endif
+    }
+
+    // Precedes every allocation, so that it can be freed through the allocator which allocated it
+    struct AllocationHeader
+    {
+        Allocator*      pAllocator; // nullptr for the heap
+        size_t          nSize;      // Size requested by the user
+        size_t          nOffset;    // Offset of the user's memory from the beginning of the allocation
+        AllocationTag   eTag;
+    };
+
+    struct TagStats
+    {
+        std::atomic<unsigned long long> nAllocationCount;
+        std::atomic<unsigned long long> nFreeCount;
+        std::atomic<unsigned long long> nAllocatedBytes;
+        std::atomic<unsigned long long> nPeakAllocatedBytes;
+    };
+
+    std::atomic<Allocator*> g_pCurrentAllocator(nullptr);
+    TagStats                g_tTagStats[AT_MAX];
+}
+
+void* Allocator::AllocateMemory(const size_t size, const AllocationTag tag, const size_t alignment)
+{
+    assert(tag >= 0 && tag < AT_MAX);
+    assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+    // The header sits right before the user's memory, which keeps the requested alignment
+    const size_t align = alignment > alignof(AllocationHeader) ? alignment : alignof(AllocationHeader);
+    const size_t offset = (sizeof(AllocationHeader) + align - 1) / align * align;
+
+    Allocator* const allocator = g_pCurrentAllocator.load();
+    char* const mem = (char*)(allocator ? allocator->Allocate(offset + size, align, tag) : HeapAllocate(offset + size, align));
+    if (mem == nullptr)
+    {
+        S3D_DBGPRINT("Failed to allocate %u bytes", (unsigned int)size);
+        assert(false);
+        return nullptr;
+    }
+
+    AllocationHeader* const header = (AllocationHeader*)(mem + offset) - 1;
+    header->pAllocator = allocator;
+    header->nSize = size;
+    header->nOffset = offset;
+    header->eTag = tag;
+
+    TagStats& stats = g_tTagStats[tag];
+    stats.nAllocationCount++;
+    const unsigned long long allocatedBytes = (stats.nAllocatedBytes += size);
+    unsigned long long peak = stats.nPeakAllocatedBytes.load();
+    while (allocatedBytes > peak && !stats.nPeakAllocatedBytes.compare_exchange_weak(peak, allocatedBytes));
+
+    return mem + offset;
+}
+
+void Allocator::FreeMemory(void* const ptr)
+{
+    if (ptr == nullptr)
+        return;
+
+    const AllocationHeader header = *((AllocationHeader*)ptr - 1);
+    assert(header.eTag >= 0 && header.eTag < AT_MAX);
+
+    TagStats& stats = g_tTagStats[header.eTag];
+    stats.nFreeCount++;
+    stats.nAllocatedBytes -= header.nSize;
+
+    if (header.pAllocator)
+        header.pAllocator->Free((char*)ptr - header.nOffset, header.eTag);
+    else
+        HeapFree((char*)ptr - header.nOffset);
+}
+
+Allocator* const Allocator::GetCurrent()
+{
+    return g_pCurrentAllocator.load();
+}
+
+void Allocator::SetCurrent(Allocator* const allocator)
+{
+    g_pCurrentAllocator.store(allocator);
+}
+
+const AllocationStats Allocator::GetStats(const AllocationTag tag)
+{
+    assert(tag >= 0 && tag < AT_MAX);
+
+    AllocationStats stats;
+    stats.nAllocationCount = g_tTagStats[tag].nAllocationCount.load();
+    stats.nFreeCount = g_tTagStats[tag].nFreeCount.load();
+    stats.nAllocatedBytes = g_tTagStats[tag].nAllocatedBytes.load();
+    stats.nPeakAllocatedBytes = g_tTagStats[tag].nPeakAllocatedBytes.load();
+
+    return stats;
+}
+
+const char* const Allocator::GetTagName(const AllocationTag tag)
+{
+    switch (tag)
+    {
+    case AT_RESOURCES:
+        return "Resources";
+    case AT_SHADER_INPUTS:
+        return "Shader inputs";
+    case AT_PROFILER:
+        return "Profiler";
+    case AT_SERIALIZATION:
+        return "Serialization";
+    case AT_FRAME:
+        return "Per-frame";
+    default:
+        assert(false);
+        return "";
+    }
+}
@@ -0,0 +1,207 @@
+/**
+ * @file        Allocator.h
+ *
+ * @note        This file is part of the "Synesthesia3D" graphics engine
+ *
+ * @copyright   Copyright (C) Iftode Bogdan-Marius <iftode.bogdan@gmail.com>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * @copyright
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ * @copyright
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+#ifndef SYNESTHESIA3D_DLL
+#ifdef SYNESTHESIA3D_EXPORTS
+#define SYNESTHESIA3D_DLL __declspec(dllexport) /**< @brief Export/import directive keyword. */
+#else
+#define SYNESTHESIA3D_DLL __declspec(dllimport) /**< @brief Export/import directive keyword. */
+#endif
+#endif // SYNESTHESIA3D_DLL
+
+#include <stddef.h>
+#include <new>
+
+#define S3D_DEFAULT_ALLOCATION_ALIGNMENT (16) /**< @brief Alignment of allocations for which none is specified, enough for any fundamental type. */
+
+namespace Synesthesia3D
+{
+    /**
+     * @brief   Subsystems on whose behalf memory is allocated, for which allocation statistics are gathered separately.
+     */
+    enum AllocationTag
+    {
+        AT_RESOURCES,       /**< @brief Resources, their data and the bookkeeping of the resource manager. */
+        AT_SHADER_INPUTS,   /**< @brief Shader input values and their upload bookkeeping. */
+        AT_PROFILER,        /**< @brief Profile markers and the buffers in which they are recorded. */
+        AT_SERIALIZATION,   /**< @brief Memory used while reading resources from files (e.g. decompressed models). */
+        AT_FRAME,           /**< @brief Transient memory of the frames in flight (see @ref FrameAllocator). */
+
+        AT_MAX              /**< @brief Number of allocation tags. */
+    };
+
+    /**
+     * @brief   Allocation statistics of an @ref AllocationTag.
+     */
+    struct AllocationStats
+    {
+        unsigned long long  nAllocationCount;   /**< @brief Allocations made so far. */
+        unsigned long long  nFreeCount;         /**< @brief Allocations freed so far. */
+        unsigned long long  nAllocatedBytes;    /**< @brief Bytes currently allocated. */
+        unsigned long long  nPeakAllocatedBytes; /**< @brief Highest value of @ref nAllocatedBytes so far. */
+    };
+
+    /**
+     * @brief   Interface through which the engine allocates memory.
+     *
+     * @details Implement it to plug in pooled or arena allocators and register it when
+     *          creating the rendering context (see @ref Renderer::CreateInstance()).
+     *          The engine never calls it directly: allocations go through @ref AllocateMemory(),
+     *          which remembers the allocator that served each allocation, so that it is freed by
+     *          the same one, and gathers statistics for each @ref AllocationTag.
+     *
+     * @note    Allocations are made from all threads that create resources or record profile
+     *          markers, so implementations must be thread safe. An allocator must stay valid
+     *          until all memory it has allocated has been freed.
+     */
+    class Allocator
+    {
+
+    public:
+
+        /**
+         * @brief   Destructor.
+         */
+        virtual ~Allocator() {}
+
+        /**
+         * @brief   Allocates memory.
+         *
+         * @param[in]   size        Size, in bytes, of the allocation.
+         * @param[in]   alignment   Alignment, in bytes, of the allocation; a power of two.
+         * @param[in]   tag         Subsystem on whose behalf the memory is allocated.
+         *
+         * @return  Pointer to the allocated memory, or nullptr on failure.
+         */
+        virtual void*   Allocate(const size_t size, const size_t alignment, const AllocationTag tag) = 0;
+
+        /**
+         * @brief   Frees memory allocated with @ref Allocate().
+         *
+         * @param[in]   ptr     Pointer returned by @ref Allocate().
+         * @param[in]   tag     Tag with which the memory was allocated.
+         */
+        virtual void    Free(void* const ptr, const AllocationTag tag) = 0;
+
+        /**
+         * @brief   Allocates memory from the current allocator.
+         *
+         * @param[in]   size        Size, in bytes, of the allocation.
+         * @param[in]   tag         Subsystem on whose behalf the memory is allocated.
+         * @param[in]   alignment   Alignment, in bytes, of the allocation; a power of two.
+         *
+         * @return  Pointer to the allocated memory, to be freed with @ref FreeMemory().
+         */
+        static  SYNESTHESIA3D_DLL   void*                   AllocateMemory(const size_t size, const AllocationTag tag, const size_t alignment = S3D_DEFAULT_ALLOCATION_ALIGNMENT);
+
+        /**
+         * @brief   Frees memory allocated with @ref AllocateMemory(), through the allocator which allocated it.
+         *
+         * @param[in]   ptr     Pointer returned by @ref AllocateMemory(), or nullptr.
+         */
+        static  SYNESTHESIA3D_DLL   void                    FreeMemory(void* const ptr);
+
+        /**
+         * @brief   Retrieves the allocator used for new allocations (nullptr if allocating from the heap).
+         */
+        static  SYNESTHESIA3D_DLL   Allocator* const        GetCurrent();
+
+        /**
+         * @brief   Retrieves the allocation statistics of a subsystem.
+         */
+        static  SYNESTHESIA3D_DLL   const AllocationStats   GetStats(const AllocationTag tag);
+
+        /**
+         * @brief   Retrieves the name of an allocation tag, for displaying statistics.
+         */
+        static  SYNESTHESIA3D_DLL   const char* const       GetTagName(const AllocationTag tag);
+
+    protected:
+
+        /**
+         * @brief   Sets the allocator used for new allocations (nullptr to allocate from the heap).
+         */
+        static void SetCurrent(Allocator* const allocator);
+
+        friend class Renderer;
+    };
+
+    /**
+     * @brief   Allocator of STL containers which allocates memory through @ref Allocator::AllocateMemory().
+     */
+    template <typename T, AllocationTag TAG>
+    class StlAllocator
+    {
+
+    public:
+
+        typedef T value_type;
+
+        template <typename U>
+        struct rebind { typedef StlAllocator<U, TAG> other; };
+
+        StlAllocator() {}
+
+        template <typename U>
+        StlAllocator(const StlAllocator<U, TAG>&) {}
+
+        T* allocate(const size_t count)
+        {
+            T* const ptr = (T*)Allocator::AllocateMemory(count * sizeof(T), TAG, alignof(T) > S3D_DEFAULT_ALLOCATION_ALIGNMENT ? alignof(T) : S3D_DEFAULT_ALLOCATION_ALIGNMENT);
+            if (ptr == nullptr)
+                throw std::bad_alloc();
+
+            return ptr;
+        }
+
+        void deallocate(T* const ptr, const size_t)
+        {
+            Allocator::FreeMemory(ptr);
+        }
+
+        template <typename U>
+        const bool operator==(const StlAllocator<U, TAG>&) const { return true; }
+
+        template <typename U>
+        const bool operator!=(const StlAllocator<U, TAG>&) const { return false; }
+    };
+}
+
+/**
+ * @brief   Declares class specific allocation functions, so that objects of the class (and of classes derived
+ *          from it, unless they declare their own) are allocated through @ref Synesthesia3D::Allocator::AllocateMemory().
+ *
+ * @note    Place it at the beginning of the class declaration. Members following it are public, until the next access specifier.
+ */
+#define S3D_ALLOCATION_TAG(tag) \
+    public: \
+        static void* operator new(const size_t size) { void* const ptr = Synesthesia3D::Allocator::AllocateMemory(size, tag); if (ptr == nullptr) throw std::bad_alloc(); return ptr; } \
+        static void* operator new[](const size_t size) { void* const ptr = Synesthesia3D::Allocator::AllocateMemory(size, tag); if (ptr == nullptr) throw std::bad_alloc(); return ptr; } \
+        static void* operator new(const size_t, void* const where) { return where; } \
+        static void operator delete(void* const ptr) { Synesthesia3D::Allocator::FreeMemory(ptr); } \
+        static void operator delete[](void* const ptr) { Synesthesia3D::Allocator::FreeMemory(ptr); } \
+        static void operator delete(void* const, void* const) {}
+
+#endif // ALLOCATOR_H
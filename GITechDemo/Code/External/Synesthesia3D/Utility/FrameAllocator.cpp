@@ -0,0 +1,100 @@
+/**
+ * @file        FrameAllocator.cpp
+ *
+ * @note        This file is part of the "Synesthesia3D" graphics engine
+ *
+ * @copyright   Copyright (C) Iftode Bogdan-Marius <iftode.bogdan@gmail.com>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * @copyright
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ * @copyright
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "stdafx.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+
+#include "FrameAllocator.h"
+using namespace Synesthesia3D;
+
+FrameAllocator::FrameAllocator(const size_t blockSize)
+    : m_nCurrFrame(0)
+{
+    for (unsigned int i = 0; i < S3D_FRAME_ALLOCATOR_BUFFER_COUNT; i++)
+        m_pFrame[i] = new LinearAllocator(blockSize, AT_FRAME);
+}
+
+FrameAllocator::~FrameAllocator()
+{
+    for (unsigned int i = 0; i < S3D_FRAME_ALLOCATOR_BUFFER_COUNT; i++)
+        delete m_pFrame[i];
+}
+
+void* FrameAllocator::Allocate(const size_t size, const size_t alignment)
+{
+    return m_pFrame[m_nCurrFrame]->Allocate(size, alignment);
+}
+
+const char* const FrameAllocator::Format(const char* const format, ...)
+{
+    va_list args;
+
+    va_start(args, format);
+    const int length = vsnprintf(nullptr, 0, format, args);
+    va_end(args);
+
+    if (length < 0)
+        return "";
+
+    char* const str = (char*)Allocate(length + 1, 1);
+
+    va_start(args, format);
+    vsnprintf(str, length + 1, format, args);
+    va_end(args);
+
+    return str;
+}
+
+const size_t FrameAllocator::GetUsedSize() const
+{
+    return m_pFrame[m_nCurrFrame]->GetUsedSize();
+}
+
+const size_t FrameAllocator::GetReservedSize() const
+{
+    size_t size = 0;
+    for (unsigned int i = 0; i < S3D_FRAME_ALLOCATOR_BUFFER_COUNT; i++)
+        size += m_pFrame[i]->GetReservedSize();
+
+    return size;
+}
+
+void FrameAllocator::BeginFrame()
+{
+    m_nCurrFrame = (m_nCurrFrame + 1) % S3D_FRAME_ALLOCATOR_BUFFER_COUNT;
+
+    // If the frame didn't fit in a single block, replace its blocks with one which
+    // fits it entirely, so that the following frames don't allocate more blocks
+    LinearAllocator* const frame = m_pFrame[m_nCurrFrame];
+    if (frame->GetBlockCount() > 1)
+    {
+        const size_t usedSize = frame->GetUsedSize();
+        frame->Release();
+        frame->Reserve(usedSize + usedSize / 4);
+    }
+    else
+    {
+        frame->Reset();
+    }
+}
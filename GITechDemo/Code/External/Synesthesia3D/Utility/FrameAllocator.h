@@ -0,0 +1,156 @@
+/**
+ * @file        FrameAllocator.h
+ *
+ * @note        This file is part of the "Synesthesia3D" graphics engine
+ *
+ * @copyright   Copyright (C) Iftode Bogdan-Marius <iftode.bogdan@gmail.com>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * @copyright
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ * @copyright
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAMEALLOCATOR_H
+#define FRAMEALLOCATOR_H
+
+#include <string>
+#include <vector>
+
+#include "LinearAllocator.h"
+
+#define S3D_FRAME_ALLOCATOR_BUFFER_COUNT (2) /**< @brief Number of frames for which per-frame allocations stay valid. */
+
+namespace Synesthesia3D
+{
+    /**
+     * @brief   Allocates transient memory which is only valid for a short, fixed number of frames.
+     *
+     * @details Each frame allocates from its own @ref LinearAllocator, which is reset when it is reused,
+     *          @ref S3D_FRAME_ALLOCATOR_BUFFER_COUNT frames later (see @ref Renderer::BeginFrame()).
+     *          Memory allocated during a frame is therefore valid until the end of the next one,
+     *          so it doesn't matter whether it was allocated before or after @ref Renderer::BeginFrame().
+     *          Once the frames' memory requirements settle, frames make no heap allocations.
+     *
+     * @note    Destructors of the objects constructed in memory from the allocator are not called.
+     *          Not thread safe: meant to be used only by the rendering thread.
+     */
+    class FrameAllocator
+    {
+
+    public:
+
+        /**
+         * @brief   Allocates memory, valid until the end of the next frame.
+         *
+         * @param[in]   size        Size, in bytes, of the allocation.
+         * @param[in]   alignment   Alignment, in bytes, of the allocation; must be a power of two.
+         */
+        SYNESTHESIA3D_DLL void*     Allocate(const size_t size, const size_t alignment = S3D_DEFAULT_ALLOCATION_ALIGNMENT);
+
+        /**
+         * @brief   Allocates memory for an array of objects and default constructs them.
+         */
+        template <typename T>
+        T*                          NewArray(const size_t count)
+        {
+            T* const arr = (T*)Allocate(sizeof(T) * count, alignof(T));
+            for (size_t i = 0; i < count; i++)
+                new (arr + i) T();
+
+            return arr;
+        }
+
+        /**
+         * @brief   Formats a string (see printf()) in memory which is valid until the end of the next frame.
+         */
+        SYNESTHESIA3D_DLL const char* const Format(const char* const format, ...);
+
+        /**
+         * @brief   Retrieves the size, in bytes, of the memory allocated during the current frame.
+         */
+        SYNESTHESIA3D_DLL const size_t GetUsedSize() const;
+
+        /**
+         * @brief   Retrieves the size, in bytes, of the memory reserved for all frames.
+         */
+        SYNESTHESIA3D_DLL const size_t GetReservedSize() const;
+
+    protected:
+
+        /**
+         * @brief   Constructor.
+         *
+         * @param[in]   blockSize   Initial size, in bytes, of the memory reserved for each frame.
+         */
+        FrameAllocator(const size_t blockSize = 256u * 1024u);
+
+        /**
+         * @brief   Destructor. Frees the memory of all frames.
+         */
+        ~FrameAllocator();
+
+        /**
+         * @brief   Moves on to the next frame's memory, invalidating the allocations made
+         *          @ref S3D_FRAME_ALLOCATOR_BUFFER_COUNT frames ago.
+         *
+         * @note    Called by @ref Renderer::BeginFrame().
+         */
+        void BeginFrame();
+
+        LinearAllocator*    m_pFrame[S3D_FRAME_ALLOCATOR_BUFFER_COUNT]; /**< @brief Memory of each frame in flight. */
+        unsigned int        m_nCurrFrame;                               /**< @brief Index of the current frame's memory in @ref m_pFrame. */
+
+        friend class Renderer;
+    };
+
+    /**
+     * @brief   Allocator of STL containers which allocates memory from a @ref FrameAllocator.
+     *
+     * @note    Memory is only reclaimed when the frame's memory is reused, so reserve the
+     *          required capacity upfront, if known, instead of growing the containers.
+     */
+    template <typename T>
+    class FrameStlAllocator
+    {
+
+    public:
+
+        typedef T value_type;
+
+        template <typename U>
+        struct rebind { typedef FrameStlAllocator<U> other; };
+
+        FrameStlAllocator(FrameAllocator& frameAllocator) : m_pFrameAllocator(&frameAllocator) {}
+
+        template <typename U>
+        FrameStlAllocator(const FrameStlAllocator<U>& other) : m_pFrameAllocator(other.m_pFrameAllocator) {}
+
+        T* allocate(const size_t count) { return (T*)m_pFrameAllocator->Allocate(count * sizeof(T), alignof(T)); }
+        void deallocate(T* const, const size_t) {}
+
+        template <typename U>
+        const bool operator==(const FrameStlAllocator<U>& other) const { return m_pFrameAllocator == other.m_pFrameAllocator; }
+
+        template <typename U>
+        const bool operator!=(const FrameStlAllocator<U>& other) const { return m_pFrameAllocator != other.m_pFrameAllocator; }
+
+        FrameAllocator* m_pFrameAllocator;
+    };
+
+    template <typename T>
+    using FrameVector = std::vector<T, FrameStlAllocator<T>>;   /**< @brief Vector in memory which is valid until the end of the next frame. */
+
+    typedef std::basic_string<char, std::char_traits<char>, FrameStlAllocator<char>> FrameString;  /**< @brief String in memory which is valid until the end of the next frame. */
+}
+
+#endif // FRAMEALLOCATOR_H
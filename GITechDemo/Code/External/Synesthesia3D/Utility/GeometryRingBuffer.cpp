@@ -0,0 +1,164 @@
+/**
+ * @file        GeometryRingBuffer.cpp
+ *
+ * @note        This file is part of the "Synesthesia3D" graphics engine
+ *
+ * @copyright   Copyright (C) Iftode Bogdan-Marius <iftode.bogdan@gmail.com>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * @copyright
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ * @copyright
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "stdafx.h"
+
+#include "Renderer.h"
+#include "ResourceManager.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+
+#include "GeometryRingBuffer.h"
+using namespace Synesthesia3D;
+
+GeometryRingBuffer::GeometryRingBuffer(VertexFormat* const vertexFormat, const unsigned int vertexCount, const unsigned int indexCount, const IndexBufferFormat indexFormat)
+    : m_pVertexFormat(vertexFormat)
+    , m_eIndexFormat(indexFormat)
+    , m_nVertexBufferIdx(~0u)
+    , m_pVertexBuffer(nullptr)
+    , m_nIndexBufferIdx(~0u)
+    , m_pIndexBuffer(nullptr)
+    , m_nVertexCursor(0u)
+    , m_nIndexCursor(0u)
+    , m_bLocked(false)
+    , m_bIndicesLocked(false)
+{
+    assert(vertexFormat != nullptr);
+    CreateBuffers(Math::Max(vertexCount, 1u), indexCount);
+}
+
+GeometryRingBuffer::~GeometryRingBuffer()
+{
+    assert(!m_bLocked);
+    ReleaseBuffers();
+}
+
+void GeometryRingBuffer::Lock(const unsigned int vertexCount, const unsigned int indexCount, unsigned int& vertexOffset, unsigned int& indexOffset)
+{
+    assert(!m_bLocked);
+    assert(vertexCount > 0);
+    assert(indexCount == 0 || m_pIndexBuffer != nullptr);
+
+    const unsigned int vertexCapacity = m_pVertexBuffer->GetElementCount();
+    const unsigned int indexCapacity = m_pIndexBuffer ? m_pIndexBuffer->GetElementCount() : 0u;
+    if (vertexCount > vertexCapacity || indexCount > indexCapacity)
+    {
+        S3D_DBGPRINT("GeometryRingBuffer: growing to fit %u vertices and %u indices", vertexCount, indexCount);
+        CreateBuffers(Math::Max(vertexCount, vertexCapacity * 2u), m_pIndexBuffer ? Math::Max(indexCount, indexCapacity * 2u) : 0u);
+    }
+
+    const BufferLocking vbLockMode = Suballocate(vertexCount, m_pVertexBuffer->GetElementCount(), m_nVertexCursor, vertexOffset);
+    m_pVertexBuffer->Lock(vbLockMode, vertexOffset, vertexCount);
+    m_bLocked = true;
+
+    indexOffset = 0u;
+    if (indexCount > 0)
+    {
+        const BufferLocking ibLockMode = Suballocate(indexCount, m_pIndexBuffer->GetElementCount(), m_nIndexCursor, indexOffset);
+        m_pIndexBuffer->Lock(ibLockMode, indexOffset, indexCount);
+        m_bIndicesLocked = true;
+    }
+}
+
+void GeometryRingBuffer::Unlock()
+{
+    assert(m_bLocked);
+
+    m_pVertexBuffer->Update();
+    m_pVertexBuffer->Unlock();
+    m_bLocked = false;
+
+    if (m_bIndicesLocked)
+    {
+        m_pIndexBuffer->Update();
+        m_pIndexBuffer->Unlock();
+        m_bIndicesLocked = false;
+    }
+}
+
+VertexBuffer* const GeometryRingBuffer::GetVertexBuffer() const
+{
+    return m_pVertexBuffer;
+}
+
+IndexBuffer* const GeometryRingBuffer::GetIndexBuffer() const
+{
+    return m_pIndexBuffer;
+}
+
+void GeometryRingBuffer::CreateBuffers(const unsigned int vertexCount, const unsigned int indexCount)
+{
+    ReleaseBuffers();
+
+    ResourceManager* const resMan = Renderer::GetInstance()->GetResourceManager();
+
+    if (indexCount > 0)
+    {
+        m_nIndexBufferIdx = resMan->CreateIndexBuffer(indexCount, m_eIndexFormat, BU_DYNAMIC);
+        m_pIndexBuffer = resMan->GetIndexBuffer(m_nIndexBufferIdx);
+    }
+
+    m_nVertexBufferIdx = resMan->CreateVertexBuffer(m_pVertexFormat, vertexCount, m_pIndexBuffer, BU_DYNAMIC);
+    m_pVertexBuffer = resMan->GetVertexBuffer(m_nVertexBufferIdx);
+
+    // Place the next ranges past the ends of the new buffers, so that they're locked with BL_WRITE_DISCARD
+    m_nVertexCursor = vertexCount;
+    m_nIndexCursor = indexCount;
+}
+
+void GeometryRingBuffer::ReleaseBuffers()
+{
+    Renderer* const renderer = Renderer::GetInstance();
+    ResourceManager* const resMan = renderer ? renderer->GetResourceManager() : nullptr;
+
+    if (m_nVertexBufferIdx != ~0u)
+    {
+        if (resMan)
+            resMan->ReleaseVertexBuffer(m_nVertexBufferIdx);
+        m_nVertexBufferIdx = ~0u;
+        m_pVertexBuffer = nullptr;
+    }
+
+    if (m_nIndexBufferIdx != ~0u)
+    {
+        if (resMan)
+            resMan->ReleaseIndexBuffer(m_nIndexBufferIdx);
+        m_nIndexBufferIdx = ~0u;
+        m_pIndexBuffer = nullptr;
+    }
+}
+
+const BufferLocking GeometryRingBuffer::Suballocate(const unsigned int count, const unsigned int capacity, unsigned int& cursor, unsigned int& offset)
+{
+    assert(count <= capacity);
+
+    if (cursor + count > capacity)
+    {
+        offset = 0u;
+        cursor = count;
+        return BL_WRITE_DISCARD;
+    }
+
+    offset = cursor;
+    cursor += count;
+    return BL_WRITE_NO_OVERWRITE;
+}
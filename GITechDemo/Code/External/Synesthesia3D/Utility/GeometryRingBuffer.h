@@ -0,0 +1,139 @@
+/**
+ * @file        GeometryRingBuffer.h
+ *
+ * @note        This file is part of the "Synesthesia3D" graphics engine
+ *
+ * @copyright   Copyright (C) Iftode Bogdan-Marius <iftode.bogdan@gmail.com>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * @copyright
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ * @copyright
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GEOMETRYRINGBUFFER_H
+#define GEOMETRYRINGBUFFER_H
+
+#include "ResourceData.h"
+
+namespace Synesthesia3D
+{
+    class VertexFormat;
+    class VertexBuffer;
+    class IndexBuffer;
+
+    /**
+     * @brief   Streams geometry which changes every frame (e.g. UI, debug drawing, particles) through
+     *          a pair of @ref BU_DYNAMIC vertex/index buffers, suballocated as ring buffers.
+     *
+     * @details Each @ref Lock() reserves the next range of vertices and indices, which is locked with
+     *          @ref BL_WRITE_NO_OVERWRITE, so that the GPU may keep drawing the ranges before it.
+     *          When a range does not fit before the end of its buffer, it starts over from the beginning,
+     *          and the buffer is locked with @ref BL_WRITE_DISCARD, so that the driver hands out a new
+     *          memory block instead of waiting for the GPU to finish with the old one.
+     *          The buffers are only recreated (with at least twice their capacity) when a single range
+     *          does not fit in them at all.
+     *
+     * @note    The update flow is: @ref Lock() > write the vertices/indices of the locked ranges through
+     *          @ref GetVertexBuffer()/@ref GetIndexBuffer() > @ref Unlock() > draw them, passing the offsets
+     *          returned by @ref Lock() to @ref Renderer::DrawVertexBuffer().
+     *          Draw the geometry of a range before locking the next one, which may discard it.
+     *          Indices are relative to the vertex offset of their range.
+     */
+    class GeometryRingBuffer
+    {
+        S3D_ALLOCATION_TAG(AT_RESOURCES)
+
+    public:
+
+        /**
+         * @brief   Constructor. Creates the vertex/index buffers.
+         *
+         * @param[in]   vertexFormat    The format of the vertices. See @ref VertexFormat.
+         * @param[in]   vertexCount     The initial capacity, in vertices, of the vertex buffer.
+         * @param[in]   indexCount      The initial capacity, in indices, of the index buffer (0 for non-indexed geometry).
+         * @param[in]   indexFormat     The data format of the indices (16 or 32 bit integers).
+         */
+        SYNESTHESIA3D_DLL GeometryRingBuffer(
+            VertexFormat* const vertexFormat, const unsigned int vertexCount,
+            const unsigned int indexCount = 0u, const IndexBufferFormat indexFormat = IBF_INDEX16);
+
+        /**
+         * @brief   Destructor. Releases the vertex/index buffers.
+         */
+        SYNESTHESIA3D_DLL ~GeometryRingBuffer();
+
+        /**
+         * @brief   Reserves and locks the next ranges of the vertex/index buffers.
+         *
+         * @param[in]   vertexCount     The number of vertices to be written.
+         * @param[in]   indexCount      The number of indices to be written (0 for non-indexed geometry).
+         * @param[out]  vertexOffset    The first vertex of the locked range.
+         * @param[out]  indexOffset     The first index of the locked range.
+         *
+         * @note    May recreate the buffers, so retrieve them afterwards.
+         */
+        SYNESTHESIA3D_DLL void      Lock(const unsigned int vertexCount, const unsigned int indexCount, unsigned int& vertexOffset, unsigned int& indexOffset);
+
+        /**
+         * @brief   Flushes the locked ranges to the vertex/index buffers and unlocks them.
+         */
+        SYNESTHESIA3D_DLL void      Unlock();
+
+        /**
+         * @brief   Retrieves the vertex buffer, which has the index buffer associated with it.
+         */
+        SYNESTHESIA3D_DLL VertexBuffer* const   GetVertexBuffer() const;
+
+        /**
+         * @brief   Retrieves the index buffer (nullptr for non-indexed geometry).
+         */
+        SYNESTHESIA3D_DLL IndexBuffer* const    GetIndexBuffer() const;
+
+    protected:
+
+        /**
+         * @brief   Recreates the buffers with enough capacity for the specified number of vertices and indices.
+         */
+        void CreateBuffers(const unsigned int vertexCount, const unsigned int indexCount);
+
+        /**
+         * @brief   Releases the buffers.
+         */
+        void ReleaseBuffers();
+
+        /**
+         * @brief   Reserves the next range of a buffer, starting over from its beginning if the range does not fit before its end.
+         *
+         * @param[in]       count       The number of elements in the range.
+         * @param[in]       capacity    The number of elements in the buffer.
+         * @param[in,out]   cursor      The first element following the previously reserved range.
+         * @param[out]      offset      The first element of the range.
+         *
+         * @return  The mode with which to lock the range.
+         */
+        static const BufferLocking Suballocate(const unsigned int count, const unsigned int capacity, unsigned int& cursor, unsigned int& offset);
+
+        VertexFormat*       m_pVertexFormat;    /**< @brief The format of the vertices. */
+        IndexBufferFormat   m_eIndexFormat;     /**< @brief The data format of the indices. */
+        unsigned int        m_nVertexBufferIdx; /**< @brief Index of the vertex buffer in the @ref ResourceManager. */
+        VertexBuffer*       m_pVertexBuffer;    /**< @brief The vertex buffer. */
+        unsigned int        m_nIndexBufferIdx;  /**< @brief Index of the index buffer in the @ref ResourceManager, if indexed. */
+        IndexBuffer*        m_pIndexBuffer;     /**< @brief The index buffer, if indexed. */
+        unsigned int        m_nVertexCursor;    /**< @brief The vertex following the last reserved range. */
+        unsigned int        m_nIndexCursor;     /**< @brief The index following the last reserved range. */
+        bool                m_bLocked;          /**< @brief Whether the vertex buffer is locked. */
+        bool                m_bIndicesLocked;   /**< @brief Whether the index buffer is locked. */
+    };
+}
+
+#endif // GEOMETRYRINGBUFFER_H
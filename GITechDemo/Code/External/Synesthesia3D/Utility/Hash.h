@@ -23,20 +23,58 @@
 #ifndef HASH_H_
 #define HASH_H_
 
-#include <string.h>
 #include <stdint.h>
-#include <stdio.h>
 
-#define S3DH1(s,i,x)    (x*65599u+(uint8_t)s[(i)<strlen(s)?strlen(s)-1-(i):strlen(s)])  /**< @brief DO NOT USE! INTERNAL USAGE ONLY! */
-#define S3DH4(s,i,x)    S3DH1(s,i,S3DH1(s,i+1,S3DH1(s,i+2,S3DH1(s,i+3,x))))             /**< @brief DO NOT USE! INTERNAL USAGE ONLY! */
-#define S3DH16(s,i,x)   S3DH4(s,i,S3DH4(s,i+4,S3DH4(s,i+8,S3DH4(s,i+12,x))))            /**< @brief DO NOT USE! INTERNAL USAGE ONLY! */
-#define S3DH64(s,i,x)   S3DH16(s,i,S3DH16(s,i+16,S3DH16(s,i+32,S3DH16(s,i+48,x))))      /**< @brief DO NOT USE! INTERNAL USAGE ONLY! */
-#define S3DH256(s,i,x)  S3DH64(s,i,S3DH64(s,i+64,S3DH64(s,i+128,S3DH64(s,i+192,x))))    /**< @brief DO NOT USE! INTERNAL USAGE ONLY! */
+namespace Synesthesia3D
+{
+    /**
+     * @brief   32 bit FNV-1a hash of a null terminated string.
+     *
+     * @details Being constexpr, string literals are hashed at compile time when the result
+     *          is used in a constant expression (see @ref StringHash), while other strings
+     *          are hashed in a single pass at runtime.
+     *
+     * @param[in]   str     Null terminated string to hash.
+     *
+     * @return  Hash of the string.
+     */
+    constexpr uint32_t HashString(const char* const str)
+    {
+        uint32_t hash = 2166136261u;
+        for (const char* c = str; *c; c++)
+            hash = (hash ^ (uint8_t)*c) * 16777619u;
+        return hash;
+    }
+
+    /**
+     * @brief   A string hash which is guaranteed to be computed at compile time
+     *          when constructed from a string literal in a constant expression.
+     *
+     * @details e.g. constexpr StringHash hash("f2HalfTexelOffset");
+     */
+    struct StringHash
+    {
+        constexpr StringHash(const char* const str)
+            : nHash(HashString(str))
+        {}
+
+        constexpr explicit StringHash(const uint32_t hash)
+            : nHash(hash)
+        {}
+
+        constexpr operator uint32_t() const { return nHash; }
+
+        constexpr bool operator==(const StringHash& rhs) const { return nHash == rhs.nHash; }
+        constexpr bool operator!=(const StringHash& rhs) const { return nHash != rhs.nHash; }
+
+        uint32_t nHash; /**< @brief Hash value (see @ref HashString()). */
+    };
+}
 
 /**
  * @brief Used for hashing shader input names.
  * @see Synesthesia3D::ShaderInput::GetInputHandleByNameHash()
  */
-#define S3DHASH(s)      ((uint32_t)(S3DH256(s,0,0)^(S3DH256(s,0,0)>>16)))
+#define S3DHASH(s)      (Synesthesia3D::HashString(s))
 
 #endif // HASH_H_
@@ -0,0 +1,128 @@
+/**
+ * @file        LinearAllocator.cpp
+ *
+ * @note        This file is part of the "Synesthesia3D" graphics engine
+ *
+ * @copyright   Copyright (C) Iftode Bogdan-Marius <iftode.bogdan@gmail.com>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * @copyright
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ * @copyright
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "stdafx.h"
+
+#include "LinearAllocator.h"
+using namespace Synesthesia3D;
+
+LinearAllocator::LinearAllocator(const size_t blockSize, const AllocationTag tag)
+    : m_nBlockSize(blockSize > 0 ? blockSize : 1)
+    , m_eTag(tag)
+    , m_nOffset(0)
+    , m_nUsedSize(0)
+{}
+
+LinearAllocator::~LinearAllocator()
+{
+    Release();
+}
+
+void* LinearAllocator::Allocate(const size_t size, const size_t alignment)
+{
+    assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+    if (!m_arrBlock.empty())
+    {
+        const Block& block = m_arrBlock.back();
+        const size_t alignedOffset = ((size_t)block.pData + m_nOffset + alignment - 1) / alignment * alignment - (size_t)block.pData;
+        if (alignedOffset + size <= block.nSize)
+        {
+            m_nUsedSize += alignedOffset + size - m_nOffset;
+            m_nOffset = alignedOffset + size;
+            return block.pData + alignedOffset;
+        }
+    }
+
+    // Leave room for aligning the allocation, in case it's larger than the alignment of the blocks
+    AddBlock(size + alignment);
+
+    return Allocate(size, alignment);
+}
+
+void LinearAllocator::Reserve(const size_t size)
+{
+    if (m_arrBlock.empty() || m_arrBlock.back().nSize - m_nOffset < size)
+        AddBlock(size + S3D_LINEAR_ALLOCATOR_DEFAULT_ALIGNMENT);
+}
+
+void LinearAllocator::Reset()
+{
+    if (m_arrBlock.empty())
+        return;
+
+    unsigned int largest = 0;
+    for (unsigned int i = 1; i < (unsigned int)m_arrBlock.size(); i++)
+        if (m_arrBlock[i].nSize > m_arrBlock[largest].nSize)
+            largest = i;
+
+    for (unsigned int i = 0; i < (unsigned int)m_arrBlock.size(); i++)
+        if (i != largest)
+            Allocator::FreeMemory(m_arrBlock[i].pData);
+
+    const Block block = m_arrBlock[largest];
+    m_arrBlock.resize(1);
+    m_arrBlock[0] = block;
+
+    m_nOffset = 0;
+    m_nUsedSize = 0;
+}
+
+void LinearAllocator::Release()
+{
+    for (unsigned int i = 0; i < (unsigned int)m_arrBlock.size(); i++)
+        Allocator::FreeMemory(m_arrBlock[i].pData);
+
+    m_arrBlock.clear();
+    m_nOffset = 0;
+    m_nUsedSize = 0;
+}
+
+const size_t LinearAllocator::GetUsedSize() const
+{
+    return m_nUsedSize;
+}
+
+const size_t LinearAllocator::GetReservedSize() const
+{
+    size_t size = 0;
+    for (unsigned int i = 0; i < (unsigned int)m_arrBlock.size(); i++)
+        size += m_arrBlock[i].nSize;
+
+    return size;
+}
+
+const unsigned int LinearAllocator::GetBlockCount() const
+{
+    return (unsigned int)m_arrBlock.size();
+}
+
+void LinearAllocator::AddBlock(const size_t minSize)
+{
+    Block block;
+    block.nSize = minSize > m_nBlockSize ? minSize : m_nBlockSize;
+    block.pData = (char*)Allocator::AllocateMemory(block.nSize, m_eTag);
+    assert(block.pData != nullptr);
+
+    m_arrBlock.push_back(block);
+    m_nOffset = 0;
+}
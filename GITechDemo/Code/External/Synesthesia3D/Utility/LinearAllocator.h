@@ -0,0 +1,135 @@
+/**
+ * @file        LinearAllocator.h
+ *
+ * @note        This file is part of the "Synesthesia3D" graphics engine
+ *
+ * @copyright   Copyright (C) Iftode Bogdan-Marius <iftode.bogdan@gmail.com>
+ *
+ * @copyright
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * @copyright
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ * @copyright
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LINEARALLOCATOR_H
+#define LINEARALLOCATOR_H
+
+#include <stddef.h>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "Allocator.h"
+
+#define S3D_LINEAR_ALLOCATOR_DEFAULT_ALIGNMENT S3D_DEFAULT_ALLOCATION_ALIGNMENT /**< @brief Alignment of allocations for which none is specified, enough for any fundamental type. */
+
+namespace Synesthesia3D
+{
+    /**
+     * @brief   Allocates memory by advancing through large blocks, which are only freed all at once.
+     *
+     * @details Meant for many small allocations which share the same lifetime (e.g. the meshes, materials
+     *          and buffer data of a model), so that they cost a handful of heap allocations instead of one each.
+     *          When a block fills up, a new one is allocated, at least as large as the default block size.
+     *
+     * @note    Destructors of the objects constructed with @ref New() are not called by the allocator.
+     *          Not thread safe.
+     */
+    class LinearAllocator
+    {
+
+    public:
+
+        /**
+         * @brief   Constructor.
+         *
+         * @param[in]   blockSize   Minimum size, in bytes, of the blocks. The first one is allocated on the first allocation.
+         * @param[in]   tag         Subsystem on whose behalf the blocks are allocated (see @ref Allocator::AllocateMemory()).
+         */
+        SYNESTHESIA3D_DLL LinearAllocator(const size_t blockSize = 64u * 1024u, const AllocationTag tag = AT_SERIALIZATION);
+
+        /**
+         * @brief   Destructor. Frees all blocks.
+         */
+        SYNESTHESIA3D_DLL ~LinearAllocator();
+
+        /**
+         * @brief   Allocates memory from the current block, or from a new one if it doesn't fit.
+         *
+         * @param[in]   size        Size, in bytes, of the allocation.
+         * @param[in]   alignment   Alignment, in bytes, of the allocation; must be a power of two.
+         *
+         * @return  Pointer to the allocated memory, valid until @ref Reset() or @ref Release().
+         */
+        SYNESTHESIA3D_DLL void*         Allocate(const size_t size, const size_t alignment = S3D_LINEAR_ALLOCATOR_DEFAULT_ALIGNMENT);
+
+        /**
+         * @brief   Allocates memory for an object and constructs it.
+         */
+        template <typename T, typename... Args>
+        T*                              New(Args&&... args) { return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...); }
+
+        /**
+         * @brief   Makes sure that the next allocations, up to the specified size, are served from a single block.
+         */
+        SYNESTHESIA3D_DLL void          Reserve(const size_t size);
+
+        /**
+         * @brief   Invalidates all allocations, keeping only the largest block, to be reused.
+         */
+        SYNESTHESIA3D_DLL void          Reset();
+
+        /**
+         * @brief   Invalidates all allocations and frees all blocks.
+         */
+        SYNESTHESIA3D_DLL void          Release();
+
+        /**
+         * @brief   Retrieves the size, in bytes, of the memory allocated so far, including alignment padding.
+         */
+        SYNESTHESIA3D_DLL const size_t  GetUsedSize() const;
+
+        /**
+         * @brief   Retrieves the size, in bytes, of all blocks.
+         */
+        SYNESTHESIA3D_DLL const size_t  GetReservedSize() const;
+
+        /**
+         * @brief   Retrieves the number of blocks, i.e. the number of heap allocations made by the allocator.
+         */
+        SYNESTHESIA3D_DLL const unsigned int GetBlockCount() const;
+
+    protected:
+
+        /**
+         * @brief   A block of memory from which allocations are served.
+         */
+        struct Block
+        {
+            char*   pData;  /**< @brief Beginning of the block. */
+            size_t  nSize;  /**< @brief Size of the block, in bytes. */
+        };
+
+        /**
+         * @brief   Allocates a new block, which becomes the current one.
+         */
+        void AddBlock(const size_t minSize);
+
+        std::vector<Block>  m_arrBlock;     /**< @brief Allocated blocks, the last one being the current one. */
+        size_t              m_nBlockSize;   /**< @brief Minimum size of a block. */
+        AllocationTag       m_eTag;         /**< @brief Subsystem on whose behalf the blocks are allocated. */
+        size_t              m_nOffset;      /**< @brief Offset of the next allocation in the current block. */
+        size_t              m_nUsedSize;    /**< @brief Memory allocated so far, including alignment padding. */
+    };
+}
+
+#endif // LINEARALLOCATOR_H
@@ -31,7 +31,7 @@
     #include <pthread.h>
 
     //Data types
-    typdef pthread_mutex_t MUTEX;
+    typedef pthread_mutex_t MUTEX;
 
     #ifndef EBUSY
     #define EBUSY 16 // resource busy
@@ -45,5 +45,7 @@
 // Include common header files
 #include <assert.h>
 #include <malloc.h>
+#include <string.h>
+#include <float.h>
 
 #endif //STDAFX_H
@@ -0,0 +1,299 @@
+#include "stdafx.h"
+
+#include <algorithm>
+
+#include <AssetPack.h>
+using namespace Synesthesia3D;
+
+#include <External/lz4/lz4hc.h>
+
+#include "../Common/Logging.h"
+#include "AssetPacker.h"
+using namespace Synesthesia3DTools;
+
+void AssetPacker::GatherFiles(const std::string& dirPath, const std::string& packPath, std::vector<PackedFile>& files)
+{
+    WIN32_FIND_DATAA findData;
+    HANDLE hFind = FindFirstFileA((dirPath + "\\*").c_str(), &findData);
+    if (hFind == INVALID_HANDLE_VALUE)
+        return;
+
+    do
+    {
+        const std::string name = findData.cFileName;
+        if (name == "." || name == "..")
+            continue;
+
+        const std::string filePath = dirPath + "\\" + name;
+        const std::string filePackPath = packPath.empty() ? name : packPath + "/" + name;
+
+        if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+        {
+            GatherFiles(filePath, filePackPath, files);
+            continue;
+        }
+
+        const size_t extPos = name.find_last_of('.');
+        const std::string ext = extPos != std::string::npos ? name.substr(extPos) : "";
+        if (_stricmp(ext.c_str(), ".s3dtex") != 0 && _stricmp(ext.c_str(), ".s3dmdl") != 0)
+            continue;
+
+        PackedFile file;
+        file.szFilePath = filePath;
+        file.szPackPath = AssetPack::NormalizePath(filePackPath.c_str());
+        file.tEntry.nPathHash = AssetPack::HashPath(file.szPackPath.c_str());
+        file.tEntry.nOffset = 0;
+        file.tEntry.nSize = 0;
+        file.tEntry.nUncompressedSize = 0;
+        file.tEntry.eCodec = APC_NONE;
+        file.tEntry.nContentHash = 0;
+        files.push_back(file);
+    } while (FindNextFileA(hFind, &findData));
+
+    FindClose(hFind);
+}
+
+const bool AssetPacker::WritePack(const char* outFilePath, std::vector<PackedFile>& files, const bool compress, mstream& logStream)
+{
+    // The table of contents is looked up with a binary search on the path hashes
+    std::sort(files.begin(), files.end(),
+        [](const PackedFile& a, const PackedFile& b)
+        {
+            return a.tEntry.nPathHash != b.tEntry.nPathHash ? a.tEntry.nPathHash < b.tEntry.nPathHash : a.szPackPath < b.szPackPath;
+        });
+
+    ofstream packFile(outFilePath, ios::binary | ios::trunc);
+    if (!packFile.is_open())
+    {
+        logStream << "[ERROR] Could not open " << outFilePath << " for writing!\n";
+        return false;
+    }
+
+    const unsigned int version = S3D_ASSET_PACK_FILE_VERSION;
+    const unsigned int entryCount = (unsigned int)files.size();
+
+    // Header and table of contents, with placeholder offsets and sizes to be filled in once the data is written
+    unsigned long long tocSize = S3D_ASSET_PACK_FILE_HEADER_SIZE + 2 * sizeof(unsigned int);
+    for (unsigned int i = 0; i < entryCount; i++)
+        tocSize += 3 * sizeof(unsigned long long) + 4 * sizeof(unsigned int) + files[i].szPackPath.length();
+
+    packFile.write(std::vector<char>((size_t)tocSize, 0).data(), (std::streamsize)tocSize);
+
+    const std::vector<char> padding(S3D_ASSET_PACK_DATA_ALIGNMENT, 0);
+
+    unsigned long long offset = tocSize;
+    unsigned long long totalSize = 0, totalPackedSize = 0;
+
+    for (unsigned int i = 0; i < entryCount; i++)
+    {
+        PackedFile& file = files[i];
+
+        ifstream inFile(file.szFilePath.c_str(), ios::binary);
+        if (!inFile.is_open())
+        {
+            logStream << "[ERROR] Could not open " << file.szFilePath << "!\n";
+            return false;
+        }
+
+        inFile.seekg(0, ios::end);
+        std::vector<char> fileData((size_t)inFile.tellg());
+        inFile.seekg(0, ios::beg);
+        inFile.read(fileData.data(), fileData.size());
+        inFile.close();
+
+        if (fileData.size() > LZ4_MAX_INPUT_SIZE)
+        {
+            logStream << "[ERROR] " << file.szFilePath << " is too large!\n";
+            return false;
+        }
+
+        file.tEntry.nUncompressedSize = (unsigned int)fileData.size();
+        file.tEntry.nSize = file.tEntry.nUncompressedSize;
+        file.tEntry.eCodec = APC_NONE;
+        file.tEntry.nContentHash = AssetPack::HashContents(fileData.data(), fileData.size());
+
+        // Compiled assets are LZ4 compressed already, so only keep the compressed entry if it's actually smaller
+        std::vector<char> compressedData;
+        if (compress && !fileData.empty())
+        {
+            compressedData.resize(LZ4_compressBound((int)fileData.size()));
+            const int compressedSize = LZ4_compress_HC(fileData.data(), compressedData.data(), (int)fileData.size(), (int)compressedData.size(), LZ4HC_CLEVEL_DEFAULT);
+            if (compressedSize > 0 && (unsigned int)compressedSize < file.tEntry.nUncompressedSize)
+            {
+                file.tEntry.nSize = (unsigned int)compressedSize;
+                file.tEntry.eCodec = APC_LZ4;
+            }
+        }
+
+        // Align every entry so that reads start on a sector boundary
+        const unsigned long long alignedOffset = (offset + S3D_ASSET_PACK_DATA_ALIGNMENT - 1) / S3D_ASSET_PACK_DATA_ALIGNMENT * S3D_ASSET_PACK_DATA_ALIGNMENT;
+        packFile.write(padding.data(), (std::streamsize)(alignedOffset - offset));
+        file.tEntry.nOffset = alignedOffset;
+
+        packFile.write(file.tEntry.eCodec == APC_LZ4 ? compressedData.data() : fileData.data(), file.tEntry.nSize);
+        offset = alignedOffset + file.tEntry.nSize;
+
+        totalSize += file.tEntry.nUncompressedSize;
+        totalPackedSize += file.tEntry.nSize;
+
+        logStream << "Packed \"" << file.szPackPath << "\": " << file.tEntry.nUncompressedSize << " bytes";
+        if (file.tEntry.eCodec == APC_LZ4)
+            logStream << " (compressed to " << file.tEntry.nSize << " bytes)";
+        logStream << "\n";
+    }
+
+    packFile.seekp(0, ios::beg);
+    packFile.write(S3D_ASSET_PACK_FILE_HEADER, S3D_ASSET_PACK_FILE_HEADER_SIZE);
+    packFile.write((const char*)&version, sizeof(unsigned int));
+    packFile.write((const char*)&entryCount, sizeof(unsigned int));
+
+    for (unsigned int i = 0; i < entryCount; i++)
+    {
+        const AssetPackEntry& entry = files[i].tEntry;
+        const unsigned int codec = entry.eCodec;
+        packFile.write((const char*)&entry.nPathHash, sizeof(unsigned long long));
+        packFile.write((const char*)&entry.nOffset, sizeof(unsigned long long));
+        packFile.write((const char*)&entry.nSize, sizeof(unsigned int));
+        packFile.write((const char*)&entry.nUncompressedSize, sizeof(unsigned int));
+        packFile.write((const char*)&codec, sizeof(unsigned int));
+        packFile.write((const char*)&entry.nContentHash, sizeof(unsigned long long));
+    }
+
+    for (unsigned int i = 0; i < entryCount; i++)
+    {
+        const unsigned int pathLength = (unsigned int)files[i].szPackPath.length();
+        packFile.write((const char*)&pathLength, sizeof(unsigned int));
+        packFile.write(files[i].szPackPath.c_str(), pathLength);
+    }
+
+    const bool success = !packFile.fail();
+    packFile.close();
+
+    if (!success)
+    {
+        logStream << "[ERROR] Could not write " << outFilePath << "!\n";
+        return false;
+    }
+
+    logStream << "\n[RESULTS]\n";
+    logStream << "Entries: " << entryCount << "\n";
+    logStream << "Asset data: " << totalSize << " bytes, " << totalPackedSize << " bytes packed\n";
+    logStream << "Pack size: " << offset << " bytes\n";
+
+    return true;
+}
+
+void AssetPacker::Run(int argc, char* argv[])
+{
+    bool bValidCmdParams = false;
+    bool bQuiet = false;
+    bool bCompress = false;
+    char outputFilePath[1024] = "";
+    char outputLogDirPath[1024] = "";
+
+    for (unsigned int arg = 1; arg < (unsigned int)argc; arg++)
+    {
+        if (arg != argc - 1)
+        {
+            if (_stricmp(argv[arg], "-q") == 0)
+            {
+                bQuiet = true;
+                continue;
+            }
+
+            if (_stricmp(argv[arg], "-c") == 0)
+            {
+                bCompress = true;
+                continue;
+            }
+
+            if (_stricmp(argv[arg], "-o") == 0)
+            {
+                arg++;
+                strcpy_s(outputFilePath, argv[arg]);
+                continue;
+            }
+
+            if (_stricmp(argv[arg], "-log") == 0)
+            {
+                arg++;
+                strcpy_s(outputLogDirPath, argv[arg]);
+                continue;
+            }
+
+            break;
+        }
+        else
+        {
+            if (argv[arg][0] == '-')
+                break;
+            else
+                bValidCmdParams = true;
+        }
+    }
+
+    if (!bValidCmdParams || strlen(outputFilePath) == 0)
+    {
+        cout << "Usage: AssetPacker [options] -o Path\\To\\pack_file.s3dpak Path\\To\\DataDir" << endl << endl;
+        cout << "Options:" << endl;
+        cout << "-q\t\tQuiet. Does not produce output to the console window" << endl;
+        cout << "-c\t\tCompress entries with LZ4, where it makes them smaller" << endl;
+        cout << "-o pack_file\tPath of the asset pack to write" << endl;
+        cout << "-log output/dir/\tOverride default log output directory (output/dir/ must exist!)" << endl << endl;
+        cout << "All compiled textures (*.s3dtex) and models (*.s3dmdl) in DataDir and its" << endl;
+        cout << "subdirectories are packed, under their paths relative to DataDir." << endl << endl;
+        return;
+    }
+
+    char fileName[256];
+    char time[80];
+    char logName[1024];
+
+    _splitpath_s(outputFilePath, (char*)nullptr, 0, (char*)nullptr, 0, fileName, 256, (char*)nullptr, 0);
+
+    std::time_t rawtime;
+    std::tm* timeinfo = new std::tm;
+    std::time(&rawtime);
+    localtime_s(timeinfo, &rawtime);
+    std::strftime(time, 80, "%Y%m%d%H%M%S", timeinfo);
+    delete timeinfo;
+
+    if (strlen(outputLogDirPath) == 0)
+        strcpy_s(outputLogDirPath, "Logs");
+
+    if (!(CreateDirectoryA(outputLogDirPath, NULL) || ERROR_ALREADY_EXISTS == GetLastError()))
+    {
+        cout << "AssetPacker requires write permission into the current directory";
+        return;
+    }
+
+    sprintf_s(logName, 1024, "%s\\AssetPacker_%s_%s.log", outputLogDirPath, time, fileName);
+    mstream Log(logName, ofstream::trunc, !bQuiet);
+
+    std::string dataDirPath = argv[argc - 1];
+    while (!dataDirPath.empty() && (dataDirPath.back() == '\\' || dataDirPath.back() == '/'))
+        dataDirPath.pop_back();
+
+    Log << "Packing: \"" << dataDirPath << "\"\n";
+    Log << "Output: \"" << outputFilePath << "\"\n\n";
+
+    std::vector<PackedFile> files;
+    GatherFiles(dataDirPath, "", files);
+
+    if (files.empty())
+    {
+        Log << "[ERROR] No compiled assets found!\n";
+        return;
+    }
+
+    if (!WritePack(outputFilePath, files, bCompress, Log))
+        DeleteFileA(outputFilePath);
+}
+
+int main(int argc, char* argv[])
+{
+    AssetPacker ap;
+    ap.Run(argc, argv);
+
+    return 0;
+}
@@ -0,0 +1,29 @@
+#ifndef ASSETPACKER_H
+#define ASSETPACKER_H
+
+#include <string>
+#include <vector>
+
+#include <ResourceData.h>
+
+namespace Synesthesia3DTools
+{
+    class mstream;
+
+    class AssetPacker
+    {
+        struct PackedFile
+        {
+            std::string                     szFilePath;     // Path on disk
+            std::string                     szPackPath;     // Normalized path, relative to the packed directory
+            Synesthesia3D::AssetPackEntry   tEntry;
+        };
+
+        static void GatherFiles(const std::string& dirPath, const std::string& packPath, std::vector<PackedFile>& files);
+        static const bool WritePack(const char* outFilePath, std::vector<PackedFile>& files, const bool compress, mstream& logStream);
+    public:
+        void Run(int argc, char* argv[]);
+    };
+}
+
+#endif // ASSETPACKER_H
@@ -0,0 +1,197 @@
+#include "stdafx.h"
+
+#include <iomanip>
+
+#include <Renderer.h>
+#include <RenderTrace.h>
+using namespace Synesthesia3D;
+
+#include "../Common/Logging.h"
+#include "TraceReplayer.h"
+using namespace Synesthesia3DTools;
+
+#define DEFAULT_ITERATION_COUNT (100)
+
+void TraceReplayer::PrintStats(const RenderTraceReplayStats& stats, mstream& logStream)
+{
+    if (stats.nIterationCount == 0)
+        return;
+
+    long long totalCommandTime = 0;
+    for (unsigned int cmd = 0; cmd < RTC_MAX; cmd++)
+        totalCommandTime += stats.nCommandTime[cmd];
+
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(3);
+    oss << "\n[RESULTS]\n";
+    oss << "Iterations: " << stats.nIterationCount << "\n";
+    oss << "Average frame time: " << (double)stats.nFrameTime / stats.nIterationCount / 1000000.0 << " ms\n";
+    oss << "Average time in traced calls: " << (double)totalCommandTime / stats.nIterationCount / 1000000.0 << " ms\n";
+    oss << "Timer overhead (subtracted): " << (double)stats.nTimerOverhead << " ns per call\n\n";
+
+    oss << std::left << std::setw(36) << "Call" << std::right
+        << std::setw(12) << "Calls/frame"
+        << std::setw(14) << "Total (ms)"
+        << std::setw(14) << "Avg (us)"
+        << std::setw(12) << "% of calls" << "\n";
+
+    for (unsigned int cmd = 0; cmd < RTC_MAX; cmd++)
+    {
+        if (stats.nCommandCount[cmd] == 0)
+            continue;
+
+        const unsigned long long callCount = (unsigned long long)stats.nCommandCount[cmd] * stats.nIterationCount;
+
+        oss << std::left << std::setw(36) << Renderer::GetEnumString((RenderTraceCommand)cmd) << std::right
+            << std::setw(12) << stats.nCommandCount[cmd]
+            << std::setw(14) << (double)stats.nCommandTime[cmd] / 1000000.0
+            << std::setw(14) << (double)stats.nCommandTime[cmd] / callCount / 1000.0
+            << std::setw(12) << (totalCommandTime > 0 ? 100.0 * stats.nCommandTime[cmd] / totalCommandTime : 0.0) << "\n";
+    }
+
+    logStream << oss.str();
+}
+
+void TraceReplayer::Run(int argc, char* argv[])
+{
+    bool bValidCmdParams = false;
+    bool bQuiet = false;
+    API api = API_NULL;
+    unsigned int iterationCount = DEFAULT_ITERATION_COUNT;
+    char outputLogDirPath[1024] = "";
+
+    for (unsigned int arg = 1; arg < (unsigned int)argc; arg++)
+    {
+        if (arg != argc - 1)
+        {
+            if (_stricmp(argv[arg], "-q") == 0)
+            {
+                bQuiet = true;
+                continue;
+            }
+
+            if (_stricmp(argv[arg], "-api") == 0)
+            {
+                arg++;
+
+                if (_stricmp(argv[arg], "null") == 0)
+                {
+                    api = API_NULL;
+                    continue;
+                }
+
+                if (_stricmp(argv[arg], "dx9") == 0)
+                {
+                    api = API_DX9;
+                    continue;
+                }
+            }
+
+            if (_stricmp(argv[arg], "-n") == 0)
+            {
+                arg++;
+                iterationCount = atoi(argv[arg]);
+                continue;
+            }
+
+            if (_stricmp(argv[arg], "-log") == 0)
+            {
+                arg++;
+                strcpy_s(outputLogDirPath, argv[arg]);
+                continue;
+            }
+
+            break;
+        }
+        else
+        {
+            if (argv[arg][0] == '-')
+                break;
+            else
+                bValidCmdParams = true;
+        }
+    }
+
+    if (!bValidCmdParams || iterationCount == 0)
+    {
+        cout << "Usage: TraceReplayer [options] Path\\To\\trace_file.s3dtrace" << endl << endl;
+        cout << "Options:" << endl;
+        cout << "-q\t\tQuiet. Does not produce output to the console window" << endl;
+        cout << "-api null|dx9\tRenderer to replay the trace on (default: null)" << endl;
+        cout << "-n count\tNumber of times to replay the trace (default: " << DEFAULT_ITERATION_COUNT << ")" << endl;
+        cout << "-log output/dir/\tOverride default log output directory (output/dir/ must exist!)" << endl << endl;
+        cout << "Shader programs referenced by the trace are loaded from paths relative" << endl;
+        cout << "to the current directory, so run from the traced application's directory." << endl << endl;
+        return;
+    }
+
+    char fileName[256];
+    char time[80];
+    char logName[1024];
+
+    _splitpath_s(argv[argc - 1], (char*)nullptr, 0, (char*)nullptr, 0, fileName, 256, (char*)nullptr, 0);
+
+    std::time_t rawtime;
+    std::tm* timeinfo = new std::tm;
+    std::time(&rawtime);
+    localtime_s(timeinfo, &rawtime);
+    std::strftime(time, 80, "%Y%m%d%H%M%S", timeinfo);
+    delete timeinfo;
+
+    if (strlen(outputLogDirPath) == 0)
+        strcpy_s(outputLogDirPath, "Logs");
+
+    if (!(CreateDirectoryA(outputLogDirPath, NULL) || ERROR_ALREADY_EXISTS == GetLastError()))
+    {
+        cout << "TraceReplayer requires write permission into the current directory";
+        return;
+    }
+
+    sprintf_s(logName, 1024, "%s\\TraceReplayer_%s_%s.log", outputLogDirPath, time, fileName);
+    mstream Log(logName, ofstream::trunc, !bQuiet);
+
+    Log << "Replaying: \"" << argv[argc - 1] << "\"\n";
+    Log << "Renderer: " << (api == API_DX9 ? "DX9" : "NULL") << "\n";
+
+    // The Direct3D 9 device needs a window, so present to the console's
+    Renderer::CreateInstance(api);
+    Renderer* renderer = Renderer::GetInstance();
+    if (renderer)
+        renderer->Initialize(api == API_DX9 ? GetConsoleWindow() : nullptr);
+
+    if (!renderer)
+    {
+        Log << "[ERROR] Could not initialize renderer!\n";
+        return;
+    }
+
+    RenderTrace* const trace = renderer->GetRenderTrace();
+    if (!trace->Load(argv[argc - 1]))
+    {
+        Log << "[ERROR] Could not load render trace!\n";
+        Renderer::DestroyInstance();
+        return;
+    }
+
+    Log << "Commands: " << trace->GetCommandCount() << "\n";
+
+    RenderTraceReplayStats stats;
+    if (!trace->Replay(iterationCount, stats))
+    {
+        Log << "[ERROR] Could not replay render trace!\n";
+        Renderer::DestroyInstance();
+        return;
+    }
+
+    PrintStats(stats, Log);
+
+    Renderer::DestroyInstance();
+}
+
+int main(int argc, char* argv[])
+{
+    TraceReplayer tr;
+    tr.Run(argc, argv);
+
+    return 0;
+}
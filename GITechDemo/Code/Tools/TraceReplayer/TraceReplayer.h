@@ -0,0 +1,21 @@
+#ifndef TRACEREPLAYER_H
+#define TRACEREPLAYER_H
+
+namespace Synesthesia3D
+{
+    struct RenderTraceReplayStats;
+}
+
+namespace Synesthesia3DTools
+{
+    class mstream;
+
+    class TraceReplayer
+    {
+        static void PrintStats(const Synesthesia3D::RenderTraceReplayStats& stats, mstream& logStream);
+    public:
+        void Run(int argc, char* argv[]);
+    };
+}
+
+#endif // TRACEREPLAYER_H
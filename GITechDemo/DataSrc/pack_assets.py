@@ -0,0 +1,76 @@
+﻿#=============================================================================
+# This file is part of the "GITechDemo" application
+# Copyright (C) Iftode Bogdan-Marius <iftode.bogdan@gmail.com>
+#
+#       File:   pack_assets.py
+#       Author: Bogdan Iftode
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program. If not, see <http://www.gnu.org/licenses/>.
+#=============================================================================
+
+import os
+import subprocess
+import time
+import sys
+
+#############################################################################
+#       Arguments:                                                          #
+#---------------------------------------------------------------------------#
+#   'x86' to use the 32 bit version of the tools                            #
+#   'x64' to use the 64 bit version of the tools (default)                  #
+#   'rebuild' to force rebuilding all data assets                           #
+#############################################################################
+
+defaultArchitecture = "x64"
+defaultForceRebuild = False
+
+# Retrieve absolute path of this script
+scriptAbsPath = os.path.abspath(os.path.dirname(os.path.realpath(sys.argv[0])));
+
+# Process command arguments
+for opt in sys.argv:
+    if(opt.lower() == "x64"):
+        defaultArchitecture = "x64"
+    if(opt.lower() == "win32" or opt.lower() == "x86"):
+        defaultArchitecture = "x86"
+    if(opt.lower() == "rebuild"):
+        defaultForceRebuild = True
+
+# Set paths
+pathToDataFiles = scriptAbsPath + "/../Data/"
+outputFile = pathToDataFiles + "GITechDemo.s3dpak"
+assetPackerExe = scriptAbsPath + "/../Bin/" + defaultArchitecture + "/Release/Synesthesia3DTools/AssetPacker.exe"
+
+# Compiled assets are packed, so run after all compile scripts
+packExtensions = [ ".s3dtex", ".s3dmdl" ]
+
+start = time.clock()
+
+# Detect modification of any compiled asset, or of the asset packer executable
+packIsOutdated = defaultForceRebuild or not os.path.isfile(outputFile)
+if not packIsOutdated:
+    packTime = os.path.getmtime(outputFile)
+    packIsOutdated = os.path.getmtime(assetPackerExe) > packTime
+    for root, dir, files in os.walk(pathToDataFiles):
+        for name in files:
+            if os.path.splitext(name)[1].lower() in packExtensions and os.path.getmtime(os.path.join(root, name)) > packTime:
+                packIsOutdated = True
+
+if packIsOutdated:
+    print "Packing compiled assets into \"" + outputFile.replace(scriptAbsPath + "/", "") + "\""
+    subprocess.call(assetPackerExe + " -q -o " + outputFile + " -log " + scriptAbsPath + "/Logs " + pathToDataFiles)
+else:
+    print "Asset pack \"" + outputFile.replace(scriptAbsPath + "/", "") + "\" is up-to-date"
+
+print "Done in " + str(time.clock() - start) + " seconds.";